@@ -35,7 +35,15 @@ SOURCES += \
     kfrustum.cpp \
     kimage.cpp \
     kabstracthdrparser.cpp \
-    kbufferedbinaryfilereader.cpp
+    kbufferedbinaryfilereader.cpp \
+    kthreadpool.cpp \
+    ktaskgroup.cpp \
+    kspatialfile.cpp \
+    kboundingvolumefit.cpp \
+    kbc6hencoder.cpp \
+    ktexturefile.cpp \
+    kenvironmentbaker.cpp \
+    kmappedfile.cpp
 
 HEADERS += \
     kcolor.h \
@@ -106,4 +114,14 @@ HEADERS += \
     kvector4d.h \
     kimage.h \
     kabstracthdrparser.h \
-    kbufferedbinaryfilereader.h
+    kbufferedbinaryfilereader.h \
+    kthreadpool.h \
+    ktaskgroup.h \
+    kparallel.h \
+    kspatialfile.h \
+    kboundingvolumefit.h \
+    kbc6hencoder.h \
+    ktexturefile.h \
+    kenvironmentbaker.h \
+    kmappedfile.h \
+    khash.h
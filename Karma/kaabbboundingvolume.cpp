@@ -6,12 +6,13 @@
 #include <KMatrix3x3>
 #include <KMatrix4x4>
 #include <KMath>
+#include <KBoundingVolumeFit>
 
 class KAabbBoundingVolumePrivate
 {
 public:
   KAabbBoundingVolumePrivate();
-  void calculateMinMaxMethod(KHalfEdgeMesh const &mesh);
+  void calculateMinMaxMethod(KBoundingVolumeFit const &fit);
   Karma::MinMaxKVector3D maxMin;
 };
 
@@ -21,10 +22,9 @@ KAabbBoundingVolumePrivate::KAabbBoundingVolumePrivate() :
   // Intentionally Empty
 }
 
-void KAabbBoundingVolumePrivate::calculateMinMaxMethod(const KHalfEdgeMesh &mesh)
+void KAabbBoundingVolumePrivate::calculateMinMaxMethod(KBoundingVolumeFit const &fit)
 {
-  KHalfEdgeMesh::VertexContainer const &vertices = mesh.vertices();
-  maxMin = Karma::findMinMaxBounds(vertices.begin(), vertices.end(), KHalfEdgeMesh::VertexPositionPred());
+  maxMin = fit.moments().bounds;
 }
 
 KAabbBoundingVolume::KAabbBoundingVolume() :
@@ -79,13 +79,19 @@ KAabbBoundingVolume::KAabbBoundingVolume(const KAabbBoundingVolume &a, const KAa
 }
 
 KAabbBoundingVolume::KAabbBoundingVolume(KHalfEdgeMesh const &mesh, Method method) :
+  KAabbBoundingVolume(KBoundingVolumeFit(mesh), method)
+{
+  // Intentionally Empty
+}
+
+KAabbBoundingVolume::KAabbBoundingVolume(KBoundingVolumeFit const &fit, Method method) :
   m_private(new KAabbBoundingVolumePrivate)
 {
   P(KAabbBoundingVolumePrivate);
   switch (method)
   {
   case MinMaxMethod:
-    p.calculateMinMaxMethod(mesh);
+    p.calculateMinMaxMethod(fit);
     break;
   }
 }
@@ -5,6 +5,7 @@
 #include <KAbstractBoundingVolume>
 class KColor;
 class KHalfEdgeMesh;
+class KBoundingVolumeFit;
 class KTransform3D;
 class KMatrix4x4;
 
@@ -26,6 +27,7 @@ public:
   KAabbBoundingVolume(It begin, It end, Accessor accessor = Karma::DefaultAccessor<KVector3D const>());
   KAabbBoundingVolume(KAabbBoundingVolume const &a, KAabbBoundingVolume const &b);
   KAabbBoundingVolume(KHalfEdgeMesh const &mesh, Method method);
+  KAabbBoundingVolume(KBoundingVolumeFit const &fit, Method method);
   KAabbBoundingVolume(KAabbBoundingVolume const &a, KVector3D const &offset);
   ~KAabbBoundingVolume();
   void operator=(KAabbBoundingVolume const &rhs);
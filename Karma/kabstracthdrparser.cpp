@@ -6,6 +6,14 @@
 #include <KAbstractLexer>
 #include <KCommon>
 #include <KAbstractReader>
+#include <KParallel>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KHDR_SSE2
+#include <emmintrin.h>
+#endif
 
 union Rgbe
 {
@@ -25,6 +33,29 @@ struct RleCode
   unsigned char run;
 };
 
+// Scanlines decoded per task when the whole file is in memory.
+static const size_t ScanlineGrain = 8;
+
+// 2^(e - 136) for every RGBE exponent, zero stays black.
+struct ExponentTable
+{
+  ExponentTable()
+  {
+    values[0] = 0.0f;
+    for (int e = 1; e < 256; ++e)
+    {
+      values[e] = float(ldexp(1.0, e - int(128+8)));
+    }
+  }
+  float values[256];
+};
+
+static float const *exponentTable()
+{
+  static const ExponentTable sg_table;
+  return sg_table.values;
+}
+
 /*******************************************************************************
  * Parser Definitions
  ******************************************************************************/
@@ -63,6 +94,11 @@ public:
   void writeColor(float *dest, unsigned char r, unsigned char g, unsigned char b, unsigned char e);
   void writeScanline(float *dest, unsigned char *src, int scanline);
 
+  // In-memory decoding
+  bool scanOffsets(unsigned char const *data, size_t size, std::vector<size_t> *offsets);
+  bool decodeScanline(unsigned char const *src, unsigned char const *end, unsigned char *scanline);
+  bool parseSpan(float *dest);
+
   // Lexer
   token_id lexToken(token_type &token);
   token_id lexTokenKeyValue(token_type &token);
@@ -73,13 +109,14 @@ public:
 
 private:
   KAbstractHdrParser *m_parser;
+  KAbstractReader *m_reader;
   std::string m_key, m_value;
   PixelOrder m_xOrder, m_yOrder;
   int m_xSize, m_ySize;
 };
 
 KAbstractHdrParserPrivate::KAbstractHdrParserPrivate(KAbstractHdrParser *parser, KAbstractReader *reader) :
-  KAbstractLexer<ParseToken>(reader), m_parser(parser)
+  KAbstractLexer<ParseToken>(reader), m_parser(parser), m_reader(reader)
 {
   // Intentionally Empty
 }
@@ -147,21 +184,146 @@ void KAbstractHdrParserPrivate::writeColor(float *dest, unsigned char r, unsigne
 
 void KAbstractHdrParserPrivate::writeScanline(float *dest, unsigned char *src, int scanline)
 {
+  // Channels are stored as separate planes of m_xSize bytes each
+  unsigned char const *r = src;
+  unsigned char const *g = src + m_xSize;
+  unsigned char const *b = src + 2 * m_xSize;
+  unsigned char const *e = src + 3 * m_xSize;
+  float const *table = exponentTable();
   switch (m_yOrder)
   {
   case KAbstractHdrParser::Positive:
-    for (int i = 0; i < m_xSize; ++i)
-    {
-      writeColor(&dest[scanline*m_xSize*3 + i*3], src[i], src[i + m_xSize], src[i + 2 * m_xSize], src[i + 3 * m_xSize]);
-    }
+    dest += scanline * m_xSize * 3;
     break;
   case KAbstractHdrParser::Negative:
-    for (int i = 0; i < m_xSize; ++i)
+    dest += (m_ySize - scanline - 1) * m_xSize * 3;
+    break;
+  }
+
+  int i = 0;
+#ifdef KHDR_SSE2
+  // Four pixels per step; every store spills one float into the next pixel,
+  // so the last pixel of the scanline is left to the scalar loop.
+  __m128i zero = _mm_setzero_si128();
+  for (; i + 4 < m_xSize; i += 4)
+  {
+    int32_t rgba[4];
+    std::memcpy(&rgba[0], r + i, 4);
+    std::memcpy(&rgba[1], g + i, 4);
+    std::memcpy(&rgba[2], b + i, 4);
+    std::memcpy(&rgba[3], e + i, 4);
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(rgba));
+    __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+    __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+    __m128 vf = _mm_setr_ps(table[e[i]], table[e[i + 1]], table[e[i + 2]], table[e[i + 3]]);
+    __m128 vr = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), vf);
+    __m128 vg = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), vf);
+    __m128 vb = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), vf);
+    __m128 vz = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(vr, vg, vb, vz);
+    _mm_storeu_ps(&dest[(i + 0) * 3], vr);
+    _mm_storeu_ps(&dest[(i + 1) * 3], vg);
+    _mm_storeu_ps(&dest[(i + 2) * 3], vb);
+    _mm_storeu_ps(&dest[(i + 3) * 3], vz);
+  }
+#endif // KHDR_SSE2
+  for (; i < m_xSize; ++i)
+  {
+    float f = table[e[i]];
+    dest[i * 3 + 0] = r[i] * f;
+    dest[i * 3 + 1] = g[i] * f;
+    dest[i * 3 + 2] = b[i] * f;
+  }
+}
+
+bool KAbstractHdrParserPrivate::scanOffsets(unsigned char const *data, size_t size, std::vector<size_t> *offsets)
+{
+  // Only skips over the runs to find where every scanline starts.
+  size_t pos = 0;
+  offsets->resize(m_ySize + 1);
+  for (int y = 0; y < m_ySize; ++y)
+  {
+    (*offsets)[y] = pos;
+    if (pos + 4 > size) return false;
+    if (data[pos] != 2 || data[pos + 1] != 2 || ((data[pos + 2] << 8) | data[pos + 3]) != m_xSize) return false;
+    pos += 4;
+    for (int channel = 0; channel < 4; ++channel)
     {
-      writeColor(&dest[(m_ySize - scanline - 1)*m_xSize*3 + i*3], src[i], src[i + m_xSize], src[i + 2 * m_xSize], src[i + 3 * m_xSize]);
+      int remaining = m_xSize;
+      while (remaining > 0)
+      {
+        if (pos + 2 > size) return false;
+        int run = data[pos];
+        int count = (run > 128) ? run - 128 : run;
+        if (count == 0 || count > remaining) return false;
+        pos += (run > 128) ? 2 : 1 + count;
+        remaining -= count;
+      }
+    }
+  }
+  if (pos > size) return false;
+  (*offsets)[m_ySize] = pos;
+  return true;
+}
+
+bool KAbstractHdrParserPrivate::decodeScanline(unsigned char const *src, unsigned char const *end, unsigned char *scanline)
+{
+  // Runs were validated by scanOffsets(), only expand them here.
+  src += 4;
+  unsigned char *ptr = scanline;
+  unsigned char *scanlineEnd = scanline + 4 * m_xSize;
+  while (ptr < scanlineEnd)
+  {
+    int run = *src++;
+    if (run > 128)
+    {
+      std::memset(ptr, *src++, run - 128);
+      ptr += run - 128;
+    }
+    else
+    {
+      std::memcpy(ptr, src, run);
+      src += run;
+      ptr += run;
     }
-    break;
   }
+  return (src == end);
+}
+
+bool KAbstractHdrParserPrivate::parseSpan(float *dest)
+{
+  // The lexer has already read one character past the header.
+  unsigned char const *data = m_reader->data();
+  if (!data || m_reader->position() == 0) return false;
+  size_t start = m_reader->position() - 1;
+  if (start > m_reader->size()) return false;
+  data += start;
+  size_t size = m_reader->size() - start;
+
+  // Only new-style RLE scanlines can be located without decoding.
+  std::vector<size_t> offsets;
+  if (m_xSize < 8 || m_xSize > 0x7fff || !scanOffsets(data, size, &offsets)) return false;
+
+  int valid = Karma::parallelReduce(
+    0, size_t(m_ySize), ScanlineGrain, 1,
+    [this, data, dest, &offsets](size_t b, size_t e)
+    {
+      int valid = 1;
+      std::vector<unsigned char> scanline(4 * m_xSize);
+      for (size_t y = b; y < e; ++y)
+      {
+        valid &= int(decodeScanline(data + offsets[y], data + offsets[y + 1], scanline.data()));
+        writeScanline(dest, scanline.data(), int(y));
+      }
+      return valid;
+    },
+    [](int lhs, int rhs) { return lhs & rhs; }
+  );
+  if (!valid)
+  {
+    qFatal("Run lengths do not match the scanline width, the file may be corrupt.");
+  }
+  return (valid != 0);
 }
 
 int KAbstractHdrParserPrivate::readInteger()
@@ -276,6 +438,13 @@ bool KAbstractHdrParserPrivate::parse()
   RleCode rle;
   float *dest = m_parser->beginData();
 
+  // Mapped files decode all scanlines in place and in parallel
+  if (parseSpan(dest))
+  {
+    m_parser->endData();
+    return false;
+  }
+
   int count;
   size_t repeat = 0;
   unsigned invalidCount = 0;
@@ -1,11 +1,19 @@
 #ifndef KABSTRACTREADER_H
 #define KABSTRACTREADER_H KAbstractReader
 
+#include <cstddef>
+
 class KAbstractReader
 {
 public:
   static const int EndOfFile = -1;
   virtual int next() = 0;
+
+  // Readers backed by memory may expose the whole input for bulk decoding.
+  // position() is the number of characters returned by next() so far.
+  virtual unsigned char const *data() const { return 0; }
+  virtual size_t size() const { return 0; }
+  virtual size_t position() const { return 0; }
 };
 
 #endif // KABSTRACTREADER_H
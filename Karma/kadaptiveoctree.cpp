@@ -9,6 +9,22 @@
 #include <KTrianglePartition>
 #include <KTrianglePointIterator>
 #include <OpenGLDebugDraw>
+#include <KTaskGroup>
+#include <KSpatialFile>
+#include <QString>
+#include <atomic>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Subtrees smaller than this are built serially (task overhead dominates).
+static const size_t ParallelCutoff = 4096;
+
+// Every node draws from a generator of its own, seeded from its parent.
+static int nodeRandom(std::minstd_rand &rng)
+{
+  return static_cast<int>(rng() % (static_cast<unsigned>(RAND_MAX) + 1u));
+}
 
 /*******************************************************************************
  * KAdaptiveOctreeNode
@@ -16,29 +32,38 @@
 class KAdaptiveOctreeNode
 {
 public:
-  typedef KTriangleIndexCloud::ConstIterator ConstIterator;
-
-  KAdaptiveOctreeNode(size_t depth, KAabbBoundingVolume const &aabb, KPointCloud &cloud);
+  KAdaptiveOctreeNode(size_t depth, KAabbBoundingVolume const &aabb, std::minstd_rand &rng);
+  ~KAdaptiveOctreeNode();
   bool isLeaf() const;
-  void debugDraw(KTransform3D &trans, size_t min, size_t max) const;
 
   size_t m_depth;
   KColor m_color;
-  KPointCloud &m_pointCloud;
   KAabbBoundingVolume m_aabb;
   KAdaptiveOctreeNode *m_children[8];
-  KTriangleIndexCloud m_objects;
+  size_t m_first, m_count; // Range within the (partitioned) triangle cloud
 };
 
-KAdaptiveOctreeNode::KAdaptiveOctreeNode(size_t depth, KAabbBoundingVolume const &aabb, KPointCloud &cloud) :
-  m_depth(depth), m_color(float(std::rand()) / RAND_MAX, float(std::rand()) / RAND_MAX, float(std::rand()) / RAND_MAX), m_pointCloud(cloud), m_aabb(aabb)
+KAdaptiveOctreeNode::KAdaptiveOctreeNode(size_t depth, KAabbBoundingVolume const &aabb, std::minstd_rand &rng) :
+  m_depth(depth), m_aabb(aabb), m_first(0), m_count(0)
 {
+  float r = float(nodeRandom(rng)) / RAND_MAX;
+  float g = float(nodeRandom(rng)) / RAND_MAX;
+  float b = float(nodeRandom(rng)) / RAND_MAX;
+  m_color = KColor(r, g, b);
   for (int i = 0; i < 8; ++i)
   {
     m_children[i] = 0;
   }
 }
 
+KAdaptiveOctreeNode::~KAdaptiveOctreeNode()
+{
+  for (int i = 0; i < 8; ++i)
+  {
+    delete m_children[i];
+  }
+}
+
 bool KAdaptiveOctreeNode::isLeaf() const
 {
   for (int i = 0; i < 8; ++i)
@@ -49,23 +74,18 @@ bool KAdaptiveOctreeNode::isLeaf() const
   return true;
 }
 
-void KAdaptiveOctreeNode::debugDraw(KTransform3D &trans, size_t min, size_t max) const
+/*******************************************************************************
+ * KAdaptiveOctreeFlatNode
+ ******************************************************************************/
+// Note: Stored verbatim on disk, only add fixed-size fields (and bump the file version).
+struct KAdaptiveOctreeFlatNode
 {
-  if (m_depth <= max)
-  {
-    if (m_depth >= min)
-    {
-      m_aabb.draw(trans, m_color);
-    }
-    for (int i = 0; i < 8; ++i)
-    {
-      if (m_children[i])
-      {
-        m_children[i]->debugDraw(trans, min, max);
-      }
-    }
-  }
-}
+  float min[3], max[3];
+  uint32_t depth;
+  uint32_t color;
+  uint32_t firstTriangle, numTriangles;
+  uint32_t children[8]; // 0 = no child (the root is never a child)
+};
 
 /*******************************************************************************
  * KAdaptiveOctreePrivate
@@ -78,19 +98,55 @@ public:
 
   KAdaptiveOctreePrivate(KGeometryCloud &parent);
   void buildBottomUp(TerminationPred pred);
-  void buildTopDown(TerminationPred pred);
-  KAdaptiveOctreeNode* recursiveTopDown(size_t depth, KAabbBoundingVolume aabb, TriangleIterator begin, TriangleIterator end, TerminationPred pred);
+  void buildTopDown(TerminationPred pred, int flags);
+  KAdaptiveOctreeNode* recursiveTopDown(size_t depth, uint32_t seed, KAabbBoundingVolume aabb, TriangleIterator begin, TriangleIterator end, TerminationPred pred);
+  void updateMaxDepth(size_t depth);
+  bool parallel() const;
+  bool deterministic() const;
+  uint32_t rootSeed() const;
+  void flatten(KAdaptiveOctreeNode *root);
+  uint32_t flattenNode(KAdaptiveOctreeNode const *node);
+  bool validNodes() const;
+  void drawNode(KTransform3D &trans, uint32_t index, size_t min, size_t max) const;
 
-  size_t m_maxDepth;
+  std::atomic<size_t> m_maxDepth; // Reported by depth(), never read while building
+  int m_buildFlags;
   KGeometryCloud m_parent;
   KPointCloud m_pointCloud;
-  KAdaptiveOctreeNode *m_root;
+
+  // Flattened tree (owned after a build, mapped after a load)
+  std::vector<KAdaptiveOctreeFlatNode> m_flatNodes;
+  std::vector<uint32_t> m_flatTriangles;
+  KSpatialFile m_file;
+  KSpatialFile::Description m_view;
 };
 
 KAdaptiveOctreePrivate::KAdaptiveOctreePrivate(KGeometryCloud &parent) :
-  m_parent(parent), m_root(0)
+  m_maxDepth(0), m_buildFlags(KGeometryCloud::NoBuildFlags), m_parent(parent)
 {
-  // Intentionally Empty
+  std::memset(&m_view, 0, sizeof(m_view));
+}
+
+void KAdaptiveOctreePrivate::updateMaxDepth(size_t depth)
+{
+  size_t prevDepth = m_maxDepth;
+  while (prevDepth < depth && !m_maxDepth.compare_exchange_weak(prevDepth, depth));
+}
+
+bool KAdaptiveOctreePrivate::parallel() const
+{
+  return (m_buildFlags & KGeometryCloud::ParallelBuild);
+}
+
+bool KAdaptiveOctreePrivate::deterministic() const
+{
+  return (m_buildFlags & KGeometryCloud::DeterministicBuild);
+}
+
+uint32_t KAdaptiveOctreePrivate::rootSeed() const
+{
+  // Only the root seed differs between builds, serial or parallel.
+  return deterministic() ? 0 : std::random_device()();
 }
 
 void KAdaptiveOctreePrivate::buildBottomUp(TerminationPred pred)
@@ -99,28 +155,34 @@ void KAdaptiveOctreePrivate::buildBottomUp(TerminationPred pred)
   qFatal("Unsupported Build Method!");
 }
 
-void KAdaptiveOctreePrivate::buildTopDown(TerminationPred pred)
+void KAdaptiveOctreePrivate::buildTopDown(TerminationPred pred, int flags)
 {
   m_maxDepth = 0;
+  m_buildFlags = flags;
   KTriangleIndexCloud & triangleCloud = m_parent.triangleIndexCloud();
   KPointCloud & pointCloud = m_parent.pointCloud();
   KAabbBoundingVolume boundingVolume(KTrianglePointIterator(triangleCloud.begin(), pointCloud), KTrianglePointIterator(triangleCloud.end(), pointCloud));
   boundingVolume.makeCube();
   m_pointCloud = m_parent.pointCloud();
-  m_root = recursiveTopDown(0, boundingVolume, triangleCloud.begin(), triangleCloud.end(), pred);
+  flatten(recursiveTopDown(0, rootSeed(), boundingVolume, triangleCloud.begin(), triangleCloud.end(), pred));
 }
 
-KAdaptiveOctreeNode* KAdaptiveOctreePrivate::recursiveTopDown(size_t depth, KAabbBoundingVolume aabb, TriangleIterator begin, TriangleIterator end, TerminationPred pred)
+KAdaptiveOctreeNode* KAdaptiveOctreePrivate::recursiveTopDown(size_t depth, uint32_t seed, KAabbBoundingVolume aabb, TriangleIterator begin, TriangleIterator end, TerminationPred pred)
 {
   KPointCloud const & pointCloud = m_parent.pointCloud();
   size_t numTriangles = std::distance(begin, end);
-  if (m_maxDepth < depth) m_maxDepth = depth;
+  updateMaxDepth(depth);
+
+  // Nothing may depend on the order nodes are visited in, so randomness is
+  // seeded per-node and the predicate sees the depth of the node.
+  std::minstd_rand rng(seed + 1);
 
   // Check if the predicate was met (terminating condition)
-  KAdaptiveOctreeNode *node = new KAdaptiveOctreeNode(depth, aabb, m_pointCloud);
-  if (pred(numTriangles, m_maxDepth))
+  KAdaptiveOctreeNode *node = new KAdaptiveOctreeNode(depth, aabb, rng);
+  node->m_first = std::distance(m_parent.triangleIndexCloud().begin(), begin);
+  node->m_count = numTriangles;
+  if (pred(numTriangles, depth))
   {
-    node->m_objects.copy(begin, end);
     return node;
   }
 
@@ -139,21 +201,130 @@ KAdaptiveOctreeNode* KAdaptiveOctreePrivate::recursiveTopDown(size_t depth, KAab
     aabb.copyOffset(-extent,  extent, -extent)
   };
 
+  // Partition for all OctNodes first (children only reorder their own range)
+  TriangleIterator bounds[9];
+  bounds[0] = begin;
+  for (int i = 0; i < 8; ++i)
+  {
+    bounds[i + 1] = std::partition(bounds[i], end, KTrianglePartitionInsideAabb(pointCloud, aabbList[i]));
+  }
+
   // Create all OctNodes
-  TriangleIterator prevIter = begin;
-  TriangleIterator currIter = end;
+  KTaskGroup group;
   for (int i = 0; i < 8; ++i)
   {
-    currIter = std::partition(prevIter, end, KTrianglePartitionInsideAabb(pointCloud, aabbList[i]));
-    node->m_children[i] = recursiveTopDown(depth + 1, aabbList[i], prevIter, currIter, pred);
-    prevIter = currIter;
+    KAabbBoundingVolume childAabb = aabbList[i];
+    TriangleIterator childBegin = bounds[i];
+    TriangleIterator childEnd = bounds[i + 1];
+    uint32_t childSeed = Karma::hashSeed(seed, i);
+    KAdaptiveOctreeNode **child = &node->m_children[i];
+    if (parallel() && static_cast<size_t>(std::distance(childBegin, childEnd)) > ParallelCutoff)
+    {
+      group.run([=]() { *child = recursiveTopDown(depth + 1, childSeed, childAabb, childBegin, childEnd, pred); });
+    }
+    else
+    {
+      *child = recursiveTopDown(depth + 1, childSeed, childAabb, childBegin, childEnd, pred);
+    }
   }
+  group.wait();
 
-  // Grab remaining indices
-  node->m_objects.copy(begin, end);
   return node;
 }
 
+void KAdaptiveOctreePrivate::flatten(KAdaptiveOctreeNode *root)
+{
+  // Nodes are laid out depth-first, children refer to each other by index.
+  m_flatNodes.clear();
+  flattenNode(root);
+  delete root;
+
+  // Triangles are stored in partitioned order, so every node owns a range.
+  KTriangleIndexCloud const &triangleCloud = m_parent.triangleIndexCloud();
+  m_flatTriangles.clear();
+  m_flatTriangles.reserve(triangleCloud.size() * 3);
+  for (KTriangleIndexCloud::ElementType const &triangle : triangleCloud)
+  {
+    m_flatTriangles.push_back(static_cast<uint32_t>(triangle.indices[0] - 1));
+    m_flatTriangles.push_back(static_cast<uint32_t>(triangle.indices[1] - 1));
+    m_flatTriangles.push_back(static_cast<uint32_t>(triangle.indices[2] - 1));
+  }
+
+  m_view.maxDepth = static_cast<uint32_t>(m_maxDepth.load());
+  m_view.nodes = m_flatNodes.data();
+  m_view.nodeCount = m_flatNodes.size();
+  m_view.nodeSize = sizeof(KAdaptiveOctreeFlatNode);
+  m_view.triangles = m_flatTriangles.data();
+  m_view.triangleCount = triangleCloud.size();
+  m_view.points = m_pointCloud.data();
+  m_view.pointCount = m_pointCloud.size();
+}
+
+uint32_t KAdaptiveOctreePrivate::flattenNode(KAdaptiveOctreeNode const *node)
+{
+  uint32_t index = static_cast<uint32_t>(m_flatNodes.size());
+  KAdaptiveOctreeFlatNode flat;
+  Karma::MinMaxKVector3D const &extents = node->m_aabb.extents();
+  for (int i = 0; i < 3; ++i)
+  {
+    flat.min[i] = extents.min[i];
+    flat.max[i] = extents.max[i];
+  }
+  flat.depth = static_cast<uint32_t>(node->m_depth);
+  flat.color = node->m_color.rgba();
+  flat.firstTriangle = static_cast<uint32_t>(node->m_first);
+  flat.numTriangles = static_cast<uint32_t>(node->m_count);
+  m_flatNodes.push_back(flat);
+
+  // Note: Recursion grows m_flatNodes, so write through the index afterwards.
+  for (int i = 0; i < 8; ++i)
+  {
+    uint32_t child = node->m_children[i] ? flattenNode(node->m_children[i]) : 0;
+    m_flatNodes[index].children[i] = child;
+  }
+  return index;
+}
+
+bool KAdaptiveOctreePrivate::validNodes() const
+{
+  // Corrupt indices would otherwise be followed by drawNode.
+  KAdaptiveOctreeFlatNode const *nodes = static_cast<KAdaptiveOctreeFlatNode const*>(m_file.description().nodes);
+  for (size_t i = 0; i < m_file.description().nodeCount; ++i)
+  {
+    KAdaptiveOctreeFlatNode const &node = nodes[i];
+    if (!m_file.isValidTriangleRange(node.firstTriangle, node.numTriangles)) return false;
+    for (int c = 0; c < 8; ++c)
+    {
+      if (!m_file.isValidChild(i, node.children[c])) return false;
+    }
+  }
+  return true;
+}
+
+void KAdaptiveOctreePrivate::drawNode(KTransform3D &trans, uint32_t index, size_t min, size_t max) const
+{
+  KAdaptiveOctreeFlatNode const &node = static_cast<KAdaptiveOctreeFlatNode const*>(m_view.nodes)[index];
+  if (node.depth <= max)
+  {
+    if (node.depth >= min)
+    {
+      Karma::MinMaxKVector3D extents;
+      extents.min = KVector3D(node.min[0], node.min[1], node.min[2]);
+      extents.max = KVector3D(node.max[0], node.max[1], node.max[2]);
+      KAabbBoundingVolume aabb;
+      aabb.setMinMaxBounds(extents);
+      aabb.draw(trans, KColor(static_cast<QRgb>(node.color)));
+    }
+    for (int i = 0; i < 8; ++i)
+    {
+      if (node.children[i])
+      {
+        drawNode(trans, node.children[i], min, max);
+      }
+    }
+  }
+}
+
 /*******************************************************************************
  * KAdaptiveOctree
  ******************************************************************************/
@@ -188,23 +359,52 @@ void KAdaptiveOctree::build(BuildMethod method, TerminationPred pred)
   if (!dirty()) return;
 
   // Build based on selected method
+  p.m_file.unmap();
+  p.m_view.type = KSpatialFile::AdaptiveOctreeType;
+  p.m_view.method = method;
+  p.m_view.sourceHash = hash();
+  p.m_view.terminationKey = terminationKey();
   switch (method)
   {
   case BottomUpMethod:
     p.buildBottomUp(pred);
     break;
   case TopDownMethod:
-    p.buildTopDown(pred);
+    p.buildTopDown(pred, buildFlags());
     break;
   }
 
   // We no longer need this data
   KGeometryCloud::clear();
+}
 
-  // Next: Depth-first search to find all leaf nodes.
-  //       Form an index buffer of all contiguous leaf nodes.
-  //       As we iterate through, update the parent nodes so they
-  //       understand the "drawable range" of the children.
+bool KAdaptiveOctree::save(QString const &fileName) const
+{
+  P(const KAdaptiveOctreePrivate);
+  if (p.m_view.nodeCount == 0) return false;
+  return KSpatialFile::write(fileName, p.m_view);
+}
+
+bool KAdaptiveOctree::load(QString const &fileName, BuildMethod method)
+{
+  P(KAdaptiveOctreePrivate);
+
+  // The file must match the geometry which would otherwise be built.
+  if (!dirty()) return false;
+  if (!p.m_file.map(fileName, KSpatialFile::AdaptiveOctreeType, method, hash(), terminationKey(), sizeof(KAdaptiveOctreeFlatNode)) || !p.validNodes())
+  {
+    p.m_file.unmap();
+    return false;
+  }
+
+  // Use the mapping in place, release anything from a previous build.
+  p.m_view = p.m_file.description();
+  p.m_maxDepth = p.m_view.maxDepth;
+  std::vector<KAdaptiveOctreeFlatNode>().swap(p.m_flatNodes);
+  std::vector<uint32_t>().swap(p.m_flatTriangles);
+  p.m_pointCloud.clear();
+  KGeometryCloud::clear();
+  return true;
 }
 
 void KAdaptiveOctree::debugDraw(size_t min, size_t max)
@@ -216,8 +416,8 @@ void KAdaptiveOctree::debugDraw(size_t min, size_t max)
 void KAdaptiveOctree::debugDraw(KTransform3D &trans, size_t min, size_t max)
 {
   P(KAdaptiveOctreePrivate);
-  if (p.m_root)
+  if (p.m_view.nodeCount)
   {
-    p.m_root->debugDraw(trans, min, max);
+    p.drawNode(trans, 0, min, max);
   }
 }
@@ -18,6 +18,8 @@ public:
   void clear();
   size_t depth() const;
   void build(BuildMethod method, TerminationPred pred);
+  bool save(QString const &fileName) const;
+  bool load(QString const &fileName, BuildMethod method);
   void debugDraw(size_t min = 0, size_t max = std::numeric_limits<size_t>::max());
   void debugDraw(KTransform3D &trans, size_t min = 0, size_t max = std::numeric_limits<size_t>::max());
 
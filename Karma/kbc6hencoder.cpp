@@ -0,0 +1,927 @@
+#include "kbc6hencoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <KParallel>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KBC6H_SSE2
+#include <emmintrin.h>
+#endif
+
+// Block rows encoded per task.
+static const size_t BlockRowGrain = 4;
+
+// Largest unsigned half (65504.0f) as its bit pattern.
+static const int MaxHalf = 0x7BFF;
+
+// Refinement effort per quality level.
+static const int FastRefits = 1;
+static const int HighRefits = 3;
+static const int HighSearchPasses = 2;
+static const int HighPartitionCandidates = 2;
+static const int HighModeCandidates = 2;
+
+/*******************************************************************************
+ * Tables
+ ******************************************************************************/
+static const int Weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+static const int Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// Two region partitions, bit i is set when texel i belongs to the second region.
+static const uint16_t Partitions[32] =
+{
+  0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+  0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+  0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+  0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C
+};
+
+// Anchor texel of the second region (Its index is stored without the top bit).
+static const uint8_t Anchors[32] =
+{
+  15, 15, 15, 15, 15, 15, 15, 15,
+  15, 15, 15, 15, 15, 15, 15, 15,
+  15,  2,  8,  2,  2,  8,  8, 15,
+   2,  8,  2,  2,  8,  8,  2,  2
+};
+
+// Endpoints in specification order: w/x are region 0, y/z are region 1.
+enum Bc6hField { W, X, Y, Z, D };
+enum Bc6hChannel { Red, Green, Blue };
+
+// Bits [a:b] of a field, stored starting at bit b and stepping towards bit a.
+struct Bc6hRun
+{
+  uint8_t field;
+  uint8_t channel;
+  uint8_t a;
+  uint8_t b;
+};
+
+struct Bc6hMode
+{
+  uint8_t code;
+  uint8_t codeBits;
+  uint8_t regions;
+  uint8_t endpointBits;
+  uint8_t deltaBits[3];
+  bool transformed;
+  uint8_t runCount;
+  Bc6hRun runs[24];
+};
+
+// Mode numbers follow the D3D specification.
+enum Bc6hModeIndex { Mode1, Mode2, Mode3, Mode4, Mode5, Mode6, Mode7, Mode8, Mode9, Mode10, Mode11, Mode12, Mode13, Mode14, ModeCount };
+static const Bc6hMode Modes[ModeCount] =
+{
+  // Mode 1: Two regions, 10-bit base with 5-bit deltas
+  { 0x00, 2, 2, 10, { 5, 5, 5 }, true, 20,
+    { { Y, Green, 4, 4 }, { Y, Blue, 4, 4 }, { Z, Blue, 4, 4 }, { W, Red, 9, 0 },
+      { W, Green, 9, 0 }, { W, Blue, 9, 0 }, { X, Red, 4, 0 }, { Z, Green, 4, 4 },
+      { Y, Green, 3, 0 }, { X, Green, 4, 0 }, { Z, Blue, 0, 0 }, { Z, Green, 3, 0 },
+      { X, Blue, 4, 0 }, { Z, Blue, 1, 1 }, { Y, Blue, 3, 0 }, { Y, Red, 4, 0 },
+      { Z, Blue, 2, 2 }, { Z, Red, 4, 0 }, { Z, Blue, 3, 3 }, { D, Red, 4, 0 } } },
+  // Mode 2: Two regions, 7-bit base with 6-bit deltas
+  { 0x01, 2, 2, 7, { 6, 6, 6 }, true, 24,
+    { { Y, Green, 5, 5 }, { Z, Green, 4, 4 }, { Z, Green, 5, 5 }, { W, Red, 6, 0 },
+      { Z, Blue, 0, 0 }, { Z, Blue, 1, 1 }, { Y, Blue, 4, 4 }, { W, Green, 6, 0 },
+      { Y, Blue, 5, 5 }, { Z, Blue, 2, 2 }, { Y, Green, 4, 4 }, { W, Blue, 6, 0 },
+      { Z, Blue, 3, 3 }, { Z, Blue, 5, 5 }, { Z, Blue, 4, 4 }, { X, Red, 5, 0 },
+      { Y, Green, 3, 0 }, { X, Green, 5, 0 }, { Z, Green, 3, 0 }, { X, Blue, 5, 0 },
+      { Y, Blue, 3, 0 }, { Y, Red, 5, 0 }, { Z, Red, 5, 0 }, { D, Red, 4, 0 } } },
+  // Mode 3: Two regions, 11-bit base with 5/4/4-bit deltas
+  { 0x02, 5, 2, 11, { 5, 4, 4 }, true, 19,
+    { { W, Red, 9, 0 }, { W, Green, 9, 0 }, { W, Blue, 9, 0 }, { X, Red, 4, 0 },
+      { W, Red, 10, 10 }, { Y, Green, 3, 0 }, { X, Green, 3, 0 }, { W, Green, 10, 10 },
+      { Z, Blue, 0, 0 }, { Z, Green, 3, 0 }, { X, Blue, 3, 0 }, { W, Blue, 10, 10 },
+      { Z, Blue, 1, 1 }, { Y, Blue, 3, 0 }, { Y, Red, 4, 0 }, { Z, Blue, 2, 2 },
+      { Z, Red, 4, 0 }, { Z, Blue, 3, 3 }, { D, Red, 4, 0 } } },
+  // Mode 4: Two regions, 11-bit base with 4/5/4-bit deltas
+  { 0x06, 5, 2, 11, { 4, 5, 4 }, true, 21,
+    { { W, Red, 9, 0 }, { W, Green, 9, 0 }, { W, Blue, 9, 0 }, { X, Red, 3, 0 },
+      { W, Red, 10, 10 }, { Z, Green, 4, 4 }, { Y, Green, 3, 0 }, { X, Green, 4, 0 },
+      { W, Green, 10, 10 }, { Z, Green, 3, 0 }, { X, Blue, 3, 0 }, { W, Blue, 10, 10 },
+      { Z, Blue, 1, 1 }, { Y, Blue, 3, 0 }, { Y, Red, 3, 0 }, { Z, Blue, 0, 0 },
+      { Z, Blue, 2, 2 }, { Z, Red, 3, 0 }, { Y, Green, 4, 4 }, { Z, Blue, 3, 3 },
+      { D, Red, 4, 0 } } },
+  // Mode 5: Two regions, 11-bit base with 4/4/5-bit deltas
+  { 0x0A, 5, 2, 11, { 4, 4, 5 }, true, 21,
+    { { W, Red, 9, 0 }, { W, Green, 9, 0 }, { W, Blue, 9, 0 }, { X, Red, 3, 0 },
+      { W, Red, 10, 10 }, { Y, Blue, 4, 4 }, { Y, Green, 3, 0 }, { X, Green, 3, 0 },
+      { W, Green, 10, 10 }, { Z, Blue, 0, 0 }, { Z, Green, 3, 0 }, { X, Blue, 4, 0 },
+      { W, Blue, 10, 10 }, { Y, Blue, 3, 0 }, { Y, Red, 3, 0 }, { Z, Blue, 1, 1 },
+      { Z, Blue, 2, 2 }, { Z, Red, 3, 0 }, { Z, Blue, 4, 4 }, { Z, Blue, 3, 3 },
+      { D, Red, 4, 0 } } },
+  // Mode 6: Two regions, 9-bit base with 5-bit deltas
+  { 0x0E, 5, 2, 9, { 5, 5, 5 }, true, 20,
+    { { W, Red, 8, 0 }, { Y, Blue, 4, 4 }, { W, Green, 8, 0 }, { Y, Green, 4, 4 },
+      { W, Blue, 8, 0 }, { Z, Blue, 4, 4 }, { X, Red, 4, 0 }, { Z, Green, 4, 4 },
+      { Y, Green, 3, 0 }, { X, Green, 4, 0 }, { Z, Blue, 0, 0 }, { Z, Green, 3, 0 },
+      { X, Blue, 4, 0 }, { Z, Blue, 1, 1 }, { Y, Blue, 3, 0 }, { Y, Red, 4, 0 },
+      { Z, Blue, 2, 2 }, { Z, Red, 4, 0 }, { Z, Blue, 3, 3 }, { D, Red, 4, 0 } } },
+  // Mode 7: Two regions, 8-bit base with 6/5/5-bit deltas
+  { 0x12, 5, 2, 8, { 6, 5, 5 }, true, 20,
+    { { W, Red, 7, 0 }, { Z, Green, 4, 4 }, { Y, Blue, 4, 4 }, { W, Green, 7, 0 },
+      { Z, Blue, 2, 2 }, { Y, Green, 4, 4 }, { W, Blue, 7, 0 }, { Z, Blue, 3, 3 },
+      { Z, Blue, 4, 4 }, { X, Red, 5, 0 }, { Y, Green, 3, 0 }, { X, Green, 4, 0 },
+      { Z, Blue, 0, 0 }, { Z, Green, 3, 0 }, { X, Blue, 4, 0 }, { Z, Blue, 1, 1 },
+      { Y, Blue, 3, 0 }, { Y, Red, 5, 0 }, { Z, Red, 5, 0 }, { D, Red, 4, 0 } } },
+  // Mode 8: Two regions, 8-bit base with 5/6/5-bit deltas
+  { 0x16, 5, 2, 8, { 5, 6, 5 }, true, 22,
+    { { W, Red, 7, 0 }, { Z, Blue, 0, 0 }, { Y, Blue, 4, 4 }, { W, Green, 7, 0 },
+      { Y, Green, 5, 5 }, { Y, Green, 4, 4 }, { W, Blue, 7, 0 }, { Z, Green, 5, 5 },
+      { Z, Blue, 4, 4 }, { X, Red, 4, 0 }, { Z, Green, 4, 4 }, { Y, Green, 3, 0 },
+      { X, Green, 5, 0 }, { Z, Green, 3, 0 }, { X, Blue, 4, 0 }, { Z, Blue, 1, 1 },
+      { Y, Blue, 3, 0 }, { Y, Red, 4, 0 }, { Z, Blue, 2, 2 }, { Z, Red, 4, 0 },
+      { Z, Blue, 3, 3 }, { D, Red, 4, 0 } } },
+  // Mode 9: Two regions, 8-bit base with 5/5/6-bit deltas
+  { 0x1A, 5, 2, 8, { 5, 5, 6 }, true, 22,
+    { { W, Red, 7, 0 }, { Z, Blue, 1, 1 }, { Y, Blue, 4, 4 }, { W, Green, 7, 0 },
+      { Y, Blue, 5, 5 }, { Y, Green, 4, 4 }, { W, Blue, 7, 0 }, { Z, Blue, 5, 5 },
+      { Z, Blue, 4, 4 }, { X, Red, 4, 0 }, { Z, Green, 4, 4 }, { Y, Green, 3, 0 },
+      { X, Green, 4, 0 }, { Z, Blue, 0, 0 }, { Z, Green, 3, 0 }, { X, Blue, 5, 0 },
+      { Y, Blue, 3, 0 }, { Y, Red, 4, 0 }, { Z, Blue, 2, 2 }, { Z, Red, 4, 0 },
+      { Z, Blue, 3, 3 }, { D, Red, 4, 0 } } },
+  // Mode 10: Two regions, 6-bit endpoints
+  { 0x1E, 5, 2, 6, { 6, 6, 6 }, false, 24,
+    { { W, Red, 5, 0 }, { Z, Green, 4, 4 }, { Z, Blue, 0, 0 }, { Z, Blue, 1, 1 },
+      { Y, Blue, 4, 4 }, { W, Green, 5, 0 }, { Y, Green, 5, 5 }, { Y, Blue, 5, 5 },
+      { Z, Blue, 2, 2 }, { Y, Green, 4, 4 }, { W, Blue, 5, 0 }, { Z, Green, 5, 5 },
+      { Z, Blue, 3, 3 }, { Z, Blue, 5, 5 }, { Z, Blue, 4, 4 }, { X, Red, 5, 0 },
+      { Y, Green, 3, 0 }, { X, Green, 5, 0 }, { Z, Green, 3, 0 }, { X, Blue, 5, 0 },
+      { Y, Blue, 3, 0 }, { Y, Red, 5, 0 }, { Z, Red, 5, 0 }, { D, Red, 4, 0 } } },
+  // Mode 11: One region, 10-bit endpoints
+  { 0x03, 5, 1, 10, { 10, 10, 10 }, false, 6,
+    { { W, Red, 9, 0 }, { W, Green, 9, 0 }, { W, Blue, 9, 0 },
+      { X, Red, 9, 0 }, { X, Green, 9, 0 }, { X, Blue, 9, 0 } } },
+  // Mode 12: One region, 11-bit base with 9-bit deltas
+  { 0x07, 5, 1, 11, { 9, 9, 9 }, true, 9,
+    { { W, Red, 9, 0 }, { W, Green, 9, 0 }, { W, Blue, 9, 0 },
+      { X, Red, 8, 0 }, { W, Red, 10, 10 }, { X, Green, 8, 0 }, { W, Green, 10, 10 },
+      { X, Blue, 8, 0 }, { W, Blue, 10, 10 } } },
+  // Mode 13: One region, 12-bit base with 8-bit deltas
+  { 0x0B, 5, 1, 12, { 8, 8, 8 }, true, 9,
+    { { W, Red, 9, 0 }, { W, Green, 9, 0 }, { W, Blue, 9, 0 },
+      { X, Red, 7, 0 }, { W, Red, 10, 11 }, { X, Green, 7, 0 }, { W, Green, 10, 11 },
+      { X, Blue, 7, 0 }, { W, Blue, 10, 11 } } },
+  // Mode 14: One region, 16-bit base with 4-bit deltas
+  { 0x0F, 5, 1, 16, { 4, 4, 4 }, true, 9,
+    { { W, Red, 9, 0 }, { W, Green, 9, 0 }, { W, Blue, 9, 0 },
+      { X, Red, 3, 0 }, { W, Red, 10, 15 }, { X, Green, 3, 0 }, { W, Green, 10, 15 },
+      { X, Blue, 3, 0 }, { W, Blue, 10, 15 } } }
+};
+
+/*******************************************************************************
+ * Bc6hTexels / Bc6hCandidate
+ ******************************************************************************/
+// Texels as unsigned half bit patterns, which is the space BC6H interpolates in.
+struct Bc6hTexels
+{
+  float v[3][16];
+};
+
+struct Bc6hCandidate
+{
+  Bc6hMode const *mode;
+  int partition;
+  int endpoints[2][2][3];
+  uint8_t indices[16];
+  float error;
+};
+
+/*******************************************************************************
+ * Half Conversion
+ ******************************************************************************/
+static inline uint32_t floatBits(float f)
+{
+  uint32_t u;
+  std::memcpy(&u, &f, sizeof(u));
+  return u;
+}
+
+static inline float bitsFloat(uint32_t u)
+{
+  float f;
+  std::memcpy(&f, &u, sizeof(f));
+  return f;
+}
+
+// Unsigned half, negative values and NaN become zero (round to nearest even).
+static inline int floatToHalf(float f)
+{
+  if (!(f > 0.0f)) return 0;
+  if (f >= 65504.0f) return MaxHalf;
+  uint32_t u = floatBits(f);
+  if (u < (113u << 23))
+  {
+    static const uint32_t DenormMagic = 126u << 23;
+    return int(floatBits(f + bitsFloat(DenormMagic)) - DenormMagic);
+  }
+  uint32_t mantissaOdd = (u >> 13) & 1;
+  u += (uint32_t(15 - 127) << 23) + 0xFFF;
+  return int((u + mantissaOdd) >> 13);
+}
+
+static inline float halfToFloat(int h)
+{
+  int exponent = (h >> 10) & 0x1F;
+  int mantissa = h & 0x3FF;
+  if (exponent == 0) return std::ldexp(float(mantissa), -24);
+  return bitsFloat(uint32_t(exponent - 15 + 127) << 23 | uint32_t(mantissa) << 13);
+}
+
+/*******************************************************************************
+ * Endpoint Quantization
+ ******************************************************************************/
+static inline int unquantize(int q, int bits)
+{
+  if (bits >= 15) return q;
+  if (q == 0) return 0;
+  if (q == (1 << bits) - 1) return 0xFFFF;
+  return ((q << 15) + 0x4000) >> (bits - 1);
+}
+
+// The decoder scales interpolated values by 31/64 to get the final half.
+static inline int finishUnquantize(int value)
+{
+  return (value * 31) >> 6;
+}
+
+static int quantize(float value, int bits)
+{
+  int maxQ = (1 << bits) - 1;
+  float unquantized = value * (64.0f / 31.0f);
+  int q = int(unquantized * float(1 << bits) / 65536.0f);
+  q = std::max(0, std::min(q, maxQ));
+
+  // The reconstruction is not linear at the ends, check the neighbours.
+  int best = q;
+  float bestError = std::numeric_limits<float>::max();
+  for (int c = std::max(0, q - 1); c <= std::min(maxQ, q + 1); ++c)
+  {
+    float error = std::abs(float(finishUnquantize(unquantize(c, bits))) - value);
+    if (error < bestError)
+    {
+      bestError = error;
+      best = c;
+    }
+  }
+  return best;
+}
+
+static inline int indexBits(Bc6hMode const &mode)
+{
+  return (mode.regions == 1) ? 4 : 3;
+}
+
+static inline void regionMasks(Bc6hMode const &mode, int partition, uint16_t masks[2])
+{
+  masks[0] = (mode.regions == 1) ? 0xFFFF : uint16_t(~Partitions[partition]);
+  masks[1] = (mode.regions == 1) ? 0 : Partitions[partition];
+}
+
+static inline int anchorTexel(int region, int partition)
+{
+  return (region == 0) ? 0 : Anchors[partition];
+}
+
+static bool fitsDeltas(Bc6hMode const &mode, int const endpoints[2][2][3])
+{
+  if (!mode.transformed) return true;
+  for (int c = 0; c < 3; ++c)
+  {
+    int limit = 1 << (mode.deltaBits[c] - 1);
+    for (int e = 1; e < 2 * mode.regions; ++e)
+    {
+      int delta = endpoints[e / 2][e % 2][c] - endpoints[0][0][c];
+      if (delta < -limit || delta >= limit) return false;
+    }
+  }
+  return true;
+}
+
+// Pulls endpoints towards the base endpoint until the deltas are representable.
+static void clampDeltas(Bc6hMode const &mode, int endpoints[2][2][3])
+{
+  if (!mode.transformed) return;
+  for (int c = 0; c < 3; ++c)
+  {
+    int limit = 1 << (mode.deltaBits[c] - 1);
+    int base = endpoints[0][0][c];
+    for (int e = 1; e < 2 * mode.regions; ++e)
+    {
+      int &value = endpoints[e / 2][e % 2][c];
+      value = base + std::max(-limit, std::min(value - base, limit - 1));
+    }
+  }
+}
+
+static void quantizeEndpoints(Bc6hMode const &mode, float const lines[2][2][3], int endpoints[2][2][3])
+{
+  for (int r = 0; r < mode.regions; ++r)
+  {
+    for (int e = 0; e < 2; ++e)
+    {
+      for (int c = 0; c < 3; ++c)
+      {
+        endpoints[r][e][c] = quantize(lines[r][e][c], mode.endpointBits);
+      }
+    }
+  }
+  clampDeltas(mode, endpoints);
+}
+
+/*******************************************************************************
+ * Index Selection
+ ******************************************************************************/
+static void buildPalette(int const e0[3], int const e1[3], int bits, int indexBits, float palette[3][16])
+{
+  int const *weights = (indexBits == 3) ? Weights3 : Weights4;
+  int count = 1 << indexBits;
+  for (int c = 0; c < 3; ++c)
+  {
+    int u0 = unquantize(e0[c], bits);
+    int u1 = unquantize(e1[c], bits);
+    for (int k = 0; k < count; ++k)
+    {
+      int value = ((64 - weights[k]) * u0 + weights[k] * u1 + 32) >> 6;
+      palette[c][k] = float(finishUnquantize(value));
+    }
+  }
+}
+
+// Picks the closest palette entry for every texel, returns the error of the
+// texels in mask. Only the indices of those texels are written.
+static float assignIndices(Bc6hTexels const &texels, float const palette[3][16], int count, uint16_t mask, uint8_t indices[16])
+{
+  float errors[16];
+  int best[16];
+#ifdef KBC6H_SSE2
+  for (int g = 0; g < 16; g += 4)
+  {
+    __m128 r = _mm_loadu_ps(texels.v[0] + g);
+    __m128 gr = _mm_loadu_ps(texels.v[1] + g);
+    __m128 b = _mm_loadu_ps(texels.v[2] + g);
+    __m128 bestError = _mm_set1_ps(std::numeric_limits<float>::max());
+    __m128i bestIndex = _mm_setzero_si128();
+    for (int k = 0; k < count; ++k)
+    {
+      __m128 dr = _mm_sub_ps(r, _mm_set1_ps(palette[0][k]));
+      __m128 dg = _mm_sub_ps(gr, _mm_set1_ps(palette[1][k]));
+      __m128 db = _mm_sub_ps(b, _mm_set1_ps(palette[2][k]));
+      __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db));
+      __m128i less = _mm_castps_si128(_mm_cmplt_ps(d, bestError));
+      bestError = _mm_min_ps(d, bestError);
+      bestIndex = _mm_or_si128(_mm_and_si128(less, _mm_set1_epi32(k)), _mm_andnot_si128(less, bestIndex));
+    }
+    _mm_storeu_ps(errors + g, bestError);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(best + g), bestIndex);
+  }
+#else
+  for (int i = 0; i < 16; ++i)
+  {
+    errors[i] = std::numeric_limits<float>::max();
+    best[i] = 0;
+    for (int k = 0; k < count; ++k)
+    {
+      float dr = texels.v[0][i] - palette[0][k];
+      float dg = texels.v[1][i] - palette[1][k];
+      float db = texels.v[2][i] - palette[2][k];
+      float d = dr * dr + dg * dg + db * db;
+      if (d < errors[i])
+      {
+        errors[i] = d;
+        best[i] = k;
+      }
+    }
+  }
+#endif
+  float error = 0.0f;
+  for (int i = 0; i < 16; ++i)
+  {
+    if (mask & (1 << i))
+    {
+      error += errors[i];
+      indices[i] = uint8_t(best[i]);
+    }
+  }
+  return error;
+}
+
+static float evaluateRegion(Bc6hTexels const &texels, Bc6hMode const &mode, uint16_t mask, int const endpoints[2][3], uint8_t indices[16])
+{
+  float palette[3][16];
+  buildPalette(endpoints[0], endpoints[1], mode.endpointBits, indexBits(mode), palette);
+  return assignIndices(texels, palette, 1 << indexBits(mode), mask, indices);
+}
+
+static float evaluate(Bc6hTexels const &texels, Bc6hMode const &mode, uint16_t const masks[2], int const endpoints[2][2][3], uint8_t indices[16])
+{
+  float error = 0.0f;
+  for (int r = 0; r < mode.regions; ++r)
+  {
+    error += evaluateRegion(texels, mode, masks[r], endpoints[r], indices);
+  }
+  return error;
+}
+
+/*******************************************************************************
+ * Endpoint Fitting
+ ******************************************************************************/
+// Fits a line through the texels in mask along their principal axis and
+// returns the squared distance of the texels to that line.
+static float fitLine(Bc6hTexels const &texels, uint16_t mask, float e0[3], float e1[3])
+{
+  float mean[3] = { 0.0f, 0.0f, 0.0f };
+  int n = 0;
+  for (int i = 0; i < 16; ++i)
+  {
+    if (!(mask & (1 << i))) continue;
+    for (int c = 0; c < 3; ++c) mean[c] += texels.v[c][i];
+    ++n;
+  }
+  if (n == 0)
+  {
+    std::fill(e0, e0 + 3, 0.0f);
+    std::fill(e1, e1 + 3, 0.0f);
+    return 0.0f;
+  }
+  for (int c = 0; c < 3; ++c) mean[c] /= float(n);
+
+  float cov[3][3] = { { 0.0f } };
+  for (int i = 0; i < 16; ++i)
+  {
+    if (!(mask & (1 << i))) continue;
+    float d[3] = { texels.v[0][i] - mean[0], texels.v[1][i] - mean[1], texels.v[2][i] - mean[2] };
+    for (int a = 0; a < 3; ++a)
+    {
+      for (int b = 0; b < 3; ++b) cov[a][b] += d[a] * d[b];
+    }
+  }
+
+  // Power iteration, started from the row of the largest variance.
+  int start = 0;
+  if (cov[1][1] > cov[start][start]) start = 1;
+  if (cov[2][2] > cov[start][start]) start = 2;
+  float axis[3] = { cov[start][0], cov[start][1], cov[start][2] };
+  for (int iteration = 0; iteration < 8; ++iteration)
+  {
+    float next[3];
+    for (int a = 0; a < 3; ++a)
+    {
+      next[a] = cov[a][0] * axis[0] + cov[a][1] * axis[1] + cov[a][2] * axis[2];
+    }
+    float scale = std::max(std::abs(next[0]), std::max(std::abs(next[1]), std::abs(next[2])));
+    if (scale <= 0.0f) break;
+    for (int a = 0; a < 3; ++a) axis[a] = next[a] / scale;
+  }
+
+  float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+  if (length <= 1e-20f)
+  {
+    std::copy(mean, mean + 3, e0);
+    std::copy(mean, mean + 3, e1);
+    return 0.0f;
+  }
+  for (int a = 0; a < 3; ++a) axis[a] /= length;
+
+  float tMin = std::numeric_limits<float>::max();
+  float tMax = -std::numeric_limits<float>::max();
+  float residual = 0.0f;
+  for (int i = 0; i < 16; ++i)
+  {
+    if (!(mask & (1 << i))) continue;
+    float d[3] = { texels.v[0][i] - mean[0], texels.v[1][i] - mean[1], texels.v[2][i] - mean[2] };
+    float t = d[0] * axis[0] + d[1] * axis[1] + d[2] * axis[2];
+    tMin = std::min(tMin, t);
+    tMax = std::max(tMax, t);
+    residual += std::max(0.0f, d[0] * d[0] + d[1] * d[1] + d[2] * d[2] - t * t);
+  }
+  for (int c = 0; c < 3; ++c)
+  {
+    e0[c] = std::max(0.0f, std::min(mean[c] + axis[c] * tMin, float(MaxHalf)));
+    e1[c] = std::max(0.0f, std::min(mean[c] + axis[c] * tMax, float(MaxHalf)));
+  }
+  return residual;
+}
+
+// Orients the line so the anchor texel lands in the lower half of the indices.
+static void orientLine(Bc6hTexels const &texels, int anchor, float e0[3], float e1[3])
+{
+  float dot = 0.0f, lengthSquared = 0.0f;
+  for (int c = 0; c < 3; ++c)
+  {
+    float axis = e1[c] - e0[c];
+    dot += (texels.v[c][anchor] - e0[c]) * axis;
+    lengthSquared += axis * axis;
+  }
+  if (dot > 0.5f * lengthSquared)
+  {
+    for (int c = 0; c < 3; ++c) std::swap(e0[c], e1[c]);
+  }
+}
+
+// Least-squares endpoints for fixed indices (Leaves the line alone when singular).
+static void refitLine(Bc6hTexels const &texels, uint16_t mask, uint8_t const indices[16], int bits, float e0[3], float e1[3])
+{
+  int const *weights = (bits == 3) ? Weights3 : Weights4;
+  float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+  float av[3] = { 0.0f, 0.0f, 0.0f }, bv[3] = { 0.0f, 0.0f, 0.0f };
+  for (int i = 0; i < 16; ++i)
+  {
+    if (!(mask & (1 << i))) continue;
+    float b = float(weights[indices[i]]) / 64.0f;
+    float a = 1.0f - b;
+    aa += a * a;
+    ab += a * b;
+    bb += b * b;
+    for (int c = 0; c < 3; ++c)
+    {
+      av[c] += a * texels.v[c][i];
+      bv[c] += b * texels.v[c][i];
+    }
+  }
+  float det = aa * bb - ab * ab;
+  if (std::abs(det) < 1e-6f) return;
+  for (int c = 0; c < 3; ++c)
+  {
+    e0[c] = std::max(0.0f, std::min((bb * av[c] - ab * bv[c]) / det, float(MaxHalf)));
+    e1[c] = std::max(0.0f, std::min((aa * bv[c] - ab * av[c]) / det, float(MaxHalf)));
+  }
+}
+
+// Greedy +/-1 steps on every quantized endpoint channel. A step only changes
+// the palette of its own region, so only that region is re-evaluated.
+static void searchEndpoints(Bc6hTexels const &texels, uint16_t const masks[2], int passes, Bc6hCandidate &candidate)
+{
+  Bc6hMode const &mode = *candidate.mode;
+  int maxQ = (1 << mode.endpointBits) - 1;
+  float regionErrors[2] = { 0.0f, 0.0f };
+  uint8_t indices[16];
+  for (int r = 0; r < mode.regions; ++r)
+  {
+    regionErrors[r] = evaluateRegion(texels, mode, masks[r], candidate.endpoints[r], indices);
+  }
+
+  for (int pass = 0; pass < passes; ++pass)
+  {
+    bool improved = false;
+    for (int e = 0; e < 2 * mode.regions; ++e)
+    {
+      int r = e / 2;
+      for (int c = 0; c < 3; ++c)
+      {
+        for (int step = -1; step <= 1; step += 2)
+        {
+          int trial[2][2][3];
+          std::memcpy(trial, candidate.endpoints, sizeof(trial));
+          int &value = trial[r][e % 2][c];
+          value += step;
+          if (value < 0 || value > maxQ || !fitsDeltas(mode, trial)) continue;
+          float error = evaluateRegion(texels, mode, masks[r], trial[r], indices);
+          if (error < regionErrors[r])
+          {
+            regionErrors[r] = error;
+            std::memcpy(candidate.endpoints, trial, sizeof(trial));
+            for (int i = 0; i < 16; ++i)
+            {
+              if (masks[r] & (1 << i)) candidate.indices[i] = indices[i];
+            }
+            improved = true;
+          }
+        }
+      }
+    }
+    if (!improved) break;
+  }
+  candidate.error = regionErrors[0] + regionErrors[1];
+}
+
+// Swaps endpoints where an anchor index has its top bit set, since that bit
+// is implied to be zero. Fails if the swapped deltas are not representable.
+static bool fixAnchors(uint16_t const masks[2], Bc6hCandidate &candidate)
+{
+  Bc6hMode const &mode = *candidate.mode;
+  int bits = indexBits(mode);
+  int maxIndex = (1 << bits) - 1;
+  for (int r = 0; r < mode.regions; ++r)
+  {
+    if (candidate.indices[anchorTexel(r, candidate.partition)] <= (maxIndex >> 1)) continue;
+    for (int c = 0; c < 3; ++c)
+    {
+      std::swap(candidate.endpoints[r][0][c], candidate.endpoints[r][1][c]);
+    }
+    for (int i = 0; i < 16; ++i)
+    {
+      if (masks[r] & (1 << i)) candidate.indices[i] = uint8_t(maxIndex - candidate.indices[i]);
+    }
+  }
+  return fitsDeltas(mode, candidate.endpoints);
+}
+
+static void encodeCandidate(Bc6hTexels const &texels, Bc6hModeIndex modeIndex, int partition, int refits, int searchPasses, Bc6hCandidate &candidate)
+{
+  Bc6hMode const &mode = Modes[modeIndex];
+  uint16_t masks[2];
+  regionMasks(mode, partition, masks);
+  candidate.mode = &mode;
+  candidate.partition = partition;
+
+  float lines[2][2][3];
+  for (int r = 0; r < mode.regions; ++r)
+  {
+    fitLine(texels, masks[r], lines[r][0], lines[r][1]);
+    orientLine(texels, anchorTexel(r, partition), lines[r][0], lines[r][1]);
+  }
+  quantizeEndpoints(mode, lines, candidate.endpoints);
+  candidate.error = evaluate(texels, mode, masks, candidate.endpoints, candidate.indices);
+
+  for (int refit = 0; refit < refits; ++refit)
+  {
+    Bc6hCandidate trial = candidate;
+    for (int r = 0; r < mode.regions; ++r)
+    {
+      refitLine(texels, masks[r], candidate.indices, indexBits(mode), lines[r][0], lines[r][1]);
+    }
+    quantizeEndpoints(mode, lines, trial.endpoints);
+    trial.error = evaluate(texels, mode, masks, trial.endpoints, trial.indices);
+    if (trial.error >= candidate.error) break;
+    candidate = trial;
+  }
+  searchEndpoints(texels, masks, searchPasses, candidate);
+
+  if (!fixAnchors(masks, candidate))
+  {
+    candidate.error = std::numeric_limits<float>::max();
+  }
+}
+
+/*******************************************************************************
+ * Bit Packing
+ ******************************************************************************/
+static inline void writeBits(unsigned char *block, int &position, uint32_t value, int count)
+{
+  for (int i = 0; i < count; ++i, ++position)
+  {
+    if ((value >> i) & 1) block[position >> 3] |= uint8_t(1 << (position & 7));
+  }
+}
+
+static inline uint32_t readBits(unsigned char const *block, int &position, int count)
+{
+  uint32_t value = 0;
+  for (int i = 0; i < count; ++i, ++position)
+  {
+    value |= uint32_t((block[position >> 3] >> (position & 7)) & 1) << i;
+  }
+  return value;
+}
+
+static void packBlock(Bc6hCandidate const &candidate, unsigned char *block)
+{
+  Bc6hMode const &mode = *candidate.mode;
+  std::memset(block, 0, KBc6hEncoder::BlockSize);
+  int position = 0;
+  writeBits(block, position, mode.code, mode.codeBits);
+
+  // Header fields (Transformed modes store x, y and z relative to w).
+  for (int i = 0; i < mode.runCount; ++i)
+  {
+    Bc6hRun const &run = mode.runs[i];
+    uint32_t value;
+    if (run.field == D)
+    {
+      value = uint32_t(candidate.partition);
+    }
+    else
+    {
+      value = uint32_t(candidate.endpoints[run.field / 2][run.field % 2][run.channel]);
+      if (mode.transformed && run.field != W)
+      {
+        value = (value - uint32_t(candidate.endpoints[0][0][run.channel])) & ((1u << mode.deltaBits[run.channel]) - 1);
+      }
+    }
+    int step = (run.a >= run.b) ? 1 : -1;
+    for (int bit = run.b; ; bit += step)
+    {
+      writeBits(block, position, value >> bit, 1);
+      if (bit == run.a) break;
+    }
+  }
+
+  // Indices (Anchors drop their implied zero top bit).
+  int bits = indexBits(mode);
+  for (int i = 0; i < 16; ++i)
+  {
+    bool anchor = (i == 0) || (mode.regions == 2 && i == Anchors[candidate.partition]);
+    writeBits(block, position, candidate.indices[i], anchor ? bits - 1 : bits);
+  }
+}
+
+/*******************************************************************************
+ * KBc6hEncoder
+ ******************************************************************************/
+KBc6hEncoder::KBc6hEncoder(Quality quality) :
+  m_quality(quality)
+{
+  // Intentionally Empty
+}
+
+KBc6hEncoder::Quality KBc6hEncoder::quality() const
+{
+  return m_quality;
+}
+
+void KBc6hEncoder::setQuality(Quality quality)
+{
+  m_quality = quality;
+}
+
+size_t KBc6hEncoder::compressedSize(int width, int height)
+{
+  return size_t((width + 3) / 4) * size_t((height + 3) / 4) * BlockSize;
+}
+
+void KBc6hEncoder::encodeBlock(float const texels[16][3], unsigned char *block) const
+{
+  Bc6hTexels source;
+  for (int i = 0; i < 16; ++i)
+  {
+    for (int c = 0; c < 3; ++c) source.v[c][i] = float(floatToHalf(texels[i][c]));
+  }
+
+  Bc6hCandidate best, candidate;
+  if (m_quality == FastQuality)
+  {
+    encodeCandidate(source, Mode11, 0, FastRefits, 0, best);
+    packBlock(best, block);
+    return;
+  }
+
+  // Single region modes, trading endpoint range for precision.
+  encodeCandidate(source, Mode11, 0, HighRefits, HighSearchPasses, best);
+  for (int mode = Mode12; mode <= Mode14; ++mode)
+  {
+    encodeCandidate(source, Bc6hModeIndex(mode), 0, HighRefits, HighSearchPasses, candidate);
+    if (candidate.error < best.error) best = candidate;
+  }
+
+  // Two region modes, only for the partitions that fit two lines best.
+  float residuals[32];
+  int order[32];
+  for (int p = 0; p < 32; ++p)
+  {
+    float e0[3], e1[3];
+    residuals[p] = fitLine(source, uint16_t(~Partitions[p]), e0, e1) + fitLine(source, Partitions[p], e0, e1);
+    order[p] = p;
+  }
+  std::partial_sort(order, order + HighPartitionCandidates, order + 32, [&residuals](int a, int b) { return residuals[a] < residuals[b]; });
+  for (int i = 0; i < HighPartitionCandidates; ++i)
+  {
+    // A plain fit ranks the modes, only the best ones are refined.
+    float modeErrors[ModeCount];
+    int modes[ModeCount];
+    int modeCount = 0;
+    for (int mode = Mode1; mode <= Mode10; ++mode)
+    {
+      encodeCandidate(source, Bc6hModeIndex(mode), order[i], 0, 0, candidate);
+      modeErrors[mode] = candidate.error;
+      modes[modeCount++] = mode;
+    }
+    std::partial_sort(modes, modes + HighModeCandidates, modes + modeCount, [&modeErrors](int a, int b) { return modeErrors[a] < modeErrors[b]; });
+    for (int m = 0; m < HighModeCandidates; ++m)
+    {
+      encodeCandidate(source, Bc6hModeIndex(modes[m]), order[i], HighRefits, HighSearchPasses, candidate);
+      if (candidate.error < best.error) best = candidate;
+    }
+  }
+  packBlock(best, block);
+}
+
+void KBc6hEncoder::encode(float const *rgb, int width, int height, unsigned char *blocks) const
+{
+  int blocksX = (width + 3) / 4;
+  int blocksY = (height + 3) / 4;
+  Karma::parallelFor(0, size_t(blocksY), BlockRowGrain, [this, rgb, width, height, blocks, blocksX](size_t b, size_t e)
+  {
+    float texels[16][3];
+    for (size_t by = b; by < e; ++by)
+    {
+      for (int bx = 0; bx < blocksX; ++bx)
+      {
+        // Partial blocks replicate the edge texels.
+        for (int i = 0; i < 16; ++i)
+        {
+          int x = std::min(bx * 4 + (i & 3), width - 1);
+          int y = std::min(int(by) * 4 + (i >> 2), height - 1);
+          std::copy(rgb + 3 * (size_t(y) * width + x), rgb + 3 * (size_t(y) * width + x) + 3, texels[i]);
+        }
+        encodeBlock(texels, blocks + (by * blocksX + bx) * BlockSize);
+      }
+    }
+  });
+}
+
+void KBc6hEncoder::decodeBlock(unsigned char const *block, float texels[16][3])
+{
+  int position = 0;
+  uint32_t code = readBits(block, position, 2);
+  if (code & 2) code |= readBits(block, position, 3) << 2;
+
+  Bc6hMode const *mode = 0;
+  for (int m = 0; m < ModeCount; ++m)
+  {
+    if (Modes[m].code == code && Modes[m].codeBits == position) mode = &Modes[m];
+  }
+  if (!mode)
+  {
+    std::memset(texels, 0, 16 * 3 * sizeof(float));
+    return;
+  }
+
+  int endpoints[2][2][3] = { { { 0 } } };
+  int partition = 0;
+  for (int i = 0; i < mode->runCount; ++i)
+  {
+    Bc6hRun const &run = mode->runs[i];
+    int step = (run.a >= run.b) ? 1 : -1;
+    for (int bit = run.b; ; bit += step)
+    {
+      int value = int(readBits(block, position, 1)) << bit;
+      if (run.field == D) partition |= value;
+      else endpoints[run.field / 2][run.field % 2][run.channel] |= value;
+      if (bit == run.a) break;
+    }
+  }
+  if (mode->transformed)
+  {
+    int mask = (1 << mode->endpointBits) - 1;
+    for (int c = 0; c < 3; ++c)
+    {
+      int sign = 1 << (mode->deltaBits[c] - 1);
+      for (int e = 1; e < 2 * mode->regions; ++e)
+      {
+        int &value = endpoints[e / 2][e % 2][c];
+        value = (endpoints[0][0][c] + ((value ^ sign) - sign)) & mask;
+      }
+    }
+  }
+
+  int bits = indexBits(*mode);
+  float palette[2][3][16];
+  for (int r = 0; r < mode->regions; ++r)
+  {
+    buildPalette(endpoints[r][0], endpoints[r][1], mode->endpointBits, bits, palette[r]);
+  }
+  for (int i = 0; i < 16; ++i)
+  {
+    bool anchor = (i == 0) || (mode->regions == 2 && i == Anchors[partition]);
+    int index = int(readBits(block, position, anchor ? bits - 1 : bits));
+    int region = (mode->regions == 2 && (Partitions[partition] & (1 << i))) ? 1 : 0;
+    for (int c = 0; c < 3; ++c)
+    {
+      texels[i][c] = halfToFloat(int(palette[region][c][index]));
+    }
+  }
+}
+
+void KBc6hEncoder::decode(unsigned char const *blocks, int width, int height, float *rgb)
+{
+  int blocksX = (width + 3) / 4;
+  int blocksY = (height + 3) / 4;
+  Karma::parallelFor(0, size_t(blocksY), BlockRowGrain, [blocks, width, height, rgb, blocksX](size_t b, size_t e)
+  {
+    float texels[16][3];
+    for (size_t by = b; by < e; ++by)
+    {
+      for (int bx = 0; bx < blocksX; ++bx)
+      {
+        decodeBlock(blocks + (by * blocksX + bx) * BlockSize, texels);
+        for (int i = 0; i < 16; ++i)
+        {
+          int x = bx * 4 + (i & 3);
+          int y = int(by) * 4 + (i >> 2);
+          if (x >= width || y >= height) continue;
+          std::copy(texels[i], texels[i] + 3, rgb + 3 * (size_t(y) * width + x));
+        }
+      }
+    }
+  });
+}
+
+float KBc6hEncoder::psnr(float const *reference, float const *test, size_t count)
+{
+  double peak = 0.0, sum = 0.0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    double difference = double(reference[i]) - double(test[i]);
+    peak = std::max(peak, double(reference[i]));
+    sum += difference * difference;
+  }
+  if (count == 0 || sum == 0.0) return std::numeric_limits<float>::infinity();
+  return float(10.0 * std::log10(peak * peak / (sum / double(count))));
+}
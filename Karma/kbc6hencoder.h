@@ -0,0 +1,47 @@
+#ifndef KBC6HENCODER_H
+#define KBC6HENCODER_H KBc6hEncoder
+
+#include <cstddef>
+
+// BC6H (unsigned float) block compression of RGB float images. Blocks are
+// 4x4 texels in 16 bytes, so 1 byte per texel with hardware filtering.
+//  - FastQuality:  Single region 10-bit endpoints (mode 11) fitted along the
+//                  principal axis, with one least-squares refit.
+//  - HighQuality:  Also tries the delta modes 12-14 and all two region modes
+//                  1-10 (best partitions only), then refines endpoints of the
+//                  modes which fit best.
+class KBc6hEncoder
+{
+public:
+  enum Quality
+  {
+    FastQuality,
+    HighQuality
+  };
+
+  static const size_t BlockSize = 16;
+
+  // Bumped whenever the encoded blocks change, so cached textures are rejected.
+  static const unsigned Version = 2;
+
+  explicit KBc6hEncoder(Quality quality = FastQuality);
+  Quality quality() const;
+  void setQuality(Quality quality);
+
+  // Encoding (rgb is width * height tightly packed texels, blocks in rows)
+  static size_t compressedSize(int width, int height);
+  void encodeBlock(float const texels[16][3], unsigned char *block) const;
+  void encode(float const *rgb, int width, int height, unsigned char *blocks) const;
+
+  // Decoding (All 14 modes, invalid mode bits decode to black)
+  static void decodeBlock(unsigned char const *block, float texels[16][3]);
+  static void decode(unsigned char const *blocks, int width, int height, float *rgb);
+
+  // Peak signal to noise ratio (dB) over count floats, peak is the reference maximum.
+  static float psnr(float const *reference, float const *test, size_t count);
+
+private:
+  Quality m_quality;
+};
+
+#endif // KBC6HENCODER_H
@@ -0,0 +1,100 @@
+#include "kboundingvolumefit.h"
+#include <KHalfEdgeMesh>
+
+// All PCA based volumes solve the covariance matrix the same way.
+static const int JacobiIterations = 50;
+
+/*******************************************************************************
+ * KBoundingVolumeFitPrivate
+ ******************************************************************************/
+class KBoundingVolumeFitPrivate
+{
+public:
+  KBoundingVolumeFitPrivate(Karma::PointStream const &points);
+  Karma::PointMoments const &moments();
+  void calculatePrincipalAxes();
+
+  Karma::PointStream m_points;
+  bool m_hasMoments;
+  bool m_hasPrincipalAxes;
+  Karma::PointMoments m_moments;
+  KMatrix3x3 m_principalAxes;
+  KVector3D m_principalAxis[3];
+  Karma::AxisExtremes m_principalExtremes[3];
+};
+
+KBoundingVolumeFitPrivate::KBoundingVolumeFitPrivate(Karma::PointStream const &points) :
+  m_points(points), m_hasMoments(false), m_hasPrincipalAxes(false)
+{
+  // Intentionally Empty
+}
+
+Karma::PointMoments const &KBoundingVolumeFitPrivate::moments()
+{
+  // First pass: bounds, centroid and covariance together.
+  if (!m_hasMoments)
+  {
+    m_moments = Karma::calculatePointMoments(m_points);
+    m_hasMoments = true;
+  }
+  return m_moments;
+}
+
+void KBoundingVolumeFitPrivate::calculatePrincipalAxes()
+{
+  if (m_hasPrincipalAxes) return;
+
+  // Second pass: all three principal axes are projected at once.
+  m_principalAxes = Karma::jacobi(moments().covariance, JacobiIterations);
+  Karma::decomposeMatrixeByColumnVectors(m_principalAxes, m_principalAxis);
+  Karma::findExtremalAlongAxes(m_points, m_principalAxis, 3, m_principalExtremes);
+  m_hasPrincipalAxes = true;
+}
+
+/*******************************************************************************
+ * KBoundingVolumeFit
+ ******************************************************************************/
+KBoundingVolumeFit::KBoundingVolumeFit(KHalfEdgeMesh const &mesh) :
+  m_private(new KBoundingVolumeFitPrivate(Karma::PointStream(mesh.vertices(), KHalfEdgeMesh::VertexPositionPred())))
+{
+  // Intentionally Empty
+}
+
+KBoundingVolumeFit::KBoundingVolumeFit(Karma::PointStream const &points) :
+  m_private(new KBoundingVolumeFitPrivate(points))
+{
+  // Intentionally Empty
+}
+
+KBoundingVolumeFit::~KBoundingVolumeFit()
+{
+  // Intentionally Empty
+}
+
+Karma::PointStream const &KBoundingVolumeFit::points() const
+{
+  return m_private->m_points;
+}
+
+Karma::PointMoments const &KBoundingVolumeFit::moments() const
+{
+  return m_private->moments();
+}
+
+KMatrix3x3 const &KBoundingVolumeFit::principalAxes() const
+{
+  m_private->calculatePrincipalAxes();
+  return m_private->m_principalAxes;
+}
+
+KVector3D const &KBoundingVolumeFit::principalAxis(int idx) const
+{
+  m_private->calculatePrincipalAxes();
+  return m_private->m_principalAxis[idx];
+}
+
+Karma::AxisExtremes const &KBoundingVolumeFit::principalExtremes(int idx) const
+{
+  m_private->calculatePrincipalAxes();
+  return m_private->m_principalExtremes[idx];
+}
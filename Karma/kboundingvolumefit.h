@@ -0,0 +1,30 @@
+#ifndef KBOUNDINGVOLUMEFIT_H
+#define KBOUNDINGVOLUMEFIT_H KBoundingVolumeFit
+
+#include <KMath>
+#include <QScopedPointer>
+class KHalfEdgeMesh;
+
+// Reductions shared between bounding volumes fit to the same points, so
+// fitting several volumes only walks the point data once per reduction.
+// Note: Only references the points, the mesh must outlive the fit.
+class KBoundingVolumeFitPrivate;
+class KBoundingVolumeFit
+{
+public:
+  explicit KBoundingVolumeFit(KHalfEdgeMesh const &mesh);
+  explicit KBoundingVolumeFit(Karma::PointStream const &points);
+  ~KBoundingVolumeFit();
+
+  // Computed on first use (Not thread-safe)
+  Karma::PointStream const &points() const;
+  Karma::PointMoments const &moments() const;
+  KMatrix3x3 const &principalAxes() const;
+  KVector3D const &principalAxis(int idx) const;
+  Karma::AxisExtremes const &principalExtremes(int idx) const;
+
+private:
+  QScopedPointer<KBoundingVolumeFitPrivate> m_private;
+};
+
+#endif // KBOUNDINGVOLUMEFIT_H
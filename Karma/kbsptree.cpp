@@ -10,32 +10,56 @@
 #include <KTrianglePointIterator>
 #include <OpenGLDebugDraw>
 #include <KPlane>
+#include <KParallel>
+#include <KTaskGroup>
+#include <KSpatialFile>
+#include <QString>
+#include <atomic>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Subtrees smaller than this are built serially (task overhead dominates).
+static const size_t ParallelCutoff = 4096;
+
+// Every node draws from a generator of its own, seeded from its parent.
+static int nodeRandom(std::minstd_rand &rng)
+{
+  return static_cast<int>(rng() % (static_cast<unsigned>(RAND_MAX) + 1u));
+}
 
 /*******************************************************************************
- * KAdaptiveOctreeNode
+ * KBspTreeNode
  ******************************************************************************/
 class KBspTreeNode
 {
 public:
-  typedef KTriangleIndexCloud::ConstIterator ConstIterator;
-
-  KBspTreeNode(size_t depth, KPointCloud &cloud);
+  KBspTreeNode(size_t depth, std::minstd_rand &rng);
+  ~KBspTreeNode();
   bool isLeaf() const;
-  void debugDraw(KTransform3D &trans, size_t min, size_t max) const;
 
   size_t m_depth;
   KColor m_color;
   KPlane m_plane;
   KBspTreeNode *m_left;
   KBspTreeNode *m_right;
-  KTriangleIndexCloud m_objects;
-  KPointCloud &m_pointCloud;
+  size_t m_first, m_count; // Range within the (partitioned) triangle cloud
 };
 
-KBspTreeNode::KBspTreeNode(size_t depth, KPointCloud &cloud) :
-  m_depth(depth), m_color(float(std::rand()) / RAND_MAX, float(std::rand()) / RAND_MAX, float(std::rand()) / RAND_MAX), m_left(0), m_right(0), m_pointCloud(cloud)
+KBspTreeNode::KBspTreeNode(size_t depth, std::minstd_rand &rng) :
+  m_depth(depth), m_plane(KVector3D(0.0f, 0.0f, 0.0f), KVector3D(0.0f, 1.0f, 0.0f)),
+  m_left(0), m_right(0), m_first(0), m_count(0)
 {
-  // Intentionally Empty
+  float r = float(nodeRandom(rng)) / RAND_MAX;
+  float g = float(nodeRandom(rng)) / RAND_MAX;
+  float b = float(nodeRandom(rng)) / RAND_MAX;
+  m_color = KColor(r, g, b);
+}
+
+KBspTreeNode::~KBspTreeNode()
+{
+  delete m_left;
+  delete m_right;
 }
 
 bool KBspTreeNode::isLeaf() const
@@ -43,32 +67,18 @@ bool KBspTreeNode::isLeaf() const
   return (m_left == 0 && m_right == 0);
 }
 
-void KBspTreeNode::debugDraw(KTransform3D &trans, size_t min, size_t max) const
+/*******************************************************************************
+ * KBspTreeFlatNode
+ ******************************************************************************/
+// Note: Stored verbatim on disk, only add fixed-size fields (and bump the file version).
+struct KBspTreeFlatNode
 {
-  if (m_depth <= max)
-  {
-    if (m_depth >= min)
-    {
-      for (KTriangleIndexCloud::ElementType const &elm : m_objects)
-      {
-        OpenGLDebugDraw::World::drawTriangle(
-          m_pointCloud[elm.indices[0] - 1],
-          m_pointCloud[elm.indices[1] - 1],
-          m_pointCloud[elm.indices[2] - 1],
-          m_color
-        );
-      }
-    }
-    if (m_left)
-    {
-      m_left->debugDraw(trans, min, max);
-    }
-    if (m_right)
-    {
-      m_right->debugDraw(trans, min, max);
-    }
-  }
-}
+  float plane[4]; // Normal and d-term
+  uint32_t depth;
+  uint32_t color;
+  uint32_t firstTriangle, numTriangles;
+  uint32_t left, right; // 0 = no child (the root is never a child)
+};
 
 /*******************************************************************************
  * KBspTreePrivate
@@ -79,22 +89,66 @@ public:
   typedef KTriangleIndexCloud::Iterator TriangleIterator;
   typedef KBspTree::TerminationPred TerminationPred;
 
+  struct PlaneScore
+  {
+    float score;
+    KPlane plane;
+    int numCoplanar, numInFront, numInBack, numStraddling;
+  };
+
   KBspTreePrivate(KGeometryCloud &parent);
   void buildBottomUp(TerminationPred pred);
-  void buildTopDown(TerminationPred pred);
-  KBspTreeNode* recursiveTopDown(size_t depth, TriangleIterator begin, TriangleIterator end, TerminationPred pred);
-  KPlane pickSplittingPlane(TriangleIterator begin, TriangleIterator end, float skipWeight = 0.0f);
-
-  KBspTreeNode *m_root;
-  size_t m_maxDepth;
+  void buildTopDown(TerminationPred pred, int flags);
+  KBspTreeNode* recursiveTopDown(size_t depth, uint32_t seed, TriangleIterator begin, TriangleIterator end, TerminationPred pred);
+  KPlane pickSplittingPlane(TriangleIterator begin, TriangleIterator end, float skipWeight, std::minstd_rand &rng);
+  PlaneScore scorePlane(TriangleIterator begin, TriangleIterator end, TriangleIterator sample) const;
+  void updateMaxDepth(size_t depth);
+  bool parallel() const;
+  bool deterministic() const;
+  uint32_t rootSeed() const;
+  void flatten(KBspTreeNode *root);
+  uint32_t flattenNode(KBspTreeNode const *node);
+  bool validNodes() const;
+  void drawNode(KTransform3D &trans, uint32_t index, size_t min, size_t max) const;
+
+  std::atomic<size_t> m_maxDepth; // Reported by depth(), never read while building
+  int m_buildFlags;
   KGeometryCloud m_parent;
   KPointCloud m_pointCloud;
+
+  // Flattened tree (owned after a build, mapped after a load)
+  std::vector<KBspTreeFlatNode> m_flatNodes;
+  std::vector<uint32_t> m_flatTriangles;
+  KSpatialFile m_file;
+  KSpatialFile::Description m_view;
 };
 
 KBspTreePrivate::KBspTreePrivate(KGeometryCloud &parent) :
-  m_root(0), m_parent(parent)
+  m_maxDepth(0), m_buildFlags(KGeometryCloud::NoBuildFlags), m_parent(parent)
 {
-  // Intentionally Empty
+  std::memset(&m_view, 0, sizeof(m_view));
+}
+
+void KBspTreePrivate::updateMaxDepth(size_t depth)
+{
+  size_t prevDepth = m_maxDepth;
+  while (prevDepth < depth && !m_maxDepth.compare_exchange_weak(prevDepth, depth));
+}
+
+bool KBspTreePrivate::parallel() const
+{
+  return (m_buildFlags & KGeometryCloud::ParallelBuild);
+}
+
+bool KBspTreePrivate::deterministic() const
+{
+  return (m_buildFlags & KGeometryCloud::DeterministicBuild);
+}
+
+uint32_t KBspTreePrivate::rootSeed() const
+{
+  // Only the root seed differs between builds, serial or parallel.
+  return deterministic() ? 0 : std::random_device()();
 }
 
 void KBspTreePrivate::buildBottomUp(TerminationPred pred)
@@ -103,25 +157,31 @@ void KBspTreePrivate::buildBottomUp(TerminationPred pred)
   qFatal("Unsupported Build Method!");
 }
 
-void KBspTreePrivate::buildTopDown(TerminationPred pred)
+void KBspTreePrivate::buildTopDown(TerminationPred pred, int flags)
 {
   m_maxDepth = 0;
+  m_buildFlags = flags;
   KTriangleIndexCloud & triangleCloud = m_parent.triangleIndexCloud();
   m_pointCloud = m_parent.pointCloud();
-  m_root = recursiveTopDown(0, triangleCloud.begin(), triangleCloud.end(), pred);
+  flatten(recursiveTopDown(0, rootSeed(), triangleCloud.begin(), triangleCloud.end(), pred));
 }
 
-KBspTreeNode* KBspTreePrivate::recursiveTopDown(size_t depth, TriangleIterator begin, TriangleIterator end, TerminationPred pred)
+KBspTreeNode* KBspTreePrivate::recursiveTopDown(size_t depth, uint32_t seed, TriangleIterator begin, TriangleIterator end, TerminationPred pred)
 {
   KPointCloud const & pointCloud = m_parent.pointCloud();
   size_t numTriangles = std::distance(begin, end);
-  if (m_maxDepth < depth) m_maxDepth = depth;
+  updateMaxDepth(depth);
+
+  // Nothing may depend on the order nodes are visited in, so randomness is
+  // seeded per-node and the predicate sees the depth of the node.
+  std::minstd_rand rng(seed + 1);
 
   // Check if the predicate was met (terminating condition)
-  KBspTreeNode *node = new KBspTreeNode(depth, m_pointCloud);
-  if (pred(numTriangles, m_maxDepth))
+  KBspTreeNode *node = new KBspTreeNode(depth, rng);
+  node->m_first = std::distance(m_parent.triangleIndexCloud().begin(), begin);
+  node->m_count = numTriangles;
+  if (pred(numTriangles, depth))
   {
-    node->m_objects.copy(begin, end);
     return node;
   }
 
@@ -133,88 +193,210 @@ KBspTreeNode* KBspTreePrivate::recursiveTopDown(size_t depth, TriangleIterator b
     skip += 0.1f;
     testTriangles /= 10;
   }
-  KPlane plane = pickSplittingPlane(begin, end, skip);
+  KPlane plane = pickSplittingPlane(begin, end, skip, rng);
   node->m_plane = plane;
 
-  // Create all nodes
+  // Create all nodes (children own disjoint ranges, so they may build concurrently)
   TriangleIterator middle = std::partition(begin, end, KTrianglePartitionPlane(pointCloud, plane));
-  node->m_left = recursiveTopDown(depth + 1, begin, middle, pred);
-  node->m_right = recursiveTopDown(depth + 1, middle, end, pred);
+  uint32_t leftSeed = Karma::hashSeed(seed, 0);
+  uint32_t rightSeed = Karma::hashSeed(seed, 1);
+  if (parallel() && numTriangles > ParallelCutoff)
+  {
+    KTaskGroup group;
+    group.run([=]() { node->m_left = recursiveTopDown(depth + 1, leftSeed, begin, middle, pred); });
+    node->m_right = recursiveTopDown(depth + 1, rightSeed, middle, end, pred);
+    group.wait();
+  }
+  else
+  {
+    node->m_left = recursiveTopDown(depth + 1, leftSeed, begin, middle, pred);
+    node->m_right = recursiveTopDown(depth + 1, rightSeed, middle, end, pred);
+  }
 
-  // Grab remaining indices
-  node->m_objects.copy(begin, end);
   return node;
 }
 
-KPlane KBspTreePrivate::pickSplittingPlane(TriangleIterator begin, TriangleIterator end, float skipWeight)
+void KBspTreePrivate::flatten(KBspTreeNode *root)
+{
+  // Nodes are laid out depth-first, children refer to each other by index.
+  m_flatNodes.clear();
+  flattenNode(root);
+  delete root;
+
+  // Triangles are stored in partitioned order, so every node owns a range.
+  KTriangleIndexCloud const &triangleCloud = m_parent.triangleIndexCloud();
+  m_flatTriangles.clear();
+  m_flatTriangles.reserve(triangleCloud.size() * 3);
+  for (KTriangleIndexCloud::ElementType const &triangle : triangleCloud)
+  {
+    m_flatTriangles.push_back(static_cast<uint32_t>(triangle.indices[0] - 1));
+    m_flatTriangles.push_back(static_cast<uint32_t>(triangle.indices[1] - 1));
+    m_flatTriangles.push_back(static_cast<uint32_t>(triangle.indices[2] - 1));
+  }
+
+  m_view.maxDepth = static_cast<uint32_t>(m_maxDepth.load());
+  m_view.nodes = m_flatNodes.data();
+  m_view.nodeCount = m_flatNodes.size();
+  m_view.nodeSize = sizeof(KBspTreeFlatNode);
+  m_view.triangles = m_flatTriangles.data();
+  m_view.triangleCount = triangleCloud.size();
+  m_view.points = m_pointCloud.data();
+  m_view.pointCount = m_pointCloud.size();
+}
+
+uint32_t KBspTreePrivate::flattenNode(KBspTreeNode const *node)
+{
+  uint32_t index = static_cast<uint32_t>(m_flatNodes.size());
+  KBspTreeFlatNode flat;
+  KVector3D const &normal = node->m_plane.normal();
+  flat.plane[0] = normal.x();
+  flat.plane[1] = normal.y();
+  flat.plane[2] = normal.z();
+  flat.plane[3] = node->m_plane.dTerm();
+  flat.depth = static_cast<uint32_t>(node->m_depth);
+  flat.color = node->m_color.rgba();
+  flat.firstTriangle = static_cast<uint32_t>(node->m_first);
+  flat.numTriangles = static_cast<uint32_t>(node->m_count);
+  m_flatNodes.push_back(flat);
+
+  // Note: Recursion grows m_flatNodes, so write through the index afterwards.
+  uint32_t left = node->m_left ? flattenNode(node->m_left) : 0;
+  m_flatNodes[index].left = left;
+  uint32_t right = node->m_right ? flattenNode(node->m_right) : 0;
+  m_flatNodes[index].right = right;
+  return index;
+}
+
+bool KBspTreePrivate::validNodes() const
+{
+  // Corrupt indices would otherwise be followed by drawNode.
+  KBspTreeFlatNode const *nodes = static_cast<KBspTreeFlatNode const*>(m_file.description().nodes);
+  for (size_t i = 0; i < m_file.description().nodeCount; ++i)
+  {
+    KBspTreeFlatNode const &node = nodes[i];
+    if (!m_file.isValidTriangleRange(node.firstTriangle, node.numTriangles)) return false;
+    if (!m_file.isValidChild(i, node.left) || !m_file.isValidChild(i, node.right)) return false;
+  }
+  return true;
+}
+
+void KBspTreePrivate::drawNode(KTransform3D &trans, uint32_t index, size_t min, size_t max) const
+{
+  KBspTreeFlatNode const &node = static_cast<KBspTreeFlatNode const*>(m_view.nodes)[index];
+  if (node.depth <= max)
+  {
+    if (node.depth >= min)
+    {
+      KColor color(static_cast<QRgb>(node.color));
+      uint32_t const *it = m_view.triangles + 3 * node.firstTriangle;
+      uint32_t const *end = it + 3 * node.numTriangles;
+      for (; it != end; it += 3)
+      {
+        OpenGLDebugDraw::World::drawTriangle(
+          m_view.points[it[0]],
+          m_view.points[it[1]],
+          m_view.points[it[2]],
+          color
+        );
+      }
+    }
+    if (node.left)
+    {
+      drawNode(trans, node.left, min, max);
+    }
+    if (node.right)
+    {
+      drawNode(trans, node.right, min, max);
+    }
+  }
+}
+
+KBspTreePrivate::PlaneScore KBspTreePrivate::scorePlane(TriangleIterator begin, TriangleIterator end, TriangleIterator sample) const
 {
   const float K = 0.8f;
 
+  // Construct the sample plane
+  PlaneScore result;
+  KTriangleIndexCloud::ElementType const &sampleTriangle = *sample;
+  result.plane = KPlane(
+    m_pointCloud[sampleTriangle.indices[0] - 1],
+    m_pointCloud[sampleTriangle.indices[1] - 1],
+    m_pointCloud[sampleTriangle.indices[2] - 1]
+  );
+
+  // Count the polygons
+  result.numCoplanar = result.numInFront = result.numInBack = result.numStraddling = 0;
+  Karma::classifyRange(result.plane, begin, end, m_pointCloud, &result.numCoplanar, &result.numInFront, &result.numInBack, &result.numStraddling);
+
+  // Score the polygons
+  result.score = K * (result.numStraddling + result.numCoplanar) + (1.0f - K) * std::abs(result.numInFront - result.numInBack);
+  return result;
+}
+
+KPlane KBspTreePrivate::pickSplittingPlane(TriangleIterator begin, TriangleIterator end, float skipWeight, std::minstd_rand &rng)
+{
   // Initialize search statistics
-  float bestScore = std::numeric_limits<float>::max();
   size_t numPolygons = std::distance(begin, end);
   size_t skipSize = numPolygons * skipWeight;
   skipSize = Karma::clamp(skipSize, static_cast<size_t>(1), numPolygons);
 
-  // For analysis
-  float score;
-  KPlane plane, bestPlane;
-  int numCoplanar, numInFront, numInBack, numStraddling;
-  int bestCoplanar, bestInFront, bestInBack, bestStraddling;
-  bestCoplanar = bestInFront = bestInBack = bestStraddling = 0;
-
   // Iterate over the range, skipping based on the weight provided.
-  size_t numRemaining;
-  TriangleIterator origBegin = begin;
-  while (begin != end)
+  // Note: Skipping through a percentage of the mesh was introduced for efficiency reasons
+  size_t numCandidates = (numPolygons < skipSize) ? 0 : (numPolygons - skipSize) / skipSize + 1;
+  std::vector<PlaneScore> scores(numCandidates);
+  auto scoreCandidates = [&](size_t from, size_t to)
   {
-    // Test if we have no more remaining
-    numRemaining = std::distance(begin, end);
-    if (numRemaining < skipSize) break;
-
-    // Construct the sample plane
-    KTriangleIndexCloud::ElementType const &sampleTriangle = *begin;
-    plane = KPlane(
-      m_pointCloud[sampleTriangle.indices[0] - 1],
-      m_pointCloud[sampleTriangle.indices[1] - 1],
-      m_pointCloud[sampleTriangle.indices[2] - 1]
-    );
+    for (size_t c = from; c < to; ++c)
+    {
+      scores[c] = scorePlane(begin, end, begin + c * skipSize);
+    }
+  };
 
-    // Count the polygons
-    numCoplanar = numInFront = numInBack = numStraddling = 0;
-    Karma::classifyRange(plane, origBegin, end, m_pointCloud, &numCoplanar, &numInFront, &numInBack, &numStraddling);
+  // Every candidate is an O(n) classification; spread them across threads.
+  if (parallel() && numPolygons * numCandidates > ParallelCutoff * 16)
+  {
+    size_t grain = std::max<size_t>(1, ParallelCutoff / std::max<size_t>(1, numPolygons));
+    Karma::parallelFor(0, numCandidates, grain, scoreCandidates);
+  }
+  else
+  {
+    scoreCandidates(0, numCandidates);
+  }
 
-    // Score the polygons
-    score = K * (numStraddling + numCoplanar) + (1.0f - K) * std::abs(numInFront - numInBack);
-    if (score < bestScore)
+  // First best score wins, so the choice matches the serial scan exactly.
+  KPlane bestPlane;
+  int bestCoplanar, bestInFront, bestInBack, bestStraddling;
+  bestCoplanar = bestInFront = bestInBack = bestStraddling = 0;
+  float bestScore = std::numeric_limits<float>::max();
+  for (PlaneScore const &score : scores)
+  {
+    if (score.score < bestScore)
     {
-      bestCoplanar = numCoplanar;
-      bestInFront = numInFront;
-      bestInBack = numInBack;
-      bestStraddling = numStraddling;
-      bestScore = score;
-      bestPlane = plane;
+      bestCoplanar = score.numCoplanar;
+      bestInFront = score.numInFront;
+      bestInBack = score.numInBack;
+      bestStraddling = score.numStraddling;
+      bestScore = score.score;
+      bestPlane = score.plane;
     }
-
-    // Note: Skipping through a percentage of the mesh was introduced for efficiency reasons
-    begin += skipSize;
   }
 
   // Edge case: No plane formed by the faces of the mesh will reduce sample size
   while (bestInFront == 0 || bestInBack == 0)
   {
-    KTriangleIndexCloud::ElementType const &a = *(origBegin + (std::rand() % numPolygons));
-    KTriangleIndexCloud::ElementType const &b = *(origBegin + (std::rand() % numPolygons));
-    KTriangleIndexCloud::ElementType const &c = *(origBegin + (std::rand() % numPolygons));
+    KTriangleIndexCloud::ElementType const &a = *(begin + (nodeRandom(rng) % numPolygons));
+    KTriangleIndexCloud::ElementType const &b = *(begin + (nodeRandom(rng) % numPolygons));
+    KTriangleIndexCloud::ElementType const &c = *(begin + (nodeRandom(rng) % numPolygons));
     bestPlane = KPlane(
       m_pointCloud[a.indices[0] - 1],
       m_pointCloud[b.indices[1] - 1],
       m_pointCloud[c.indices[2] - 1]
     );
-    Karma::classifyRange(bestPlane, origBegin, end, m_pointCloud, &bestCoplanar, &bestInFront, &bestInBack, &bestStraddling);
+    Karma::classifyRange(bestPlane, begin, end, m_pointCloud, &bestCoplanar, &bestInFront, &bestInBack, &bestStraddling);
   }
 
   // Due to the edge case, the splitting of the mesh isn't always the same.
+  // (Unless this is a DeterministicBuild, which seeds every build the same.)
   return bestPlane;
 }
 
@@ -252,23 +434,52 @@ void KBspTree::build(KGeometryCloud::BuildMethod method, KGeometryCloud::Termina
   if (!dirty()) return;
 
   // Build based on selected method
+  p.m_file.unmap();
+  p.m_view.type = KSpatialFile::BspTreeType;
+  p.m_view.method = method;
+  p.m_view.sourceHash = hash();
+  p.m_view.terminationKey = terminationKey();
   switch (method)
   {
   case BottomUpMethod:
     p.buildBottomUp(pred);
     break;
   case TopDownMethod:
-    p.buildTopDown(pred);
+    p.buildTopDown(pred, buildFlags());
     break;
   }
 
   // We no longer need this data
   KGeometryCloud::clear();
+}
 
-  // Next: Depth-first search to find all leaf nodes.
-  //       Form an index buffer of all contiguous leaf nodes.
-  //       As we iterate through, update the parent nodes so they
-  //       understand the "drawable range" of the children.
+bool KBspTree::save(QString const &fileName) const
+{
+  P(const KBspTreePrivate);
+  if (p.m_view.nodeCount == 0) return false;
+  return KSpatialFile::write(fileName, p.m_view);
+}
+
+bool KBspTree::load(QString const &fileName, BuildMethod method)
+{
+  P(KBspTreePrivate);
+
+  // The file must match the geometry which would otherwise be built.
+  if (!dirty()) return false;
+  if (!p.m_file.map(fileName, KSpatialFile::BspTreeType, method, hash(), terminationKey(), sizeof(KBspTreeFlatNode)) || !p.validNodes())
+  {
+    p.m_file.unmap();
+    return false;
+  }
+
+  // Use the mapping in place, release anything from a previous build.
+  p.m_view = p.m_file.description();
+  p.m_maxDepth = p.m_view.maxDepth;
+  std::vector<KBspTreeFlatNode>().swap(p.m_flatNodes);
+  std::vector<uint32_t>().swap(p.m_flatTriangles);
+  p.m_pointCloud.clear();
+  KGeometryCloud::clear();
+  return true;
 }
 
 void KBspTree::debugDraw(size_t min, size_t max)
@@ -280,8 +491,8 @@ void KBspTree::debugDraw(size_t min, size_t max)
 void KBspTree::debugDraw(KTransform3D &trans, size_t min, size_t max)
 {
   P(KBspTreePrivate);
-  if (p.m_root)
+  if (p.m_view.nodeCount)
   {
-    p.m_root->debugDraw(trans, min, max);
+    p.drawNode(trans, 0, min, max);
   }
 }
@@ -16,6 +16,8 @@ public:
   inline ~KBufferedBinaryFileReaderPrivate();
   inline int next();
   QFile m_file;
+  uchar *m_map; // Note: Mapped files bypass the buffers entirely.
+  size_t m_mapSize, m_mapPos;
   char *m_buffer; // Note: (m_buffer == Null) ? !isVaid : isValid;
   char *m_currBuffer, *m_nextBuffer;
   char const *m_bufferPos;
@@ -23,16 +25,22 @@ public:
 };
 
 inline KBufferedBinaryFileReaderPrivate::KBufferedBinaryFileReaderPrivate() :
-  m_file(), m_buffer(Q_NULLPTR), m_bufferSize(0)
+  m_file(), m_map(Q_NULLPTR), m_mapSize(0), m_mapPos(0), m_buffer(Q_NULLPTR), m_bufferSize(0)
 {
   // Intentionally Empty
 }
 
 inline KBufferedBinaryFileReaderPrivate::KBufferedBinaryFileReaderPrivate(const QString &fileName, size_t buffsize) :
-  m_file(fileName), m_buffer(Q_NULLPTR), m_bufferSize(buffsize)
+  m_file(fileName), m_map(Q_NULLPTR), m_mapSize(0), m_mapPos(0), m_buffer(Q_NULLPTR), m_bufferSize(buffsize)
 {
   if (m_file.open(QFile::ReadOnly))
   {
+    // Prefer reading the file in place
+    m_mapSize = static_cast<size_t>(m_file.size());
+    if (m_mapSize > 0) m_map = m_file.map(0, m_file.size());
+    if (m_map) return;
+    m_mapSize = 0;
+
     // m_buffer is also our "isValid"
     m_buffer = new char[buffsize * 2 + 2];
 
@@ -55,11 +63,18 @@ inline KBufferedBinaryFileReaderPrivate::KBufferedBinaryFileReaderPrivate(const
 
 inline KBufferedBinaryFileReaderPrivate::~KBufferedBinaryFileReaderPrivate()
 {
+  if (m_map) m_file.unmap(m_map);
   delete [] m_buffer;
 }
 
 inline int KBufferedBinaryFileReaderPrivate::next()
 {
+  if (m_map)
+  {
+    if (m_mapPos == m_mapSize) return EOF;
+    return m_map[m_mapPos++];
+  }
+
   ++m_bufferPos;
 
   // Handle EOF Markers
@@ -108,5 +123,23 @@ int KBufferedBinaryFileReader::next()
 bool KBufferedBinaryFileReader::valid()
 {
   P(KBufferedBinaryFileReaderPrivate);
-  return (p.m_buffer != Q_NULLPTR);
+  return (p.m_map != Q_NULLPTR || p.m_buffer != Q_NULLPTR);
+}
+
+unsigned char const *KBufferedBinaryFileReader::data() const
+{
+  P(const KBufferedBinaryFileReaderPrivate);
+  return p.m_map;
+}
+
+size_t KBufferedBinaryFileReader::size() const
+{
+  P(const KBufferedBinaryFileReaderPrivate);
+  return p.m_mapSize;
+}
+
+size_t KBufferedBinaryFileReader::position() const
+{
+  P(const KBufferedBinaryFileReaderPrivate);
+  return p.m_mapPos;
 }
@@ -14,6 +14,11 @@ public:
   ~KBufferedBinaryFileReader();
   int next();
   bool valid();
+
+  // Memory mapped files are read in place (Buffered otherwise)
+  unsigned char const *data() const;
+  size_t size() const;
+  size_t position() const;
 private:
   QScopedPointer<KBufferedBinaryFileReaderPrivate> m_private;
 };
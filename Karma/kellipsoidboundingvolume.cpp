@@ -6,21 +6,22 @@
 #include <KTransform3D>
 #include <OpenGLDebugDraw>
 #include <KMatrix3x3>
+#include <KBoundingVolumeFit>
 
 class KEllipsoidBoundingVolumePrivate
 {
 public:
-  void calculatePcaMethod(KHalfEdgeMesh const &mesh);
+  void calculatePcaMethod(KBoundingVolumeFit const &fit);
   KVector3D centroid;
   KMatrix3x3 axes;
   KVector3D extents;
 private:
-  void calculateUsingCovarianceMatrix(KHalfEdgeMesh const &mesh, int iterations);
+  void calculateUsingCovarianceMatrix(KBoundingVolumeFit const &fit);
 };
 
-void KEllipsoidBoundingVolumePrivate::calculatePcaMethod(const KHalfEdgeMesh &mesh)
+void KEllipsoidBoundingVolumePrivate::calculatePcaMethod(KBoundingVolumeFit const &fit)
 {
-  calculateUsingCovarianceMatrix(mesh, 50);
+  calculateUsingCovarianceMatrix(fit);
   /*
   for (KHalfEdgeMesh::Vertex const &v : mesh.vertices())
   {
@@ -45,29 +46,17 @@ void KEllipsoidBoundingVolumePrivate::calculatePcaMethod(const KHalfEdgeMesh &me
   */
 }
 
-void KEllipsoidBoundingVolumePrivate::calculateUsingCovarianceMatrix(const KHalfEdgeMesh &mesh, int iterations)
+void KEllipsoidBoundingVolumePrivate::calculateUsingCovarianceMatrix(KBoundingVolumeFit const &fit)
 {
-  KHalfEdgeMesh::VertexContainer const &vertices = mesh.vertices();
-
-  // Solve for the covariance matrix
-  KMatrix3x3 covariance =
-    Karma::covarianceMatrix(
-      vertices.begin(),
-      vertices.end(),
-      KHalfEdgeMesh::VertexPositionPred()
-    );
-  axes = Karma::jacobi(covariance, iterations);
-
-  // Find the extremal projected points along each axis
-  std::vector<KVector3D> extractedAxes = Karma::decomposeMatrixeByColumnVectors(axes);
-  std::vector<Karma::MinMaxKVector3D> extremal =
-    Karma::findExtremalProjectedPointsAlongAxes(
-      vertices.begin(),
-      vertices.end(),
-      extractedAxes.begin(),
-      extractedAxes.end(),
-      KHalfEdgeMesh::VertexPositionPred()
-    );
+  // Principal axes and their extremal projections come from the fit
+  axes = fit.principalAxes();
+  Karma::MinMaxKVector3D extremal[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    Karma::AxisExtremes const &extremes = fit.principalExtremes(i);
+    extremal[i].min = extremes.minProj * fit.principalAxis(i);
+    extremal[i].max = extremes.maxProj * fit.principalAxis(i);
+  }
 
   // Store information for the centroid and extent
   KVector3D axisA = extremal[0].max - extremal[0].min;
@@ -94,13 +83,19 @@ KEllipsoidBoundingVolume::KEllipsoidBoundingVolume() :
 }
 
 KEllipsoidBoundingVolume::KEllipsoidBoundingVolume(KHalfEdgeMesh const &mesh, Method method) :
+  KEllipsoidBoundingVolume(KBoundingVolumeFit(mesh), method)
+{
+  // Intentionally Empty
+}
+
+KEllipsoidBoundingVolume::KEllipsoidBoundingVolume(KBoundingVolumeFit const &fit, Method method) :
   m_private(new KEllipsoidBoundingVolumePrivate)
 {
   P(KEllipsoidBoundingVolumePrivate);
   switch (method)
   {
   case PcaMethod:
-    p.calculatePcaMethod(mesh);
+    p.calculatePcaMethod(fit);
     break;
   }
 }
@@ -3,6 +3,7 @@
 
 #include <KAbstractBoundingVolume>
 class KHalfEdgeMesh;
+class KBoundingVolumeFit;
 
 class KEllipsoidBoundingVolumePrivate;
 class KEllipsoidBoundingVolume : public KAbstractBoundingVolume
@@ -15,6 +16,7 @@ public:
 
   KEllipsoidBoundingVolume();
   KEllipsoidBoundingVolume(KHalfEdgeMesh const &mesh, Method method);
+  KEllipsoidBoundingVolume(KBoundingVolumeFit const &fit, Method method);
   ~KEllipsoidBoundingVolume();
   void draw(KTransform3D &t, KColor const &color) const;
 private:
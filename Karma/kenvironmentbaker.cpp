@@ -0,0 +1,428 @@
+#include "kenvironmentbaker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <KHash>
+#include <KParallel>
+#include <KTextureFile>
+#include <QString>
+
+// Output rows filtered per task (each texel takes sampleCount fetches).
+static const size_t RowGrain = 4;
+
+// Source rows projected per task.
+static const size_t ProjectionGrain = 16;
+
+// Bumped whenever the bake itself changes, so old cache files are rejected.
+static const uint32_t BakeVersion = 1;
+
+static const float Pi = 3.14159265358979f;
+static const float Pi2 = 6.28318530717959f;
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+struct KBakeVector
+{
+  float x, y, z;
+};
+
+struct KBakeSample
+{
+  KBakeVector L;  // Tangent space (N = +Z)
+  float NoL;
+  float lod;
+};
+
+struct KShSums
+{
+  double c[KEnvironmentBaker::ShCoefficients][3];
+};
+
+static KBakeVector normalized(KBakeVector const &v)
+{
+  float invLength = 1.0f / std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+  KBakeVector r = { v.x * invLength, v.y * invLength, v.z * invLength };
+  return r;
+}
+
+static KBakeVector cross(KBakeVector const &a, KBakeVector const &b)
+{
+  KBakeVector r = { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+  return r;
+}
+
+// Matches InvSphereMap() in Math.glsl.
+static KBakeVector sphereDirection(float u, float v)
+{
+  float alpha = Pi2 * (0.5f - u);
+  float theta = Pi * v;
+  float sinTheta = std::sin(theta);
+  KBakeVector r = { std::cos(alpha) * sinTheta, std::sin(alpha) * sinTheta, std::cos(theta) };
+  return r;
+}
+
+static float radicalInverse(unsigned bits)
+{
+  bits = (bits << 16u) | (bits >> 16u);
+  bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+  bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+  bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+  bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+  return float(bits) * 2.3283064365386963e-10f;
+}
+
+static void evaluateSh(KBakeVector const &d, float basis[KEnvironmentBaker::ShCoefficients])
+{
+  basis[0] = 0.282095f;
+  basis[1] = 0.488603f * d.y;
+  basis[2] = 0.488603f * d.z;
+  basis[3] = 0.488603f * d.x;
+  basis[4] = 1.092548f * d.x * d.y;
+  basis[5] = 1.092548f * d.y * d.z;
+  basis[6] = 0.315392f * (3.0f * d.z * d.z - 1.0f);
+  basis[7] = 1.092548f * d.x * d.z;
+  basis[8] = 0.546274f * (d.x * d.x - d.y * d.y);
+}
+
+static void downsample(KEnvironmentBaker::Level const &src, KEnvironmentBaker::Level &dst)
+{
+  dst.width = std::max(src.width / 2, 1);
+  dst.height = std::max(src.height / 2, 1);
+  dst.rgb.resize(3 * size_t(dst.width) * dst.height);
+  Karma::parallelFor(0, size_t(dst.height), ProjectionGrain, [&src, &dst](size_t b, size_t e)
+  {
+    for (size_t y = b; y < e; ++y)
+    {
+      size_t y0 = std::min<size_t>(2 * y, src.height - 1), y1 = std::min<size_t>(2 * y + 1, src.height - 1);
+      for (size_t x = 0; x < size_t(dst.width); ++x)
+      {
+        size_t x0 = std::min<size_t>(2 * x, src.width - 1), x1 = std::min<size_t>(2 * x + 1, src.width - 1);
+        float const *a = &src.rgb[3 * (y0 * src.width + x0)];
+        float const *b = &src.rgb[3 * (y0 * src.width + x1)];
+        float const *c = &src.rgb[3 * (y1 * src.width + x0)];
+        float const *d = &src.rgb[3 * (y1 * src.width + x1)];
+        float *out = &dst.rgb[3 * (y * dst.width + x)];
+        for (int i = 0; i < 3; ++i) out[i] = 0.25f * (a[i] + b[i] + c[i] + d[i]);
+      }
+    }
+  });
+}
+
+// Bilinear with wrapping longitude and clamped latitude.
+static void sampleLevel(KEnvironmentBaker::Level const &level, float u, float v, float rgb[3])
+{
+  float fx = u * level.width - 0.5f;
+  float fy = std::min(std::max(v * level.height - 0.5f, 0.0f), float(level.height - 1));
+  float x0f = std::floor(fx), y0f = std::floor(fy);
+  float tx = fx - x0f, ty = fy - y0f;
+  int x0 = int(x0f) % level.width;
+  if (x0 < 0) x0 += level.width;
+  int x1 = (x0 + 1 == level.width) ? 0 : x0 + 1;
+  int y0 = int(y0f);
+  int y1 = std::min(y0 + 1, level.height - 1);
+  float const *a = &level.rgb[3 * (size_t(y0) * level.width + x0)];
+  float const *b = &level.rgb[3 * (size_t(y0) * level.width + x1)];
+  float const *c = &level.rgb[3 * (size_t(y1) * level.width + x0)];
+  float const *d = &level.rgb[3 * (size_t(y1) * level.width + x1)];
+  for (int i = 0; i < 3; ++i)
+  {
+    float top = a[i] + (b[i] - a[i]) * tx;
+    float bottom = c[i] + (d[i] - c[i]) * tx;
+    rgb[i] = top + (bottom - top) * ty;
+  }
+}
+
+// Trilinear between the source mips, like textureSphereLod().
+static void sampleSphere(std::vector<KEnvironmentBaker::Level> const &mips, KBakeVector const &d, float lod, float rgb[3])
+{
+  float u = 0.5f - std::atan2(d.y, d.x) / Pi2;
+  float v = std::acos(std::min(std::max(d.z, -1.0f), 1.0f)) / Pi;
+  lod = std::min(std::max(lod, 0.0f), float(mips.size() - 1));
+  size_t l0 = size_t(lod);
+  size_t l1 = std::min(l0 + 1, mips.size() - 1);
+  float t = lod - float(l0);
+  sampleLevel(mips[l0], u, v, rgb);
+  if (t > 0.0f && l1 != l0)
+  {
+    float next[3];
+    sampleLevel(mips[l1], u, v, next);
+    for (int i = 0; i < 3; ++i) rgb[i] += (next[i] - rgb[i]) * t;
+  }
+}
+
+// GGX importance samples for N = V, shared by every texel of a level. The
+// source lod follows the sample pdf (filtered importance sampling), and never
+// drops below the output resolution so that no level aliases.
+static std::vector<KBakeSample> ggxSamples(float roughness, unsigned count, int sourceTexels, float minLod)
+{
+  std::vector<KBakeSample> samples;
+  if (roughness <= 0.0f)
+  {
+    KBakeSample mirror = { { 0.0f, 0.0f, 1.0f }, 1.0f, minLod };
+    samples.push_back(mirror);
+    return samples;
+  }
+
+  // Alpha is the roughness itself, as in DGgx() of Physical.glsl.
+  float a2 = roughness * roughness;
+  float texelSolidAngle = 4.0f * Pi / float(sourceTexels);
+  for (unsigned i = 0; i < count; ++i)
+  {
+    float phi = Pi2 * float(i) / float(count);
+    float xi = radicalInverse(i);
+    float cosTheta = std::sqrt((1.0f - xi) / (1.0f + (a2 - 1.0f) * xi));
+    float sinTheta = std::sqrt(1.0f - cosTheta * cosTheta);
+    KBakeVector H = { sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta };
+
+    KBakeSample sample;
+    float NoH = cosTheta;
+    sample.L.x = 2.0f * NoH * H.x;
+    sample.L.y = 2.0f * NoH * H.y;
+    sample.L.z = 2.0f * NoH * H.z - 1.0f;
+    sample.NoL = sample.L.z;
+    if (sample.NoL <= 0.0f) continue;
+
+    // pdf(L) = D * NoH / (4 * VoH), and VoH == NoH here.
+    float denom = NoH * NoH * (a2 - 1.0f) + 1.0f;
+    float D = a2 / (Pi * denom * denom);
+    float sampleSolidAngle = 4.0f / (float(count) * D);
+    sample.lod = std::max(0.5f * std::log2(sampleSolidAngle / texelSolidAngle) + 1.0f, minLod);
+    samples.push_back(sample);
+  }
+  return samples;
+}
+
+/*******************************************************************************
+ * KEnvironmentBaker
+ ******************************************************************************/
+KEnvironmentBaker::KEnvironmentBaker() :
+  m_baseWidth(512), m_baseHeight(256), m_levelCount(6), m_sampleCount(64)
+{
+  std::memset(m_irradiance, 0, sizeof(m_irradiance));
+}
+
+void KEnvironmentBaker::setBaseSize(int width, int height)
+{
+  m_baseWidth = std::max(width, 1);
+  m_baseHeight = std::max(height, 1);
+}
+
+void KEnvironmentBaker::setLevelCount(int count)
+{
+  // One level of the cache file is taken by the irradiance.
+  m_levelCount = std::min(std::max(count, 1), int(KTextureFile::MaxLevels) - 1);
+}
+
+void KEnvironmentBaker::setSampleCount(unsigned count)
+{
+  m_sampleCount = std::max(count, 1u);
+}
+
+int KEnvironmentBaker::levelCount() const
+{
+  return m_levelCount;
+}
+
+void KEnvironmentBaker::bake(float const *rgb, int width, int height)
+{
+  projectIrradiance(rgb, width, height, m_irradiance);
+
+  // Source mips, used to keep the sample count low for rough levels.
+  std::vector<Level> mips(1);
+  mips[0].width = width;
+  mips[0].height = height;
+  mips[0].rgb.assign(rgb, rgb + 3 * size_t(width) * height);
+  while (mips.back().width > 1 || mips.back().height > 1)
+  {
+    mips.push_back(Level());
+    downsample(mips[mips.size() - 2], mips.back());
+  }
+
+  // The chain is never larger than the source.
+  int baseWidth = std::min(m_baseWidth, width);
+  int baseHeight = std::min(m_baseHeight, height);
+  m_levels.assign(size_t(m_levelCount), Level());
+  for (int i = 0; i < m_levelCount; ++i)
+  {
+    Level &level = m_levels[size_t(i)];
+    level.width = std::max(baseWidth >> i, 1);
+    level.height = std::max(baseHeight >> i, 1);
+    level.rgb.resize(3 * size_t(level.width) * level.height);
+
+    float roughness = (m_levelCount > 1) ? float(i) / float(m_levelCount - 1) : 0.0f;
+    float minLod = std::max(std::log2(float(width) / float(level.width)), 0.0f);
+    std::vector<KBakeSample> samples = ggxSamples(roughness, m_sampleCount, width * height, minLod);
+
+    Karma::parallelFor(0, size_t(level.height), RowGrain, [&level, &mips, &samples](size_t b, size_t e)
+    {
+      for (size_t y = b; y < e; ++y)
+      {
+        float v = (float(y) + 0.5f) / float(level.height);
+        for (size_t x = 0; x < size_t(level.width); ++x)
+        {
+          float u = (float(x) + 0.5f) / float(level.width);
+          KBakeVector N = sphereDirection(u, v);
+          KBakeVector up = { 0.0f, 0.0f, 1.0f };
+          if (std::abs(N.z) >= 0.999f)
+          {
+            up.x = 1.0f;
+            up.z = 0.0f;
+          }
+          KBakeVector tangentX = normalized(cross(up, N));
+          KBakeVector tangentY = cross(N, tangentX);
+
+          float sum[3] = { 0.0f, 0.0f, 0.0f }, weight = 0.0f;
+          for (size_t s = 0; s < samples.size(); ++s)
+          {
+            KBakeSample const &sample = samples[s];
+            KBakeVector L =
+            {
+              sample.L.x * tangentX.x + sample.L.y * tangentY.x + sample.L.z * N.x,
+              sample.L.x * tangentX.y + sample.L.y * tangentY.y + sample.L.z * N.y,
+              sample.L.x * tangentX.z + sample.L.y * tangentY.z + sample.L.z * N.z
+            };
+            float texel[3];
+            sampleSphere(mips, L, sample.lod, texel);
+            for (int c = 0; c < 3; ++c) sum[c] += texel[c] * sample.NoL;
+            weight += sample.NoL;
+          }
+
+          float *out = &level.rgb[3 * (y * level.width + x)];
+          for (int c = 0; c < 3; ++c) out[c] = sum[c] / weight;
+        }
+      }
+    });
+  }
+}
+
+void KEnvironmentBaker::projectIrradiance(float const *rgb, int width, int height, float sh[ShCoefficients][3])
+{
+  KShSums identity;
+  std::memset(&identity, 0, sizeof(identity));
+
+  // Every texel is weighted by its solid angle, which shrinks towards the poles.
+  KShSums sums = Karma::parallelReduce(
+    0, size_t(height), ProjectionGrain, identity,
+    [rgb, width, height, &identity](size_t b, size_t e)
+    {
+      KShSums partial = identity;
+      float basis[ShCoefficients];
+      for (size_t y = b; y < e; ++y)
+      {
+        float v = (float(y) + 0.5f) / float(height);
+        float solidAngle = (Pi2 / float(width)) * (Pi / float(height)) * std::sin(Pi * v);
+        for (size_t x = 0; x < size_t(width); ++x)
+        {
+          float u = (float(x) + 0.5f) / float(width);
+          evaluateSh(sphereDirection(u, v), basis);
+          float const *texel = &rgb[3 * (y * width + x)];
+          for (int i = 0; i < ShCoefficients; ++i)
+          {
+            double w = double(basis[i]) * solidAngle;
+            partial.c[i][0] += w * texel[0];
+            partial.c[i][1] += w * texel[1];
+            partial.c[i][2] += w * texel[2];
+          }
+        }
+      }
+      return partial;
+    },
+    [](KShSums a, KShSums const &b)
+    {
+      for (int i = 0; i < ShCoefficients; ++i)
+      {
+        a.c[i][0] += b.c[i][0];
+        a.c[i][1] += b.c[i][1];
+        a.c[i][2] += b.c[i][2];
+      }
+      return a;
+    }
+  );
+
+  // Convolve with the clamped cosine (Ramamoorthi and Hanrahan), so that
+  // evaluating the basis at N gives the irradiance directly.
+  static const float Band[ShCoefficients] =
+  {
+    Pi,
+    2.0f * Pi / 3.0f, 2.0f * Pi / 3.0f, 2.0f * Pi / 3.0f,
+    Pi / 4.0f, Pi / 4.0f, Pi / 4.0f, Pi / 4.0f, Pi / 4.0f
+  };
+  for (int i = 0; i < ShCoefficients; ++i)
+  {
+    sh[i][0] = float(sums.c[i][0]) * Band[i];
+    sh[i][1] = float(sums.c[i][1]) * Band[i];
+    sh[i][2] = float(sums.c[i][2]) * Band[i];
+  }
+}
+
+uint64_t KEnvironmentBaker::sourceHash(float const *rgb, int width, int height) const
+{
+  uint32_t settings[7] =
+  {
+    BakeVersion, uint32_t(width), uint32_t(height),
+    uint32_t(m_baseWidth), uint32_t(m_baseHeight), uint32_t(m_levelCount), m_sampleCount
+  };
+  uint64_t hash = Karma::hash(settings, sizeof(settings));
+  return Karma::hash(rgb, 3 * size_t(width) * height * sizeof(float), hash);
+}
+
+float const (*KEnvironmentBaker::irradiance() const)[3]
+{
+  return m_irradiance;
+}
+
+KEnvironmentBaker::Level const &KEnvironmentBaker::level(int i) const
+{
+  return m_levels[size_t(i)];
+}
+
+bool KEnvironmentBaker::load(QString const &fileName, uint64_t sourceHash)
+{
+  KTextureFile file;
+  if (!file.map(fileName, KTextureFile::EnvironmentBakeFormat, BakeVersion, sourceHash)) return false;
+
+  KTextureFile::Description const &desc = file.description();
+  if (desc.faces != 1 || desc.levelCount != size_t(m_levelCount) + 1) return false;
+  if (desc.levels[0].width != ShCoefficients || desc.levels[0].height != 1) return false;
+
+  std::memcpy(m_irradiance, desc.levels[0].data, sizeof(m_irradiance));
+  m_levels.assign(size_t(m_levelCount), Level());
+  for (int i = 0; i < m_levelCount; ++i)
+  {
+    KTextureFile::Level const &l = desc.levels[i + 1];
+    float const *data = static_cast<float const*>(l.data);
+    Level &level = m_levels[size_t(i)];
+    level.width = int(l.width);
+    level.height = int(l.height);
+    level.rgb.assign(data, data + 3 * size_t(l.width) * l.height);
+  }
+  return true;
+}
+
+bool KEnvironmentBaker::save(QString const &fileName, uint64_t sourceHash) const
+{
+  if (m_levels.size() != size_t(m_levelCount)) return false;
+
+  KTextureFile::Description desc;
+  std::memset(&desc, 0, sizeof(desc));
+  desc.format = KTextureFile::EnvironmentBakeFormat;
+  desc.method = BakeVersion;
+  desc.sourceHash = sourceHash;
+  desc.faces = 1;
+  desc.levelCount = size_t(m_levelCount) + 1;
+  desc.levels[0].width = ShCoefficients;
+  desc.levels[0].height = 1;
+  desc.levels[0].data = m_irradiance;
+  desc.levels[0].size = sizeof(m_irradiance);
+  for (int i = 0; i < m_levelCount; ++i)
+  {
+    KTextureFile::Level &l = desc.levels[i + 1];
+    l.width = uint32_t(m_levels[size_t(i)].width);
+    l.height = uint32_t(m_levels[size_t(i)].height);
+    l.data = m_levels[size_t(i)].rgb.data();
+    l.size = m_levels[size_t(i)].rgb.size() * sizeof(float);
+  }
+  return KTextureFile::write(fileName, desc);
+}
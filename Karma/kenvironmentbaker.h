@@ -0,0 +1,58 @@
+#ifndef KENVIRONMENTBAKER_H
+#define KENVIRONMENTBAKER_H KEnvironmentBaker
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+class QString;
+
+// Bakes image based lighting from a single equirectangular RGB float map
+// (same parameterization as SphereMap() in Math.glsl):
+//  - Irradiance:   Second-order (9 coefficient) spherical harmonics, already
+//                  convolved with the clamped cosine lobe.
+//  - Prefiltered:  Radiance convolved with the GGX lobe (N = V = R, split-sum)
+//                  where level i holds roughness i / (levelCount - 1).
+class KEnvironmentBaker
+{
+public:
+  enum
+  {
+    ShCoefficients = 9
+  };
+
+  struct Level
+  {
+    int width;
+    int height;
+    std::vector<float> rgb;
+  };
+
+  KEnvironmentBaker();
+
+  // Settings (Note: Changing any of them changes sourceHash())
+  void setBaseSize(int width, int height);
+  void setLevelCount(int count);
+  void setSampleCount(unsigned count);
+  int levelCount() const;
+
+  // Baking
+  void bake(float const *rgb, int width, int height);
+  static void projectIrradiance(float const *rgb, int width, int height, float sh[ShCoefficients][3]);
+  uint64_t sourceHash(float const *rgb, int width, int height) const;
+
+  // Results
+  float const (*irradiance() const)[3];
+  Level const &level(int i) const;
+
+  // Caching (Level 0 holds the coefficients as a 9x1 image)
+  bool load(QString const &fileName, uint64_t sourceHash);
+  bool save(QString const &fileName, uint64_t sourceHash) const;
+
+private:
+  int m_baseWidth, m_baseHeight, m_levelCount;
+  unsigned m_sampleCount;
+  float m_irradiance[ShCoefficients][3];
+  std::vector<Level> m_levels;
+};
+
+#endif // KENVIRONMENTBAKER_H
@@ -1,4 +1,8 @@
 #include "kepossphere.h"
+#include <cmath>
+
+// Grow passes before settling for the furthest point as the radius.
+static const int MaxGrowPasses = 8;
 
 struct Sphere
 {
@@ -42,9 +46,47 @@ Sphere WelzlSphere(KMinMaxVectorCloud::const_iterator begin, KMinMaxVectorCloud:
   return Sphere(WelzlSphere(begin, halfWay), WelzlSphere(halfWay, end));
 }
 
+KEposSphere::KEposSphere(Karma::PointStream const &points, KVector3D const *axes, size_t numAxes)
+{
+  KMinMaxVectorCloud extremalVerts = Karma::findExtremalPointsAlongAxes(points, axes, numAxes);
+  calculateMinimumSphere(extremalVerts.begin(), extremalVerts.end());
+}
+
+KEposSphere::KEposSphere(Karma::PointStream const &points, int k)
+{
+  size_t numNormals;
+  KVector3D const *normals = Karma::eposNormals(k, &numNormals);
+  KMinMaxVectorCloud extremalVerts = Karma::findExtremalPointsAlongAxes(points, normals, numNormals);
+  calculateMinimumSphere(extremalVerts.begin(), extremalVerts.end());
+}
+
+KEposSphere::KEposSphere(const_iterator begin, const_iterator end)
+{
+  calculateMinimumSphere(begin, end);
+}
+
 void KEposSphere::calculateMinimumSphere(const_iterator begin, const_iterator end)
 {
   Sphere s = WelzlSphere(begin, end);
   centroid = s.origin;
   radius = s.radius;
 }
+
+void KEposSphere::growToContain(Karma::PointStream const &points)
+{
+  float distSquared;
+  size_t furthest = Karma::findFurthestPoint(points, centroid, &distSquared);
+  for (int pass = 0; pass < MaxGrowPasses && distSquared > radius * radius; ++pass)
+  {
+    // Move the far side of the sphere out to the furthest point
+    float dist = std::sqrt(distSquared);
+    float newRadius = (radius + dist) / 2.0f;
+    centroid += (points[furthest] - centroid) * ((newRadius - radius) / dist);
+    radius = newRadius;
+    furthest = Karma::findFurthestPoint(points, centroid, &distSquared);
+  }
+  if (distSquared > radius * radius)
+  {
+    radius = std::sqrt(distSquared);
+  }
+}
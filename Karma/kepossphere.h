@@ -12,8 +12,15 @@ public:
 
   template <typename It1, typename It2, typename VecAccessor = Karma::DefaultAccessor<KVector3D>, typename AxisAccessor = Karma::DefaultAccessor<KVector3D>>
   KEposSphere(It1 bVec, It1 eVec, It2 bAxis, It2 eAxis, VecAccessor vAccessor = Karma::DefaultAccessor<KVector3D>(), AxisAccessor aAccessor = Karma::DefaultAccessor<KVector3D>());
+  KEposSphere(Karma::PointStream const &points, KVector3D const *axes, size_t numAxes);
+  KEposSphere(Karma::PointStream const &points, int k);
+  KEposSphere(const_iterator begin, const_iterator end);
   void calculateMinimumSphere(const_iterator begin, const_iterator end);
 
+  // Grows towards the furthest outlier until all points are contained.
+  // Note: Every pass is a parallel sweep; results do not depend on thread count.
+  void growToContain(Karma::PointStream const &points);
+
   float radius;
   KVector3D centroid;
 };
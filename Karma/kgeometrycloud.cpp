@@ -1,6 +1,7 @@
 #include "kgeometrycloud.h"
 
 #include <KHalfEdgeMesh>
+#include <KHash>
 #include <KMacros>
 #include <KMatrix4x4>
 #include <KPointCloud>
@@ -13,10 +14,19 @@
 class KGeometryCloudPrivate
 {
 public:
+  KGeometryCloudPrivate(int buildFlags = KGeometryCloud::NoBuildFlags, uint64_t terminationKey = 0);
   KPointCloud m_pointCloud;
   KTriangleIndexCloud m_triangleCloud;
+  int m_buildFlags;
+  uint64_t m_terminationKey;
 };
 
+KGeometryCloudPrivate::KGeometryCloudPrivate(int buildFlags, uint64_t terminationKey) :
+  m_buildFlags(buildFlags), m_terminationKey(terminationKey)
+{
+  // Intentionally Empty
+}
+
 /*******************************************************************************
  * KGeometryCloud
  ******************************************************************************/
@@ -71,9 +81,23 @@ void KGeometryCloud::build(KGeometryCloud::BuildMethod method, KGeometryCloud::T
   (void)pred;
 }
 
+bool KGeometryCloud::save(QString const &fileName) const
+{
+  (void)fileName;
+  return false;
+}
+
+bool KGeometryCloud::load(QString const &fileName, KGeometryCloud::BuildMethod method)
+{
+  (void)fileName;
+  (void)method;
+  return false;
+}
+
 void KGeometryCloud::clear()
 {
-  m_private = new KGeometryCloudPrivate;
+  // Build flags and keys are configuration, not geometry; keep them.
+  m_private = new KGeometryCloudPrivate(buildFlags(), terminationKey());
 }
 
 bool KGeometryCloud::dirty() const
@@ -82,6 +106,50 @@ bool KGeometryCloud::dirty() const
   return (!p.m_pointCloud.empty() || !p.m_triangleCloud.empty());
 }
 
+int KGeometryCloud::buildFlags() const
+{
+  P(const KGeometryCloudPrivate);
+  return p.m_buildFlags;
+}
+
+void KGeometryCloud::setBuildFlags(int flags)
+{
+  P(KGeometryCloudPrivate);
+  p.m_buildFlags = flags;
+}
+
+uint64_t KGeometryCloud::terminationKey() const
+{
+  P(const KGeometryCloudPrivate);
+  return p.m_terminationKey;
+}
+
+void KGeometryCloud::setTerminationKey(uint64_t key)
+{
+  P(KGeometryCloudPrivate);
+  p.m_terminationKey = key;
+}
+
+uint64_t KGeometryCloud::hash() const
+{
+  P(const KGeometryCloudPrivate);
+  uint64_t hash = Karma::HashBasis;
+  uint64_t counts[] = { p.m_pointCloud.size(), p.m_triangleCloud.size() };
+  hash = Karma::hash(counts, sizeof(counts), hash);
+  hash = Karma::hash(p.m_pointCloud.data(), p.m_pointCloud.size() * sizeof(KPointCloud::ElementType), hash);
+  for (KTriangleIndexCloud::ElementType const &triangle : p.m_triangleCloud)
+  {
+    uint32_t indices[] =
+    {
+      static_cast<uint32_t>(triangle.indices[0]),
+      static_cast<uint32_t>(triangle.indices[1]),
+      static_cast<uint32_t>(triangle.indices[2])
+    };
+    hash = Karma::hash(indices, sizeof(indices), hash);
+  }
+  return hash;
+}
+
 const KPointCloud &KGeometryCloud::pointCloud() const
 {
   P(const KGeometryCloudPrivate);
@@ -5,6 +5,8 @@ class KHalfEdgeMesh;
 class KTransform3D;
 class KPointCloud;
 class KTriangleIndexCloud;
+class QString;
+#include <cstdint>
 #include <KSharedPointer>
 
 class KGeometryCloudPrivate;
@@ -19,14 +21,34 @@ public:
     TopDownMethod,
     BottomUpMethod
   };
-  typedef bool (*TerminationPred)(size_t numTriangles, size_t depth);
+  enum BuildFlag
+  {
+    NoBuildFlags       = 0x0,
+    ParallelBuild      = 0x1, // Build subtrees as tasks on KThreadPool
+    DeterministicBuild = 0x2  // Same tree for the same input, serial or parallel
+  };
+  typedef bool (*TerminationPred)(size_t numTriangles, size_t depth); // depth of the node tested
 
   void addGeometry(KHalfEdgeMesh const &mesh);
   void addGeometry(KHalfEdgeMesh const &mesh, KTransform3D const &trans);
   virtual void build(BuildMethod method, TerminationPred pred);
 
+  // Persistence (A load only succeeds if the file was built from this geometry,
+  // method and termination key.) A plain cloud has no structure to persist,
+  // so the base versions always fail; the spatial structures override them.
+  virtual bool save(QString const &fileName) const;
+  virtual bool load(QString const &fileName, BuildMethod method);
+
   void clear();
   bool dirty() const;
+  int buildFlags() const;
+  void setBuildFlags(int flags);
+  uint64_t hash() const;
+
+  // The predicate is a plain function, so whatever it tests (e.g. its limits)
+  // has to be described by this key for saved structures to match it.
+  uint64_t terminationKey() const;
+  void setTerminationKey(uint64_t key);
 
   KPointCloud const &pointCloud() const;
   KTriangleIndexCloud const &triangleIndexCloud() const;
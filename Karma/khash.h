@@ -0,0 +1,37 @@
+#ifndef KHASH_H
+#define KHASH_H KHash
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Hashes identifying the sources of the on-disk caches (not for security).
+namespace Karma
+{
+  static const uint64_t HashBasis = 14695981039346656037ull;
+  static const uint64_t HashPrime = 1099511628211ull;
+
+  // FNV-1a over 64-bit words (Trailing bytes are hashed one by one).
+  uint64_t hash(void const *data, size_t bytes, uint64_t seed = HashBasis);
+}
+
+inline uint64_t Karma::hash(void const *data, size_t bytes, uint64_t seed)
+{
+  unsigned char const *it = static_cast<unsigned char const*>(data);
+  uint64_t hash = seed;
+  for (; bytes >= sizeof(uint64_t); bytes -= sizeof(uint64_t), it += sizeof(uint64_t))
+  {
+    uint64_t word;
+    std::memcpy(&word, it, sizeof(word));
+    hash ^= word;
+    hash *= HashPrime;
+  }
+  for (; bytes > 0; --bytes)
+  {
+    hash ^= *it++;
+    hash *= HashPrime;
+  }
+  return hash;
+}
+
+#endif // KHASH_H
@@ -0,0 +1,26 @@
+#include "kmappedfile.h"
+
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QString>
+
+bool Karma::writeFilePadding(QFile &file, uint64_t to)
+{
+  static const char zeros[MappedFileAlignment] = { 0 };
+  uint64_t pos = file.pos();
+  if (pos > to || to - pos > MappedFileAlignment) return false;
+  return (file.write(zeros, to - pos) == static_cast<qint64>(to - pos));
+}
+
+QString Karma::cacheDirectory()
+{
+  QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+  QDir().mkpath(cacheDir);
+  return cacheDir;
+}
+
+QString Karma::cacheFileName(QString const &name)
+{
+  return cacheDirectory() + "/" + name;
+}
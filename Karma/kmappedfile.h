@@ -0,0 +1,40 @@
+#ifndef KMAPPEDFILE_H
+#define KMAPPEDFILE_H KMappedFile
+
+#include <cstdint>
+class QFile;
+class QString;
+
+// Helpers of the on-disk caches. The memory mapped ones (KTextureFile and
+// KSpatialFile) keep their sections at aligned offsets behind a versioned
+// header.
+namespace Karma
+{
+  static const uint64_t MappedFileAlignment = 16;
+
+  uint64_t alignFileOffset(uint64_t offset);
+
+  // True if count elements of size bytes starting at offset end by limit,
+  // without overflowing on corrupt counts.
+  bool fileSectionFits(uint64_t offset, uint64_t count, uint64_t size, uint64_t limit);
+
+  // Zero fills the file up to the offset to, false if it is already past it.
+  bool writeFilePadding(QFile &file, uint64_t to);
+
+  // The writable cache location (created on demand), and a path within it.
+  QString cacheDirectory();
+  QString cacheFileName(QString const &name);
+}
+
+inline uint64_t Karma::alignFileOffset(uint64_t offset)
+{
+  return (offset + MappedFileAlignment - 1) & ~(MappedFileAlignment - 1);
+}
+
+inline bool Karma::fileSectionFits(uint64_t offset, uint64_t count, uint64_t size, uint64_t limit)
+{
+  if (offset > limit || size == 0) return false;
+  return (count <= (limit - offset) / size);
+}
+
+#endif // KMAPPEDFILE_H
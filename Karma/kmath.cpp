@@ -2,6 +2,12 @@
 #include <QMainWindow>
 #include <QWidget>
 #include <QApplication>
+#include <KParallel>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KMATH_SSE2
+#include <emmintrin.h>
+#endif
 
 const float Karma::Pi       = 3.1415926535897932384626433832795028841971693993751058f;
 const float Karma::PiHalf   = 1.5707963267948966192313216916397514420985846996875529f;
@@ -12,7 +18,7 @@ const float Karma::Sqrt2Pi  = 2.506628274631000502415765284811045253006986740609
 
 void Karma::symSchur2(const KMatrix3x3 &symMtx, int p, int q, float *cosine, float *sine)
 {
-  if (std::abs(symMtx[p][q] > 0.0001f))
+  if (std::abs(symMtx[p][q]) > 0.0001f)
   {
     float r = (symMtx[q][q] - symMtx[p][p]) / (2.0f * symMtx[p][q]);
     float t;
@@ -67,9 +73,9 @@ KMatrix3x3 Karma::jacobi(KMatrix3x3 covar, int iterations)
     jacobiMtx[p][p] = jacobiMtx[q][q] = c;
     jacobiMtx[p][q] = s; jacobiMtx[q][p] = -s;
 
-    // Cumulate rotations
-    eigen *= jacobiMtx;
-    covar = (jacobiMtx.transposed() * covar) * jacobiMtx;
+    // Cumulate rotations (KMatrix3x3::operator[] indexes rows)
+    eigen = jacobiMtx * eigen;
+    covar = (jacobiMtx * covar) * jacobiMtx.transposed();
     float off = 0.0f;
     for (int i = 0; i < 3; ++i)
     {
@@ -193,6 +199,19 @@ float Karma::normalDist(float value, float mean, float deviation)
 }
 
 
+uint32_t Karma::hashSeed(uint32_t seed, uint32_t value)
+{
+  // Murmur3 finalizer over the combined values
+  uint32_t h = seed ^ (value + 0x9e3779b9u + (seed << 6) + (seed >> 2));
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35u;
+  h ^= h >> 16;
+  return h;
+}
+
+
 Karma::PolygonType Karma::classifyPolygon(const KPlane &plane, const KVector3D &a, const KVector3D &b, const KVector3D &c)
 {
   static const float epsilon = 0.01f;
@@ -265,3 +284,513 @@ void Karma::setTitle(const KString &str)
     }
   }
 }
+
+
+/*******************************************************************************
+ * Point Stream Reductions
+ ******************************************************************************/
+// Reductions below this many points are not worth splitting across threads.
+static const size_t ReductionGrain = 16384;
+
+// Sums are accumulated in floats per block, then folded into doubles.
+static const size_t ReductionBlock = 1024;
+
+// Axes projected per sweep over the points (EPOS-26 and DiTO-26 use 13).
+static const size_t AxisBatch = 16;
+
+static inline float const *pointAt(Karma::PointStream const &points, size_t idx)
+{
+  return reinterpret_cast<float const*>(points.data + idx * points.stride);
+}
+
+#ifdef KMATH_SSE2
+// Lanes 0-2 hold xyz; lane 3 is whatever follows the position in memory.
+// The last point is loaded per-component, it may end the allocation.
+static inline __m128 loadPoint(Karma::PointStream const &points, size_t idx)
+{
+  float const *p = pointAt(points, idx);
+  if (idx + 1 < points.count) return _mm_loadu_ps(p);
+  return _mm_setr_ps(p[0], p[1], p[2], 0.0f);
+}
+
+// Four consecutive points transposed into x, y and z lanes.
+static inline void loadPoints4(Karma::PointStream const &points, size_t idx, __m128 *x, __m128 *y, __m128 *z)
+{
+  __m128 p0 = loadPoint(points, idx + 0);
+  __m128 p1 = loadPoint(points, idx + 1);
+  __m128 p2 = loadPoint(points, idx + 2);
+  __m128 p3 = loadPoint(points, idx + 3);
+  _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+  (*x) = p0;
+  (*y) = p1;
+  (*z) = p2;
+}
+
+static inline __m128 selectPs(__m128 mask, __m128 a, __m128 b)
+{
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline __m128i selectEpi32(__m128 mask, __m128i a, __m128i b)
+{
+  __m128i m = _mm_castps_si128(mask);
+  return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+}
+#endif // KMATH_SSE2
+
+struct KPointMomentsPartial
+{
+  KPointMomentsPartial();
+  size_t count;
+  float min[3], max[3];
+  size_t minIndex[3], maxIndex[3];
+  double sum[3];    // Relative to the first point (keeps the moments precise)
+  double square[6]; // xx, yy, zz, xy, yz, zx
+};
+
+KPointMomentsPartial::KPointMomentsPartial() :
+  count(0)
+{
+  for (int i = 0; i < 3; ++i)
+  {
+    min[i] =  std::numeric_limits<float>::infinity();
+    max[i] = -std::numeric_limits<float>::infinity();
+    minIndex[i] = maxIndex[i] = 0;
+    sum[i] = 0.0;
+  }
+  for (int i = 0; i < 6; ++i)
+  {
+    square[i] = 0.0;
+  }
+}
+
+static KPointMomentsPartial momentsKernel(Karma::PointStream const &points, size_t begin, size_t end)
+{
+  KPointMomentsPartial result;
+  result.count = end - begin;
+  float const *shift = pointAt(points, 0);
+#ifdef KMATH_SSE2
+  __m128 vMin = _mm_set1_ps( std::numeric_limits<float>::infinity());
+  __m128 vMax = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+  __m128i iMin = _mm_setzero_si128();
+  __m128i iMax = _mm_setzero_si128();
+  __m128 vShift = _mm_setr_ps(shift[0], shift[1], shift[2], 0.0f);
+  float sums[4], squares[4], crosses[4];
+  for (size_t blockBegin = begin; blockBegin < end; blockBegin += ReductionBlock)
+  {
+    size_t blockEnd = std::min(end, blockBegin + ReductionBlock);
+    __m128 vSum = _mm_setzero_ps();
+    __m128 vSquare = _mm_setzero_ps();
+    __m128 vCross = _mm_setzero_ps();
+    for (size_t i = blockBegin; i < blockEnd; ++i)
+    {
+      __m128 v = loadPoint(points, i);
+      __m128i vIdx = _mm_set1_epi32(static_cast<int>(i));
+      __m128 less = _mm_cmplt_ps(v, vMin);
+      __m128 greater = _mm_cmpgt_ps(v, vMax);
+      vMin = selectPs(less, v, vMin);
+      vMax = selectPs(greater, v, vMax);
+      iMin = selectEpi32(less, vIdx, iMin);
+      iMax = selectEpi32(greater, vIdx, iMax);
+      __m128 d = _mm_sub_ps(v, vShift);
+      vSum = _mm_add_ps(vSum, d);
+      vSquare = _mm_add_ps(vSquare, _mm_mul_ps(d, d));
+      vCross = _mm_add_ps(vCross, _mm_mul_ps(d, _mm_shuffle_ps(d, d, _MM_SHUFFLE(3, 0, 2, 1))));
+    }
+    _mm_storeu_ps(sums, vSum);
+    _mm_storeu_ps(squares, vSquare);
+    _mm_storeu_ps(crosses, vCross);
+    for (int a = 0; a < 3; ++a)
+    {
+      result.sum[a] += sums[a];
+      result.square[a] += squares[a];
+      result.square[a + 3] += crosses[a];
+    }
+  }
+  float mins[4], maxs[4];
+  int32_t minIndices[4], maxIndices[4];
+  _mm_storeu_ps(mins, vMin);
+  _mm_storeu_ps(maxs, vMax);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(minIndices), iMin);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(maxIndices), iMax);
+  for (int a = 0; a < 3; ++a)
+  {
+    result.min[a] = mins[a];
+    result.max[a] = maxs[a];
+    result.minIndex[a] = static_cast<size_t>(minIndices[a]);
+    result.maxIndex[a] = static_cast<size_t>(maxIndices[a]);
+  }
+#else
+  for (size_t blockBegin = begin; blockBegin < end; blockBegin += ReductionBlock)
+  {
+    size_t blockEnd = std::min(end, blockBegin + ReductionBlock);
+    float sums[3] = { 0.0f, 0.0f, 0.0f };
+    float squares[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    for (size_t i = blockBegin; i < blockEnd; ++i)
+    {
+      float const *v = pointAt(points, i);
+      float d[3];
+      for (int a = 0; a < 3; ++a)
+      {
+        if (v[a] < result.min[a]) { result.min[a] = v[a]; result.minIndex[a] = i; }
+        if (v[a] > result.max[a]) { result.max[a] = v[a]; result.maxIndex[a] = i; }
+        d[a] = v[a] - shift[a];
+        sums[a] += d[a];
+        squares[a] += d[a] * d[a];
+      }
+      squares[3] += d[0] * d[1];
+      squares[4] += d[1] * d[2];
+      squares[5] += d[2] * d[0];
+    }
+    for (int a = 0; a < 3; ++a) result.sum[a] += sums[a];
+    for (int a = 0; a < 6; ++a) result.square[a] += squares[a];
+  }
+#endif // KMATH_SSE2
+  return result;
+}
+
+static KPointMomentsPartial combineMoments(KPointMomentsPartial const &lhs, KPointMomentsPartial const &rhs)
+{
+  // Earlier chunks are on the left, they win ties.
+  KPointMomentsPartial result = lhs;
+  result.count += rhs.count;
+  for (int a = 0; a < 3; ++a)
+  {
+    if (rhs.min[a] < result.min[a])
+    {
+      result.min[a] = rhs.min[a];
+      result.minIndex[a] = rhs.minIndex[a];
+    }
+    if (rhs.max[a] > result.max[a])
+    {
+      result.max[a] = rhs.max[a];
+      result.maxIndex[a] = rhs.maxIndex[a];
+    }
+    result.sum[a] += rhs.sum[a];
+  }
+  for (int a = 0; a < 6; ++a)
+  {
+    result.square[a] += rhs.square[a];
+  }
+  return result;
+}
+
+Karma::PointMoments Karma::calculatePointMoments(PointStream const &points)
+{
+  KPointMomentsPartial partial = Karma::parallelReduce(
+    0, points.count, ReductionGrain, KPointMomentsPartial(),
+    [&points](size_t b, size_t e) { return momentsKernel(points, b, e); },
+    &combineMoments
+  );
+
+  PointMoments result;
+  result.count = partial.count;
+  result.bounds.min = KVector3D(partial.min[0], partial.min[1], partial.min[2]);
+  result.bounds.max = KVector3D(partial.max[0], partial.max[1], partial.max[2]);
+  for (int a = 0; a < 3; ++a)
+  {
+    result.minIndex[a] = partial.minIndex[a];
+    result.maxIndex[a] = partial.maxIndex[a];
+  }
+  if (partial.count == 0)
+  {
+    result.centroid = KVector3D(0.0f, 0.0f, 0.0f);
+    result.covariance = KMatrix3x3();
+    return result;
+  }
+
+  // cov(a,b) = E[ab] - E[a]E[b], on values relative to the first point.
+  double k = 1.0 / double(partial.count);
+  double mean[3] = { partial.sum[0] * k, partial.sum[1] * k, partial.sum[2] * k };
+  float const *shift = pointAt(points, 0);
+  result.centroid = KVector3D(float(shift[0] + mean[0]), float(shift[1] + mean[1]), float(shift[2] + mean[2]));
+  KMatrix3x3 &covariance = result.covariance;
+  covariance[0][0] = float(partial.square[0] * k - mean[0] * mean[0]);
+  covariance[1][1] = float(partial.square[1] * k - mean[1] * mean[1]);
+  covariance[2][2] = float(partial.square[2] * k - mean[2] * mean[2]);
+  covariance[0][1] = covariance[1][0] = float(partial.square[3] * k - mean[0] * mean[1]);
+  covariance[1][2] = covariance[2][1] = float(partial.square[4] * k - mean[1] * mean[2]);
+  covariance[0][2] = covariance[2][0] = float(partial.square[5] * k - mean[2] * mean[0]);
+  return result;
+}
+
+static std::vector<Karma::AxisExtremes> extremesIdentity(size_t numAxes)
+{
+  Karma::AxisExtremes identity;
+  identity.minProj =  std::numeric_limits<float>::infinity();
+  identity.maxProj = -std::numeric_limits<float>::infinity();
+  identity.minIndex = identity.maxIndex = 0;
+  return std::vector<Karma::AxisExtremes>(numAxes, identity);
+}
+
+static void extremesKernel(Karma::PointStream const &points, KVector3D const *axes, size_t numAxes, size_t begin, size_t end, Karma::AxisExtremes *results)
+{
+  size_t i = begin;
+#ifdef KMATH_SSE2
+  // Four points per step, one point per lane, up to AxisBatch axes per sweep.
+  size_t simdEnd = begin + (end - begin) / 4 * 4;
+  for (size_t axisBegin = 0; axisBegin < numAxes && begin < simdEnd; axisBegin += AxisBatch)
+  {
+    size_t batch = std::min(AxisBatch, numAxes - axisBegin);
+    __m128 vMin[AxisBatch], vMax[AxisBatch];
+    __m128i iMin[AxisBatch], iMax[AxisBatch];
+    for (size_t a = 0; a < batch; ++a)
+    {
+      vMin[a] = _mm_set1_ps( std::numeric_limits<float>::infinity());
+      vMax[a] = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+      iMin[a] = iMax[a] = _mm_setzero_si128();
+    }
+    for (size_t j = begin; j < simdEnd; j += 4)
+    {
+      __m128 x, y, z;
+      loadPoints4(points, j, &x, &y, &z);
+      __m128i vIdx = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(j)), _mm_setr_epi32(0, 1, 2, 3));
+      for (size_t a = 0; a < batch; ++a)
+      {
+        KVector3D const &axis = axes[axisBegin + a];
+        __m128 proj = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(axis.x()), x), _mm_mul_ps(_mm_set1_ps(axis.y()), y)), _mm_mul_ps(_mm_set1_ps(axis.z()), z));
+        __m128 less = _mm_cmplt_ps(proj, vMin[a]);
+        __m128 greater = _mm_cmpgt_ps(proj, vMax[a]);
+        vMin[a] = selectPs(less, proj, vMin[a]);
+        vMax[a] = selectPs(greater, proj, vMax[a]);
+        iMin[a] = selectEpi32(less, vIdx, iMin[a]);
+        iMax[a] = selectEpi32(greater, vIdx, iMax[a]);
+      }
+    }
+
+    // Fold the lanes, the lowest index wins ties (same as the scalar loop).
+    for (size_t a = 0; a < batch; ++a)
+    {
+      float mins[4], maxs[4];
+      int32_t minIndices[4], maxIndices[4];
+      _mm_storeu_ps(mins, vMin[a]);
+      _mm_storeu_ps(maxs, vMax[a]);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(minIndices), iMin[a]);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(maxIndices), iMax[a]);
+      Karma::AxisExtremes &result = results[axisBegin + a];
+      for (size_t l = 0; l < 4; ++l)
+      {
+        size_t minIndex = static_cast<size_t>(minIndices[l]);
+        size_t maxIndex = static_cast<size_t>(maxIndices[l]);
+        if (mins[l] < result.minProj || (mins[l] == result.minProj && minIndex < result.minIndex))
+        {
+          result.minProj = mins[l];
+          result.minIndex = minIndex;
+        }
+        if (maxs[l] > result.maxProj || (maxs[l] == result.maxProj && maxIndex < result.maxIndex))
+        {
+          result.maxProj = maxs[l];
+          result.maxIndex = maxIndex;
+        }
+      }
+    }
+  }
+  i = simdEnd;
+#endif // KMATH_SSE2
+  for (; i < end; ++i)
+  {
+    KVector3D const &v = points[i];
+    for (size_t axis = 0; axis < numAxes; ++axis)
+    {
+      float proj = KVector3D::dotProduct(v, axes[axis]);
+      if (proj < results[axis].minProj)
+      {
+        results[axis].minProj = proj;
+        results[axis].minIndex = i;
+      }
+      if (proj > results[axis].maxProj)
+      {
+        results[axis].maxProj = proj;
+        results[axis].maxIndex = i;
+      }
+    }
+  }
+}
+
+void Karma::findExtremalAlongAxes(PointStream const &points, KVector3D const *axes, size_t numAxes, AxisExtremes *results)
+{
+  typedef std::vector<AxisExtremes> Extremes;
+  Extremes extremes = Karma::parallelReduce(
+    0, points.count, ReductionGrain, extremesIdentity(numAxes),
+    [&points, axes, numAxes](size_t b, size_t e)
+    {
+      Extremes partial = extremesIdentity(numAxes);
+      extremesKernel(points, axes, numAxes, b, e, partial.data());
+      return partial;
+    },
+    [numAxes](Extremes lhs, Extremes const &rhs)
+    {
+      // Earlier chunks are on the left, they win ties.
+      for (size_t axis = 0; axis < numAxes; ++axis)
+      {
+        if (rhs[axis].minProj < lhs[axis].minProj)
+        {
+          lhs[axis].minProj = rhs[axis].minProj;
+          lhs[axis].minIndex = rhs[axis].minIndex;
+        }
+        if (rhs[axis].maxProj > lhs[axis].maxProj)
+        {
+          lhs[axis].maxProj = rhs[axis].maxProj;
+          lhs[axis].maxIndex = rhs[axis].maxIndex;
+        }
+      }
+      return lhs;
+    }
+  );
+  std::copy(extremes.begin(), extremes.end(), results);
+}
+
+size_t Karma::findFurthestPoint(PointStream const &points, KVector3D const &center, float *distSquared)
+{
+  typedef std::pair<float, size_t> Furthest;
+  Furthest furthest = Karma::parallelReduce(
+    0, points.count, ReductionGrain, Furthest(0.0f, 0),
+    [&points, &center](size_t b, size_t e)
+    {
+      Furthest partial(0.0f, b);
+      size_t i = b;
+#ifdef KMATH_SSE2
+      size_t simdEnd = b + (e - b) / 4 * 4;
+      if (b < simdEnd)
+      {
+        __m128 cx = _mm_set1_ps(center.x()), cy = _mm_set1_ps(center.y()), cz = _mm_set1_ps(center.z());
+        __m128 vMax = _mm_set1_ps(-1.0f);
+        __m128i iMax = _mm_setzero_si128();
+        for (; i < simdEnd; i += 4)
+        {
+          __m128 x, y, z;
+          loadPoints4(points, i, &x, &y, &z);
+          x = _mm_sub_ps(x, cx);
+          y = _mm_sub_ps(y, cy);
+          z = _mm_sub_ps(z, cz);
+          __m128 dist2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+          __m128 greater = _mm_cmpgt_ps(dist2, vMax);
+          __m128i vIdx = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(i)), _mm_setr_epi32(0, 1, 2, 3));
+          vMax = selectPs(greater, dist2, vMax);
+          iMax = selectEpi32(greater, vIdx, iMax);
+        }
+        float maxs[4];
+        int32_t indices[4];
+        _mm_storeu_ps(maxs, vMax);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(indices), iMax);
+        partial = Furthest(maxs[0], static_cast<size_t>(indices[0]));
+        for (size_t l = 1; l < 4; ++l)
+        {
+          size_t idx = static_cast<size_t>(indices[l]);
+          if (maxs[l] > partial.first || (maxs[l] == partial.first && idx < partial.second))
+          {
+            partial = Furthest(maxs[l], idx);
+          }
+        }
+      }
+#endif // KMATH_SSE2
+      for (; i < e; ++i)
+      {
+        float dist2 = (points[i] - center).lengthSquared();
+        if (dist2 > partial.first) partial = Furthest(dist2, i);
+      }
+      return partial;
+    },
+    [](Furthest const &lhs, Furthest const &rhs) { return (rhs.first > lhs.first) ? rhs : lhs; }
+  );
+  if (distSquared) (*distSquared) = furthest.first;
+  return furthest.second;
+}
+
+float Karma::findMaxDistanceSquared(PointStream const &points, KVector3D const &center)
+{
+  float distSquared;
+  findFurthestPoint(points, center, &distSquared);
+  return distSquared;
+}
+
+Karma::MinMaxKVector3D Karma::findMinMaxBounds(PointStream const &points)
+{
+  return calculatePointMoments(points).bounds;
+}
+
+KVector3D Karma::findAverageCentroid(PointStream const &points)
+{
+  return calculatePointMoments(points).centroid;
+}
+
+KMatrix3x3 Karma::covarianceMatrix(PointStream const &points)
+{
+  return calculatePointMoments(points).covariance;
+}
+
+Karma::MinMaxKVector3DContainer Karma::findExtremalPointsAlongAxes(PointStream const &points, KVector3D const *axes, size_t numAxes)
+{
+  std::vector<AxisExtremes> extremes(numAxes);
+  findExtremalAlongAxes(points, axes, numAxes, extremes.data());
+  MinMaxKVector3DContainer results(numAxes);
+  for (size_t axis = 0; axis < numAxes; ++axis)
+  {
+    results[axis].min = points[extremes[axis].minIndex];
+    results[axis].max = points[extremes[axis].maxIndex];
+  }
+  return results;
+}
+
+Karma::MinMaxKVector3DContainer Karma::findExtremalProjectedPointsAlongAxes(PointStream const &points, KVector3D const *axes, size_t numAxes)
+{
+  std::vector<AxisExtremes> extremes(numAxes);
+  findExtremalAlongAxes(points, axes, numAxes, extremes.data());
+  MinMaxKVector3DContainer results(numAxes);
+  for (size_t axis = 0; axis < numAxes; ++axis)
+  {
+    results[axis].min = extremes[axis].minProj * axes[axis];
+    results[axis].max = extremes[axis].maxProj * axes[axis];
+  }
+  return results;
+}
+
+void Karma::maxSeperatedAlongAxis(PointStream const &points, KVector3D const &axis, KVector3D *min, KVector3D *max)
+{
+  AxisExtremes extremes;
+  findExtremalAlongAxes(points, &axis, 1, &extremes);
+  (*min) = points[extremes.minIndex];
+  (*max) = points[extremes.maxIndex];
+}
+
+KVector3D Karma::calculateCentroid(PointStream const &points, KVector3D const *axes, size_t numAxes, float *extents)
+{
+  std::vector<AxisExtremes> extremes(numAxes);
+  findExtremalAlongAxes(points, axes, numAxes, extremes.data());
+
+  // Calculate the centroid via the min/max of (orthogonal) axes
+  KVector3D centroid(0.0f, 0.0f, 0.0f);
+  for (size_t axis = 0; axis < numAxes; ++axis)
+  {
+    KVector3D minimum = extremes[axis].minProj * axes[axis];
+    KVector3D maximum = extremes[axis].maxProj * axes[axis];
+    extents[axis] = (maximum - minimum).length();
+    centroid += (maximum + minimum) / 2.0f;
+  }
+  return centroid;
+}
+
+KVector3D const *Karma::eposNormals(int k, size_t *count)
+{
+  // Larsson's EPOS-6/14/26 sets; each is a prefix of the next.
+  static const KVector3D sg_normals[] =
+  {
+    KVector3D(1.0f, 0.0f, 0.0f),
+    KVector3D(0.0f, 1.0f, 0.0f),
+    KVector3D(0.0f, 0.0f, 1.0f),
+    KVector3D(1.0f, 1.0f, 1.0f),
+    KVector3D(1.0f, 1.0f,-1.0f),
+    KVector3D(1.0f,-1.0f, 1.0f),
+    KVector3D(1.0f,-1.0f,-1.0f),
+    KVector3D(1.0f, 1.0f, 0.0f),
+    KVector3D(1.0f,-1.0f, 0.0f),
+    KVector3D(1.0f, 0.0f, 1.0f),
+    KVector3D(1.0f, 0.0f,-1.0f),
+    KVector3D(0.0f, 1.0f, 1.0f),
+    KVector3D(0.0f, 1.0f,-1.0f)
+  };
+  if (k >= 26) (*count) = 13;
+  else if (k >= 14) (*count) = 7;
+  else (*count) = 3;
+  return sg_normals;
+}
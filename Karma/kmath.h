@@ -7,6 +7,9 @@
 #include <KPointCloud>
 #include <KPlane>
 #include <limits>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
 #include <KColor>
 #include <QMatrix4x4>
 #include <QVector2D>
@@ -88,6 +91,37 @@ namespace Karma
   typedef MinMax<KVector3D> MinMaxKVector3D;
   typedef std::vector<MinMaxKVector3D> MinMaxKVector3DContainer;
 
+  // Strided view over positions stored in contiguous memory (e.g. the
+  // position member of every vertex). Used by the vectorized reductions.
+  struct PointStream
+  {
+    PointStream();
+    PointStream(KVector3D const *points, size_t count, size_t stride = sizeof(KVector3D));
+    template <typename T, typename Accessor>
+    PointStream(std::vector<T> const &container, Accessor accessor);
+    KVector3D const &operator[](size_t idx) const;
+    size_t size() const;
+    char const *data;
+    size_t count;
+    size_t stride;
+  };
+
+  // Everything a single pass over a point set can tell (see calculatePointMoments).
+  struct PointMoments
+  {
+    size_t count;
+    MinMaxKVector3D bounds;
+    size_t minIndex[3], maxIndex[3]; // First points attaining the bounds
+    KVector3D centroid;
+    KMatrix3x3 covariance;
+  };
+
+  struct AxisExtremes
+  {
+    float minProj, maxProj;
+    size_t minIndex, maxIndex;
+  };
+
   template <typename Val>
   struct DefaultAccessor : public std::unary_function<Val, Val>
   {
@@ -173,6 +207,23 @@ namespace Karma
   template <typename It, typename Accessor = DefaultAccessor<KVector3D>>
   MinMaxKVector3D findMinMaxBounds(It begin, It end, Accessor accessor = DefaultAccessor<KVector3D>());
 
+  // Point Stream Reductions (SSE where available, split across KThreadPool for large inputs)
+  // Note: Results are deterministic; ties resolve to the first point like the iterator versions.
+  PointMoments calculatePointMoments(PointStream const &points);
+  void findExtremalAlongAxes(PointStream const &points, KVector3D const *axes, size_t numAxes, AxisExtremes *results);
+  float findMaxDistanceSquared(PointStream const &points, KVector3D const &center);
+  size_t findFurthestPoint(PointStream const &points, KVector3D const &center, float *distSquared = 0);
+  MinMaxKVector3D findMinMaxBounds(PointStream const &points);
+  KVector3D findAverageCentroid(PointStream const &points);
+  KMatrix3x3 covarianceMatrix(PointStream const &points);
+  MinMaxKVector3DContainer findExtremalPointsAlongAxes(PointStream const &points, KVector3D const *axes, size_t numAxes);
+  MinMaxKVector3DContainer findExtremalProjectedPointsAlongAxes(PointStream const &points, KVector3D const *axes, size_t numAxes);
+  void maxSeperatedAlongAxis(PointStream const &points, KVector3D const &axis, KVector3D *min, KVector3D *max);
+  KVector3D calculateCentroid(PointStream const &points, KVector3D const *axes, size_t numAxes, float *extents);
+
+  // Fixed sample directions of EPOS-k / DiTO-k (k/2 unnormalized normals, the first three are x, y, z)
+  KVector3D const *eposNormals(int k, size_t *count);
+
   // Color Manipulaton
   KColor colorShift(KColor const &orig, float amt);
 
@@ -188,6 +239,41 @@ namespace Karma
   // Distributions
   float normalDist(float value, float mean, float deviation);
 
+  // Seeding (derive child seeds from a parent seed, e.g. per tree node)
+  uint32_t hashSeed(uint32_t seed, uint32_t value);
+
+}
+
+inline Karma::PointStream::PointStream() :
+  data(0), count(0), stride(sizeof(KVector3D))
+{
+  // Intentionally Empty
+}
+
+inline Karma::PointStream::PointStream(KVector3D const *points, size_t count, size_t stride) :
+  data(reinterpret_cast<char const*>(points)), count(count), stride(stride)
+{
+  // Intentionally Empty
+}
+
+template <typename T, typename Accessor>
+Karma::PointStream::PointStream(std::vector<T> const &container, Accessor accessor) :
+  data(0), count(container.size()), stride(sizeof(T))
+{
+  typedef decltype(accessor(container[0])) ReturnType;
+  static_assert(std::is_lvalue_reference<ReturnType>::value, "PointStream accessors must return a reference into the element.");
+  static_assert(std::is_same<typename std::decay<ReturnType>::type, KVector3D>::value, "PointStream accessors must return a KVector3D.");
+  if (count) data = reinterpret_cast<char const*>(&accessor(container[0]));
+}
+
+inline KVector3D const &Karma::PointStream::operator[](size_t idx) const
+{
+  return *reinterpret_cast<KVector3D const*>(data + idx * stride);
+}
+
+inline size_t Karma::PointStream::size() const
+{
+  return count;
 }
 
 template <typename T>
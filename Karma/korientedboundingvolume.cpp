@@ -5,47 +5,208 @@
 #include <KHalfEdgeMesh>
 #include <KTransform3D>
 #include <OpenGLDebugDraw>
+#include <KBoundingVolumeFit>
+
+static const float DitoEpsilon = 1e-6f;
+
+// Half of the surface area of the box (with the given axes) around the points.
+static float obbQuality(std::vector<KVector3D> const &points, KVector3D const axes[3])
+{
+  float length[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    float minProj = KVector3D::dotProduct(points[0], axes[i]);
+    float maxProj = minProj;
+    for (KVector3D const &point : points)
+    {
+      float proj = KVector3D::dotProduct(point, axes[i]);
+      if (proj < minProj) minProj = proj;
+      if (proj > maxProj) maxProj = proj;
+    }
+    length[i] = maxProj - minProj;
+  }
+  return length[0] * length[1] + length[1] * length[2] + length[2] * length[0];
+}
 
 class KOrientedBoundingVolumePrivate
 {
 public:
-  void calculatePcaMethod(KHalfEdgeMesh const &mesh);
+  void calculatePcaMethod(KBoundingVolumeFit const &fit);
+  void calculateDitoMethod(KBoundingVolumeFit const &fit, int k);
+  void calculateFromAxes(KVector3D const axes[3], Karma::AxisExtremes const extremes[3]);
   KVector3D centroid;
   KMatrix3x3 axes;
   KVector3D extents;
+private:
+  void testCandidate(std::vector<KVector3D> const &points, KVector3D const &e0, KVector3D const &n);
+  void testTriangle(std::vector<KVector3D> const &points, KVector3D const &p0, KVector3D const &p1, KVector3D const &p2);
+  KVector3D m_bestAxes[3];
+  float m_bestQuality;
 };
 
-void KOrientedBoundingVolumePrivate::calculatePcaMethod(const KHalfEdgeMesh &mesh)
+void KOrientedBoundingVolumePrivate::calculatePcaMethod(KBoundingVolumeFit const &fit)
 {
-  KHalfEdgeMesh::VertexContainer const &vertices = mesh.vertices();
-
-  // Solve for the covariance matrix
-  KMatrix3x3 covariance =
-    Karma::covarianceMatrix(
-      vertices.begin(),
-      vertices.end(),
-      KHalfEdgeMesh::VertexPositionPred()
-    );
-  axes = Karma::jacobi(covariance, 50);
-
-  // Find the extremal projected points along each axis
-  std::vector<KVector3D> extractedAxes = Karma::decomposeMatrixeByColumnVectors(axes);
-  std::vector<Karma::MinMaxKVector3D> extremal =
-    Karma::findExtremalProjectedPointsAlongAxes(
-      vertices.begin(),
-      vertices.end(),
-      extractedAxes.begin(),
-      extractedAxes.end(),
-      KHalfEdgeMesh::VertexPositionPred()
-    );
+  // Principal axes and their extremal projections come from the fit
+  axes = fit.principalAxes();
+  KVector3D extremalMin[3], extremalMax[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    Karma::AxisExtremes const &extremes = fit.principalExtremes(i);
+    extremalMin[i] = extremes.minProj * fit.principalAxis(i);
+    extremalMax[i] = extremes.maxProj * fit.principalAxis(i);
+  }
 
   // Store information for the centroid and extent
-  extents.setX((extremal[0].max - extremal[0].min).length() / 2.0f);
-  extents.setY((extremal[1].max - extremal[1].min).length() / 2.0f);
-  extents.setZ((extremal[2].max - extremal[2].min).length() / 2.0f);
-  centroid  = (extremal[0].max + extremal[0].min) / 2.0f;
-  centroid += (extremal[1].max + extremal[1].min) / 2.0f;
-  centroid += (extremal[2].max + extremal[2].min) / 2.0f;
+  extents.setX((extremalMax[0] - extremalMin[0]).length() / 2.0f);
+  extents.setY((extremalMax[1] - extremalMin[1]).length() / 2.0f);
+  extents.setZ((extremalMax[2] - extremalMin[2]).length() / 2.0f);
+  centroid  = (extremalMax[0] + extremalMin[0]) / 2.0f;
+  centroid += (extremalMax[1] + extremalMin[1]) / 2.0f;
+  centroid += (extremalMax[2] + extremalMin[2]) / 2.0f;
+}
+
+void KOrientedBoundingVolumePrivate::calculateDitoMethod(KBoundingVolumeFit const &fit, int k)
+{
+  Karma::PointStream const &points = fit.points();
+  if (points.size() == 0) return;
+
+  // Extremal points along all sample directions, found in a single sweep.
+  // Note: DiTO-k shares the EPOS-k directions, the first three are x, y and z.
+  size_t numNormals;
+  KVector3D const *normals = Karma::eposNormals(k, &numNormals);
+  std::vector<Karma::AxisExtremes> extremes(numNormals);
+  Karma::findExtremalAlongAxes(points, normals, numNormals, extremes.data());
+  std::vector<KVector3D> extremalPoints;
+  extremalPoints.reserve(2 * numNormals);
+  for (size_t i = 0; i < numNormals; ++i)
+  {
+    extremalPoints.push_back(points[extremes[i].minIndex]);
+    extremalPoints.push_back(points[extremes[i].maxIndex]);
+  }
+
+  // The AABB is the first candidate (the first three directions are x, y and z)
+  m_bestAxes[0] = normals[0];
+  m_bestAxes[1] = normals[1];
+  m_bestAxes[2] = normals[2];
+  m_bestQuality = obbQuality(extremalPoints, m_bestAxes);
+  float aabbQuality = m_bestQuality;
+
+  // First edge of the base triangle: the most distant pair of extremal points
+  size_t pair = 0;
+  float maxDistSquared = 0.0f;
+  for (size_t i = 0; i < numNormals; ++i)
+  {
+    float distSquared = (extremalPoints[2 * i + 1] - extremalPoints[2 * i]).lengthSquared();
+    if (distSquared > maxDistSquared)
+    {
+      maxDistSquared = distSquared;
+      pair = i;
+    }
+  }
+
+  // Every sample direction saw the same point, nothing to orient
+  if (maxDistSquared > DitoEpsilon)
+  {
+    KVector3D p0 = extremalPoints[2 * pair];
+    KVector3D p1 = extremalPoints[2 * pair + 1];
+    KVector3D e0 = (p1 - p0).normalized();
+
+    // Third point: the extremal point furthest from the first edge
+    KVector3D p2;
+    float maxLineDistSquared = 0.0f;
+    for (KVector3D const &point : extremalPoints)
+    {
+      KVector3D v = point - p0;
+      float distSquared = (v - e0 * KVector3D::dotProduct(v, e0)).lengthSquared();
+      if (distSquared > maxLineDistSquared)
+      {
+        maxLineDistSquared = distSquared;
+        p2 = point;
+      }
+    }
+
+    if (maxLineDistSquared <= DitoEpsilon)
+    {
+      // Collinear points, any box around e0 is as tight as another.
+      KVector3D n = KVector3D::crossProduct(e0, normals[0]);
+      if (n.lengthSquared() <= DitoEpsilon) n = KVector3D::crossProduct(e0, normals[1]);
+      testCandidate(extremalPoints, e0, n.normalized());
+    }
+    else
+    {
+      // Base triangle, and the ditetrahedron formed with the extremal points along its normal
+      testTriangle(extremalPoints, p0, p1, p2);
+      KVector3D n = KVector3D::crossProduct(p1 - p0, p2 - p0).normalized();
+      Karma::AxisExtremes normalExtremes;
+      Karma::findExtremalAlongAxes(Karma::PointStream(extremalPoints.data(), extremalPoints.size()), &n, 1, &normalExtremes);
+      float baseProj = KVector3D::dotProduct(p0, n);
+      KVector3D const apexes[2] = { extremalPoints[normalExtremes.minIndex], extremalPoints[normalExtremes.maxIndex] };
+      float const apexProj[2] = { normalExtremes.minProj, normalExtremes.maxProj };
+      for (int i = 0; i < 2; ++i)
+      {
+        if (std::abs(apexProj[i] - baseProj) <= DitoEpsilon) continue;
+        testTriangle(extremalPoints, p0, p1, apexes[i]);
+        testTriangle(extremalPoints, p1, p2, apexes[i]);
+        testTriangle(extremalPoints, p2, p0, apexes[i]);
+      }
+    }
+  }
+
+  // Exact extents along the chosen axes need one more sweep over all points
+  KVector3D axes[3] = { m_bestAxes[0], m_bestAxes[1], m_bestAxes[2] };
+  Karma::AxisExtremes axesExtremes[3];
+  Karma::findExtremalAlongAxes(points, axes, 3, axesExtremes);
+
+  // The candidates were only judged on the extremal points, keep the AABB if it is better
+  float length[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    length[i] = axesExtremes[i].maxProj - axesExtremes[i].minProj;
+  }
+  float quality = length[0] * length[1] + length[1] * length[2] + length[2] * length[0];
+  if (quality > aabbQuality)
+  {
+    std::copy(normals, normals + 3, axes);
+    std::copy(extremes.begin(), extremes.begin() + 3, axesExtremes);
+  }
+  calculateFromAxes(axes, axesExtremes);
+}
+
+void KOrientedBoundingVolumePrivate::calculateFromAxes(KVector3D const axes[3], Karma::AxisExtremes const extremes[3])
+{
+  Karma::reconstructMatrixByColumnVectors(&this->axes, axes[0], axes[1], axes[2]);
+  extents.setX((extremes[0].maxProj - extremes[0].minProj) / 2.0f);
+  extents.setY((extremes[1].maxProj - extremes[1].minProj) / 2.0f);
+  extents.setZ((extremes[2].maxProj - extremes[2].minProj) / 2.0f);
+  centroid  = axes[0] * (extremes[0].maxProj + extremes[0].minProj) / 2.0f;
+  centroid += axes[1] * (extremes[1].maxProj + extremes[1].minProj) / 2.0f;
+  centroid += axes[2] * (extremes[2].maxProj + extremes[2].minProj) / 2.0f;
+}
+
+void KOrientedBoundingVolumePrivate::testCandidate(std::vector<KVector3D> const &points, KVector3D const &e0, KVector3D const &n)
+{
+  KVector3D candidate[3] = { e0, KVector3D::crossProduct(n, e0), n };
+  float quality = obbQuality(points, candidate);
+  if (quality < m_bestQuality)
+  {
+    m_bestQuality = quality;
+    std::copy(candidate, candidate + 3, m_bestAxes);
+  }
+}
+
+void KOrientedBoundingVolumePrivate::testTriangle(std::vector<KVector3D> const &points, KVector3D const &p0, KVector3D const &p1, KVector3D const &p2)
+{
+  KVector3D n = KVector3D::crossProduct(p1 - p0, p2 - p0);
+  if (n.lengthSquared() <= DitoEpsilon) return;
+  n.normalize();
+
+  // Each triangle edge (with the triangle normal) defines a candidate basis
+  KVector3D const edges[3] = { p1 - p0, p2 - p1, p0 - p2 };
+  for (KVector3D const &edge : edges)
+  {
+    if (edge.lengthSquared() <= DitoEpsilon) continue;
+    testCandidate(points, edge.normalized(), n);
+  }
 }
 
 KOrientedBoundingVolume::KOrientedBoundingVolume() :
@@ -55,13 +216,25 @@ KOrientedBoundingVolume::KOrientedBoundingVolume() :
 }
 
 KOrientedBoundingVolume::KOrientedBoundingVolume(const KHalfEdgeMesh &mesh, Method method) :
+  KOrientedBoundingVolume(KBoundingVolumeFit(mesh), method)
+{
+  // Intentionally Empty
+}
+
+KOrientedBoundingVolume::KOrientedBoundingVolume(KBoundingVolumeFit const &fit, Method method) :
   m_private(new KOrientedBoundingVolumePrivate)
 {
   P(KOrientedBoundingVolumePrivate);
   switch (method)
   {
   case PcaMethod:
-    p.calculatePcaMethod(mesh);
+    p.calculatePcaMethod(fit);
+    break;
+  case Dito14Method:
+    p.calculateDitoMethod(fit, 14);
+    break;
+  case Dito26Method:
+    p.calculateDitoMethod(fit, 26);
     break;
   }
 }
@@ -71,6 +244,12 @@ KOrientedBoundingVolume::~KOrientedBoundingVolume()
   delete m_private;
 }
 
+float KOrientedBoundingVolume::volume() const
+{
+  P(KOrientedBoundingVolumePrivate);
+  return 8.0f * p.extents.x() * p.extents.y() * p.extents.z();
+}
+
 void KOrientedBoundingVolume::draw(KTransform3D &t, const KColor &color) const
 {
   P(KOrientedBoundingVolumePrivate);
@@ -3,6 +3,7 @@
 
 #include <KAbstractBoundingVolume>
 class KHalfEdgeMesh;
+class KBoundingVolumeFit;
 
 class KOrientedBoundingVolumePrivate;
 class KOrientedBoundingVolume : public KAbstractBoundingVolume
@@ -12,14 +13,20 @@ public:
   // Construction Methods
   enum Method
   {
-    PcaMethod
+    PcaMethod,
+    Dito14Method,
+    Dito26Method
   };
 
   // Constructors / Destructor
   KOrientedBoundingVolume();
   KOrientedBoundingVolume(KHalfEdgeMesh const &mesh, Method method);
+  KOrientedBoundingVolume(KBoundingVolumeFit const &fit, Method method);
   ~KOrientedBoundingVolume();
 
+  // Query
+  float volume() const;
+
   // Virtual Implementaiton
   void draw(KTransform3D &t, KColor const &color) const;
 
@@ -0,0 +1,91 @@
+#ifndef KPARALLEL_H
+#define KPARALLEL_H KParallel
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include <KTaskGroup>
+#include <KThreadPool>
+
+namespace Karma
+{
+  // Splits [begin, end) into chunks of at least grain elements and calls
+  // f(chunkBegin, chunkEnd) for each of them on the global thread pool.
+  template <typename Func>
+  void parallelFor(size_t begin, size_t end, size_t grain, Func f);
+
+  // Same chunking as parallelFor, but each chunk produces a partial result
+  // via map(chunkBegin, chunkEnd). Partials are combined serially in chunk
+  // order, so the result does not depend on scheduling.
+  template <typename T, typename Map, typename Combine>
+  T parallelReduce(size_t begin, size_t end, size_t grain, T identity, Map map, Combine combine);
+
+  size_t parallelChunkCount(size_t count, size_t grain);
+}
+
+inline size_t Karma::parallelChunkCount(size_t count, size_t grain)
+{
+  if (count == 0) return 0;
+  if (grain == 0) grain = 1;
+  size_t threads = KThreadPool::globalInstance()->threadCount();
+  size_t chunks = (count + grain - 1) / grain;
+
+  // Oversubscribe slightly so stealing can balance uneven chunks.
+  return std::max<size_t>(1, std::min(chunks, threads * 4));
+}
+
+template <typename Func>
+void Karma::parallelFor(size_t begin, size_t end, size_t grain, Func f)
+{
+  if (end <= begin) return;
+  size_t count = end - begin;
+  size_t chunks = parallelChunkCount(count, grain);
+  if (chunks == 1)
+  {
+    f(begin, end);
+    return;
+  }
+
+  KTaskGroup group;
+  size_t chunkSize = (count + chunks - 1) / chunks;
+  for (size_t b = begin; b < end; b += chunkSize)
+  {
+    size_t e = std::min(end, b + chunkSize);
+    group.run([&f, b, e]() { f(b, e); });
+  }
+  group.wait();
+}
+
+template <typename T, typename Map, typename Combine>
+T Karma::parallelReduce(size_t begin, size_t end, size_t grain, T identity, Map map, Combine combine)
+{
+  if (end <= begin) return identity;
+  size_t count = end - begin;
+  size_t chunks = parallelChunkCount(count, grain);
+  if (chunks == 1)
+  {
+    return combine(identity, map(begin, end));
+  }
+
+  KTaskGroup group;
+  std::vector<T> partials(chunks, identity);
+  size_t chunkSize = (count + chunks - 1) / chunks;
+  for (size_t c = 0; c < chunks; ++c)
+  {
+    size_t b = begin + c * chunkSize;
+    size_t e = std::min(end, b + chunkSize);
+    if (b >= e) break;
+    T *partial = &partials[c];
+    group.run([&map, partial, b, e]() { (*partial) = map(b, e); });
+  }
+  group.wait();
+
+  T result = identity;
+  for (T const &partial : partials)
+  {
+    result = combine(result, partial);
+  }
+  return result;
+}
+
+#endif // KPARALLEL_H
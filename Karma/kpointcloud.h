@@ -16,6 +16,7 @@ public:
   void emplace_back(ElementType const &elm);
   ElementType &operator[](size_t elm);
   ElementType const &operator[](size_t elm) const;
+  ElementType const *data() const;
   size_t size() const;
   bool empty() const;
   void clear();
@@ -42,6 +43,11 @@ inline auto KPointCloud::operator[](size_t elm) const -> ElementType const&
   return m_container[elm];
 }
 
+inline auto KPointCloud::data() const -> ElementType const*
+{
+  return m_container.data();
+}
+
 inline size_t KPointCloud::size() const
 {
   return m_container.size();
@@ -0,0 +1,224 @@
+#include "kspatialfile.h"
+
+#include <cstring>
+#include <limits>
+#include <QFile>
+#include <QString>
+
+#include <KMacros>
+#include <KMappedFile>
+#include <KVector3D>
+
+static_assert(sizeof(KVector3D) == 3 * sizeof(float), "KVector3D must be tightly packed to be mapped from disk.");
+
+/*******************************************************************************
+ * KSpatialFileHeader
+ ******************************************************************************/
+struct KSpatialFileHeader
+{
+  char magic[4];
+  uint32_t version;
+  uint32_t type;
+  uint32_t method;
+  uint64_t sourceHash;
+  uint64_t terminationKey;
+  uint32_t maxDepth;
+  uint32_t nodeSize;
+  uint64_t nodeCount, nodeOffset;
+  uint64_t triangleCount, triangleOffset;
+  uint64_t pointCount, pointOffset;
+  uint64_t fileSize;
+};
+
+static const char KSpatialFileMagic[4] = { 'K', 'S', 'P', 'F' };
+static const uint32_t KSpatialFileVersion = 2;
+
+/*******************************************************************************
+ * KSpatialFilePrivate
+ ******************************************************************************/
+class KSpatialFilePrivate
+{
+public:
+  KSpatialFilePrivate();
+  QFile m_file;
+  uchar *m_mapping;
+  KSpatialFile::Description m_desc;
+};
+
+KSpatialFilePrivate::KSpatialFilePrivate() :
+  m_mapping(Q_NULLPTR)
+{
+  std::memset(&m_desc, 0, sizeof(m_desc));
+}
+
+/*******************************************************************************
+ * KSpatialFile
+ ******************************************************************************/
+KSpatialFile::KSpatialFile() :
+  m_private(new KSpatialFilePrivate)
+{
+  // Intentionally Empty
+}
+
+KSpatialFile::~KSpatialFile()
+{
+  unmap();
+}
+
+bool KSpatialFile::write(QString const &fileName, Description const &desc)
+{
+  KSpatialFileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, KSpatialFileMagic, sizeof(header.magic));
+  header.version = KSpatialFileVersion;
+  header.type = desc.type;
+  header.method = desc.method;
+  header.sourceHash = desc.sourceHash;
+  header.terminationKey = desc.terminationKey;
+  header.maxDepth = desc.maxDepth;
+  header.nodeSize = static_cast<uint32_t>(desc.nodeSize);
+
+  // Lay out the sections
+  uint64_t nodeBytes = desc.nodeCount * desc.nodeSize;
+  uint64_t triangleBytes = desc.triangleCount * 3 * sizeof(uint32_t);
+  uint64_t pointBytes = desc.pointCount * sizeof(KVector3D);
+  header.nodeCount = desc.nodeCount;
+  header.nodeOffset = Karma::alignFileOffset(sizeof(KSpatialFileHeader));
+  header.triangleCount = desc.triangleCount;
+  header.triangleOffset = Karma::alignFileOffset(header.nodeOffset + nodeBytes);
+  header.pointCount = desc.pointCount;
+  header.pointOffset = Karma::alignFileOffset(header.triangleOffset + triangleBytes);
+  header.fileSize = header.pointOffset + pointBytes;
+
+  QFile file(fileName);
+  if (!file.open(QFile::WriteOnly | QFile::Truncate)) return false;
+  bool success =
+    file.write(reinterpret_cast<char const*>(&header), sizeof(header)) == sizeof(header) &&
+    Karma::writeFilePadding(file, header.nodeOffset) &&
+    file.write(static_cast<char const*>(desc.nodes), nodeBytes) == static_cast<qint64>(nodeBytes) &&
+    Karma::writeFilePadding(file, header.triangleOffset) &&
+    file.write(reinterpret_cast<char const*>(desc.triangles), triangleBytes) == static_cast<qint64>(triangleBytes) &&
+    Karma::writeFilePadding(file, header.pointOffset) &&
+    file.write(reinterpret_cast<char const*>(desc.points), pointBytes) == static_cast<qint64>(pointBytes);
+  file.close();
+
+  // Never leave a partial file behind, it would only fail validation later.
+  if (!success) QFile::remove(fileName);
+  return success;
+}
+
+bool KSpatialFile::map(QString const &fileName, Type type, uint32_t method, uint64_t sourceHash, uint64_t terminationKey, size_t nodeSize)
+{
+  P(KSpatialFilePrivate);
+  unmap();
+
+  p.m_file.setFileName(fileName);
+  if (!p.m_file.open(QFile::ReadOnly)) return false;
+  qint64 fileSize = p.m_file.size();
+  if (fileSize < static_cast<qint64>(sizeof(KSpatialFileHeader)))
+  {
+    p.m_file.close();
+    return false;
+  }
+
+  p.m_mapping = p.m_file.map(0, fileSize);
+  if (!p.m_mapping)
+  {
+    p.m_file.close();
+    return false;
+  }
+
+  // Validate before handing out any pointers into the mapping.
+  KSpatialFileHeader const *header = reinterpret_cast<KSpatialFileHeader const*>(p.m_mapping);
+  bool valid =
+    std::memcmp(header->magic, KSpatialFileMagic, sizeof(header->magic)) == 0 &&
+    header->version == KSpatialFileVersion &&
+    header->type == static_cast<uint32_t>(type) &&
+    header->method == method &&
+    header->sourceHash == sourceHash &&
+    header->terminationKey == terminationKey &&
+    nodeSize > 0 && header->nodeSize == nodeSize &&
+    header->fileSize == static_cast<uint64_t>(fileSize) &&
+    header->nodeOffset >= sizeof(KSpatialFileHeader) &&
+    header->nodeOffset % Karma::MappedFileAlignment == 0 &&
+    header->triangleOffset % Karma::MappedFileAlignment == 0 &&
+    header->pointOffset % Karma::MappedFileAlignment == 0 &&
+    header->nodeCount <= std::numeric_limits<uint32_t>::max() &&
+    header->triangleCount <= std::numeric_limits<uint32_t>::max() &&
+    header->pointCount <= std::numeric_limits<uint32_t>::max() &&
+    Karma::fileSectionFits(header->nodeOffset, header->nodeCount, nodeSize, header->triangleOffset) &&
+    Karma::fileSectionFits(header->triangleOffset, header->triangleCount, 3 * sizeof(uint32_t), header->pointOffset) &&
+    Karma::fileSectionFits(header->pointOffset, header->pointCount, sizeof(KVector3D), header->fileSize);
+  if (!valid)
+  {
+    unmap();
+    return false;
+  }
+
+  // Every triangle has to index a point, checked once instead of per draw.
+  uint32_t const *triangles = reinterpret_cast<uint32_t const*>(p.m_mapping + header->triangleOffset);
+  uint32_t const *trianglesEnd = triangles + 3 * header->triangleCount;
+  for (uint32_t const *it = triangles; it != trianglesEnd; ++it)
+  {
+    if (*it >= header->pointCount)
+    {
+      unmap();
+      return false;
+    }
+  }
+
+  // Fix up the section pointers, nothing else has to be touched.
+  Description &desc = p.m_desc;
+  desc.type = type;
+  desc.method = method;
+  desc.sourceHash = sourceHash;
+  desc.terminationKey = terminationKey;
+  desc.maxDepth = header->maxDepth;
+  desc.nodes = p.m_mapping + header->nodeOffset;
+  desc.nodeCount = header->nodeCount;
+  desc.nodeSize = nodeSize;
+  desc.triangles = reinterpret_cast<uint32_t const*>(p.m_mapping + header->triangleOffset);
+  desc.triangleCount = header->triangleCount;
+  desc.points = reinterpret_cast<KVector3D const*>(p.m_mapping + header->pointOffset);
+  desc.pointCount = header->pointCount;
+  return true;
+}
+
+void KSpatialFile::unmap()
+{
+  P(KSpatialFilePrivate);
+  if (p.m_mapping)
+  {
+    p.m_file.unmap(p.m_mapping);
+    p.m_mapping = Q_NULLPTR;
+  }
+  if (p.m_file.isOpen())
+  {
+    p.m_file.close();
+  }
+  std::memset(&p.m_desc, 0, sizeof(p.m_desc));
+}
+
+bool KSpatialFile::isMapped() const
+{
+  P(const KSpatialFilePrivate);
+  return (p.m_mapping != Q_NULLPTR);
+}
+
+KSpatialFile::Description const &KSpatialFile::description() const
+{
+  P(const KSpatialFilePrivate);
+  return p.m_desc;
+}
+
+bool KSpatialFile::isValidChild(size_t parent, uint32_t child) const
+{
+  P(const KSpatialFilePrivate);
+  return (child == 0 || (child > parent && child < p.m_desc.nodeCount));
+}
+
+bool KSpatialFile::isValidTriangleRange(uint32_t first, uint32_t count) const
+{
+  P(const KSpatialFilePrivate);
+  return Karma::fileSectionFits(first, count, 1, p.m_desc.triangleCount);
+}
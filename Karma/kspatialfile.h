@@ -0,0 +1,63 @@
+#ifndef KSPATIALFILE_H
+#define KSPATIALFILE_H KSpatialFile
+
+#include <cstddef>
+#include <cstdint>
+#include <QScopedPointer>
+class QString;
+class KVector3D;
+
+class KSpatialFilePrivate;
+class KSpatialFile
+{
+public:
+  enum Type
+  {
+    StaticGeometryType = 1,
+    AdaptiveOctreeType = 2,
+    BspTreeType        = 3
+  };
+
+  // Flattened structures are stored as three sections (nodes, triangles and
+  // points) behind a versioned header. Triangles are 0-based index triplets.
+  // A file is keyed by its source geometry, build method and termination key.
+  struct Description
+  {
+    Type type;
+    uint32_t method;
+    uint64_t sourceHash;
+    uint64_t terminationKey;
+    uint32_t maxDepth;
+    void const *nodes;
+    size_t nodeCount;
+    size_t nodeSize;
+    uint32_t const *triangles;
+    size_t triangleCount;
+    KVector3D const *points;
+    size_t pointCount;
+  };
+
+  KSpatialFile();
+  ~KSpatialFile();
+
+  // Writing
+  static bool write(QString const &fileName, Description const &desc);
+
+  // Reading (Note: Sections point into the mapping, keep this object alive)
+  // The sections are bounds-checked and every triangle index refers to a
+  // point; node fields are up to the caller (see the validation helpers).
+  bool map(QString const &fileName, Type type, uint32_t method, uint64_t sourceHash, uint64_t terminationKey, size_t nodeSize);
+  void unmap();
+  bool isMapped() const;
+  Description const &description() const;
+
+  // Validation of mapped nodes (Children are laid out after their parent,
+  // which also rules out cycles; 0 is no child.)
+  bool isValidChild(size_t parent, uint32_t child) const;
+  bool isValidTriangleRange(uint32_t first, uint32_t count) const;
+
+private:
+  QScopedPointer<KSpatialFilePrivate> m_private;
+};
+
+#endif // KSPATIALFILE_H
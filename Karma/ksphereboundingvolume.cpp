@@ -6,113 +6,111 @@
 #include <KMatrix3x3>
 #include <KMath>
 #include <KEposSphere>
+#include <KBoundingVolumeFit>
+
+// Extremal points along the coordinate axes are a by-product of the bounds.
+static KEposSphere axisAlignedEposSphere(KBoundingVolumeFit const &fit)
+{
+  Karma::PointStream const &points = fit.points();
+  Karma::PointMoments const &moments = fit.moments();
+  KMinMaxVectorCloud extremalVerts(3);
+  for (int i = 0; i < 3; ++i)
+  {
+    extremalVerts[i].min = points[moments.minIndex[i]];
+    extremalVerts[i].max = points[moments.maxIndex[i]];
+  }
+  return KEposSphere(extremalVerts.begin(), extremalVerts.end());
+}
 
 class KSphereBoundingVolumePrivate
 {
 public:
-  void calculateCentroidMethod(const KHalfEdgeMesh &mesh);
-  void calculateRittersMethod(const KHalfEdgeMesh &mesh);
-  void calculateLarssonsMethod(const KHalfEdgeMesh &mesh);
-  void calculatePcaMethod(const KHalfEdgeMesh &mesh);
+  KSphereBoundingVolumePrivate();
+  void calculateCentroidMethod(KBoundingVolumeFit const &fit);
+  void calculateRittersMethod(KBoundingVolumeFit const &fit);
+  void calculateLarssonsMethod(KBoundingVolumeFit const &fit, int k);
+  void calculatePcaMethod(KBoundingVolumeFit const &fit);
   KVector3D centroid;
   float radius;
 private:
-  void mostSeparatedPoints(KVector3D *min, KVector3D *max, const KHalfEdgeMesh &mesh, size_t sample);
-  void calculateFromDistantPoints(const KHalfEdgeMesh &mesh, size_t sample);
+  void mostSeparatedPoints(KVector3D *min, KVector3D *max, Karma::PointStream const &points, size_t sample);
+  void calculateFromDistantPoints(Karma::PointStream const &points, size_t sample);
   void expandToContainPoint(const KVector3D &v);
-  void calculateFromCovarianceMatrix(const KHalfEdgeMesh &mesh, int iterations);
+  void expandToContainPoints(Karma::PointStream const &points);
+  void calculateFromCovarianceMatrix(KBoundingVolumeFit const &fit);
 };
 
-void KSphereBoundingVolumePrivate::calculateCentroidMethod(const KHalfEdgeMesh &mesh)
+KSphereBoundingVolumePrivate::KSphereBoundingVolumePrivate() :
+  centroid(0.0f, 0.0f, 0.0f), radius(0.0f)
 {
-  // Calculate centroid
-  KHalfEdgeMesh::VertexContainer const &vertices = mesh.vertices();
-  centroid = Karma::findAverageCentroid(vertices.begin(), vertices.end(), KHalfEdgeMesh::VertexPositionPred());
+  // Intentionally Empty
+}
 
-  // Calculate Radius
-  radius = 0.0f;
-  float tempRadius;
-  for (KHalfEdgeMesh::Vertex const &v : vertices)
-  {
-    tempRadius = (centroid - v.position).lengthSquared();
-    if (tempRadius > radius) radius = tempRadius;
-  }
-  radius = std::sqrt(radius);
+void KSphereBoundingVolumePrivate::calculateCentroidMethod(KBoundingVolumeFit const &fit)
+{
+  centroid = fit.moments().centroid;
+  radius = std::sqrt(Karma::findMaxDistanceSquared(fit.points(), centroid));
 }
 
-void KSphereBoundingVolumePrivate::calculateRittersMethod(const KHalfEdgeMesh &mesh)
+void KSphereBoundingVolumePrivate::calculateRittersMethod(KBoundingVolumeFit const &fit)
 {
-  calculateFromDistantPoints(mesh, 6);
-  for (KHalfEdgeMesh::Vertex const & v : mesh.vertices())
-  {
-    expandToContainPoint(v.position);
-  }
+  calculateFromDistantPoints(fit.points(), 6);
+  expandToContainPoints(fit.points());
 }
 
-void KSphereBoundingVolumePrivate::calculateLarssonsMethod(const KHalfEdgeMesh &mesh)
+void KSphereBoundingVolumePrivate::calculateLarssonsMethod(KBoundingVolumeFit const &fit, int k)
 {
-  std::vector<KVector3D> normals =
-  {
-    KVector3D(1.0f, 0.0f, 0.0f),
-    KVector3D(0.0f, 1.0f, 0.0f),
-    KVector3D(0.0f, 0.0f, 1.0f)
-  };
-  KEposSphere sphere(mesh.vertices().begin(), mesh.vertices().end(), normals.begin(), normals.end(), KHalfEdgeMesh::VertexPositionPred());
+  Karma::PointStream const &points = fit.points();
+  KEposSphere sphere = (k < 14) ? axisAlignedEposSphere(fit) : KEposSphere(points, k);
+  sphere.growToContain(points);
   centroid = sphere.centroid;
   radius = sphere.radius;
-  for (KHalfEdgeMesh::Vertex const & v : mesh.vertices())
-  {
-    expandToContainPoint(v.position);
-  }
 }
 
-void KSphereBoundingVolumePrivate::calculatePcaMethod(const KHalfEdgeMesh &mesh)
+void KSphereBoundingVolumePrivate::calculatePcaMethod(KBoundingVolumeFit const &fit)
 {
-  calculateFromCovarianceMatrix(mesh, 50);
-  for (KHalfEdgeMesh::Vertex const & v : mesh.vertices())
-  {
-    expandToContainPoint(v.position);
-  }
+  calculateFromCovarianceMatrix(fit);
+  expandToContainPoints(fit.points());
 }
 
-void KSphereBoundingVolumePrivate::mostSeparatedPoints(KVector3D *minimum, KVector3D *maximum, const KHalfEdgeMesh &mesh, size_t sample)
+void KSphereBoundingVolumePrivate::mostSeparatedPoints(KVector3D *minimum, KVector3D *maximum, Karma::PointStream const &points, size_t sample)
 {
-  size_t step = mesh.vertices().size() / sample;
+  size_t step = points.size() / sample;
+  if (step == 0) step = 1;
 
   size_t minx = 0, miny = 0, minz = 0, maxx = 0, maxy = 0, maxz = 0;
-  KHalfEdgeMesh::VertexContainer const &vertices = mesh.vertices();
-  for (size_t i = step; i < mesh.vertices().size(); i += step)
+  for (size_t i = step; i < points.size(); i += step)
   {
-    if (vertices[i].position.x() < vertices[minx].position.x()) minx = i;
-    if (vertices[i].position.y() < vertices[miny].position.y()) miny = i;
-    if (vertices[i].position.z() < vertices[minz].position.z()) minz = i;
-    if (vertices[i].position.x() > vertices[maxx].position.x()) maxx = i;
-    if (vertices[i].position.y() > vertices[maxy].position.y()) maxy = i;
-    if (vertices[i].position.z() > vertices[maxz].position.z()) maxz = i;
+    if (points[i].x() < points[minx].x()) minx = i;
+    if (points[i].y() < points[miny].y()) miny = i;
+    if (points[i].z() < points[minz].z()) minz = i;
+    if (points[i].x() > points[maxx].x()) maxx = i;
+    if (points[i].y() > points[maxy].y()) maxy = i;
+    if (points[i].z() > points[maxz].z()) maxz = i;
   }
 
-  float dist2x = (vertices[maxx].position - vertices[minx].position).lengthSquared();
-  float dist2y = (vertices[maxy].position - vertices[miny].position).lengthSquared();
-  float dist2z = (vertices[maxz].position - vertices[minz].position).lengthSquared();
+  float dist2x = (points[maxx] - points[minx]).lengthSquared();
+  float dist2y = (points[maxy] - points[miny]).lengthSquared();
+  float dist2z = (points[maxz] - points[minz]).lengthSquared();
 
-  (*maximum) = vertices[maxx].position;
-  (*minimum) = vertices[minx].position;
+  (*maximum) = points[maxx];
+  (*minimum) = points[minx];
   if (dist2y > dist2x && dist2y > dist2z)
   {
-    (*maximum) = vertices[maxy].position;
-    (*minimum) = vertices[miny].position;
+    (*maximum) = points[maxy];
+    (*minimum) = points[miny];
   }
   if (dist2z > dist2x && dist2z > dist2y)
   {
-    (*maximum) = vertices[maxz].position;
-    (*minimum) = vertices[minz].position;
+    (*maximum) = points[maxz];
+    (*minimum) = points[minz];
   }
 }
 
-void KSphereBoundingVolumePrivate::calculateFromDistantPoints(const KHalfEdgeMesh &mesh, size_t sample)
+void KSphereBoundingVolumePrivate::calculateFromDistantPoints(Karma::PointStream const &points, size_t sample)
 {
   KVector3D min, max;
-  mostSeparatedPoints(&min, &max, mesh, sample);
+  mostSeparatedPoints(&min, &max, points, sample);
 
   centroid = (min + max) / 2.0f;
   radius = (max - centroid).length();
@@ -132,28 +130,28 @@ void KSphereBoundingVolumePrivate::expandToContainPoint(const KVector3D &v)
   }
 }
 
-void KSphereBoundingVolumePrivate::calculateFromCovarianceMatrix(const KHalfEdgeMesh &mesh, int iterations)
+void KSphereBoundingVolumePrivate::expandToContainPoints(Karma::PointStream const &points)
 {
-  KHalfEdgeMesh::VertexContainer const &vertices = mesh.vertices();
-
-  // Calculate the covariance matrix
-  KMatrix3x3 covariance =
-    Karma::covarianceMatrix(
-      vertices.begin(),
-      vertices.end(),
-      KHalfEdgeMesh::VertexPositionPred()
-    );
-  KMatrix3x3 eigenVectors = Karma::jacobi(covariance, iterations);
+  // Note: Every expansion depends on the previous one, this pass stays serial.
+  for (size_t i = 0; i < points.size(); ++i)
+  {
+    expandToContainPoint(points[i]);
+  }
+}
 
-  // Find extremal points along axis
-  KVector3D axis = Karma::maxEigenExtents(eigenVectors);
-  Karma::MinMaxKVector3D minMax =
-    Karma::findExtremalPointsAlongAxis(
-      vertices.begin(),
-      vertices.end(),
-      axis,
-      KHalfEdgeMesh::VertexPositionPred()
-    );
+void KSphereBoundingVolumePrivate::calculateFromCovarianceMatrix(KBoundingVolumeFit const &fit)
+{
+  // The maximum eigen extent is one of the principal axes the fit projected onto.
+  KVector3D axis = Karma::maxEigenExtents(fit.principalAxes());
+  int axisIndex = 0;
+  for (int i = 0; i < 3; ++i)
+  {
+    if (fit.principalAxis(i) == axis) axisIndex = i;
+  }
+  Karma::AxisExtremes const &extremes = fit.principalExtremes(axisIndex);
+  Karma::MinMaxKVector3D minMax;
+  minMax.min = fit.points()[extremes.minIndex];
+  minMax.max = fit.points()[extremes.maxIndex];
 
   // Store Information
   float dist = (minMax.max - minMax.min).length();
@@ -167,23 +165,33 @@ KSphereBoundingVolume::KSphereBoundingVolume() :
   // Intentionally Empty
 }
 
-KSphereBoundingVolume::KSphereBoundingVolume(const KHalfEdgeMesh &mesh, Method method) :
+KSphereBoundingVolume::KSphereBoundingVolume(const KHalfEdgeMesh &mesh, Method method, int eposK) :
+  KSphereBoundingVolume(KBoundingVolumeFit(mesh), method, eposK)
+{
+  // Intentionally Empty
+}
+
+KSphereBoundingVolume::KSphereBoundingVolume(KBoundingVolumeFit const &fit, Method method, int eposK) :
   m_private(new KSphereBoundingVolumePrivate)
 {
   P(KSphereBoundingVolumePrivate);
+
+  // Nothing to bound (the methods below index into the points)
+  if (fit.points().size() == 0) return;
+
   switch (method)
   {
   case CentroidMethod:
-    p.calculateCentroidMethod(mesh);
+    p.calculateCentroidMethod(fit);
     break;
   case RittersMethod:
-    p.calculateRittersMethod(mesh);
+    p.calculateRittersMethod(fit);
     break;
   case LarssonsMethod:
-    p.calculateLarssonsMethod(mesh);
+    p.calculateLarssonsMethod(fit, eposK);
     break;
   case PcaMethod:
-    p.calculatePcaMethod(mesh);
+    p.calculatePcaMethod(fit);
     break;
   }
 }
@@ -193,6 +201,12 @@ KSphereBoundingVolume::~KSphereBoundingVolume()
   delete m_private;
 }
 
+float KSphereBoundingVolume::radius() const
+{
+  P(KSphereBoundingVolumePrivate);
+  return p.radius;
+}
+
 void KSphereBoundingVolume::draw(KTransform3D &t, const KColor &color) const
 {
   P(KSphereBoundingVolumePrivate);
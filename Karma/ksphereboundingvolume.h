@@ -3,6 +3,7 @@
 
 #include <KAbstractBoundingVolume>
 class KHalfEdgeMesh;
+class KBoundingVolumeFit;
 
 class KSphereBoundingVolumePrivate;
 class KSphereBoundingVolume : public KAbstractBoundingVolume
@@ -19,10 +20,16 @@ public:
   };
 
   // Constuctors / Destructor
+  // Larsson's method takes the extremal points along k/2 directions, the
+  // EPOS-6/14/26 sets (a k in between rounds down). Other methods ignore k.
   KSphereBoundingVolume();
-  KSphereBoundingVolume(KHalfEdgeMesh const &mesh, Method method);
+  KSphereBoundingVolume(KHalfEdgeMesh const &mesh, Method method, int eposK = 6);
+  KSphereBoundingVolume(KBoundingVolumeFit const &fit, Method method, int eposK = 6);
   ~KSphereBoundingVolume();
 
+  // Query
+  float radius() const;
+
   // Virtual Implementation
   void draw(KTransform3D &t, KColor const &color) const;
 
@@ -1,5 +1,6 @@
 #include "kstaticgeometry.h"
 
+#include <cstring>
 #include <vector>
 #include <KMath>
 #include <KMacros>
@@ -11,29 +12,10 @@
 #include <KAabbBoundingVolume>
 #include <KPointCloud>
 #include <KTriangleIndexCloud>
-#include <KIndexCloud>
 #include <KTrianglePointIterator>
 #include <KTrianglePartition>
-
-/*******************************************************************************
- * KStaticGeometryInstance
- ******************************************************************************/
-struct KStaticGeometryInstance
-{
-  KStaticGeometryInstance(KTriangleIndexIterator begin, KTriangleIndexIterator end);
-  KIndexCloud m_indexCloud;
-};
-
-KStaticGeometryInstance::KStaticGeometryInstance(KTriangleIndexIterator begin, KTriangleIndexIterator end)
-{
-  size_t numIndices = std::distance(begin, end);
-  m_indexCloud.reserve(numIndices);
-  while (begin != end)
-  {
-    m_indexCloud.emplace_back((*begin) - 1);
-    ++begin;
-  }
-}
+#include <KSpatialFile>
+#include <QString>
 
 /*******************************************************************************
  * KStaticGeometryNode
@@ -45,8 +27,8 @@ public:
 
   KStaticGeometryNode(size_t depth, ConstIterator begin, ConstIterator end, KPointCloud const &pointCloud);
   KStaticGeometryNode(size_t depth, KStaticGeometryNode *left, KStaticGeometryNode *right);
+  ~KStaticGeometryNode();
   bool isLeaf() const;
-  void drawAabb(KTransform3D &trans, KColor const &color, size_t min, size_t max) const;
   void correctDepth(size_t depth);
   size_t getMaxDepth();
 
@@ -54,46 +36,35 @@ public:
   KStaticGeometryNode *left;
   KStaticGeometryNode *right;
 
-  // For drawing
+  // For drawing (Leaf range within the triangle cloud)
   size_t from, to;
   size_t depth;
-  KStaticGeometryInstance *instance;
 };
 
 KStaticGeometryNode::KStaticGeometryNode(size_t d, ConstIterator begin, ConstIterator end, KPointCloud const &pointCloud) :
   aabb(KTrianglePointIterator(begin, pointCloud), KTrianglePointIterator(end, pointCloud)),
-  left(0), right(0), depth(d), instance(0)
+  left(0), right(0), from(0), to(0), depth(d)
 {
   // Intentionally Empty
 }
 
 KStaticGeometryNode::KStaticGeometryNode(size_t d, KStaticGeometryNode *left, KStaticGeometryNode *right) :
   aabb(left->aabb, right->aabb),
-  left(left), right(right), depth(d), instance(0)
+  left(left), right(right), from(0), to(0), depth(d)
 {
   left->depth = depth + 1;
   right->depth = depth + 1;
 }
 
-bool KStaticGeometryNode::isLeaf() const
+KStaticGeometryNode::~KStaticGeometryNode()
 {
-  return (left == 0);
+  delete left;
+  delete right;
 }
 
-void KStaticGeometryNode::drawAabb(KTransform3D &trans, const KColor &color, size_t min, size_t max) const
+bool KStaticGeometryNode::isLeaf() const
 {
-  if (depth <= max)
-  {
-    if (depth >= min)
-    {
-      aabb.draw(trans, Karma::colorShift(color, 0.1f * depth));
-    }
-    if (!isLeaf())
-    {
-      if (left)  left->drawAabb(trans, color, min, max);
-      if (right) right->drawAabb(trans, color, min, max);
-    }
-  }
+  return (left == 0);
 }
 
 void KStaticGeometryNode::correctDepth(size_t d)
@@ -108,6 +79,18 @@ size_t KStaticGeometryNode::getMaxDepth()
   return std::max(depth, std::max(left ? left->getMaxDepth() : 0, right ? right->getMaxDepth() : 0));
 }
 
+/*******************************************************************************
+ * KStaticGeometryFlatNode
+ ******************************************************************************/
+// Note: Stored verbatim on disk, only add fixed-size fields (and bump the file version).
+struct KStaticGeometryFlatNode
+{
+  float min[3], max[3];
+  uint32_t depth;
+  uint32_t firstTriangle, numTriangles; // Only leaves own triangles
+  uint32_t left, right; // 0 = no child (the root is never a child)
+};
+
 /*******************************************************************************
  * KStaticGeometryPrivate
  ******************************************************************************/
@@ -119,10 +102,20 @@ public:
   KStaticGeometryPrivate(KGeometryCloud &parent);
   void buildBottomUp(TerminationPred pred);
   void buildTopDown(TerminationPred pred);
+  void flatten(KStaticGeometryNode *root);
+  uint32_t flattenNode(KStaticGeometryNode const *node);
+  bool validNodes() const;
+  void drawNode(KTransform3D &trans, KColor const &color, uint32_t index, size_t min, size_t max) const;
 
-  KStaticGeometryNode *m_root;
   size_t m_maxDepth;
   KGeometryCloud m_parent;
+  KPointCloud m_pointCloud;
+
+  // Flattened tree (owned after a build, mapped after a load)
+  std::vector<KStaticGeometryFlatNode> m_flatNodes;
+  std::vector<uint32_t> m_flatTriangles;
+  KSpatialFile m_file;
+  KSpatialFile::Description m_view;
 
 private:
   KStaticGeometryNode *recursiveTopDown(size_t depth, TriangleIterator begin, TriangleIterator end, TerminationPred pred);
@@ -146,9 +139,9 @@ struct KAabbMinCentroidDistance : public std::binary_function<bool, KStaticGeome
 };
 
 KStaticGeometryPrivate::KStaticGeometryPrivate(KGeometryCloud &parent) :
-  m_parent(parent)
+  m_maxDepth(0), m_parent(parent)
 {
-  // Intentionally Empty
+  std::memset(&m_view, 0, sizeof(m_view));
 }
 
 void KStaticGeometryPrivate::buildBottomUp(TerminationPred pred)
@@ -182,6 +175,8 @@ void KStaticGeometryPrivate::buildBottomUp(TerminationPred pred)
     if (remaining > leafCount)
       remaining = leafCount;
     currNode = new KStaticGeometryNode(0, it, it + remaining, pointCloud);
+    currNode->from = std::distance(triangleCloud.begin(), it);
+    currNode->to = currNode->from + remaining;
     nodes.push_back(currNode);
     std::advance(it, remaining);
   }
@@ -212,9 +207,9 @@ void KStaticGeometryPrivate::buildBottomUp(TerminationPred pred)
     working.clear();
   }
 
-  m_root = nodes[0];
-  m_root->correctDepth(0);
-  m_maxDepth = m_root->getMaxDepth();
+  nodes[0]->correctDepth(0);
+  m_maxDepth = nodes[0]->getMaxDepth();
+  flatten(nodes[0]);
 }
 
 KStaticGeometryNode *KStaticGeometryPrivate::recursiveTopDown(size_t depth, TriangleIterator begin, TriangleIterator end, TerminationPred pred)
@@ -232,7 +227,8 @@ KStaticGeometryNode *KStaticGeometryPrivate::recursiveTopDown(size_t depth, Tria
     TriangleIterator secondHalf = std::partition(begin, end, KTrianglePartitionAlongAxis(pointCloud, node->aabb.center(), maxAxis));
     if (secondHalf == begin || secondHalf == end)
     {
-      node->instance = new KStaticGeometryInstance(begin, end);
+      node->from = std::distance(m_parent.triangleIndexCloud().begin(), begin);
+      node->to = node->from + numTriangles;
     }
     else
     {
@@ -242,7 +238,8 @@ KStaticGeometryNode *KStaticGeometryPrivate::recursiveTopDown(size_t depth, Tria
   }
   else
   {
-    node->instance = new KStaticGeometryInstance(begin, end);
+    node->from = std::distance(m_parent.triangleIndexCloud().begin(), begin);
+    node->to = node->from + numTriangles;
   }
 
   return node;
@@ -253,7 +250,91 @@ void KStaticGeometryPrivate::buildTopDown(TerminationPred pred)
   // Top-Down looks at the entire triangle cloud.
   m_maxDepth = 0;
   KTriangleIndexCloud & triangleCloud = m_parent.triangleIndexCloud();
-  m_root = recursiveTopDown(0, triangleCloud.begin(), triangleCloud.end(), pred);
+  flatten(recursiveTopDown(0, triangleCloud.begin(), triangleCloud.end(), pred));
+}
+
+void KStaticGeometryPrivate::flatten(KStaticGeometryNode *root)
+{
+  // Nodes are laid out depth-first, children refer to each other by index.
+  m_flatNodes.clear();
+  if (root) flattenNode(root);
+  delete root;
+
+  // Triangles are stored in partitioned order, so every leaf owns a range.
+  KTriangleIndexCloud const &triangleCloud = m_parent.triangleIndexCloud();
+  m_flatTriangles.clear();
+  m_flatTriangles.reserve(triangleCloud.size() * 3);
+  for (KTriangleIndexCloud::ElementType const &triangle : triangleCloud)
+  {
+    m_flatTriangles.push_back(static_cast<uint32_t>(triangle.indices[0] - 1));
+    m_flatTriangles.push_back(static_cast<uint32_t>(triangle.indices[1] - 1));
+    m_flatTriangles.push_back(static_cast<uint32_t>(triangle.indices[2] - 1));
+  }
+
+  m_pointCloud = m_parent.pointCloud();
+  m_view.maxDepth = static_cast<uint32_t>(m_maxDepth);
+  m_view.nodes = m_flatNodes.data();
+  m_view.nodeCount = m_flatNodes.size();
+  m_view.nodeSize = sizeof(KStaticGeometryFlatNode);
+  m_view.triangles = m_flatTriangles.data();
+  m_view.triangleCount = triangleCloud.size();
+  m_view.points = m_pointCloud.data();
+  m_view.pointCount = m_pointCloud.size();
+}
+
+uint32_t KStaticGeometryPrivate::flattenNode(KStaticGeometryNode const *node)
+{
+  uint32_t index = static_cast<uint32_t>(m_flatNodes.size());
+  KStaticGeometryFlatNode flat;
+  Karma::MinMaxKVector3D const &extents = node->aabb.extents();
+  for (int i = 0; i < 3; ++i)
+  {
+    flat.min[i] = extents.min[i];
+    flat.max[i] = extents.max[i];
+  }
+  flat.depth = static_cast<uint32_t>(node->depth);
+  flat.firstTriangle = static_cast<uint32_t>(node->from);
+  flat.numTriangles = static_cast<uint32_t>(node->to - node->from);
+  m_flatNodes.push_back(flat);
+
+  // Note: Recursion grows m_flatNodes, so write through the index afterwards.
+  uint32_t left = node->left ? flattenNode(node->left) : 0;
+  m_flatNodes[index].left = left;
+  uint32_t right = node->right ? flattenNode(node->right) : 0;
+  m_flatNodes[index].right = right;
+  return index;
+}
+
+bool KStaticGeometryPrivate::validNodes() const
+{
+  // Corrupt indices would otherwise be followed by drawNode.
+  KStaticGeometryFlatNode const *nodes = static_cast<KStaticGeometryFlatNode const*>(m_file.description().nodes);
+  for (size_t i = 0; i < m_file.description().nodeCount; ++i)
+  {
+    KStaticGeometryFlatNode const &node = nodes[i];
+    if (!m_file.isValidTriangleRange(node.firstTriangle, node.numTriangles)) return false;
+    if (!m_file.isValidChild(i, node.left) || !m_file.isValidChild(i, node.right)) return false;
+  }
+  return true;
+}
+
+void KStaticGeometryPrivate::drawNode(KTransform3D &trans, const KColor &color, uint32_t index, size_t min, size_t max) const
+{
+  KStaticGeometryFlatNode const &node = static_cast<KStaticGeometryFlatNode const*>(m_view.nodes)[index];
+  if (node.depth <= max)
+  {
+    if (node.depth >= min)
+    {
+      Karma::MinMaxKVector3D extents;
+      extents.min = KVector3D(node.min[0], node.min[1], node.min[2]);
+      extents.max = KVector3D(node.max[0], node.max[1], node.max[2]);
+      KAabbBoundingVolume aabb;
+      aabb.setMinMaxBounds(extents);
+      aabb.draw(trans, Karma::colorShift(color, 0.1f * node.depth));
+    }
+    if (node.left)  drawNode(trans, color, node.left, min, max);
+    if (node.right) drawNode(trans, color, node.right, min, max);
+  }
 }
 
 /*******************************************************************************
@@ -278,6 +359,11 @@ void KStaticGeometry::build(BuildMethod method, TerminationPred pred)
   if (!dirty()) return;
 
   // Build based on selected method
+  p.m_file.unmap();
+  p.m_view.type = KSpatialFile::StaticGeometryType;
+  p.m_view.method = method;
+  p.m_view.sourceHash = hash();
+  p.m_view.terminationKey = terminationKey();
   switch (method)
   {
   case BottomUpMethod:
@@ -290,12 +376,35 @@ void KStaticGeometry::build(BuildMethod method, TerminationPred pred)
 
   // We no longer need this data
   KGeometryCloud::clear();
+}
+
+bool KStaticGeometry::save(QString const &fileName) const
+{
+  P(const KStaticGeometryPrivate);
+  if (p.m_view.nodeCount == 0) return false;
+  return KSpatialFile::write(fileName, p.m_view);
+}
+
+bool KStaticGeometry::load(QString const &fileName, BuildMethod method)
+{
+  P(KStaticGeometryPrivate);
 
-  // Next: Depth-first search to find all leaf nodes.
-  //       Form an index buffer of all contiguous leaf nodes.
-  //       As we iterate through, update the parent nodes so they
-  //       understand the "drawable range" of the children.
+  // The file must match the geometry which would otherwise be built.
+  if (!dirty()) return false;
+  if (!p.m_file.map(fileName, KSpatialFile::StaticGeometryType, method, hash(), terminationKey(), sizeof(KStaticGeometryFlatNode)) || !p.validNodes())
+  {
+    p.m_file.unmap();
+    return false;
+  }
 
+  // Use the mapping in place, release anything from a previous build.
+  p.m_view = p.m_file.description();
+  p.m_maxDepth = p.m_view.maxDepth;
+  std::vector<KStaticGeometryFlatNode>().swap(p.m_flatNodes);
+  std::vector<uint32_t>().swap(p.m_flatTriangles);
+  p.m_pointCloud.clear();
+  KGeometryCloud::clear();
+  return true;
 }
 
 void KStaticGeometry::clear()
@@ -317,12 +426,14 @@ void KStaticGeometry::drawAabbs(KTransform3D &trans, const KColor &color)
 
 void KStaticGeometry::drawAabbs(KTransform3D &trans, const KColor &color, size_t min)
 {
-  P(KStaticGeometryPrivate);
-  p.m_root->drawAabb(trans, color, min, std::numeric_limits<size_t>::max());
+  drawAabbs(trans, color, min, std::numeric_limits<size_t>::max());
 }
 
 void KStaticGeometry::drawAabbs(KTransform3D &trans, const KColor &color, size_t min, size_t max)
 {
   P(KStaticGeometryPrivate);
-  p.m_root->drawAabb(trans, color, min, max);
+  if (p.m_view.nodeCount)
+  {
+    p.drawNode(trans, color, 0, min, max);
+  }
 }
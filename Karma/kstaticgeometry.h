@@ -18,6 +18,8 @@ public:
   void clear();
   size_t depth() const;
   void build(BuildMethod method, TerminationPred pred);
+  bool save(QString const &fileName) const;
+  bool load(QString const &fileName, BuildMethod method);
   void drawAabbs(KTransform3D &trans, KColor const &color);
   void drawAabbs(KTransform3D &trans, KColor const &color, size_t min);
   void drawAabbs(KTransform3D &trans, KColor const &color, size_t min, size_t max);
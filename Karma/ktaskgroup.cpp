@@ -0,0 +1,27 @@
+#include "ktaskgroup.h"
+
+#include <thread>
+
+KTaskGroup::KTaskGroup(KThreadPool *pool) :
+  m_pool(pool), m_outstanding(0)
+{
+  // Intentionally Empty
+}
+
+KTaskGroup::~KTaskGroup()
+{
+  wait();
+}
+
+void KTaskGroup::wait()
+{
+  // Rather than blocking, help the pool drain work until our tasks are done.
+  // This is what keeps nested (recursive) task groups from deadlocking.
+  while (m_outstanding > 0)
+  {
+    if (!m_pool->tryRunPendingTask())
+    {
+      std::this_thread::yield();
+    }
+  }
+}
@@ -0,0 +1,38 @@
+#ifndef KTASKGROUP_H
+#define KTASKGROUP_H KTaskGroup
+
+#include <atomic>
+#include <cstddef>
+#include <KThreadPool>
+
+class KTaskGroup
+{
+public:
+  explicit KTaskGroup(KThreadPool *pool = KThreadPool::globalInstance());
+  ~KTaskGroup();
+  template <typename Func>
+  void run(Func f);
+  void wait();
+private:
+  KThreadPool *m_pool;
+  std::atomic<size_t> m_outstanding;
+};
+
+template <typename Func>
+void KTaskGroup::run(Func f)
+{
+  ++m_outstanding;
+  std::atomic<size_t> *outstanding = &m_outstanding;
+  m_pool->start([f, outstanding]() mutable
+  {
+    // Counted down even if f throws, or wait() (and ~KTaskGroup) would spin forever.
+    struct Done
+    {
+      std::atomic<size_t> *outstanding;
+      ~Done() { --(*outstanding); }
+    } done = { outstanding };
+    f();
+  });
+}
+
+#endif // KTASKGROUP_H
@@ -0,0 +1,223 @@
+#include "ktexturefile.h"
+
+#include <cstring>
+#include <QFile>
+#include <QString>
+
+#include <KMacros>
+#include <KMappedFile>
+
+/*******************************************************************************
+ * KTextureFileHeader
+ ******************************************************************************/
+struct KTextureFileLevel
+{
+  uint32_t width;
+  uint32_t height;
+  uint64_t offset;
+  uint64_t size;
+};
+
+struct KTextureFileHeader
+{
+  char magic[4];
+  uint32_t version;
+  uint32_t format;
+  uint32_t method;
+  uint64_t sourceHash;
+  uint32_t faces;
+  uint32_t reserved;
+  uint64_t levelCount;
+  KTextureFileLevel levels[KTextureFile::MaxLevels];
+  uint64_t fileSize;
+};
+
+static const char KTextureFileMagic[4] = { 'K', 'T', 'E', 'X' };
+static const uint32_t KTextureFileVersion = 2;
+
+/*******************************************************************************
+ * KTextureFilePrivate
+ ******************************************************************************/
+class KTextureFilePrivate
+{
+public:
+  KTextureFilePrivate();
+  QFile m_file;
+  uchar *m_mapping;
+  KTextureFile::Description m_desc;
+};
+
+KTextureFilePrivate::KTextureFilePrivate() :
+  m_mapping(Q_NULLPTR)
+{
+  std::memset(&m_desc, 0, sizeof(m_desc));
+}
+
+/*******************************************************************************
+ * KTextureFile
+ ******************************************************************************/
+KTextureFile::KTextureFile() :
+  m_private(new KTextureFilePrivate)
+{
+  // Intentionally Empty
+}
+
+KTextureFile::~KTextureFile()
+{
+  unmap();
+}
+
+bool KTextureFile::write(QString const &fileName, Description const &desc)
+{
+  if (desc.levelCount == 0 || desc.levelCount > MaxLevels) return false;
+  for (size_t i = 0; i < desc.levelCount; ++i)
+  {
+    Level const &level = desc.levels[i];
+    if (level.size == 0 || level.size != levelSize(desc.format, level.width, level.height, desc.faces)) return false;
+  }
+
+  KTextureFileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, KTextureFileMagic, sizeof(header.magic));
+  header.version = KTextureFileVersion;
+  header.format = desc.format;
+  header.method = desc.method;
+  header.sourceHash = desc.sourceHash;
+  header.faces = desc.faces;
+  header.levelCount = desc.levelCount;
+
+  // Lay out the levels
+  uint64_t offset = sizeof(KTextureFileHeader);
+  for (size_t i = 0; i < desc.levelCount; ++i)
+  {
+    offset = Karma::alignFileOffset(offset);
+    header.levels[i].width = desc.levels[i].width;
+    header.levels[i].height = desc.levels[i].height;
+    header.levels[i].offset = offset;
+    header.levels[i].size = desc.levels[i].size;
+    offset += desc.levels[i].size;
+  }
+  header.fileSize = offset;
+
+  QFile file(fileName);
+  if (!file.open(QFile::WriteOnly | QFile::Truncate)) return false;
+  bool success = file.write(reinterpret_cast<char const*>(&header), sizeof(header)) == sizeof(header);
+  for (size_t i = 0; success && i < desc.levelCount; ++i)
+  {
+    qint64 size = static_cast<qint64>(desc.levels[i].size);
+    success =
+      Karma::writeFilePadding(file, header.levels[i].offset) &&
+      file.write(static_cast<char const*>(desc.levels[i].data), size) == size;
+  }
+  file.close();
+
+  // Never leave a partial file behind, it would only fail validation later.
+  if (!success) QFile::remove(fileName);
+  return success;
+}
+
+bool KTextureFile::map(QString const &fileName, Format format, uint32_t method, uint64_t sourceHash)
+{
+  P(KTextureFilePrivate);
+  unmap();
+
+  p.m_file.setFileName(fileName);
+  if (!p.m_file.open(QFile::ReadOnly)) return false;
+  qint64 fileSize = p.m_file.size();
+  if (fileSize < static_cast<qint64>(sizeof(KTextureFileHeader)))
+  {
+    p.m_file.close();
+    return false;
+  }
+
+  p.m_mapping = p.m_file.map(0, fileSize);
+  if (!p.m_mapping)
+  {
+    p.m_file.close();
+    return false;
+  }
+
+  // Validate before handing out any pointers into the mapping.
+  KTextureFileHeader const *header = reinterpret_cast<KTextureFileHeader const*>(p.m_mapping);
+  bool valid =
+    std::memcmp(header->magic, KTextureFileMagic, sizeof(header->magic)) == 0 &&
+    header->version == KTextureFileVersion &&
+    header->format == static_cast<uint32_t>(format) &&
+    header->method == method &&
+    header->sourceHash == sourceHash &&
+    header->fileSize == static_cast<uint64_t>(fileSize) &&
+    header->levelCount > 0 && header->levelCount <= MaxLevels;
+  for (uint64_t i = 0; valid && i < header->levelCount; ++i)
+  {
+    KTextureFileLevel const &level = header->levels[i];
+    valid =
+      level.offset >= sizeof(KTextureFileHeader) &&
+      level.offset % Karma::MappedFileAlignment == 0 &&
+      Karma::fileSectionFits(level.offset, level.size, 1, header->fileSize) &&
+      level.size != 0 && level.size == levelSize(format, level.width, level.height, header->faces);
+  }
+  if (!valid)
+  {
+    unmap();
+    return false;
+  }
+
+  // Fix up the level pointers, nothing else has to be touched.
+  Description &desc = p.m_desc;
+  desc.format = format;
+  desc.method = method;
+  desc.sourceHash = sourceHash;
+  desc.faces = header->faces;
+  desc.levelCount = header->levelCount;
+  for (size_t i = 0; i < desc.levelCount; ++i)
+  {
+    desc.levels[i].width = header->levels[i].width;
+    desc.levels[i].height = header->levels[i].height;
+    desc.levels[i].data = p.m_mapping + header->levels[i].offset;
+    desc.levels[i].size = header->levels[i].size;
+  }
+  return true;
+}
+
+void KTextureFile::unmap()
+{
+  P(KTextureFilePrivate);
+  if (p.m_mapping)
+  {
+    p.m_file.unmap(p.m_mapping);
+    p.m_mapping = Q_NULLPTR;
+  }
+  if (p.m_file.isOpen())
+  {
+    p.m_file.close();
+  }
+  std::memset(&p.m_desc, 0, sizeof(p.m_desc));
+}
+
+bool KTextureFile::isMapped() const
+{
+  P(const KTextureFilePrivate);
+  return (p.m_mapping != Q_NULLPTR);
+}
+
+KTextureFile::Description const &KTextureFile::description() const
+{
+  P(const KTextureFilePrivate);
+  return p.m_desc;
+}
+
+uint64_t KTextureFile::levelSize(Format format, uint32_t width, uint32_t height, uint32_t faces)
+{
+  if (faces == 0 || faces > MaxFaces) return 0;
+  uint64_t texels = uint64_t(width) * height * faces;
+  switch (format)
+  {
+  case Bc6hUnsignedFormat:
+    return ((uint64_t(width) + 3) / 4) * ((uint64_t(height) + 3) / 4) * faces * 16;
+  case EnvironmentBakeFormat:
+    return texels * 3 * sizeof(float);
+  case BrdfLookupFormat:
+    return texels * 2 * sizeof(float);
+  }
+  return 0;
+}
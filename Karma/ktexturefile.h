@@ -0,0 +1,70 @@
+#ifndef KTEXTUREFILE_H
+#define KTEXTUREFILE_H KTextureFile
+
+#include <cstddef>
+#include <cstdint>
+#include <QScopedPointer>
+class QString;
+
+class KTextureFilePrivate;
+class KTextureFile
+{
+public:
+  enum Format
+  {
+    Bc6hUnsignedFormat = 1,
+    EnvironmentBakeFormat = 2,
+    BrdfLookupFormat = 3
+  };
+
+  enum
+  {
+    MaxLevels = 16,
+    MaxFaces = 6
+  };
+
+  // Mip levels are stored back to back (largest first) behind a versioned
+  // header, each level holds all faces back to back. The method is format
+  // specific (e.g. the encoder quality).
+  // Bc6hUnsignedFormat levels are 16 byte blocks of 4x4 texels.
+  // EnvironmentBakeFormat levels are RGB floats, see KEnvironmentBaker.
+  // BrdfLookupFormat is a single level of RG floats, see OpenGLBrdfLookup.
+  struct Level
+  {
+    uint32_t width;
+    uint32_t height;
+    void const *data;
+    size_t size;
+  };
+
+  struct Description
+  {
+    Format format;
+    uint32_t method;
+    uint64_t sourceHash;
+    uint32_t faces;
+    size_t levelCount;
+    Level levels[MaxLevels];
+  };
+
+  KTextureFile();
+  ~KTextureFile();
+
+  // Writing
+  static bool write(QString const &fileName, Description const &desc);
+
+  // Reading (Note: Levels point into the mapping, keep this object alive)
+  // Every level lies within the file and has the size of its format.
+  bool map(QString const &fileName, Format format, uint32_t method, uint64_t sourceHash);
+  void unmap();
+  bool isMapped() const;
+  Description const &description() const;
+
+  // Bytes of a level of the format, 0 for unknown formats.
+  static uint64_t levelSize(Format format, uint32_t width, uint32_t height, uint32_t faces);
+
+private:
+  QScopedPointer<KTextureFilePrivate> m_private;
+};
+
+#endif // KTEXTUREFILE_H
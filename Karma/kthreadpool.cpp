@@ -0,0 +1,265 @@
+#include "kthreadpool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <KMacros>
+
+/*******************************************************************************
+ * KThreadPoolQueue
+ ******************************************************************************/
+class KThreadPoolQueue
+{
+public:
+  typedef KThreadPool::Task Task;
+  void pushBack(Task const &task);
+  bool popBack(Task *task);
+  bool popFront(Task *task);
+private:
+  std::mutex m_mutex;
+  std::deque<Task> m_tasks;
+};
+
+void KThreadPoolQueue::pushBack(Task const &task)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_tasks.push_back(task);
+}
+
+bool KThreadPoolQueue::popBack(Task *task)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_tasks.empty()) return false;
+  (*task) = std::move(m_tasks.back());
+  m_tasks.pop_back();
+  return true;
+}
+
+bool KThreadPoolQueue::popFront(Task *task)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_tasks.empty()) return false;
+  (*task) = std::move(m_tasks.front());
+  m_tasks.pop_front();
+  return true;
+}
+
+/*******************************************************************************
+ * KThreadPoolPrivate
+ ******************************************************************************/
+class KThreadPoolPrivate;
+static thread_local KThreadPoolPrivate *sg_currentPool = nullptr;
+static thread_local size_t sg_currentWorker = 0;
+
+class KThreadPoolPrivate
+{
+public:
+  typedef KThreadPool::Task Task;
+
+  KThreadPoolPrivate(size_t threadCount);
+  ~KThreadPoolPrivate();
+  void startWorkers(size_t threadCount);
+  void stopWorkers();
+  size_t currentQueue() const;
+  void enqueue(Task const &task);
+  bool dequeue(size_t queue, Task *task);
+  bool runTask(size_t queue);
+  void workerLoop(size_t worker);
+
+  size_t m_threadCount;
+  size_t m_workerCount;
+  std::vector<std::thread> m_workers;
+  std::vector<KThreadPoolQueue*> m_queues;
+  std::mutex m_sleepMutex;
+  std::condition_variable m_wake;
+  std::atomic<int> m_pending;
+  bool m_quit;
+};
+
+KThreadPoolPrivate::KThreadPoolPrivate(size_t threadCount) :
+  m_threadCount(0), m_workerCount(0), m_pending(0), m_quit(false)
+{
+  startWorkers(threadCount);
+}
+
+KThreadPoolPrivate::~KThreadPoolPrivate()
+{
+  stopWorkers();
+}
+
+void KThreadPoolPrivate::startWorkers(size_t threadCount)
+{
+  if (threadCount == 0) threadCount = KThreadPool::idealThreadCount();
+  m_threadCount = threadCount;
+  m_quit = false;
+
+  // One queue per worker, plus a shared injection queue for outside threads.
+  // Note: Queues must be fully set up before the first worker starts.
+  m_workerCount = threadCount - 1;
+  for (size_t i = 0; i <= m_workerCount; ++i)
+  {
+    m_queues.push_back(new KThreadPoolQueue);
+  }
+  m_workers.reserve(m_workerCount);
+  for (size_t i = 0; i < m_workerCount; ++i)
+  {
+    m_workers.emplace_back(&KThreadPoolPrivate::workerLoop, this, i);
+  }
+}
+
+void KThreadPoolPrivate::stopWorkers()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_sleepMutex);
+    m_quit = true;
+  }
+  m_wake.notify_all();
+  for (std::thread &worker : m_workers)
+  {
+    worker.join();
+  }
+  for (KThreadPoolQueue *queue : m_queues)
+  {
+    delete queue;
+  }
+  m_workers.clear();
+  m_queues.clear();
+  m_workerCount = 0;
+  m_pending = 0;
+}
+
+size_t KThreadPoolPrivate::currentQueue() const
+{
+  // Workers own a queue, everyone else shares the injection queue (last).
+  if (sg_currentPool == this) return sg_currentWorker;
+  return m_workerCount;
+}
+
+void KThreadPoolPrivate::enqueue(Task const &task)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_sleepMutex);
+    ++m_pending;
+  }
+  m_queues[currentQueue()]->pushBack(task);
+  m_wake.notify_one();
+}
+
+bool KThreadPoolPrivate::dequeue(size_t queue, Task *task)
+{
+  size_t workerCount = m_workerCount;
+
+  // Local work is taken LIFO (depth-first, cache-warm)
+  if (queue < workerCount && m_queues[queue]->popBack(task))
+  {
+    --m_pending;
+    return true;
+  }
+
+  // Work submitted from outside of the pool
+  if (m_queues[workerCount]->popFront(task))
+  {
+    --m_pending;
+    return true;
+  }
+
+  // Steal FIFO from the other workers (oldest tasks are the largest)
+  for (size_t i = 1; i <= workerCount; ++i)
+  {
+    size_t victim = (queue + i) % workerCount;
+    if (victim != queue && m_queues[victim]->popFront(task))
+    {
+      --m_pending;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool KThreadPoolPrivate::runTask(size_t queue)
+{
+  Task task;
+  if (!dequeue(queue, &task)) return false;
+  task();
+  return true;
+}
+
+void KThreadPoolPrivate::workerLoop(size_t worker)
+{
+  sg_currentPool = this;
+  sg_currentWorker = worker;
+  for (;;)
+  {
+    if (runTask(worker)) continue;
+    std::unique_lock<std::mutex> lock(m_sleepMutex);
+    m_wake.wait(lock, [this]() { return m_quit || m_pending > 0; });
+    if (m_quit) break;
+  }
+  sg_currentPool = nullptr;
+}
+
+/*******************************************************************************
+ * KThreadPool
+ ******************************************************************************/
+KThreadPool::KThreadPool(size_t threadCount) :
+  m_private(new KThreadPoolPrivate(threadCount))
+{
+  // Intentionally Empty
+}
+
+KThreadPool::~KThreadPool()
+{
+  // Intentionally Empty
+}
+
+KThreadPool *KThreadPool::globalInstance()
+{
+  static KThreadPool sg_globalPool;
+  return &sg_globalPool;
+}
+
+size_t KThreadPool::idealThreadCount()
+{
+  size_t count = std::thread::hardware_concurrency();
+  return (count == 0) ? 1 : count;
+}
+
+size_t KThreadPool::threadCount() const
+{
+  P(const KThreadPoolPrivate);
+  return p.m_threadCount;
+}
+
+void KThreadPool::setThreadCount(size_t count)
+{
+  P(KThreadPoolPrivate);
+  if (count == 0) count = idealThreadCount();
+  if (count == p.m_threadCount) return;
+  p.stopWorkers();
+  p.startWorkers(count);
+}
+
+void KThreadPool::start(Task const &task)
+{
+  P(KThreadPoolPrivate);
+
+  // With a single thread, tasks run inline on the caller.
+  if (p.m_workerCount == 0)
+  {
+    task();
+    return;
+  }
+  p.enqueue(task);
+}
+
+bool KThreadPool::tryRunPendingTask()
+{
+  P(KThreadPoolPrivate);
+  if (p.m_workerCount == 0) return false;
+  return p.runTask(p.currentQueue());
+}
@@ -0,0 +1,33 @@
+#ifndef KTHREADPOOL_H
+#define KTHREADPOOL_H KThreadPool
+
+#include <cstddef>
+#include <functional>
+#include <QScopedPointer>
+
+class KThreadPoolPrivate;
+class KThreadPool
+{
+public:
+  typedef std::function<void()> Task;
+
+  // Note: A thread count of N spawns N-1 workers, the calling thread is
+  //       expected to help out while it waits (see KTaskGroup::wait()).
+  explicit KThreadPool(size_t threadCount = 0);
+  ~KThreadPool();
+  static KThreadPool *globalInstance();
+  static size_t idealThreadCount();
+
+  // Configuration (Only change the thread count while the pool is idle)
+  size_t threadCount() const;
+  void setThreadCount(size_t count);
+
+  // Scheduling
+  void start(Task const &task);
+  bool tryRunPendingTask();
+
+private:
+  QScopedPointer<KThreadPoolPrivate> m_private;
+};
+
+#endif // KTHREADPOOL_H
@@ -0,0 +1,28 @@
+#-------------------------------------------------
+#
+# Benchmarks and tolerance checks, needs KARMA_BENCHMARK (see config.pri).
+#
+#-------------------------------------------------
+
+TEMPLATE  = app
+CONFIG   -= app_bundle
+CONFIG   += console
+QT       += core gui
+TARGET    = KarmaBenchmark
+include(../config.pri)
+
+LIBS += $${KARMA_LIB}
+LIBS += $${OPENGL_LIB}
+LIBS += $${QTBASEEXT_LIB}
+
+PRE_TARGETDEPS += $${KARMA_DEP}
+PRE_TARGETDEPS += $${OPENGL_DEP}
+PRE_TARGETDEPS += $${QTBASEEXT_DEP}
+
+SOURCES += \
+    main.cpp \
+    texturebenchmarks.cpp \
+    lightingbenchmarks.cpp
+
+HEADERS += \
+    benchmarks.h
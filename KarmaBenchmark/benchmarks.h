@@ -0,0 +1,27 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H Benchmarks
+
+#include <vector>
+struct RgbF;
+
+// Every benchmark logs its timings and returns false when a result is out of
+// tolerance, which makes KarmaBenchmark exit with a failure.
+
+// Synthetic environment: smooth sky, hard edged windows and a bright sun
+std::vector<RgbF> syntheticEnvironment(int width, int height);
+
+// Radiance file (new-style RLE scanlines) of an equirect map, rows top-down.
+std::vector<unsigned char> encodeHdr(RgbF const *rgb, int width, int height);
+
+// Texture Benchmarks
+bool benchmarkHdrDecoding();
+bool benchmarkToneMapping();
+bool benchmarkHdrPacking();
+bool benchmarkBc6h();
+bool benchmarkCubeMapping();
+
+// Lighting Benchmarks
+bool benchmarkEnvironmentBaking();
+bool benchmarkBrdfLookup();
+
+#endif // BENCHMARKS_H
@@ -0,0 +1,266 @@
+#include "benchmarks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <KDebug>
+#include <KElapsedTimer>
+#include <KEnvironmentBaker>
+#include <OpenGLAbstractLightGroup>
+#include <OpenGLBrdfLookup>
+#include <OpenGLToneMappingFunction>
+
+static const float Pi = 3.14159265358979f;
+static const float Pi2 = 6.28318530717959f;
+
+/*******************************************************************************
+ * Environment Baking
+ ******************************************************************************/
+
+// Same basis as the baker and environment.frag.
+static void evaluateSh(float const d[3], float basis[KEnvironmentBaker::ShCoefficients])
+{
+  basis[0] = 0.282095f;
+  basis[1] = 0.488603f * d[1];
+  basis[2] = 0.488603f * d[2];
+  basis[3] = 0.488603f * d[0];
+  basis[4] = 1.092548f * d[0] * d[1];
+  basis[5] = 1.092548f * d[1] * d[2];
+  basis[6] = 0.315392f * (3.0f * d[2] * d[2] - 1.0f);
+  basis[7] = 1.092548f * d[0] * d[2];
+  basis[8] = 0.546274f * (d[0] * d[0] - d[1] * d[1]);
+}
+
+static void irradiance(KEnvironmentBaker const &baker, float const d[3], float rgb[3])
+{
+  float basis[KEnvironmentBaker::ShCoefficients];
+  evaluateSh(d, basis);
+  rgb[0] = rgb[1] = rgb[2] = 0.0f;
+  for (int i = 0; i < KEnvironmentBaker::ShCoefficients; ++i)
+  {
+    for (int c = 0; c < 3; ++c) rgb[c] += basis[i] * baker.irradiance()[i][c];
+  }
+}
+
+// Direction of a texel center, like InvSphereMap() in Math.glsl.
+static void texelDirection(int x, int y, int width, int height, float d[3])
+{
+  float alpha = Pi2 * (0.5f - (float(x) + 0.5f) / float(width));
+  float theta = Pi * (float(y) + 0.5f) / float(height);
+  d[0] = std::cos(alpha) * std::sin(theta);
+  d[1] = std::sin(alpha) * std::sin(theta);
+  d[2] = std::cos(theta);
+}
+
+// Map of the given radiance function of the direction.
+template <typename F>
+static std::vector<float> analyticEnvironment(int width, int height, F radiance)
+{
+  std::vector<float> rgb(3 * size_t(width) * height);
+  float d[3];
+  for (int y = 0; y < height; ++y)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      texelDirection(x, y, width, height, d);
+      radiance(d, &rgb[3 * (size_t(y) * width + x)]);
+    }
+  }
+  return rgb;
+}
+
+static float relativeError(float value, float expected)
+{
+  return std::abs(value - expected) / std::max(std::abs(expected), 1e-6f);
+}
+
+// Largest relative error of the irradiance over the level 0 texel directions.
+template <typename F>
+static float irradianceError(KEnvironmentBaker const &baker, F expected)
+{
+  KEnvironmentBaker::Level const &level = baker.level(0);
+  float d[3], value[3], reference[3], error = 0.0f;
+  for (int y = 0; y < level.height; ++y)
+  {
+    for (int x = 0; x < level.width; ++x)
+    {
+      texelDirection(x, y, level.width, level.height, d);
+      irradiance(baker, d, value);
+      expected(d, reference);
+      for (int c = 0; c < 3; ++c) error = std::max(error, relativeError(value[c], reference[c]));
+    }
+  }
+  return error;
+}
+
+// Largest relative error of a prefiltered level.
+template <typename F>
+static float levelError(KEnvironmentBaker const &baker, int i, F expected)
+{
+  KEnvironmentBaker::Level const &level = baker.level(i);
+  float d[3], reference[3], error = 0.0f;
+  for (int y = 0; y < level.height; ++y)
+  {
+    for (int x = 0; x < level.width; ++x)
+    {
+      texelDirection(x, y, level.width, level.height, d);
+      expected(d, reference);
+      float const *value = &level.rgb[3 * (size_t(y) * level.width + x)];
+      for (int c = 0; c < 3; ++c) error = std::max(error, relativeError(value[c], reference[c]));
+    }
+  }
+  return error;
+}
+
+// A constant environment has constant irradiance (Pi times the radiance) and
+// constant prefiltered levels. A linear one (1 + z) is exact in the first two
+// SH bands, its irradiance is Pi + 2 Pi / 3 * z and its mirror level is itself.
+bool benchmarkEnvironmentBaking()
+{
+  static const int Width = 512;
+  static const int Height = 256;
+  static const float ShTolerance = 1e-3f;
+  static const float ConstantTolerance = 1e-3f;
+  static const float MirrorTolerance = 5e-3f;
+  static const float Constant[3] = { 1.0f, 2.0f, 0.5f };
+
+  bool passed = true;
+  float error;
+  KEnvironmentBaker baker;
+  kDebug() << "Environment Baking | Environment | Check | Max Error";
+
+  std::vector<float> constant = analyticEnvironment(Width, Height, [](float const *, float *rgb)
+  {
+    for (int c = 0; c < 3; ++c) rgb[c] = Constant[c];
+  });
+  baker.bake(constant.data(), Width, Height);
+  error = irradianceError(baker, [](float const *, float *rgb)
+  {
+    for (int c = 0; c < 3; ++c) rgb[c] = Pi * Constant[c];
+  });
+  kDebug() << "Constant | Irradiance |" << error;
+  if (!(error <= ShTolerance))
+  {
+    qCritical("KarmaBenchmark: Irradiance of a constant environment is off by %g (tolerance %g).", error, ShTolerance);
+    passed = false;
+  }
+  error = 0.0f;
+  for (int i = 0; i < baker.levelCount(); ++i)
+  {
+    error = std::max(error, levelError(baker, i, [](float const *, float *rgb)
+    {
+      for (int c = 0; c < 3; ++c) rgb[c] = Constant[c];
+    }));
+  }
+  kDebug() << "Constant | Prefiltered |" << error;
+  if (!(error <= ConstantTolerance))
+  {
+    qCritical("KarmaBenchmark: Prefiltering a constant environment is off by %g (tolerance %g).", error, ConstantTolerance);
+    passed = false;
+  }
+
+  std::vector<float> linear = analyticEnvironment(Width, Height, [](float const *d, float *rgb)
+  {
+    for (int c = 0; c < 3; ++c) rgb[c] = 1.0f + d[2];
+  });
+  baker.bake(linear.data(), Width, Height);
+  error = irradianceError(baker, [](float const *d, float *rgb)
+  {
+    for (int c = 0; c < 3; ++c) rgb[c] = Pi + 2.0f * Pi / 3.0f * d[2];
+  });
+  kDebug() << "Linear | Irradiance |" << error;
+  if (!(error <= ShTolerance))
+  {
+    qCritical("KarmaBenchmark: Irradiance of a linear environment is off by %g (tolerance %g).", error, ShTolerance);
+    passed = false;
+  }
+  error = levelError(baker, 0, [](float const *d, float *rgb)
+  {
+    for (int c = 0; c < 3; ++c) rgb[c] = 1.0f + d[2];
+  });
+  kDebug() << "Linear | Mirror Level |" << error;
+  if (!(error <= MirrorTolerance))
+  {
+    qCritical("KarmaBenchmark: The mirror level of a linear environment is off by %g (tolerance %g).", error, MirrorTolerance);
+    passed = false;
+  }
+
+  // Timing on the synthetic environment
+  static const int BakeWidth = 2048;
+  static const int BakeHeight = 1024;
+  std::vector<RgbF> source = syntheticEnvironment(BakeWidth, BakeHeight);
+  float const *rgb = &source[0].r;
+  float sh[KEnvironmentBaker::ShCoefficients][3];
+  KElapsedTimer timer;
+  timer.start();
+  KEnvironmentBaker::projectIrradiance(rgb, BakeWidth, BakeHeight, sh);
+  quint64 projectMs = timer.elapsed();
+  timer.start();
+  baker.bake(rgb, BakeWidth, BakeHeight);
+  quint64 bakeMs = timer.elapsed();
+  kDebug() << "Environment Baking | Source | Irradiance (sec) | Full Bake (sec)";
+  kDebug() << BakeWidth << "x" << BakeHeight << "|" << float(projectMs) / 1e3f << "|" << float(bakeMs) / 1e3f;
+  return passed;
+}
+
+/*******************************************************************************
+ * BRDF Lookup
+ ******************************************************************************/
+
+// Geometry factors which never exceed 1, so no table of theirs may reflect
+// more than it receives. The Beckmann fits overshoot at grazing angles.
+static bool isBounded(int g)
+{
+  switch (g)
+  {
+  case GSmithBeckmann:
+  case GSmithSchlickBeckmann:
+    return false;
+  }
+  return true;
+}
+
+// Every table must be finite, reflect everything at the smoothest texel
+// facing the viewer, and conserve energy for the bounded geometry factors.
+bool benchmarkBrdfLookup()
+{
+  static const size_t Texels = OpenGLBrdfLookup::Size * OpenGLBrdfLookup::Size;
+  static const float MirrorTolerance = 3e-2f;
+  static const float EnergyTolerance = 1e-2f;
+
+  bool passed = true;
+  KElapsedTimer timer;
+  std::vector<float> rg(2 * Texels);
+  kDebug() << "BRDF Lookup | Fresnel | Geometry | Distribution | Integrate (ms) | Mirror | Max Energy";
+  for (int f = 0; f < FresnelCount; ++f)
+  {
+    for (int g = 0; g < GeometryCount; ++g)
+    {
+      for (int s = 0; s < DistributionCount; ++s)
+      {
+        timer.start();
+        OpenGLBrdfLookup::integrate(f, g, s, rg.data());
+        quint64 ms = timer.elapsed();
+
+        size_t nonFinite = 0;
+        float energy = 0.0f;
+        for (size_t i = 0; i < Texels; ++i)
+        {
+          if (!std::isfinite(rg[2 * i]) || !std::isfinite(rg[2 * i + 1])) ++nonFinite;
+          energy = std::max(energy, rg[2 * i] + rg[2 * i + 1]);
+        }
+        float const *mirror = &rg[2 * (OpenGLBrdfLookup::Size - 1)];
+        float mirrorEnergy = mirror[0] + mirror[1];
+
+        kDebug() << FToCStr(f).c_str() << "|" << GToCStr(g).c_str() << "|" << DToCStr(s).c_str() << "|" << ms << "|" << mirrorEnergy << "|" << energy;
+        if (nonFinite || !(std::abs(mirrorEnergy - 1.0f) <= MirrorTolerance) || (isBounded(g) && !(energy <= 1.0f + EnergyTolerance)))
+        {
+          qCritical("KarmaBenchmark: BRDF lookup %s %s %s is out of tolerance (%u non-finite, mirror %g, max energy %g).",
+                    FToCStr(f).c_str(), GToCStr(g).c_str(), DToCStr(s).c_str(), unsigned(nonFinite), mirrorEnergy, energy);
+          passed = false;
+        }
+      }
+    }
+  }
+  return passed;
+}
@@ -0,0 +1,138 @@
+#include "benchmarks.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <QDebug>
+#include <QGuiApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QSurfaceFormat>
+#include <OpenGLFunctions>
+#include <OpenGLMarkerRegistry>
+#include <OpenGLProfiler>
+
+#ifdef    KARMA_BENCHMARK
+// Counts every allocation of the process, checks read it around a section
+// which must not allocate.
+static std::atomic<size_t> sg_allocations(0);
+
+void *operator new(size_t size)
+{
+  ++sg_allocations;
+  void *ptr = std::malloc(size ? size : 1);
+  if (!ptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void *ptr) noexcept
+{
+  std::free(ptr);
+}
+
+static QSurfaceFormat benchmarkFormat()
+{
+  QSurfaceFormat format;
+#if defined(QT_OPENGL_ES)
+  format.setRenderableType(QSurfaceFormat::OpenGLES);
+  format.setVersion(3,0);
+#else
+  format.setRenderableType(QSurfaceFormat::OpenGL);
+  format.setProfile(QSurfaceFormat::CoreProfile);
+  format.setVersion(4,3);
+#endif
+  return format;
+}
+
+// Once warmed up, recording a frame must not allocate, neither with markers
+// past the capacity of a frame nor with results being read.
+static bool benchmarkProfilerAllocations()
+{
+  static const unsigned WarmupFrames = 4 * OpenGLProfiler::MaxLatency;
+  static const unsigned CheckedFrames = 600;
+  static const unsigned MarkersPerFrame = OpenGLProfiler::MaxCpuMarkers + 64;
+
+  OpenGLProfiler profiler;
+  if (!profiler.initialize())
+  {
+    qWarning("KarmaBenchmark: No timer queries, skipping profiler allocations.");
+    return true;
+  }
+  OpenGLMarkerId gpuMarker = OPENGL_MARKER_ID("Benchmark GPU Marker");
+  OpenGLMarkerId cpuMarker = OPENGL_MARKER_ID("Benchmark CPU Marker");
+
+  size_t allocations = 0;
+  for (unsigned frame = 0; frame < WarmupFrames + CheckedFrames; ++frame)
+  {
+    if (frame == WarmupFrames) allocations = sg_allocations;
+    profiler.beginFrame();
+    for (unsigned i = 0; i < MarkersPerFrame; ++i)
+    {
+      profiler.pushGpuMarker(gpuMarker);
+      profiler.pushCpuMarker(cpuMarker);
+      profiler.popCpuMarker();
+      profiler.popGpuMarker();
+    }
+    profiler.endFrame();
+    GL::glFlush();
+  }
+  allocations = sg_allocations - allocations;
+
+  qDebug() << "KarmaBenchmark: Profiler allocations over" << CheckedFrames << "frames:" << allocations << "(" << profiler.droppedMarkers() << "markers dropped )";
+  if (allocations)
+  {
+    qCritical("KarmaBenchmark: The profiler allocated while recording frames.");
+    return false;
+  }
+  return true;
+}
+#endif // KARMA_BENCHMARK
+
+int main(int argc, char *argv[])
+{
+  QGuiApplication app(argc, argv);
+#ifdef    KARMA_BENCHMARK
+  // Benchmarks get a context of their own, nothing renders with it.
+  QOffscreenSurface surface;
+  surface.setFormat(benchmarkFormat());
+  surface.create();
+  QOpenGLContext context;
+  context.setFormat(surface.format());
+  if (!context.create() || !context.makeCurrent(&surface))
+  {
+    qCritical("KarmaBenchmark: Failed to create an OpenGL context.");
+    return 1;
+  }
+
+  OpenGLFunctions functions;
+  functions.initializeOpenGLFunctions();
+  GL::setInstance(&functions);
+  std::vector<char const*> missing;
+  if (!GL::resolve(&context, &missing))
+  {
+    QByteArray names;
+    for (char const *name : missing)
+    {
+      names.append(' ').append(name);
+    }
+    qCritical("KarmaBenchmark: The context is missing required entry points:%s", names.constData());
+    return 1;
+  }
+
+  GL::benchmark();
+  bool passed = benchmarkProfilerAllocations();
+  passed &= benchmarkHdrDecoding();
+  passed &= benchmarkToneMapping();
+  passed &= benchmarkHdrPacking();
+  passed &= benchmarkBc6h();
+  passed &= benchmarkCubeMapping();
+  passed &= benchmarkEnvironmentBaking();
+  passed &= benchmarkBrdfLookup();
+  context.doneCurrent();
+  return passed ? 0 : 1;
+#else
+  qWarning("KarmaBenchmark: Built without KARMA_BENCHMARK, nothing to run (see config.pri).");
+  return 0;
+#endif // KARMA_BENCHMARK
+}
@@ -0,0 +1,721 @@
+#include "benchmarks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <KAbstractHdrParser>
+#include <KAbstractReader>
+#include <KBc6hEncoder>
+#include <KDebug>
+#include <KElapsedTimer>
+#include <KMatrix4x4>
+#include <KThreadPool>
+#include <OpenGLAbstractLightGroup>
+#include <OpenGLBindings>
+#include <OpenGLBrdfLookup>
+#include <OpenGLCubeMapping>
+#include <OpenGLEnvironment>
+#include <OpenGLFramebufferObject>
+#include <OpenGLFunctions>
+#include <OpenGLHdrPacking>
+#include <OpenGLMesh>
+#include <OpenGLRenderBlock>
+#include <OpenGLShaderProgram>
+#include <OpenGLTexture>
+#include <OpenGLToneMappingFunction>
+#include <QOpenGLContext>
+#include <QFile>
+#include <QTemporaryDir>
+
+/*******************************************************************************
+ * Synthetic Images
+ ******************************************************************************/
+std::vector<RgbF> syntheticEnvironment(int width, int height)
+{
+  std::vector<RgbF> source;
+  source.reserve(size_t(width) * height);
+  for (int y = 0; y < height; ++y)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      float sky = std::exp(2.0f * std::sin(x * 0.013f) * std::cos(y * 0.021f));
+      float window = ((x / 37 + y / 23) % 2) ? 4.0f : 0.25f;
+      float sun = (std::abs(x - width * 2 / 3) < 12 && std::abs(y - height / 6) < 12) ? 50.0f : 0.0f;
+      source.push_back(RgbF(sky * window + sun, 0.7f * sky * window + sun, 0.4f * sky + 0.1f * window + sun));
+    }
+  }
+  return source;
+}
+
+static void encodeRgbe(RgbF const &color, unsigned char *rgbe)
+{
+  float value = std::max(color.r, std::max(color.g, color.b));
+  if (value < 1e-32f)
+  {
+    rgbe[0] = rgbe[1] = rgbe[2] = rgbe[3] = 0;
+    return;
+  }
+  int exponent;
+  float scale = std::frexp(value, &exponent) * 256.0f / value;
+  rgbe[0] = static_cast<unsigned char>(color.r * scale);
+  rgbe[1] = static_cast<unsigned char>(color.g * scale);
+  rgbe[2] = static_cast<unsigned char>(color.b * scale);
+  rgbe[3] = static_cast<unsigned char>(exponent + 128);
+}
+
+// Runs of 4 or more equal bytes are repeated, everything else is literal.
+static void encodeRle(unsigned char const *bytes, int count, std::vector<unsigned char> &out)
+{
+  int x = 0;
+  while (x < count)
+  {
+    int run = 1;
+    while (x + run < count && run < 127 && bytes[x + run] == bytes[x]) ++run;
+    if (run >= 4)
+    {
+      out.push_back(static_cast<unsigned char>(128 + run));
+      out.push_back(bytes[x]);
+      x += run;
+      continue;
+    }
+
+    int begin = x;
+    while (x < count && x - begin < 128)
+    {
+      run = 1;
+      while (x + run < count && run < 4 && bytes[x + run] == bytes[x]) ++run;
+      if (run >= 4) break;
+      ++x;
+    }
+    out.push_back(static_cast<unsigned char>(x - begin));
+    out.insert(out.end(), bytes + begin, bytes + x);
+  }
+}
+
+std::vector<unsigned char> encodeHdr(RgbF const *rgb, int width, int height)
+{
+  char header[128];
+  std::snprintf(header, sizeof(header), "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y %d +X %d\n", height, width);
+  std::vector<unsigned char> file(header, header + std::strlen(header));
+
+  // Every scanline stores the four channels as separate planes.
+  std::vector<unsigned char> planes(4 * width);
+  unsigned char rgbe[4];
+  for (int y = 0; y < height; ++y)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      encodeRgbe(rgb[size_t(y) * width + x], rgbe);
+      for (int channel = 0; channel < 4; ++channel)
+      {
+        planes[channel * width + x] = rgbe[channel];
+      }
+    }
+    file.push_back(2);
+    file.push_back(2);
+    file.push_back(static_cast<unsigned char>(width >> 8));
+    file.push_back(static_cast<unsigned char>(width & 0xFF));
+    for (int channel = 0; channel < 4; ++channel)
+    {
+      encodeRle(&planes[channel * width], width, file);
+    }
+  }
+  return file;
+}
+
+/*******************************************************************************
+ * HDR Decoding
+ ******************************************************************************/
+
+// Reads a file held in memory, either one character at a time (like a
+// buffered file) or also exposing all of it (like a mapped file).
+class MemoryReader : public KAbstractReader
+{
+public:
+  MemoryReader(std::vector<unsigned char> const &bytes, bool mapped) :
+    m_bytes(bytes), m_position(0), m_mapped(mapped)
+  {
+    // Intentionally Empty
+  }
+  int next()
+  {
+    if (m_position == m_bytes.size()) return EndOfFile;
+    return m_bytes[m_position++];
+  }
+  unsigned char const *data() const
+  {
+    return m_mapped ? m_bytes.data() : 0;
+  }
+  size_t size() const
+  {
+    return m_mapped ? m_bytes.size() : 0;
+  }
+  size_t position() const
+  {
+    return m_mapped ? m_position : 0;
+  }
+private:
+  std::vector<unsigned char> const &m_bytes;
+  size_t m_position;
+  bool m_mapped;
+};
+
+class HdrDecoder : public KAbstractHdrParser
+{
+public:
+  HdrDecoder(KAbstractReader *reader) :
+    KAbstractHdrParser(reader)
+  {
+    // Intentionally Empty
+  }
+  std::vector<float> rgb;
+protected:
+  void onKeyValue(char const *, char const *)
+  {
+    // Intentionally Empty
+  }
+  void onResolution(PixelOrder, PixelOrder, int width, int height)
+  {
+    rgb.resize(3 * size_t(width) * height);
+  }
+  float *beginData()
+  {
+    return rgb.data();
+  }
+  void endData()
+  {
+    // Intentionally Empty
+  }
+};
+
+// Both paths must match ldexp() bit for bit, mapped files decode in parallel.
+bool benchmarkHdrDecoding()
+{
+  static const int Width = 2048;
+  static const int Height = 1024;
+
+  std::vector<RgbF> source = syntheticEnvironment(Width, Height);
+  std::vector<unsigned char> file = encodeHdr(source.data(), Width, Height);
+
+  // Scanlines come out bottom-up (-Y), ready for upload.
+  std::vector<float> reference(3 * source.size());
+  unsigned char rgbe[4];
+  for (int y = 0; y < Height; ++y)
+  {
+    float *dest = &reference[3 * size_t(Height - y - 1) * Width];
+    for (int x = 0; x < Width; ++x)
+    {
+      encodeRgbe(source[size_t(y) * Width + x], rgbe);
+      float scale = rgbe[3] ? std::ldexp(1.0f, int(rgbe[3]) - (128 + 8)) : 0.0f;
+      for (int channel = 0; channel < 3; ++channel)
+      {
+        dest[3 * x + channel] = rgbe[channel] * scale;
+      }
+    }
+  }
+
+  bool passed = true;
+  KElapsedTimer timer;
+  kDebug() << "HDR Decoding | Reader | Decode (sec) | MPix/s | Mismatches";
+  for (int mapped = 0; mapped < 2; ++mapped)
+  {
+    MemoryReader reader(file, mapped != 0);
+    HdrDecoder decoder(&reader);
+    timer.start();
+    decoder.parse();
+    quint64 ms = std::max<quint64>(timer.elapsed(), 1);
+    size_t mismatches = 0;
+    if (decoder.rgb.size() != reference.size())
+    {
+      mismatches = reference.size();
+    }
+    else
+    {
+      for (size_t i = 0; i < reference.size(); ++i)
+      {
+        if (std::memcmp(&decoder.rgb[i], &reference[i], sizeof(float)) != 0) ++mismatches;
+      }
+    }
+    kDebug() << (mapped ? "Mapped" : "Buffered") << "|" << float(ms) / 1e3f << "|" << float(source.size()) / (float(ms) * 1e3f) << "|" << mismatches;
+    if (mismatches)
+    {
+      qCritical("KarmaBenchmark: %s HDR decoding differs from ldexp() in %u floats.", mapped ? "Mapped" : "Buffered", unsigned(mismatches));
+      passed = false;
+    }
+  }
+  return passed;
+}
+
+/*******************************************************************************
+ * Tone Mapping
+ ******************************************************************************/
+
+// The batch path must stay within Tolerance of the scalar functor.
+bool benchmarkToneMapping()
+{
+  static const int Width = 4096;
+  static const int Height = 2048;
+  static const float Tolerance = 1e-5f;
+
+  // Synthetic radiance spanning many orders of magnitude
+  std::vector<RgbF> source;
+  source.reserve(Width * Height);
+  for (int i = 0; i < Width * Height; ++i)
+  {
+    float value = std::pow(10.0f, float(i % 2000) / 100.0f - 12.0f);
+    source.push_back(RgbF(value, 0.5f * value, 3.0f * value));
+  }
+
+  quint64 scalarMs, batchMs;
+  KElapsedTimer timer;
+  OpenGLStandardToneMapping toneMapping(1.0f, 1.0f);
+  std::vector<RgbF> scalar = source, batch = source;
+  timer.start();
+  for (RgbF &color : scalar)
+  {
+    color = toneMapping(color);
+  }
+  scalarMs = timer.elapsed();
+  timer.start();
+  toneMapping.applyParallel(batch.data(), Width, Height);
+  batchMs = timer.elapsed();
+
+  float maxError = 0.0f;
+  for (size_t i = 0; i < scalar.size(); ++i)
+  {
+    maxError = std::max(maxError, std::abs(scalar[i].r - batch[i].r));
+    maxError = std::max(maxError, std::abs(scalar[i].g - batch[i].g));
+    maxError = std::max(maxError, std::abs(scalar[i].b - batch[i].b));
+  }
+  kDebug() << "Tone Mapping | Scalar (sec) | Batch (sec) | Max Error";
+  kDebug() << Width << "x" << Height << "|" << float(scalarMs) / 1e3f << "|" << float(batchMs) / 1e3f << "|" << maxError;
+  if (!(maxError <= Tolerance))
+  {
+    qCritical("KarmaBenchmark: Batch tone mapping differs from the scalar functor by %g (tolerance %g).", maxError, Tolerance);
+    return false;
+  }
+  return true;
+}
+
+/*******************************************************************************
+ * HDR Packing
+ ******************************************************************************/
+
+// Value of a float with a 5-bit exponent (bias 15) and the given mantissa.
+static float unpackSmallFloat(uint32_t bits, int mantissaBits)
+{
+  uint32_t mantissa = bits & ((1u << mantissaBits) - 1);
+  int exponent = int(bits >> mantissaBits) & 0x1F;
+  if (exponent == 0) return std::ldexp(float(mantissa), -14 - mantissaBits);
+  return std::ldexp(float(mantissa | (1u << mantissaBits)), exponent - 15 - mantissaBits);
+}
+
+static void unpackTexel(OpenGLInternalFormat format, unsigned char const *texel, float rgb[3])
+{
+  uint32_t bits;
+  uint16_t half[3];
+  switch (format)
+  {
+  case OpenGLInternalFormat::Rgb16F:
+    std::memcpy(half, texel, sizeof(half));
+    for (int i = 0; i < 3; ++i)
+    {
+      rgb[i] = unpackSmallFloat(half[i] & 0x7FFF, 10) * ((half[i] & 0x8000) ? -1.0f : 1.0f);
+    }
+    break;
+  case OpenGLInternalFormat::Rg11B10F:
+    std::memcpy(&bits, texel, sizeof(bits));
+    rgb[0] = unpackSmallFloat(bits & 0x7FF, 6);
+    rgb[1] = unpackSmallFloat((bits >> 11) & 0x7FF, 6);
+    rgb[2] = unpackSmallFloat(bits >> 22, 5);
+    break;
+  default:
+    std::memcpy(&bits, texel, sizeof(bits));
+    for (int i = 0; i < 3; ++i)
+    {
+      rgb[i] = std::ldexp(float((bits >> (9 * i)) & 0x1FF), int(bits >> 27) - 15 - 9);
+    }
+    break;
+  }
+}
+
+// Values are clamped to the finite range of the format.
+static float clampToFormat(OpenGLInternalFormat format, int channel, float value)
+{
+  switch (format)
+  {
+  case OpenGLInternalFormat::Rgb16F:
+    return std::min(std::max(value, -65504.0f), 65504.0f);
+  case OpenGLInternalFormat::Rg11B10F:
+    return std::min(std::max(value, 0.0f), (channel == 2) ? 64512.0f : 65024.0f);
+  default:
+    return std::min(std::max(value, 0.0f), 65408.0f);
+  }
+}
+
+// Largest error of a correctly rounded value of the format, per channel.
+static void packingTolerance(OpenGLInternalFormat format, float const expected[3], float tolerance[3])
+{
+  switch (format)
+  {
+  case OpenGLInternalFormat::Rgb16F:
+    for (int i = 0; i < 3; ++i) tolerance[i] = std::ldexp(std::abs(expected[i]), -11) + std::ldexp(1.0f, -25);
+    break;
+  case OpenGLInternalFormat::Rg11B10F:
+    tolerance[0] = std::ldexp(expected[0], -7) + std::ldexp(1.0f, -21);
+    tolerance[1] = std::ldexp(expected[1], -7) + std::ldexp(1.0f, -21);
+    tolerance[2] = std::ldexp(expected[2], -6) + std::ldexp(1.0f, -20);
+    break;
+  default:
+    // The shared exponent follows the largest channel, rounding it up to 512
+    // bumps the exponent and so the step.
+    for (int i = 0; i < 3; ++i)
+    {
+      tolerance[i] = std::max(expected[0], std::max(expected[1], expected[2])) / 511.0f + std::ldexp(1.0f, -25);
+    }
+    break;
+  }
+}
+
+// Every packed texel must round-trip within half a step of its format.
+bool benchmarkHdrPacking()
+{
+  static const int Width = 2048;
+  static const int Height = 1024;
+  static const OpenGLInternalFormat Formats[] =
+  {
+    OpenGLInternalFormat::Rgb16F,
+    OpenGLInternalFormat::Rg11B10F,
+    OpenGLInternalFormat::Rgb9E5
+  };
+
+  // Rows span 2^-24 to 2^15 times the environment, negative every 7th texel,
+  // so denormals and clamping are covered. An odd count leaves a scalar tail.
+  std::vector<RgbF> source = syntheticEnvironment(Width, Height);
+  for (size_t i = 0; i < source.size(); ++i)
+  {
+    float scale = std::ldexp((i % 7) ? 1.0f : -1.0f, int(i / Width % 40) - 24);
+    source[i] = source[i] * scale;
+  }
+  size_t texels = source.size() - 1;
+
+  bool passed = true;
+  KElapsedTimer timer;
+  std::vector<unsigned char> packed;
+  kDebug() << "HDR Packing | Format | Pack (sec) | MPix/s | Out of Tolerance";
+  for (OpenGLInternalFormat format : Formats)
+  {
+    size_t texelSize = OpenGLHdrPacking::texelSize(format);
+    packed.resize(texels * texelSize);
+    timer.start();
+    OpenGLHdrPacking::packParallel(format, source.data(), packed.data(), texels);
+    quint64 ms = std::max<quint64>(timer.elapsed(), 1);
+
+    size_t failures = 0;
+    float rgb[3], expected[3], tolerance[3];
+    for (size_t i = 0; i < texels; ++i)
+    {
+      float const *in = &source[i].r;
+      for (int c = 0; c < 3; ++c)
+      {
+        expected[c] = clampToFormat(format, c, in[c]);
+      }
+      unpackTexel(format, &packed[i * texelSize], rgb);
+      packingTolerance(format, expected, tolerance);
+      for (int c = 0; c < 3; ++c)
+      {
+        if (!(std::abs(rgb[c] - expected[c]) <= tolerance[c])) ++failures;
+      }
+    }
+    kDebug() << OpenGLHdrPacking::formatName(format) << "|" << float(ms) / 1e3f << "|" << float(texels) / (float(ms) * 1e3f) << "|" << failures;
+    if (failures)
+    {
+      qCritical("KarmaBenchmark: %s packing is out of tolerance in %u channels.", OpenGLHdrPacking::formatName(format), unsigned(failures));
+      passed = false;
+    }
+  }
+  return passed;
+}
+
+/*******************************************************************************
+ * BC6H
+ ******************************************************************************/
+
+// Blocks must not depend on the thread count, and each quality has to reach
+// its PSNR on the synthetic environment.
+bool benchmarkBc6h()
+{
+  static const int Width = 1024;
+  static const int Height = 512;
+  static const float MinPsnr[] = { 58.0f, 61.0f }; // About 3 dB of headroom
+  static char const *Names[] = { "Fast", "High" };
+
+  std::vector<RgbF> environment = syntheticEnvironment(Width, Height);
+  float const *source = &environment[0].r;
+  size_t floats = 3 * environment.size();
+  size_t maxThreads = std::max<size_t>(KThreadPool::idealThreadCount(), 4);
+
+  bool passed = true;
+  KElapsedTimer timer;
+  KThreadPool *pool = KThreadPool::globalInstance();
+  size_t origThreads = pool->threadCount();
+  std::vector<unsigned char> blocks(KBc6hEncoder::compressedSize(Width, Height));
+  std::vector<unsigned char> serialBlocks(blocks.size());
+  std::vector<float> decoded(floats);
+
+  kDebug() << "BC6H | Quality | Threads | Encode (sec) | MPix/s | PSNR (dB)";
+  for (int quality = KBc6hEncoder::FastQuality; quality <= KBc6hEncoder::HighQuality; ++quality)
+  {
+    KBc6hEncoder encoder(static_cast<KBc6hEncoder::Quality>(quality));
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+      pool->setThreadCount(threads);
+      timer.start();
+      encoder.encode(source, Width, Height, blocks.data());
+      quint64 ms = std::max<quint64>(timer.elapsed(), 1);
+      KBc6hEncoder::decode(blocks.data(), Width, Height, decoded.data());
+      float psnr = KBc6hEncoder::psnr(source, decoded.data(), floats);
+      kDebug() << Names[quality] << "|" << threads << "|" << float(ms) / 1e3f << "|" << float(Width * Height) / (float(ms) * 1e3f) << "|" << psnr;
+
+      if (threads == 1)
+      {
+        serialBlocks = blocks;
+        if (!(psnr >= MinPsnr[quality]))
+        {
+          qCritical("KarmaBenchmark: %s BC6H reaches %g dB (at least %g dB).", Names[quality], psnr, MinPsnr[quality]);
+          passed = false;
+        }
+      }
+      else if (blocks != serialBlocks)
+      {
+        qCritical("KarmaBenchmark: %s BC6H blocks differ with %u threads.", Names[quality], unsigned(threads));
+        passed = false;
+      }
+    }
+  }
+  pool->setThreadCount(origThreads);
+  return passed;
+}
+
+/*******************************************************************************
+ * Cube Mapping
+ ******************************************************************************/
+
+// Texture memory and upload time of one environment layout, read from a
+// Radiance file of the synthetic environment.
+// GPU time (ms per frame) of the environment pass program for the layout of
+// env, drawn like EnvironmentPass over a sky-only GBuffer, where every pixel
+// reads the full resolution map. The view turns a full circle over the
+// frames. Negative without timer queries.
+static float environmentPassTime(OpenGLEnvironment &env)
+{
+  static const int Width = 1920;
+  static const int Height = 1080;
+  static const unsigned PassFrames = 64;
+
+#if !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
+  if (QOpenGLContext::currentContext()->isOpenGLES() || !GL::dispatch()->glGetQueryObjectui64v) return -1.0f;
+
+  OpenGLShaderProgram program;
+  if (env.isCubeMap()) program.addShaderDefines("#define K_CUBE_ENVIRONMENT\n");
+  program.addShaderFromSourceFile(QOpenGLShader::Vertex, ":/resources/shaders/lighting/environment.vert");
+  program.addShaderFromSourceFile(QOpenGLShader::Fragment, ":/resources/shaders/lighting/environment.frag");
+  if (!program.link()) return -1.0f;
+
+  // Depth cleared to the far plane, so the pass only shades the sky.
+  OpenGLTexture color, depth;
+  color.create(OpenGLTexture::Texture2D);
+  color.bind();
+  color.setInternalFormat(OpenGLInternalFormat::Rgba16F);
+  color.setSize(Width, Height);
+  color.allocate();
+  depth.create(OpenGLTexture::Texture2D);
+  depth.bind();
+  depth.setInternalFormat(OpenGLInternalFormat::Depth32F);
+  depth.setFilter(OpenGLTexture::Magnification, OpenGLTexture::Nearest);
+  depth.setFilter(OpenGLTexture::Minification, OpenGLTexture::Nearest);
+  depth.setSize(Width, Height);
+  depth.allocate();
+  OpenGLFramebufferObject fbo;
+  fbo.create();
+  fbo.bind();
+  fbo.attachTexture2D(OpenGLFramebufferObject::TargetDraw, OpenGLFramebufferObject::ColorAttachment0, color);
+  fbo.attachTexture2D(OpenGLFramebufferObject::TargetDraw, OpenGLFramebufferObject::DepthAttachment, depth);
+  fbo.drawBuffers(OpenGLFramebufferObject::ColorAttachment0);
+  fbo.validate();
+  GL::glViewport(0, 0, Width, Height);
+  GL::glClearDepthf(1.0f);
+  GL::glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  fbo.release();
+
+  OpenGLMesh quad;
+  quad.create(":/resources/objects/quad.obj");
+  OpenGLBrdfLookup brdfLookup;
+  GL::glActiveTexture(OpenGLTexture::beginTextureUnits() + K_TEXTURE_0);
+  env.direct().bind();
+  GL::glActiveTexture(OpenGLTexture::beginTextureUnits() + K_TEXTURE_2);
+  env.prefiltered().bind();
+  GL::glActiveTexture(OpenGLTexture::beginTextureUnits() + K_DEPTH_TEXTURE_BINDING);
+  depth.bind();
+  GL::glActiveTexture(OpenGLTexture::beginTextureUnits() + K_BRDF_LOOKUP_BINDING);
+  brdfLookup.table(OpenGLAbstractLightGroup::FFactor(), OpenGLAbstractLightGroup::GFactor(), OpenGLAbstractLightGroup::SFactor()).bind();
+  GL::glActiveTexture(OpenGLTexture::beginTextureUnits());
+
+  KMatrix4x4 perspective;
+  perspective.perspective(60.0f, float(Width) / float(Height), 0.1f, 1000.0f);
+  OpenGLRenderBlock block;
+  block.setPerspectiveMatrix(perspective);
+  block.setNearFar(0.1f, 1000.0f);
+  block.setDimensions(Width, Height);
+
+  GLuint query;
+  GL::glGenQueries(1, &query);
+  GL::glDisable(GL_DEPTH_TEST);
+  GL::glDepthMask(GL_FALSE);
+  fbo.bind();
+  program.bind();
+  program.setUniformValueArray(program.uniformLocation("IrradianceSH"), env.irradiance(), 9, 3);
+  program.setUniformValue(program.uniformLocation("PrefilteredMaxLevel"), env.prefilteredMaxLevel());
+
+  // The first frame (warm up) is not counted.
+  GLuint64 total = 0;
+  for (unsigned frame = 0; frame <= PassFrames; ++frame)
+  {
+    KMatrix4x4 view;
+    view.rotate(360.0f * float(frame) / float(PassFrames), 0.0f, 1.0f, 0.0f);
+    block.setViewMatrix(view);
+    block.update();
+    block.bindBlock(K_CURRENT_VIEW_BINDING);
+    GL::glBeginQuery(GL_TIME_ELAPSED, query);
+    quad.draw();
+    GL::glEndQuery(GL_TIME_ELAPSED);
+    GLuint64 ns = 0;
+    GL::glGetQueryObjectui64v(query, GL_QUERY_RESULT, &ns);
+    if (frame) total += ns;
+  }
+  program.release();
+  fbo.release();
+  GL::glDepthMask(GL_TRUE);
+  GL::glEnable(GL_DEPTH_TEST);
+  GL::glDeleteQueries(1, &query);
+  OpenGLUniformBufferObject::bindBufferId(K_CURRENT_VIEW_BINDING, 0);
+  return float(double(total) / PassFrames / 1e6);
+#else
+  (void)env;
+  return -1.0f;
+#endif
+}
+
+static bool benchmarkEnvironmentLayout(QString const &filePath, bool cube)
+{
+  QByteArray path = filePath.toLocal8Bit();
+  OpenGLEnvironment env;
+  env.setCubeMapEnabled(cube);
+  KElapsedTimer timer;
+  timer.start();
+  env.setDirect(path.constData());
+  quint64 ms = timer.elapsed();
+  if (env.isCubeMap() != cube)
+  {
+    qCritical("KarmaBenchmark: The environment was uploaded as %s.", env.isCubeMap() ? "a cube map" : "an equirect map");
+    return false;
+  }
+  float passMs = environmentPassTime(env);
+  kDebug() << (cube ? "Cube Map" : "Equirect") << "|" << float(ms) / 1e3f << "|" << float(env.textureBytes()) / 1024.0f << "|" << passMs;
+  return true;
+}
+
+// Faces of a map holding its own direction (rgb = 1 + xyz) must hold the
+// direction through their texels, which catches wrongly oriented faces. The
+// result must not depend on the thread count.
+bool benchmarkCubeMapping()
+{
+  static const int Width = 2048;
+  static const int Height = 1024;
+  static const float Tolerance = 1e-3f;
+  static const float Pi = 3.14159265358979f;
+  static const float Pi2 = 6.28318530717959f;
+
+  std::vector<RgbF> directions;
+  directions.reserve(size_t(Width) * Height);
+  for (int y = 0; y < Height; ++y)
+  {
+    float theta = Pi * (float(y) + 0.5f) / float(Height);
+    for (int x = 0; x < Width; ++x)
+    {
+      float alpha = Pi2 * (0.5f - (float(x) + 0.5f) / float(Width));
+      directions.push_back(RgbF(1.0f + std::cos(alpha) * std::sin(theta), 1.0f + std::sin(alpha) * std::sin(theta), 1.0f + std::cos(theta)));
+    }
+  }
+
+  bool passed = true;
+  KElapsedTimer timer;
+  KThreadPool *pool = KThreadPool::globalInstance();
+  size_t origThreads = pool->threadCount();
+  size_t maxThreads = std::max<size_t>(KThreadPool::idealThreadCount(), 4);
+  int faceSize = OpenGLCubeMapping::faceSize(Width);
+  size_t faceTexels = OpenGLCubeMapping::faceTexels(faceSize);
+  size_t texels = faceTexels * OpenGLCubeMapping::FaceCount;
+  std::vector<RgbF> faces(texels, RgbF(0.0f, 0.0f, 0.0f));
+  std::vector<RgbF> serialFaces;
+
+  kDebug() << "Cube Map | Threads | Resample (sec) | MPix/s | Max Error";
+  for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+  {
+    pool->setThreadCount(threads);
+    timer.start();
+    OpenGLCubeMapping::resampleParallel(directions.data(), Width, Height, faceSize, faces.data());
+    quint64 ms = std::max<quint64>(timer.elapsed(), 1);
+
+    if (threads > 1)
+    {
+      kDebug() << Width << "x" << Height << "|" << threads << "|" << float(ms) / 1e3f << "|" << float(texels) / (float(ms) * 1e3f) << "|";
+      if (std::memcmp(faces.data(), serialFaces.data(), texels * sizeof(RgbF)) != 0)
+      {
+        qCritical("KarmaBenchmark: Cube map faces differ with %u threads.", unsigned(threads));
+        passed = false;
+      }
+      continue;
+    }
+
+    float maxError = 0.0f, dir[3];
+    for (size_t i = 0; i < texels; ++i)
+    {
+      int face = int(i / faceTexels);
+      float s = (float(i % faceSize) + 0.5f) * 2.0f / float(faceSize) - 1.0f;
+      float t = (float(i % faceTexels / faceSize) + 0.5f) * 2.0f / float(faceSize) - 1.0f;
+      OpenGLCubeMapping::faceDirection(face, s, t, dir);
+      float invLength = 1.0f / std::sqrt(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]);
+      float const *rgb = &faces[i].r;
+      for (int c = 0; c < 3; ++c)
+      {
+        maxError = std::max(maxError, std::abs(rgb[c] - (1.0f + dir[c] * invLength)));
+      }
+    }
+    kDebug() << Width << "x" << Height << "|" << threads << "|" << float(ms) / 1e3f << "|" << float(texels) / (float(ms) * 1e3f) << "|" << maxError;
+    if (!(maxError <= Tolerance))
+    {
+      qCritical("KarmaBenchmark: Cube map faces are off their directions by %g (tolerance %g).", maxError, Tolerance);
+      passed = false;
+    }
+    serialFaces = faces;
+  }
+  pool->setThreadCount(origThreads);
+
+  // Both layouts of OpenGLEnvironment, direct map and prefiltered chain.
+  QTemporaryDir directory;
+  QFile file(directory.filePath("KarmaBenchmark.hdr"));
+  std::vector<RgbF> source = syntheticEnvironment(Width, Height);
+  std::vector<unsigned char> bytes = encodeHdr(source.data(), Width, Height);
+  if (!directory.isValid() || !file.open(QIODevice::WriteOnly) || file.write(reinterpret_cast<char const*>(bytes.data()), qint64(bytes.size())) != qint64(bytes.size()))
+  {
+    qCritical("KarmaBenchmark: Failed to write a temporary environment file.");
+    return false;
+  }
+  file.close();
+  kDebug() << "Environment | Layout | Upload (sec) | Textures (KiB) | Environment Pass (ms)";
+  passed &= benchmarkEnvironmentLayout(file.fileName(), false);
+  passed &= benchmarkEnvironmentLayout(file.fileName(), true);
+  return passed;
+}
@@ -80,7 +80,7 @@ void DebugGBufferPass::render(OpenGLScene &scene)
 {
   (void)scene;
   P(DebugGBufferPassPrivate);
-  OpenGLMarkerScoped _("Debug G Buffer");
+  OpenGLMarkerScoped _(OPENGL_MARKER_ID("Debug G Buffer"));
 
   if (KInputManager::keyTriggered(Qt::Key_0))
   {
@@ -10,18 +10,48 @@
 #include <OpenGLTexture>
 #include <OpenGLBindings>
 #include <OpenGLUniformBufferObject>
-#include <OpenGLHammersleyData>
 #include <OpenGLAbstractLightGroup>
+#include <OpenGLBrdfLookup>
+
+// One program per environment layout, indexed by OpenGLEnvironment::isCubeMap().
+struct EnvironmentPassProgram
+{
+  OpenGLShaderProgram *m_program;
+  bool m_resolved;
+  int m_uIrradianceSH, m_uPrefilteredMaxLevel, m_uHasIrradianceMap;
+};
 
 class EnvironmentPassPrivate
 {
 public:
+  void createProgram(EnvironmentPassProgram &program, char const *defines);
+  void resolveProgram(EnvironmentPassProgram &program);
   OpenGLMesh m_quadGL;
-  OpenGLShaderProgram *m_environmentPass;
+  EnvironmentPassProgram m_programs[2];
+  OpenGLBrdfLookup m_brdfLookup;
   KSize m_dimensions;
-  int m_uFresnel, m_uGeometry, m_uDistribution, m_uDistributionSample, m_uDiffuseScalar;
 };
 
+void EnvironmentPassPrivate::createProgram(EnvironmentPassProgram &program, char const *defines)
+{
+  program.m_program = new OpenGLShaderProgram();
+  program.m_program->addShaderDefines(defines);
+  program.m_program->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/resources/shaders/lighting/environment.vert");
+  program.m_program->addShaderFromSourceFile(QOpenGLShader::Fragment, ":/resources/shaders/lighting/environment.frag");
+  program.m_program->link();
+  program.m_resolved = false;
+}
+
+// Deferred to the first use, so initialize() never waits on the compiler.
+void EnvironmentPassPrivate::resolveProgram(EnvironmentPassProgram &program)
+{
+  // Get the uniform locations (the BRDF factors only select the lookup table)
+  program.m_uIrradianceSH = program.m_program->uniformLocation("IrradianceSH");
+  program.m_uPrefilteredMaxLevel = program.m_program->uniformLocation("PrefilteredMaxLevel");
+  program.m_uHasIrradianceMap = program.m_program->uniformLocation("HasIrradianceMap");
+  program.m_resolved = true;
+}
+
 EnvironmentPass::EnvironmentPass() :
   m_private(0)
 {
@@ -33,22 +63,17 @@ void EnvironmentPass::initialize()
   m_private = new EnvironmentPassPrivate;
   P(EnvironmentPassPrivate);
 
-  p.m_environmentPass = new OpenGLShaderProgram();
-  p.m_environmentPass->addShaderFromSourceFile(QOpenGLShader::Vertex, ":/resources/shaders/lighting/environment.vert");
-  p.m_environmentPass->addShaderFromSourceFile(QOpenGLShader::Fragment, ":/resources/shaders/lighting/environment.frag");
-  p.m_environmentPass->link();
+  p.createProgram(p.m_programs[0], "");
+  p.createProgram(p.m_programs[1], "#define K_CUBE_ENVIRONMENT\n");
 
-  // Get the subroutine locations
+  // Filter across cube map faces (always on for OpenGL ES 3.0).
 #if !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
-  p.m_environmentPass->bind();
-  p.m_uFresnel = GL::glGetSubroutineUniformLocation(p.m_environmentPass->programId(), GL_FRAGMENT_SHADER, "uFresnel");
-  p.m_uGeometry = GL::glGetSubroutineUniformLocation(p.m_environmentPass->programId(), GL_FRAGMENT_SHADER, "uGeometry");
-  p.m_uDistribution = GL::glGetSubroutineUniformLocation(p.m_environmentPass->programId(), GL_FRAGMENT_SHADER, "uDistribution");
-  p.m_uDistributionSample = GL::glGetSubroutineUniformLocation(p.m_environmentPass->programId(), GL_FRAGMENT_SHADER, "uDistributionSample");
-  p.m_uDiffuseScalar = GL::glGetSubroutineUniformLocation(p.m_environmentPass->programId(), GL_FRAGMENT_SHADER, "uDiffuse");
-  p.m_environmentPass->release();
+  GL::glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 #endif
 
+  // Prepare the lookup table of the initial factors, others are made on demand.
+  p.m_brdfLookup.table(OpenGLAbstractLightGroup::FFactor(), OpenGLAbstractLightGroup::GFactor(), OpenGLAbstractLightGroup::SFactor());
+
   p.m_quadGL.create(":/resources/objects/quad.obj");
 }
 
@@ -68,34 +93,30 @@ void EnvironmentPass::render(OpenGLScene &scene)
   (void)scene;
   if (!active()) return;
   P(EnvironmentPassPrivate);
-  OpenGLMarkerScoped _("Light Accumulation Pass");
+  OpenGLMarkerScoped _(OPENGL_MARKER_ID("Light Accumulation Pass"));
 
   GL::glDisable(GL_DEPTH_TEST);
   GL::glDepthMask(GL_FALSE);
+  OpenGLEnvironment *env = scene.environment();
   GL::glActiveTexture(OpenGLTexture::beginTextureUnits() + K_TEXTURE_0);
-  scene.environment()->direct().bind();
-  GL::glActiveTexture(OpenGLTexture::beginTextureUnits() + K_TEXTURE_1);
-  scene.environment()->indirect().bind();
-  p.m_environmentPass->bind();
-  //p.m_environmentPass->setUniformValue("Dimensions", scene.environment()->directSize().width(), scene.environment()->directSize().height());
-#if !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
-  std::string fName = "s" + FToCStr(OpenGLAbstractLightGroup::FFactor());
-  std::string gName = "s" + GToCStr(OpenGLAbstractLightGroup::GFactor());
-  std::string dName = "s" + DToCStr(OpenGLAbstractLightGroup::DFactor());
-  std::string sName = "s" + DToCStr(OpenGLAbstractLightGroup::SFactor()) + "Sample";
-  unsigned fIndex = GL::glGetSubroutineIndex(p.m_environmentPass->programId(), GL_FRAGMENT_SHADER, fName.c_str());
-  unsigned gIndex = GL::glGetSubroutineIndex(p.m_environmentPass->programId(), GL_FRAGMENT_SHADER, gName.c_str());
-  unsigned dIndex = GL::glGetSubroutineIndex(p.m_environmentPass->programId(), GL_FRAGMENT_SHADER, dName.c_str());
-  unsigned sIndex = GL::glGetSubroutineIndex(p.m_environmentPass->programId(), GL_FRAGMENT_SHADER, sName.c_str());
-  unsigned locations[4];
-  if (p.m_uFresnel != -1) locations[p.m_uFresnel] = fIndex;
-  if (p.m_uGeometry != -1) locations[p.m_uGeometry] = gIndex;
-  if (p.m_uDistribution != -1) locations[p.m_uDistribution] = dIndex;
-  if (p.m_uDistributionSample != -1) locations[p.m_uDistributionSample] = sIndex;
-  GL::glUniformSubroutinesuiv(GL_FRAGMENT_SHADER, 4, locations);
-#endif
+  env->direct().bind();
+  if (env->hasIndirect())
+  {
+    GL::glActiveTexture(OpenGLTexture::beginTextureUnits() + K_TEXTURE_1);
+    env->indirect().bind();
+  }
+  GL::glActiveTexture(OpenGLTexture::beginTextureUnits() + K_TEXTURE_2);
+  env->prefiltered().bind();
+  GL::glActiveTexture(OpenGLTexture::beginTextureUnits() + K_BRDF_LOOKUP_BINDING);
+  p.m_brdfLookup.table(OpenGLAbstractLightGroup::FFactor(), OpenGLAbstractLightGroup::GFactor(), OpenGLAbstractLightGroup::SFactor()).bind();
+  EnvironmentPassProgram &program = p.m_programs[env->isCubeMap() ? 1 : 0];
+  program.m_program->bind();
+  if (!program.m_resolved) p.resolveProgram(program);
+  program.m_program->setUniformValueArray(program.m_uIrradianceSH, env->irradiance(), 9, 3);
+  program.m_program->setUniformValue(program.m_uPrefilteredMaxLevel, env->prefilteredMaxLevel());
+  program.m_program->setUniformValue(program.m_uHasIrradianceMap, GLint(env->hasIndirect()));
   p.m_quadGL.draw();
-  p.m_environmentPass->release();
+  program.m_program->release();
   GL::glDepthMask(GL_TRUE);
   GL::glEnable(GL_DEPTH_TEST);
 }
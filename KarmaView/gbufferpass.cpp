@@ -106,7 +106,7 @@ void GBufferPass::commit(OpenGLViewport &)
 void GBufferPass::render(OpenGLScene &scene)
 {
   P(GBufferPassPrivate);
-  OpenGLMarkerScoped _("Generate G Buffer");
+  OpenGLMarkerScoped _(OPENGL_MARKER_ID("Generate G Buffer"));
 
   // Generate the GBuffer
   p.m_program->bind();
@@ -40,7 +40,7 @@ void LightAccumulationPass::commit(OpenGLViewport &view)
 void LightAccumulationPass::render(OpenGLScene &scene)
 {
   (void)scene;
-  OpenGLMarkerScoped _("Light Accumulation Pass");
+  OpenGLMarkerScoped _(OPENGL_MARKER_ID("Light Accumulation Pass"));
 
   GL::glDisable(GL_DEPTH_TEST);
   GL::glDepthMask(GL_FALSE);
@@ -4,6 +4,8 @@
 #include <KInputManager>
 
 // OpenGL Framework
+#include <OpenGLCpuMarkerScoped>
+#include <OpenGLFunctions>
 #include <OpenGLRenderer>
 #include <OpenGLViewport>
 #include <OpenGLShaderProgram>
@@ -93,12 +95,15 @@ void MainWidgetPrivate::resizeGL(int width, int height)
 
 void MainWidgetPrivate::paintGL()
 {
+  // Qt binds its framebuffer and sets the viewport behind GL::'s back.
+  GL::beginFrame();
   OpenGLProfiler::BeginFrame();
   if (m_sceneManager.activeScene())
   {
     m_renderer.render(*m_sceneManager.currentScene());
   }
   OpenGLProfiler::EndFrame();
+  GL::endFrame();
 }
 
 void MainWidgetPrivate::teardownGL()
@@ -147,10 +152,13 @@ OpenGLRenderer *MainWidget::renderer()
  ******************************************************************************/
 void MainWidget::initializeGL()
 {
+  // Submit every program of the widget and passes at once.
+  OpenGLShaderProgram::beginBatch();
   OpenGLWidget::initializeGL();
   m_private = new MainWidgetPrivate;
   P(MainWidgetPrivate);
   p.initializeGL();
+  OpenGLShaderProgram::endBatch();
   p.m_sceneManager.pushScene(new SampleScene);
 }
 
@@ -178,6 +186,15 @@ void MainWidget::updateEvent(OpenGLUpdateEvent *event)
 {
   P(MainWidgetPrivate);
   makeCurrent();
-  p.m_sceneManager.update(event);
+  {
+    OpenGLCpuMarkerScoped _(OPENGL_MARKER_ID("Scene Update"));
+    p.m_sceneManager.update(event);
+  }
+  if (!p.m_started)
+  {
+    // The first update starts the scene, which builds the remaining programs.
+    OpenGLShaderProgram::reportBinaryCache();
+    OpenGLShaderProgram::reportCompile();
+  }
   p.m_started = true;
 }
@@ -3,6 +3,7 @@
 #include <QAction>
 #include <SampleScene>
 #include <QColorDialog>
+#include <QFileDialog>
 #include <QColor>
 #include <OpenGLRenderer>
 #include <RenderPasses>
@@ -321,6 +322,32 @@ void MainWindow::on_actionFrame_Profiler_triggered(bool checked)
   ui->openGLWidget->setProfilerVisible(checked);
 }
 
+void MainWindow::on_actionRecord_Profiler_Capture_triggered(bool checked)
+{
+  // Starting a recording begins a new range, stopping keeps it for saving.
+  ui->openGLWidget->setProfilerRecording(checked, checked);
+}
+
+void MainWindow::on_actionSave_Profiler_Capture_triggered()
+{
+  QString fileName = QFileDialog::getSaveFileName(this, "Save Profiler Capture", QString(), "Chrome Trace (*.json)");
+  if (fileName.isEmpty()) return;
+  if (!ui->openGLWidget->saveProfilerCapture(fileName))
+  {
+    QMessageBox::warning(this, "KarmaView", "Failed to save the profiler capture to " + fileName);
+  }
+}
+
+void MainWindow::on_actionSave_Profiler_Statistics_triggered()
+{
+  QString fileName = QFileDialog::getSaveFileName(this, "Save Profiler Statistics", QString(), "JSON (*.json)");
+  if (fileName.isEmpty()) return;
+  if (!ui->openGLWidget->saveProfilerStatistics(fileName))
+  {
+    QMessageBox::warning(this, "KarmaView", "Failed to save the profiler statistics to " + fileName);
+  }
+}
+
 void MainWindow::on_bvAabb_clicked(bool checked)
 {
   S(SampleScene);
@@ -42,6 +42,9 @@ private slots:
   void on_rectLightsChanged();
   void on_about();
   void on_actionFrame_Profiler_triggered(bool checked);
+  void on_actionRecord_Profiler_Capture_triggered(bool checked);
+  void on_actionSave_Profiler_Capture_triggered();
+  void on_actionSave_Profiler_Statistics_triggered();
   void on_bvAabb_clicked(bool checked);
   void on_bvObb_clicked(bool checked);
   void on_bvSphereRitters_clicked(bool checked);
@@ -89,7 +89,7 @@ void MotionBlurPass::render(OpenGLScene &scene)
   (void)scene;
   if (!active()) return;
   P(MotionBlurPassPrivate);
-  OpenGLMarkerScoped _("Motion Blur Pass");
+  OpenGLMarkerScoped _(OPENGL_MARKER_ID("Motion Blur Pass"));
 
   // Blur Texture
   p.m_fbo.bind();
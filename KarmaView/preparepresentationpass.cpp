@@ -72,7 +72,7 @@ void PreparePresentationPass::render(OpenGLScene &scene)
 {
   (void)scene;
   P(PreparePresentationPassPrivate);
-  OpenGLMarkerScoped _("Presentation Preparation Pass");
+  OpenGLMarkerScoped _(OPENGL_MARKER_ID("Presentation Preparation Pass"));
 
   p.m_lFbo.bind();
   GL::glClear(GL_COLOR_BUFFER_BIT);
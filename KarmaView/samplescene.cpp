@@ -11,6 +11,7 @@
 #include <KHalfEdgeMesh>
 #include <KLinq>
 #include <KMacros>
+#include <KMappedFile>
 #include <KMath>
 #include <KString>
 #include <KVector3D>
@@ -19,12 +20,14 @@
 
 // Bounding Volumes / BVH
 #include <KAabbBoundingVolume>
+#include <KBoundingVolumeFit>
 #include <KSphereBoundingVolume>
 #include <KEllipsoidBoundingVolume>
 #include <KOrientedBoundingVolume>
 #include <KStaticGeometry>
 #include <KAdaptiveOctree>
 #include <KBspTree>
+#include <KThreadPool>
 
 // OpenGL Framework
 #include <OpenGLInstance>
@@ -44,6 +47,17 @@
 #include <OpenGLSphereLightGroup>
 #include <OpenGLRectangleLight>
 #include <OpenGLRectangleLightGroup>
+#include <OpenGLCpuMarkerScoped>
+
+// Leaf limits of the spatial structures, which key their cached files too.
+static const size_t SpatialLeafTriangles = 64;
+static const size_t SpatialMaxDepth = 16;
+static const uint64_t SpatialTerminationKey = (uint64_t(SpatialLeafTriangles) << 32) | SpatialMaxDepth;
+
+static bool spatialTermination(size_t numTriangles, size_t depth)
+{
+  return (numTriangles <= SpatialLeafTriangles || depth >= SpatialMaxDepth);
+}
 
 struct LightInfo
 {
@@ -98,7 +112,13 @@ public:
   void loadObj(const KString &fileName);
 
   template <typename T>
-  void buildMethod(T &geom, KHalfEdgeMesh const &mesh, typename T::BuildMethod method, typename T::TerminationPred pred);
+  void buildMethod(T &geom, KHalfEdgeMesh const &mesh, typename T::BuildMethod method, typename T::TerminationPred pred, uint64_t terminationKey, char const *cacheSuffix = Q_NULLPTR, bool rebuild = false);
+
+#ifdef    KARMA_BENCHMARK
+  void benchmarkBuilds(KHalfEdgeMesh const &mesh);
+  void benchmarkOrientedBoundingVolumes(KHalfEdgeMesh const &mesh);
+  void benchmarkSphereBoundingVolumes(KHalfEdgeMesh const &mesh);
+#endif // KARMA_BENCHMARK
 };
 
 SampleScenePrivate::SampleScenePrivate() :
@@ -133,6 +153,7 @@ void SampleScenePrivate::loadObj(const char *fileName)
 
 void SampleScenePrivate::loadObj(const KString &fileName)
 {
+  OpenGLCpuMarkerScoped _(OPENGL_MARKER_ID("Load Obj"));
   OpenGLMesh openGLMesh;
   KHalfEdgeMesh halfEdgeMesh;
   KCountResult boundaries;
@@ -200,16 +221,22 @@ void SampleScenePrivate::loadObj(const KString &fileName)
       delete m_sphereRitters;
       delete m_obb;
       delete m_ellipse;
-      m_aabb = new KAabbBoundingVolume(halfEdgeMesh, KAabbBoundingVolume::MinMaxMethod);
-      m_sphereCentroid = new KSphereBoundingVolume(halfEdgeMesh, KSphereBoundingVolume::CentroidMethod);
-      m_sphereLarsons = new KSphereBoundingVolume(halfEdgeMesh, KSphereBoundingVolume::LarssonsMethod);
-      m_spherePca = new KSphereBoundingVolume(halfEdgeMesh, KSphereBoundingVolume::PcaMethod);
-      m_sphereRitters = new KSphereBoundingVolume(halfEdgeMesh, KSphereBoundingVolume::RittersMethod);
-      m_obb = new KOrientedBoundingVolume(halfEdgeMesh, KOrientedBoundingVolume::PcaMethod);
-      m_ellipse = new KEllipsoidBoundingVolume(halfEdgeMesh, KEllipsoidBoundingVolume::PcaMethod);
+      KBoundingVolumeFit fit(halfEdgeMesh);
+      m_aabb = new KAabbBoundingVolume(fit, KAabbBoundingVolume::MinMaxMethod);
+      m_sphereCentroid = new KSphereBoundingVolume(fit, KSphereBoundingVolume::CentroidMethod);
+      m_sphereLarsons = new KSphereBoundingVolume(fit, KSphereBoundingVolume::LarssonsMethod);
+      m_spherePca = new KSphereBoundingVolume(fit, KSphereBoundingVolume::PcaMethod);
+      m_sphereRitters = new KSphereBoundingVolume(fit, KSphereBoundingVolume::RittersMethod);
+      m_obb = new KOrientedBoundingVolume(fit, KOrientedBoundingVolume::PcaMethod);
+      m_ellipse = new KEllipsoidBoundingVolume(fit, KEllipsoidBoundingVolume::PcaMethod);
       ms = timer.elapsed();
       kDebug() << "Bounding Volume Gen. (sec)   :" << float(ms) / 1e3f;
     }
+#ifdef    KARMA_BENCHMARK
+    benchmarkBuilds(halfEdgeMesh);
+    benchmarkOrientedBoundingVolumes(halfEdgeMesh);
+    benchmarkSphereBoundingVolumes(halfEdgeMesh);
+#endif // KARMA_BENCHMARK
     kDebug() << "--------------------------------------";
     kDebug() << "Mesh Vertexes  :" << halfEdgeMesh.numVertices();
     kDebug() << "Mesh Faces     :" << halfEdgeMesh.numFaces();
@@ -226,8 +253,10 @@ void SampleScenePrivate::loadObj(const KString &fileName)
   }
 }
 
+// Files are named after the geometry, the header keys method and predicate.
+// A rebuild replaces the cached file instead of loading it.
 template <typename T>
-void SampleScenePrivate::buildMethod(T &geom, KHalfEdgeMesh const &mesh, typename T::BuildMethod method, typename T::TerminationPred pred)
+void SampleScenePrivate::buildMethod(T &geom, KHalfEdgeMesh const &mesh, typename T::BuildMethod method, typename T::TerminationPred pred, uint64_t terminationKey, char const *cacheSuffix, bool rebuild)
 {
   KTransform3D transform;
   geom.clear();
@@ -238,8 +267,125 @@ void SampleScenePrivate::buildMethod(T &geom, KHalfEdgeMesh const &mesh, typenam
     transform.setTranslation(cos(rads) * radius, 0.0f, sin(rads) * radius);
     geom.addGeometry(mesh, transform);
   }
+  geom.setTerminationKey(terminationKey);
+  if (!cacheSuffix)
+  {
+    geom.build(method, pred);
+    return;
+  }
+
+  QString cacheFile = Karma::cacheFileName(QString::number(geom.hash(), 16) + cacheSuffix);
+  if (!rebuild && geom.load(cacheFile, method)) return;
   geom.build(method, pred);
+  geom.save(cacheFile);
+}
+
+#ifdef    KARMA_BENCHMARK
+
+void SampleScenePrivate::benchmarkBuilds(KHalfEdgeMesh const &mesh)
+{
+  quint64 staticMs, octreeMs, bspMs;
+  KElapsedTimer timer;
+  KThreadPool *pool = KThreadPool::globalInstance();
+  size_t origThreads = pool->threadCount();
+  int flags = KGeometryCloud::ParallelBuild | KGeometryCloud::DeterministicBuild;
+  KStaticGeometry &staticGeometry = m_staticGeometry[0];
+  staticGeometry.setBuildFlags(flags);
+  m_octree.setBuildFlags(flags);
+  m_bspTree.setBuildFlags(flags);
+
+  kDebug() << "Threads | Octree (sec) | BspTree (sec)";
+  for (size_t threads = 1; threads <= 32; threads *= 2)
+  {
+    pool->setThreadCount(threads);
+    timer.start();
+    buildMethod(m_octree, mesh, KAdaptiveOctree::TopDownMethod, &spatialTermination, SpatialTerminationKey);
+    octreeMs = timer.elapsed();
+    timer.start();
+    buildMethod(m_bspTree, mesh, KBspTree::TopDownMethod, &spatialTermination, SpatialTerminationKey);
+    bspMs = timer.elapsed();
+    kDebug() << threads << "|" << float(octreeMs) / 1e3f << "|" << float(bspMs) / 1e3f;
+  }
+  pool->setThreadCount(origThreads);
+
+  // Persistence: the first pass builds and saves, the second maps the files.
+  kDebug() << "Persistence | Static Geometry (sec) | Octree (sec) | BspTree (sec)";
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    bool rebuild = (pass == 0);
+    timer.start();
+    buildMethod(staticGeometry, mesh, KStaticGeometry::TopDownMethod, &spatialTermination, SpatialTerminationKey, ".static", rebuild);
+    staticMs = timer.elapsed();
+    timer.start();
+    buildMethod(m_octree, mesh, KAdaptiveOctree::TopDownMethod, &spatialTermination, SpatialTerminationKey, ".octree", rebuild);
+    octreeMs = timer.elapsed();
+    timer.start();
+    buildMethod(m_bspTree, mesh, KBspTree::TopDownMethod, &spatialTermination, SpatialTerminationKey, ".bsp", rebuild);
+    bspMs = timer.elapsed();
+    kDebug() << (rebuild ? "Build + Save" : "Loaded") << "|" << float(staticMs) / 1e3f << "|" << float(octreeMs) / 1e3f << "|" << float(bspMs) / 1e3f;
+  }
+}
+
+void SampleScenePrivate::benchmarkOrientedBoundingVolumes(KHalfEdgeMesh const &mesh)
+{
+  static const int Repeats = 16;
+  static const KOrientedBoundingVolume::Method methods[] =
+  {
+    KOrientedBoundingVolume::PcaMethod,
+    KOrientedBoundingVolume::Dito14Method,
+    KOrientedBoundingVolume::Dito26Method
+  };
+  static const char *methodNames[] = { "PCA", "DiTO-14", "DiTO-26" };
+
+  // Each build gets a fresh fit, so every method pays for its own passes.
+  quint64 ms;
+  float volume = 0.0f;
+  KElapsedTimer timer;
+  kDebug() << "OBB Method | Build (sec) | Volume";
+  for (int i = 0; i < 3; ++i)
+  {
+    timer.start();
+    for (int n = 0; n < Repeats; ++n)
+    {
+      KOrientedBoundingVolume obb(KBoundingVolumeFit(mesh), methods[i]);
+      volume = obb.volume();
+    }
+    ms = timer.elapsed();
+    kDebug() << methodNames[i] << "|" << float(ms) / 1e3f / Repeats << "|" << volume;
+  }
+}
+
+void SampleScenePrivate::benchmarkSphereBoundingVolumes(KHalfEdgeMesh const &mesh)
+{
+  static const int Repeats = 16;
+  static const KSphereBoundingVolume::Method methods[] =
+  {
+    KSphereBoundingVolume::RittersMethod,
+    KSphereBoundingVolume::LarssonsMethod,
+    KSphereBoundingVolume::LarssonsMethod,
+    KSphereBoundingVolume::LarssonsMethod,
+    KSphereBoundingVolume::PcaMethod
+  };
+  static const int eposK[] = { 6, 6, 14, 26, 6 };
+  static const char *methodNames[] = { "Ritter", "EPOS-6", "EPOS-14", "EPOS-26", "PCA" };
+
+  quint64 ms;
+  float radius = 0.0f;
+  KElapsedTimer timer;
+  kDebug() << "Sphere Method | Build (sec) | Radius";
+  for (int i = 0; i < 5; ++i)
+  {
+    timer.start();
+    for (int n = 0; n < Repeats; ++n)
+    {
+      KSphereBoundingVolume sphere(KBoundingVolumeFit(mesh), methods[i], eposK[i]);
+      radius = sphere.radius();
+    }
+    ms = timer.elapsed();
+    kDebug() << methodNames[i] << "|" << float(ms) / 1e3f / Repeats << "|" << radius;
+  }
 }
+#endif // KARMA_BENCHMARK
 
 SampleScene::SampleScene() :
   m_private(new SampleScenePrivate)
@@ -325,6 +471,7 @@ void SampleScene::start()
   //          environment maps. At the time, this must be hardcoded. (Will have to find a fix later.)
   //          This means the code will only run on my machine unless you change the path.
   OpenGLEnvironment *env = environment();
+  env->setInternalFormat(OpenGLInternalFormat::Rg11B10F);
   env->setDirect(":/resources/images/AlexsApt.hdr");
   env->setIndirect(":/resources/images/AlexsApt_Env.hdr");
 }
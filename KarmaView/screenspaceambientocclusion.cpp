@@ -91,10 +91,6 @@ void ScreenSpaceAmbientOcclusion::initialize()
   p.m_blurProgram = new OpenGLShaderProgram;
   p.m_blurProgram->addShaderFromSourceFile(QOpenGLShader::Compute, ":/resources/shaders/compute/bilateralBlur.comp");
   p.m_blurProgram->link();
-  p.m_blurProgram->bind();
-  p.m_blurProgram->setUniformValue("src", 0);
-  p.m_blurProgram->setUniformValue("dst", 1);
-  p.m_blurProgram->release();
 
   // Setup blur data
   OpenGLBlurData data(8, 8.0f);
@@ -142,7 +138,7 @@ void ScreenSpaceAmbientOcclusion::render(OpenGLScene &)
   P(ScreenSpaceAmbientOcclusionPrivate);
   if (!active() && !p.m_lastActive) return;
 
-  OpenGLMarkerScoped _("Screen Space Ambient Occlusion");
+  OpenGLMarkerScoped _(OPENGL_MARKER_ID("Screen Space Ambient Occlusion"));
   OpenGLFramebufferObject::push();
   p.m_fbo.bind();
   if (active())
@@ -33,7 +33,7 @@ void ShadowedLightAccumulationPass::commit(OpenGLViewport &)
 
 void ShadowedLightAccumulationPass::render(OpenGLScene &scene)
 {
-  OpenGLMarkerScoped _("Shadow-Casting Light Accumulation Pass");
+  OpenGLMarkerScoped _(OPENGL_MARKER_ID("Shadow-Casting Light Accumulation Pass"));
   scene.renderShadowedLights();
 }
 
@@ -65,7 +65,7 @@ void ViewportPresentationPass::render(OpenGLScene &scene)
 {
   (void)scene;
   P(ViewportPresentationPassPrivate);
-  OpenGLMarkerScoped _("Viewport Presentation Pass");
+  OpenGLMarkerScoped _(OPENGL_MARKER_ID("Viewport Presentation Pass"));
 
   OpenGLFramebufferObject::release();
   GL::glViewport(p.m_x, p.m_y, p.m_width, p.m_height);
@@ -61,9 +61,23 @@ SOURCES += \
     openglrectanglelightgroup.cpp \
     openglrenderpass.cpp \
     openglupdateevent.cpp \
+    openglhdrpacking.cpp \
+    openglbrdflookup.cpp \
+    openglcubemapping.cpp \
+    openglringbuffer.cpp \
+    opengldispatch.cpp \
+    openglcallprofiler.cpp \
+    openglmarkerregistry.cpp \
+    openglprofilercapture.cpp \
+    openglprofilerstatistics.cpp \
     ../Karma/kabstractlexer.cpp \
     ../Karma/kabstracthdrparser.cpp \
-    ../Karma/kbufferedbinaryfilereader.cpp
+    ../Karma/kbufferedbinaryfilereader.cpp \
+    ../Karma/kthreadpool.cpp \
+    ../Karma/ktaskgroup.cpp \
+    ../Karma/kbc6hencoder.cpp \
+    ../Karma/ktexturefile.cpp \
+    ../Karma/kenvironmentbaker.cpp
 
 HEADERS += \
     openglprofiler.h \
@@ -138,4 +152,16 @@ HEADERS += \
     openglarealightdata.h \
     openglrectanglelight.h \
     openglrectanglelightgroup.h \
-    openglupdateevent.h
+    openglupdateevent.h \
+    openglhdrpacking.h \
+    openglbrdflookup.h \
+    openglcubemapping.h \
+    openglringbuffer.h \
+    opengldispatch.h \
+    opengldispatchentries.h \
+    openglcallprofiler.h \
+    openglcallscoped.h \
+    openglcpumarkerscoped.h \
+    openglmarkerregistry.h \
+    openglprofilercapture.h \
+    openglprofilerstatistics.h
@@ -5,18 +5,25 @@
 #include <OpenGLBlurData>
 #include <OpenGLBindings>
 
-bool OpenGLAbstractLightGroup::create()
+void OpenGLFactorSubroutines::resolve(OpenGLShaderProgram &program)
 {
-  // Get the subroutine locations
-#if !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
-  m_regularLight->bind();
-  m_uFresnel = GL::glGetSubroutineUniformLocation(m_regularLight->programId(), GL_FRAGMENT_SHADER, "uFresnel");
-  m_uGeometry = GL::glGetSubroutineUniformLocation(m_regularLight->programId(), GL_FRAGMENT_SHADER, "uGeometry");
-  m_uDistribution = GL::glGetSubroutineUniformLocation(m_regularLight->programId(), GL_FRAGMENT_SHADER, "uDistribution");
-  m_uDistributionSample = GL::glGetSubroutineUniformLocation(m_regularLight->programId(), GL_FRAGMENT_SHADER, "uDistributionSample");
-  m_regularLight->release();
-#endif
+  for (int f = 0; f < FresnelCount; ++f)
+  {
+    fresnel[f] = program.subroutineIndex(GL_FRAGMENT_SHADER, ("s" + FToCStr(f)).c_str());
+  }
+  for (int g = 0; g < GeometryCount; ++g)
+  {
+    geometry[g] = program.subroutineIndex(GL_FRAGMENT_SHADER, ("s" + GToCStr(g)).c_str());
+  }
+  for (int d = 0; d < DistributionCount; ++d)
+  {
+    distribution[d] = program.subroutineIndex(GL_FRAGMENT_SHADER, ("s" + DToCStr(d)).c_str());
+    distributionSample[d] = program.subroutineIndex(GL_FRAGMENT_SHADER, ("s" + DToCStr(d) + "Sample").c_str());
+  }
+}
 
+bool OpenGLAbstractLightGroup::create()
+{
   // Create the shadow texture
   m_shadowTexture.create(OpenGLTexture::Texture2D);
   m_shadowTexture.bind();
@@ -76,14 +83,21 @@ bool OpenGLAbstractLightGroup::create()
   m_blurProgram = new OpenGLShaderProgram;
   m_blurProgram->addShaderFromSourceFile(QOpenGLShader::Compute, ":/resources/shaders/compute/gaussianBlur.comp");
   m_blurProgram->link();
-  m_blurProgram->bind();
-  m_blurProgram->setUniformValue("src", 0);
-  m_blurProgram->setUniformValue("dst", 1);
-  m_blurProgram->release();
 
   return ret;
 }
 
+void OpenGLAbstractLightGroup::resolveLocations()
+{
+  // Get the subroutine locations (Waits for the program if still compiling)
+  m_uFresnel = m_regularLight->subroutineUniformLocation(GL_FRAGMENT_SHADER, "uFresnel");
+  m_uGeometry = m_regularLight->subroutineUniformLocation(GL_FRAGMENT_SHADER, "uGeometry");
+  m_uDistribution = m_regularLight->subroutineUniformLocation(GL_FRAGMENT_SHADER, "uDistribution");
+  m_uDistributionSample = m_regularLight->subroutineUniformLocation(GL_FRAGMENT_SHADER, "uDistributionSample");
+  m_subroutines.resolve(*m_regularLight);
+  m_uBlurDirection = m_blurProgram->uniformLocation("Direction");
+}
+
 void OpenGLAbstractLightGroup::setMesh(const OpenGLMesh &mesh)
 {
   m_mesh = mesh;
@@ -85,13 +85,28 @@ static std::string DToCStr(int d)
 
 #undef CASE
 
+// Fragment subroutine indices of a program for every factor ("s" + name, and
+// "s" + name + "Sample" for the sampled distributions), resolved once so that
+// drawing neither builds names nor queries GL.
+struct OpenGLFactorSubroutines
+{
+  void resolve(OpenGLShaderProgram &program);
+  unsigned fresnel[FresnelCount];
+  unsigned geometry[GeometryCount];
+  unsigned distribution[DistributionCount];
+  unsigned distributionSample[DistributionCount];
+};
+
 class OpenGLAbstractLightGroup
 {
 public:
   typedef unsigned char Byte;
 
   // Construction Routines
+  // Note: create() only submits the programs, resolveLocations() has to
+  //       follow once they may be used (e.g. after the compile batch).
   bool create();
+  void resolveLocations();
 
   // Properties
   void setMesh(const OpenGLMesh &mesh);
@@ -119,6 +134,8 @@ protected:
   OpenGLShaderProgram *m_shadowMappingLight;
   OpenGLShaderProgram *m_blurProgram;
   int m_uFresnel, m_uGeometry, m_uDistribution, m_uDistributionSample;
+  int m_uBlurDirection;
+  OpenGLFactorSubroutines m_subroutines;
 };
 
 #endif // OPENGLABSTRACTLIGHTGROUP_H
@@ -0,0 +1,293 @@
+#include "openglbrdflookup.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <KDebug>
+#include <KElapsedTimer>
+#include <KHash>
+#include <KMacros>
+#include <KMappedFile>
+#include <KParallel>
+#include <KTextureFile>
+#include <OpenGLAbstractLightGroup>
+#include <OpenGLTexture>
+#include <QString>
+
+// Table rows integrated per task.
+static const size_t RowGrain = 4;
+
+// Bumped whenever the integration changes, so old cache files are rejected.
+static const uint32_t LookupVersion = 1;
+
+// The scale and bias are solved from two reflectances. This is exact for the
+// Fresnel terms which are linear in F0, and a secant fit for Cook-Torrance.
+static const float LowF0 = 0.04f;
+static const float HighF0 = 0.9f;
+
+static const float Pi = 3.14159265358979f;
+static const float Pi2 = 6.28318530717959f;
+
+static inline float saturate(float value)
+{
+  return std::min(1.0f, std::max(0.0f, value));
+}
+
+static float radicalInverse(unsigned bits)
+{
+  bits = (bits << 16u) | (bits >> 16u);
+  bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+  bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+  bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+  bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+  return float(bits) * 2.3283064365386963e-10f;
+}
+
+/*******************************************************************************
+ * Factors (Mirrors lighting/Physical.glsl, see there for the notes)
+ ******************************************************************************/
+static float fresnel(int f, float F0, float VoH)
+{
+  switch (f)
+  {
+  case FNone:
+    return F0;
+  case FSchlick:
+    return F0 + (1.0f - F0) * std::pow(1.0f - VoH, 5.0f);
+  case FCookTorrance:
+  {
+    float c = VoH;
+    float k = std::sqrt(F0);
+    float n = (1.0f + k) / (1.0f - k);
+    float g = std::sqrt(n * n - 1.0f + c * c);
+    float gMc = g - c, gPc = g + c;
+    float gMc1 = gMc * c + 1.0f, gPc1 = gPc * c - 1.0f;
+    float factor0 = (gMc * gMc) / (gPc * gPc);
+    float factor1 = 1.0f + (gPc1 * gPc1) / (gMc1 * gMc1);
+    return 0.5f * factor0 * factor1;
+  }
+  case FSphericalGaussian:
+    return F0 + (1.0f - F0) * std::pow(2.0f, (-5.55473f * VoH - 6.98316f) * VoH);
+  }
+  return F0;
+}
+
+static float smithBeckmann(float roughness, float NoV, float VoH)
+{
+  float c = 1.0f / (roughness * std::sqrt(1.0f + 1.0f / NoV));
+  float c2 = c * c;
+  float final = (3.535f * c + 2.181f * c2) / (1.0f + 2.276f * c + 2.577f * c2);
+  float base = saturate(VoH / NoV);
+  return (c < 1.6f) ? base * final : base;
+}
+
+static float smithGgx(float roughness, float NoV)
+{
+  float NoV2 = NoV * NoV;
+  return (2.0f * NoV) / (NoV + std::sqrt(NoV2 + roughness * roughness * (1.0f - NoV2)));
+}
+
+static float smithSchlickBeckmann(float roughness, float NoV)
+{
+  float k = roughness * roughness * std::sqrt(Pi2);
+  return NoV / (NoV * (1.0f - k) + k);
+}
+
+static float geometry(int g, float roughness, float NoL, float NoV, float NoH, float VoH)
+{
+  switch (g)
+  {
+  case GImplicit:
+    return NoL * NoV;
+  case GNeumann:
+    return (NoL * NoV) / std::max(NoL, NoV);
+  case GCookTorrance:
+  {
+    float orig = (2.0f * NoH) / VoH;
+    return std::min(1.0f, std::min(NoV * orig, NoL * orig));
+  }
+  case GKelemen:
+    return std::min(2.0f * (NoH * NoV) / VoH, 1.0f);
+  case GSmithBeckmann:
+    return smithBeckmann(roughness, NoL, VoH) * smithBeckmann(roughness, NoV, VoH);
+  case GSmithGgx:
+    return smithGgx(roughness, NoL) * smithGgx(roughness, NoV);
+  case GSmithSchlickBeckmann:
+    return smithSchlickBeckmann(roughness, NoL) * smithSchlickBeckmann(roughness, NoV);
+  case GSmith:
+  {
+    float k = std::sqrt((2.0f * roughness * roughness) / Pi);
+    return NoV / (NoV * (1.0f - k) + k);
+  }
+  }
+  return 1.0f;
+}
+
+// Cosine of the half vector angle for the E.x sample of a distribution. Unlike
+// the shader versions, the sample follows D * NoH exactly (no random rotation,
+// Phong uses the same exponent as DPhong) so that D cancels in the estimator.
+static float sampleCosTheta(int s, float roughness, float E)
+{
+  float a2 = roughness * roughness;
+  switch (s)
+  {
+  case DPhong:
+  {
+    float ap = (2.0f / a2) - 2.0f;
+    return std::pow(E, 1.0f / (ap + 2.0f));
+  }
+  case DBeckmann:
+    return std::cos(std::atan(std::sqrt(-a2 * std::log(1.0f - E))));
+  case DGgx:
+    return std::cos(std::atan(std::sqrt((a2 * E) / (1.0f - E))));
+  }
+  return 1.0f;
+}
+
+/*******************************************************************************
+ * OpenGLBrdfLookupPrivate
+ ******************************************************************************/
+class OpenGLBrdfLookupPrivate
+{
+public:
+  OpenGLBrdfLookupPrivate();
+  static int index(int f, int g, int s);
+  void create(int f, int g, int s);
+  OpenGLTexture m_tables[FresnelCount * GeometryCount * DistributionCount];
+  bool m_created[FresnelCount * GeometryCount * DistributionCount];
+};
+
+OpenGLBrdfLookupPrivate::OpenGLBrdfLookupPrivate()
+{
+  std::memset(m_created, 0, sizeof(m_created));
+}
+
+int OpenGLBrdfLookupPrivate::index(int f, int g, int s)
+{
+  return (f * GeometryCount + g) * DistributionCount + s;
+}
+
+void OpenGLBrdfLookupPrivate::create(int f, int g, int s)
+{
+  // Keyed on the combination and the table layout.
+  uint32_t key[6] = { LookupVersion, uint32_t(f), uint32_t(g), uint32_t(s), OpenGLBrdfLookup::Size, OpenGLBrdfLookup::SampleCount };
+  uint64_t sourceHash = Karma::hash(key, sizeof(key));
+  QString cacheFile = Karma::cacheFileName(QString::fromStdString(FToCStr(f) + GToCStr(g) + DToCStr(s) + ".kbrdf"));
+
+  KElapsedTimer timer;
+  timer.start();
+  std::vector<float> generated;
+  float const *rg = Q_NULLPTR;
+  KTextureFile cache;
+  bool cached =
+    cache.map(cacheFile, KTextureFile::BrdfLookupFormat, LookupVersion, sourceHash) &&
+    cache.description().faces == 1 &&
+    cache.description().levels[0].width == OpenGLBrdfLookup::Size &&
+    cache.description().levels[0].height == OpenGLBrdfLookup::Size;
+  if (cached)
+  {
+    rg = static_cast<float const*>(cache.description().levels[0].data);
+  }
+  else
+  {
+    generated.resize(2 * OpenGLBrdfLookup::Size * OpenGLBrdfLookup::Size);
+    OpenGLBrdfLookup::integrate(f, g, s, generated.data());
+    rg = generated.data();
+
+    KTextureFile::Description desc;
+    std::memset(&desc, 0, sizeof(desc));
+    desc.format = KTextureFile::BrdfLookupFormat;
+    desc.method = LookupVersion;
+    desc.sourceHash = sourceHash;
+    desc.faces = 1;
+    desc.levelCount = 1;
+    desc.levels[0].width = OpenGLBrdfLookup::Size;
+    desc.levels[0].height = OpenGLBrdfLookup::Size;
+    desc.levels[0].data = rg;
+    desc.levels[0].size = generated.size() * sizeof(float);
+    KTextureFile::write(cacheFile, desc);
+  }
+
+  // The driver converts to half floats on upload.
+  OpenGLTexture &table = m_tables[index(f, g, s)];
+  table.create(OpenGLTexture::Texture2D);
+  table.bind();
+  table.setInternalFormat(OpenGLInternalFormat::Rg16F);
+  table.setWrapMode(OpenGLTexture::DirectionS, OpenGLTexture::ClampToEdge);
+  table.setWrapMode(OpenGLTexture::DirectionT, OpenGLTexture::ClampToEdge);
+  table.setFilter(OpenGLTexture::Magnification, OpenGLTexture::Linear);
+  table.setFilter(OpenGLTexture::Minification, OpenGLTexture::Linear);
+  table.setSize(OpenGLBrdfLookup::Size, OpenGLBrdfLookup::Size);
+  table.allocate(rg, 0, OpenGLBrdfLookup::Size, OpenGLBrdfLookup::Size, OpenGLType::Float);
+  table.release();
+  m_created[index(f, g, s)] = true;
+
+  kDebug() << "BRDF Lookup |" << FToCStr(f).c_str() << GToCStr(g).c_str() << DToCStr(s).c_str()
+           << "|" << (cached ? "Cache hit" : "Integrated") << "|" << timer.elapsed() << "ms";
+}
+
+/*******************************************************************************
+ * OpenGLBrdfLookup
+ ******************************************************************************/
+OpenGLBrdfLookup::OpenGLBrdfLookup() :
+  m_private(new OpenGLBrdfLookupPrivate)
+{
+  // Intentionally Empty
+}
+
+OpenGLBrdfLookup::~OpenGLBrdfLookup()
+{
+  delete m_private;
+}
+
+OpenGLTexture &OpenGLBrdfLookup::table(int fFactor, int gFactor, int sFactor)
+{
+  P(OpenGLBrdfLookupPrivate);
+  int i = OpenGLBrdfLookupPrivate::index(fFactor, gFactor, sFactor);
+  if (!p.m_created[i]) p.create(fFactor, gFactor, sFactor);
+  return p.m_tables[i];
+}
+
+void OpenGLBrdfLookup::integrate(int fFactor, int gFactor, int sFactor, float *rg)
+{
+  Karma::parallelFor(0, Size, RowGrain, [fFactor, gFactor, sFactor, rg](size_t b, size_t e)
+  {
+    for (size_t y = b; y < e; ++y)
+    {
+      float roughness = (float(y) + 0.5f) / float(Size);
+      for (size_t x = 0; x < size_t(Size); ++x)
+      {
+        // N = +Z, V in the XZ plane.
+        float NoV = (float(x) + 0.5f) / float(Size);
+        float V[3] = { std::sqrt(1.0f - NoV * NoV), 0.0f, NoV };
+
+        // Same estimator as the sampled shader loop: F * G * VoH / (NoH * NoV)
+        double low = 0.0, high = 0.0;
+        for (unsigned i = 0; i < SampleCount; ++i)
+        {
+          float cosTheta = sampleCosTheta(sFactor, roughness, float(i) / float(SampleCount));
+          float sinTheta = std::sqrt(std::max(1.0f - cosTheta * cosTheta, 0.0f));
+          float phi = Pi2 * radicalInverse(i);
+          float H[3] = { sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta };
+          float VoH = V[0] * H[0] + V[1] * H[1] + V[2] * H[2];
+          float NoL = 2.0f * VoH * H[2] - V[2];
+          if (NoL <= 0.0f || VoH <= 0.0f) continue;
+
+          float NoH = saturate(H[2]);
+          float G = geometry(gFactor, roughness, NoL, NoV, NoH, VoH);
+          float weight = G * VoH / (NoH * NoV);
+          low += fresnel(fFactor, LowF0, VoH) * weight;
+          high += fresnel(fFactor, HighF0, VoH) * weight;
+        }
+        low /= SampleCount;
+        high /= SampleCount;
+
+        float scale = float((high - low) / (HighF0 - LowF0));
+        float *out = &rg[2 * (y * Size + x)];
+        out[0] = scale;
+        out[1] = float(low) - scale * LowF0;
+      }
+    }
+  });
+}
@@ -0,0 +1,37 @@
+#ifndef OPENGLBRDFLOOKUP_H
+#define OPENGLBRDFLOOKUP_H OpenGLBrdfLookup
+
+class OpenGLTexture;
+
+// Split-sum environment BRDF: For every (NoV, roughness) texel the specular
+// integral is stored as a scale and bias of F0 (R = F0 * scale + bias, G).
+// One table exists per Fresnel / Geometry / sampled Distribution combination
+// of OpenGLAbstractLightGroup. The Distribution itself cancels out of the
+// importance sampled integral, so only the sampling routine matters.
+//
+// Tables are integrated on the CPU (rows in parallel) the first time they are
+// needed, cached to disk, and uploaded as Rg16F.
+class OpenGLBrdfLookupPrivate;
+class OpenGLBrdfLookup
+{
+public:
+  enum
+  {
+    Size = 64,
+    SampleCount = 256
+  };
+
+  OpenGLBrdfLookup();
+  ~OpenGLBrdfLookup();
+
+  // Returns the table, generating or loading it on first use.
+  OpenGLTexture &table(int fFactor, int gFactor, int sFactor);
+
+  // Size * Size RG floats, NoV along x and roughness along y (texel centers).
+  static void integrate(int fFactor, int gFactor, int sFactor, float *rg);
+
+private:
+  OpenGLBrdfLookupPrivate *m_private;
+};
+
+#endif // OPENGLBRDFLOOKUP_H
@@ -0,0 +1,97 @@
+#include "openglcallprofiler.h"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+/*******************************************************************************
+ * OpenGLCallTable
+ ******************************************************************************/
+// Only the owning thread writes the counters, flush() reads them and keeps
+// what it saw last, so neither side needs a read-modify-write.
+struct OpenGLCallTable
+{
+  OpenGLCallTable();
+  std::atomic<quint64> m_calls[OpenGLCallProfiler::MaxFunctions];
+  std::atomic<quint64> m_ns[OpenGLCallProfiler::MaxFunctions];
+  quint64 m_flushedCalls[OpenGLCallProfiler::MaxFunctions];
+  quint64 m_flushedNs[OpenGLCallProfiler::MaxFunctions];
+};
+
+OpenGLCallTable::OpenGLCallTable()
+{
+  for (unsigned i = 0; i < OpenGLCallProfiler::MaxFunctions; ++i)
+  {
+    m_calls[i].store(0, std::memory_order_relaxed);
+    m_ns[i].store(0, std::memory_order_relaxed);
+    m_flushedCalls[i] = m_flushedNs[i] = 0;
+  }
+}
+
+// Tables of exited threads stay around, their last counts still get flushed.
+static std::mutex sg_mutex;
+static std::vector<OpenGLCallTable*> sg_tables;
+static char const *sg_names[OpenGLCallProfiler::MaxFunctions] = { "Other" };
+static std::atomic<unsigned> sg_nameCount(1);
+static thread_local OpenGLCallTable *sg_threadTable = Q_NULLPTR;
+
+static OpenGLCallTable *threadTable()
+{
+  if (!sg_threadTable)
+  {
+    sg_threadTable = new OpenGLCallTable;
+    std::lock_guard<std::mutex> lock(sg_mutex);
+    sg_tables.push_back(sg_threadTable);
+  }
+  return sg_threadTable;
+}
+
+/*******************************************************************************
+ * OpenGLCallProfiler
+ ******************************************************************************/
+unsigned OpenGLCallProfiler::intern(char const *name)
+{
+  std::lock_guard<std::mutex> lock(sg_mutex);
+  unsigned count = sg_nameCount.load(std::memory_order_relaxed);
+  for (unsigned id = 1; id < count; ++id)
+  {
+    if (std::strcmp(sg_names[id], name) == 0) return id;
+  }
+  if (count == MaxFunctions) return OtherFunction;
+  sg_names[count] = name;
+  sg_nameCount.store(count + 1, std::memory_order_release);
+  return count;
+}
+
+char const *OpenGLCallProfiler::name(unsigned id)
+{
+  return (id < sg_nameCount.load(std::memory_order_acquire)) ? sg_names[id] : sg_names[OtherFunction];
+}
+
+void OpenGLCallProfiler::record(unsigned id, quint64 ns)
+{
+  OpenGLCallTable *table = threadTable();
+  table->m_calls[id].store(table->m_calls[id].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  table->m_ns[id].store(table->m_ns[id].load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+}
+
+void OpenGLCallProfiler::flush(OpenGLCallResults &results)
+{
+  results.clear();
+  std::lock_guard<std::mutex> lock(sg_mutex);
+  unsigned count = sg_nameCount.load(std::memory_order_relaxed);
+  for (unsigned id = 0; id < count; ++id)
+  {
+    OpenGLCallResult result = { id, 0, 0 };
+    for (OpenGLCallTable *table : sg_tables)
+    {
+      quint64 calls = table->m_calls[id].load(std::memory_order_relaxed);
+      quint64 ns = table->m_ns[id].load(std::memory_order_relaxed);
+      result.calls += static_cast<unsigned>(calls - table->m_flushedCalls[id]);
+      result.ns += ns - table->m_flushedNs[id];
+      table->m_flushedCalls[id] = calls;
+      table->m_flushedNs[id] = ns;
+    }
+    if (result.calls) results.push_back(result);
+  }
+}
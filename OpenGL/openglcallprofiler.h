@@ -0,0 +1,39 @@
+#ifndef OPENGLCALLPROFILER_H
+#define OPENGLCALLPROFILER_H OpenGLCallProfiler
+
+#include <vector>
+#include <QtGlobal>
+
+struct OpenGLCallResult
+{
+  unsigned id;
+  unsigned calls;
+  quint64 ns;
+};
+
+typedef std::vector<OpenGLCallResult> OpenGLCallResults;
+
+// CPU call counts and times of GL_PROFILE'd functions (GL_DEBUG). Every thread
+// counts into its own table without locking; flush() sums up what each table
+// gained since the last flush, once a frame from OpenGLProfiler. The GPU is
+// never involved, so the profiled calls keep their timing.
+class OpenGLCallProfiler
+{
+public:
+  enum
+  {
+    MaxFunctions = 512,
+    OtherFunction = 0
+  };
+
+  // Names must outlive the profiler (string literals). Once MaxFunctions are
+  // interned, further names are counted as OtherFunction.
+  static unsigned intern(char const *name);
+  static char const *name(unsigned id);
+  static void record(unsigned id, quint64 ns);
+
+  // Reuses the capacity of results, which only holds functions called since.
+  static void flush(OpenGLCallResults &results);
+};
+
+#endif // OPENGLCALLPROFILER_H
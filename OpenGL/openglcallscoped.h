@@ -0,0 +1,20 @@
+#ifndef OPENGLCALLSCOPED_H
+#define OPENGLCALLSCOPED_H OpenGLCallScoped
+
+#include <chrono>
+#include <OpenGLCallProfiler>
+
+class OpenGLCallScoped
+{
+public:
+  OpenGLCallScoped(unsigned id);
+  ~OpenGLCallScoped();
+private:
+  unsigned m_id;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+inline OpenGLCallScoped::OpenGLCallScoped(unsigned id) : m_id(id), m_start(std::chrono::steady_clock::now()) {}
+inline OpenGLCallScoped::~OpenGLCallScoped() { OpenGLCallProfiler::record(m_id, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count()); }
+
+#endif // OPENGLCALLSCOPED_H
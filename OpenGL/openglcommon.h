@@ -2,6 +2,7 @@
 #define OPENGLCOMMON_H OpenGLCommon
 
 #include <KMacros>
+#include <OpenGLCallScoped>
 #include <OpenGLError>
 #include <OpenGLMarkerScoped>
 
@@ -68,8 +69,8 @@
 #ifdef    GL_DEBUG
 # define GL_CHECK(caller,...) GL_DECL(caller,__VA_ARGS__) { if(!GL_CALL(caller,__VA_ARGS__)) { GL_REPORT(caller,__VA_ARGS__); return false; } return true; }
 # define GL_CHECK_CONST(caller,...) GL_DECL(caller,__VA_ARGS__) const { if(!GL_CALL(caller,__VA_ARGS__)) { GL_REPORT(caller,__VA_ARGS__); return false; } return true; }
-# define GL_PROFILE(caller,...) GL_DECL(caller,__VA_ARGS__) { OpenGLMarkerScoped prf(STR(PGET_N(0,__VA_ARGS__))); return GL_CALL(caller,__VA_ARGS__); }
-# define GL_PROFILE_CONST(caller,...) GL_DECL(caller,__VA_ARGS__) const { OpenGLMarkerScoped prf(STR(PGET_N(0,__VA_ARGS__))); return GL_CALL(caller,__VA_ARGS__); }
+# define GL_PROFILE(caller,...) GL_DECL(caller,__VA_ARGS__) { static const unsigned prf = OpenGLCallProfiler::intern(STR(caller) "::" STR(PGET_N(0,__VA_ARGS__))); OpenGLCallScoped scp(prf); return GL_CALL(caller,__VA_ARGS__); }
+# define GL_PROFILE_CONST(caller,...) GL_DECL(caller,__VA_ARGS__) const { static const unsigned prf = OpenGLCallProfiler::intern(STR(caller) "::" STR(PGET_N(0,__VA_ARGS__))); OpenGLCallScoped scp(prf); return GL_CALL(caller,__VA_ARGS__); }
 #else
 # define GL_CHECK(caller,...)
 # define GL_PROFILE(caller,...)
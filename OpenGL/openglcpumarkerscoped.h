@@ -0,0 +1,19 @@
+#ifndef OPENGLCPUMARKERSCOPED_H
+#define OPENGLCPUMARKERSCOPED_H OpenGLCpuMarkerScoped
+
+#include <OpenGLMarkerRegistry>
+#include <OpenGLProfiler>
+
+class OpenGLCpuMarkerScoped
+{
+public:
+  OpenGLCpuMarkerScoped(OpenGLMarkerId id);
+  OpenGLCpuMarkerScoped(const char *name);
+  ~OpenGLCpuMarkerScoped();
+};
+
+inline OpenGLCpuMarkerScoped::OpenGLCpuMarkerScoped(OpenGLMarkerId id) { OpenGLProfiler::PushCpuMarker(id); }
+inline OpenGLCpuMarkerScoped::OpenGLCpuMarkerScoped(const char *name) { OpenGLProfiler::PushCpuMarker(name); }
+inline OpenGLCpuMarkerScoped::~OpenGLCpuMarkerScoped() { OpenGLProfiler::PopCpuMarker(); }
+
+#endif // OPENGLCPUMARKERSCOPED_H
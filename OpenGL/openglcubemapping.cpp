@@ -0,0 +1,120 @@
+#include "openglcubemapping.h"
+
+#include <algorithm>
+#include <cmath>
+#include <KParallel>
+#include <OpenGLHdrPacking>
+#include <OpenGLToneMappingFunction>
+
+// Face rows resampled per task.
+static const size_t RowGrain = 8;
+
+// Taps per cube texel along each axis.
+static const int SuperSamples = 2;
+
+static const float Pi = 3.14159265358979f;
+static const float Pi2 = 6.28318530717959f;
+
+// Bilinear with wrapping longitude and clamped latitude (like the sampler of
+// the equirect texture).
+static inline void sampleBilinear(RgbF const *src, int width, int height, float u, float v, float rgb[3])
+{
+  float fx = u * width - 0.5f;
+  float fy = std::min(std::max(v * height - 0.5f, 0.0f), float(height - 1));
+  float x0f = std::floor(fx), y0f = std::floor(fy);
+  float tx = fx - x0f, ty = fy - y0f;
+  int x0 = int(x0f) % width;
+  if (x0 < 0) x0 += width;
+  int x1 = (x0 + 1 == width) ? 0 : x0 + 1;
+  int y0 = int(y0f);
+  int y1 = std::min(y0 + 1, height - 1);
+  RgbF const &a = src[size_t(y0) * width + x0];
+  RgbF const &b = src[size_t(y0) * width + x1];
+  RgbF const &c = src[size_t(y1) * width + x0];
+  RgbF const &d = src[size_t(y1) * width + x1];
+  float w00 = (1.0f - tx) * (1.0f - ty), w10 = tx * (1.0f - ty);
+  float w01 = (1.0f - tx) * ty, w11 = tx * ty;
+  rgb[0] += w00 * a.r + w10 * b.r + w01 * c.r + w11 * d.r;
+  rgb[1] += w00 * a.g + w10 * b.g + w01 * c.g + w11 * d.g;
+  rgb[2] += w00 * a.b + w10 * b.b + w01 * c.b + w11 * d.b;
+}
+
+/*******************************************************************************
+ * OpenGLCubeMapping
+ ******************************************************************************/
+int OpenGLCubeMapping::faceSize(int equirectWidth)
+{
+  return std::max(equirectWidth / 4, 1);
+}
+
+size_t OpenGLCubeMapping::faceTexels(int faceSize)
+{
+  return size_t(faceSize) * faceSize;
+}
+
+void OpenGLCubeMapping::faceDirection(int face, float s, float t, float dir[3])
+{
+  // Inverse of the face selection table in the GL specification.
+  static const float Table[FaceCount][3][3] =
+  {
+    // s                      t                       major
+    { {  0.0f, 0.0f, -1.0f }, { 0.0f, -1.0f,  0.0f }, {  1.0f,  0.0f,  0.0f } },
+    { {  0.0f, 0.0f,  1.0f }, { 0.0f, -1.0f,  0.0f }, { -1.0f,  0.0f,  0.0f } },
+    { {  1.0f, 0.0f,  0.0f }, { 0.0f,  0.0f,  1.0f }, {  0.0f,  1.0f,  0.0f } },
+    { {  1.0f, 0.0f,  0.0f }, { 0.0f,  0.0f, -1.0f }, {  0.0f, -1.0f,  0.0f } },
+    { {  1.0f, 0.0f,  0.0f }, { 0.0f, -1.0f,  0.0f }, {  0.0f,  0.0f,  1.0f } },
+    { { -1.0f, 0.0f,  0.0f }, { 0.0f, -1.0f,  0.0f }, {  0.0f,  0.0f, -1.0f } }
+  };
+  float const (*axes)[3] = Table[face];
+  for (int i = 0; i < 3; ++i)
+  {
+    dir[i] = s * axes[0][i] + t * axes[1][i] + axes[2][i];
+  }
+}
+
+void OpenGLCubeMapping::resampleParallel(RgbF const *src, int width, int height, int faceSize, RgbF *faces)
+{
+  size_t rows = size_t(FaceCount) * faceSize;
+  Karma::parallelFor(0, rows, RowGrain, [src, width, height, faceSize, faces](size_t b, size_t e)
+  {
+    const float weight = 1.0f / float(SuperSamples * SuperSamples);
+    const float step = 2.0f / float(faceSize * SuperSamples);
+    for (size_t row = b; row < e; ++row)
+    {
+      int face = int(row / faceSize);
+      int y = int(row % faceSize);
+      RgbF *out = faces + row * faceSize;
+      for (int x = 0; x < faceSize; ++x)
+      {
+        float rgb[3] = { 0.0f, 0.0f, 0.0f };
+        for (int j = 0; j < SuperSamples; ++j)
+        {
+          float t = (float(y * SuperSamples + j) + 0.5f) * step - 1.0f;
+          for (int i = 0; i < SuperSamples; ++i)
+          {
+            float s = (float(x * SuperSamples + i) + 0.5f) * step - 1.0f;
+            float dir[3];
+            faceDirection(face, s, t, dir);
+            float invLength = 1.0f / std::sqrt(dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2]);
+            float z = std::min(std::max(dir[2] * invLength, -1.0f), 1.0f);
+            float u = 0.5f - std::atan2(dir[1], dir[0]) / Pi2;
+            float v = std::acos(z) / Pi;
+            sampleBilinear(src, width, height, u, v, rgb);
+          }
+        }
+        out[x].r = rgb[0] * weight;
+        out[x].g = rgb[1] * weight;
+        out[x].b = rgb[2] * weight;
+      }
+    }
+  });
+}
+
+void OpenGLCubeMapping::downsampleParallel(RgbF const *faces, int faceSize, RgbF *dst)
+{
+  int nextSize = std::max(faceSize / 2, 1);
+  for (int face = 0; face < FaceCount; ++face)
+  {
+    OpenGLHdrPacking::downsampleParallel(faces + face * faceTexels(faceSize), faceSize, faceSize, dst + face * faceTexels(nextSize));
+  }
+}
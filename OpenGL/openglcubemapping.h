@@ -0,0 +1,35 @@
+#ifndef OPENGLCUBEMAPPING_H
+#define OPENGLCUBEMAPPING_H OpenGLCubeMapping
+
+#include <cstddef>
+
+struct RgbF;
+
+// Resampling of equirectangular maps (parameterized like SphereMap() in
+// Math.glsl) into cube maps. Faces are stored back to back in the order of
+// the GL face targets (+X, -X, +Y, -Y, +Z, -Z), each faceSize * faceSize with
+// rows running along the face's t coordinate, so a cube lookup in direction D
+// returns what textureSphere() would return for D.
+namespace OpenGLCubeMapping
+{
+  enum
+  {
+    FaceCount = 6
+  };
+
+  // Keeps the equatorial texel density of an equirect map of the given width.
+  int faceSize(int equirectWidth);
+  size_t faceTexels(int faceSize);
+
+  // Direction (not normalized) through (s, t) in [-1, 1] on the given face.
+  void faceDirection(int face, float s, float t, float dir[3]);
+
+  // Each cube texel averages 2x2 bilinear taps of the source, which keeps the
+  // poles (where the equirect map is much denser) from aliasing.
+  void resampleParallel(RgbF const *src, int width, int height, int faceSize, RgbF *faces);
+
+  // 2x2 box filter of every face into the next mip level.
+  void downsampleParallel(RgbF const *faces, int faceSize, RgbF *dst);
+}
+
+#endif // OPENGLCUBEMAPPING_H
@@ -185,7 +185,7 @@ public:
   OpenGLDebugGroups(const std::initializer_list<OpenGLAbstractDebugGroup*> &groups);
   void create();
   void write(KDebugVertex *dest);
-  void draw();
+  void draw(GLsizei first);
   void destroy();
   void clear();
   GLsizei size() const;
@@ -220,9 +220,9 @@ void OpenGLDebugGroups::write(KDebugVertex *dest)
   }
 }
 
-void OpenGLDebugGroups::draw()
+void OpenGLDebugGroups::draw(GLsizei first)
 {
-  GLsizei offset = 0;
+  GLsizei offset = first;
   for (OpenGLAbstractDebugGroup *group : m_groups)
   {
     group->bind();
@@ -322,23 +322,21 @@ void OpenGLDebugDraw::draw()
 
   // Send data to GPU
   {
-    OpenGLBuffer::RangeAccessFlags flags =
-      OpenGLBuffer::RangeUnsynchronized   |
-      OpenGLBuffer::RangeInvalidateBuffer |
-      OpenGLBuffer::RangeWrite;
     GLsizei size = sg_debugGroups.size();
-
-    sg_vertexBuffer.reserve(size);
-    KDebugVertex *dest = sg_vertexBuffer.mapRange(0, size, flags);
+    KDebugVertex *dest = sg_vertexBuffer.mapStream(size);
     sg_debugGroups.write(dest);
-    sg_vertexBuffer.unmap();
+    sg_vertexBuffer.unmapStream();
   }
 
   // Draw Data
+  // Note: The attributes follow the stream, its offset is a whole vertex.
   sg_vertexArrayObject->bind();
   {
+    sg_vertexBuffer.bindStream();
+    GL::glVertexAttribPointer(0, KDebugVertex::PositionTupleSize, GL_FLOAT, GL_FALSE, KDebugVertex::stride(), (void*)KDebugVertex::positionOffset());
+    GL::glVertexAttribPointer(1, KDebugVertex::ColorTupleSize, GL_FLOAT, GL_FALSE, KDebugVertex::stride(), (void*)KDebugVertex::colorOffset());
     glDisable(GL_DEPTH_TEST);
-    sg_debugGroups.draw();
+    sg_debugGroups.draw(static_cast<GLsizei>(sg_vertexBuffer.streamIndex()));
     glEnable(GL_DEPTH_TEST);
   }
   sg_vertexArrayObject->release();
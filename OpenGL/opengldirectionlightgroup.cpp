@@ -23,11 +23,11 @@ bool OpenGLDirectionLightGroup::create()
   return LightGroup::create();
 }
 
-void OpenGLDirectionLightGroup::initializeMesh(OpenGLMesh &mesh)
+void OpenGLDirectionLightGroup::initializeMesh(OpenGLMesh &mesh, int base)
 {
-  mesh.vertexAttribPointerDivisor(1, 3, OpenGLElementType::Float, false, sizeof(DataType), DataType::DirectionOffset() , 1);
-  mesh.vertexAttribPointerDivisor(2, 3, OpenGLElementType::Float, false, sizeof(DataType), DataType::DiffuseOffset()   , 1);
-  mesh.vertexAttribPointerDivisor(3, 3, OpenGLElementType::Float, false, sizeof(DataType), DataType::SpecularOffset()  , 1);
+  mesh.vertexAttribPointerDivisor(1, 3, OpenGLElementType::Float, false, sizeof(DataType), base + DataType::DirectionOffset() , 1);
+  mesh.vertexAttribPointerDivisor(2, 3, OpenGLElementType::Float, false, sizeof(DataType), base + DataType::DiffuseOffset()   , 1);
+  mesh.vertexAttribPointerDivisor(3, 3, OpenGLElementType::Float, false, sizeof(DataType), base + DataType::SpecularOffset()  , 1);
 }
 
 void OpenGLDirectionLightGroup::translateBuffer(const OpenGLRenderBlock &stats, DataPointer data, ConstLightIterator begin, ConstLightIterator end)
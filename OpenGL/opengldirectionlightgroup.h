@@ -12,7 +12,7 @@ class OpenGLDirectionLightGroup : public OpenGLLightGroup<OpenGLDirectionLight,
 {
 public:
   bool create();
-  void initializeMesh(OpenGLMesh &mesh);
+  void initializeMesh(OpenGLMesh &mesh, int base);
   void translateBuffer(const OpenGLRenderBlock &stats, DataPointer data, ConstLightIterator begin, ConstLightIterator end);
   void translateUniforms(const OpenGLRenderBlock &stats, Byte *data, SizeType step, ConstLightIterator begin, ConstLightIterator end);
 };
@@ -0,0 +1,109 @@
+#include "opengldispatch.h"
+
+#include <cstring>
+#include <QOpenGLContext>
+
+// Not every GL header has this (GL 4.1 / ARB_get_program_binary).
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+// Entry points a context below 4.3 may still have, through an extension or
+// because they were core in an earlier version.
+struct OpenGLExtensionEntry
+{
+  char const *name;
+  char const *extension;
+  int majorVersion;
+  int minorVersion;
+};
+
+static const OpenGLExtensionEntry sg_extensionEntries[] =
+{
+  { "glGetProgramBinary", "GL_ARB_get_program_binary", 4, 1 },
+  { "glProgramBinary", "GL_ARB_get_program_binary", 4, 1 },
+  { "glProgramParameteri", "GL_ARB_get_program_binary", 4, 1 },
+  { "glGetUniformSubroutineuiv", "GL_ARB_shader_subroutine", 4, 0 },
+  { "glUniformSubroutinesuiv", "GL_ARB_shader_subroutine", 4, 0 },
+  { "glGetProgramStageiv", "GL_ARB_shader_subroutine", 4, 0 },
+  { "glGetActiveSubroutineName", "GL_ARB_shader_subroutine", 4, 0 },
+  { "glGetActiveSubroutineUniformName", "GL_ARB_shader_subroutine", 4, 0 },
+  { "glGetActiveSubroutineUniformiv", "GL_ARB_shader_subroutine", 4, 0 },
+  { "glGetSubroutineIndex", "GL_ARB_shader_subroutine", 4, 0 },
+  { "glGetSubroutineUniformLocation", "GL_ARB_shader_subroutine", 4, 0 }
+};
+
+static bool hasExtensionEntry(QOpenGLContext *ctx, char const *name)
+{
+  if (ctx->isOpenGLES()) return false;
+  for (OpenGLExtensionEntry const &entry : sg_extensionEntries)
+  {
+    if (std::strcmp(entry.name, name) != 0) continue;
+    if (ctx->format().version() >= qMakePair(entry.majorVersion, entry.minorVersion)) return true;
+    return ctx->hasExtension(entry.extension);
+  }
+  return false;
+}
+
+/*******************************************************************************
+ * OpenGLDispatch
+ ******************************************************************************/
+OpenGLDispatch::Profile OpenGLDispatch::profile(QOpenGLContext *ctx)
+{
+  if (ctx->isOpenGLES()) return Es30;
+  return (ctx->format().version() >= qMakePair(4, 3)) ? Core43 : Core33;
+}
+
+bool OpenGLDispatch::resolve(QOpenGLContext *ctx, Profile profile, std::vector<char const*> *missing)
+{
+  // Some loaders (GLX) return an address for any name, so the profile decides
+  // which entries are looked up at all.
+  unsigned missingCount = 0;
+  auto lookup = [&](unsigned profiles, char const *name) -> QFunctionPointer
+  {
+    if (!(profiles & profile) && !hasExtensionEntry(ctx, name)) return Q_NULLPTR;
+    QFunctionPointer function = ctx->getProcAddress(name);
+    if (!function && (profiles & profile))
+    {
+      if (missing) missing->push_back(name);
+      ++missingCount;
+    }
+    return function;
+  };
+
+#define GL_ENTRY(profiles, ret, name, params) name = reinterpret_cast<decltype(name)>(lookup(profiles, #name));
+#include "opengldispatchentries.h"
+#undef GL_ENTRY
+
+  return (missingCount == 0);
+}
+
+/*******************************************************************************
+ * OpenGLCapabilities
+ ******************************************************************************/
+void OpenGLCapabilities::query(QOpenGLContext *ctx, OpenGLDispatch const &dispatch)
+{
+  auto integer = [&dispatch](GLenum property) -> int
+  {
+    GLint value = 0;
+    dispatch.glGetIntegerv(property, &value);
+    return static_cast<int>(value);
+  };
+
+  profile = OpenGLDispatch::profile(ctx);
+  majorVersion = integer(GL_MAJOR_VERSION);
+  minorVersion = integer(GL_MINOR_VERSION);
+  uniformBufferOffsetAlignment = integer(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT);
+  maxUniformBufferBindings = integer(GL_MAX_UNIFORM_BUFFER_BINDINGS);
+  maxUniformBlockSize = integer(GL_MAX_UNIFORM_BLOCK_SIZE);
+  maxCombinedTextureImageUnits = integer(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS);
+  maxTextureSize = integer(GL_MAX_TEXTURE_SIZE);
+  maxSamples = integer(GL_MAX_SAMPLES);
+  programBinaryFormats = dispatch.glProgramBinary ? integer(GL_NUM_PROGRAM_BINARY_FORMATS) : 0;
+  timerQuery = !ctx->isOpenGLES() || ctx->hasExtension("GL_EXT_disjoint_timer_query");
+  shaderSubroutine =
+    dispatch.glGetProgramStageiv && dispatch.glGetActiveSubroutineName &&
+    dispatch.glGetActiveSubroutineUniformName && dispatch.glGetSubroutineUniformLocation &&
+    dispatch.glUniformSubroutinesuiv;
+  computeShader = (profile == OpenGLDispatch::Core43);
+}
@@ -0,0 +1,54 @@
+#ifndef OPENGLDISPATCH_H
+#define OPENGLDISPATCH_H OpenGLDispatch
+
+#include <vector>
+#include <QtOpenGL/QGL>
+class QOpenGLContext;
+
+// Raw entry points of every function the GL:: wrappers call, resolved once
+// when the context is created. Calling through the table skips Qt's
+// versioned function objects (a private d-pointer hop per call).
+//
+// The entries are generated from the wrappers by scripts/GenDispatch.pl;
+// entries the context's profile does not have stay null.
+struct OpenGLDispatch
+{
+  enum Profile
+  {
+    Core33 = 1 << 0,
+    Core43 = 1 << 1,
+    Es30   = 1 << 2
+  };
+
+#define GL_ENTRY(profiles, ret, name, params) ret (QOPENGLF_APIENTRYP name) params;
+#include "opengldispatchentries.h"
+#undef GL_ENTRY
+
+  static Profile profile(QOpenGLContext *ctx);
+
+  // Returns false if the context lacks an entry point of its profile, the
+  // names of those are appended to missing.
+  bool resolve(QOpenGLContext *ctx, Profile profile, std::vector<char const*> *missing = Q_NULLPTR);
+};
+
+// Limits and features of the context, queried once next to the dispatch.
+struct OpenGLCapabilities
+{
+  OpenGLDispatch::Profile profile;
+  int majorVersion;
+  int minorVersion;
+  int uniformBufferOffsetAlignment;
+  int maxUniformBufferBindings;
+  int maxUniformBlockSize;
+  int maxCombinedTextureImageUnits;
+  int maxTextureSize;
+  int maxSamples;
+  int programBinaryFormats;
+  bool timerQuery;
+  bool shaderSubroutine; // GL 4.0 or ARB_shader_subroutine
+  bool computeShader;    // GL 4.3
+
+  void query(QOpenGLContext *ctx, OpenGLDispatch const &dispatch);
+};
+
+#endif // OPENGLDISPATCH_H
@@ -0,0 +1,307 @@
+// Generated by scripts/GenDispatch.pl, do not edit.
+// GL_ENTRY(Profiles, ReturnType, Name, (Parameters))
+
+GL_ENTRY(Core33 | Core43 | Es30, void, glActiveTexture, (GLenum texture))
+GL_ENTRY(Core33 | Core43 | Es30, void, glAttachShader, (GLuint program, GLuint shader))
+GL_ENTRY(Core33 | Core43 | Es30, void, glBindAttribLocation, (GLuint program, GLuint index, const GLchar *name))
+GL_ENTRY(Core33 | Core43 | Es30, void, glBindBuffer, (GLenum target, GLuint buffer))
+GL_ENTRY(Core33 | Core43 | Es30, void, glBindFramebuffer, (GLenum target, GLuint framebuffer))
+GL_ENTRY(Core33 | Core43 | Es30, void, glBindRenderbuffer, (GLenum target, GLuint renderbuffer))
+GL_ENTRY(Core33 | Core43 | Es30, void, glBindTexture, (GLenum target, GLuint texture))
+GL_ENTRY(Core33 | Core43 | Es30, void, glBlendColor, (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha))
+GL_ENTRY(Core33 | Core43 | Es30, void, glBlendEquation, (GLenum mode))
+GL_ENTRY(Core33 | Core43 | Es30, void, glBlendEquationSeparate, (GLenum modeRGB, GLenum modeAlpha))
+GL_ENTRY(Core33 | Core43 | Es30, void, glBlendFunc, (GLenum sfactor, GLenum dfactor))
+GL_ENTRY(Core33 | Core43 | Es30, void, glBlendFuncSeparate, (GLenum sfactorRGB, GLenum dfactorRGB, GLenum sfactorAlpha, GLenum dfactorAlpha))
+GL_ENTRY(Core33 | Core43 | Es30, void, glBufferData, (GLenum target, GLsizeiptr size, const void *data, GLenum usage))
+GL_ENTRY(Core33 | Core43 | Es30, void, glBufferSubData, (GLenum target, GLintptr offset, GLsizeiptr size, const void *data))
+GL_ENTRY(Core33 | Core43 | Es30, GLenum, glCheckFramebufferStatus, (GLenum target))
+GL_ENTRY(Core33 | Core43 | Es30, void, glClear, (GLbitfield mask))
+GL_ENTRY(Core33 | Core43 | Es30, void, glClearColor, (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha))
+GL_ENTRY(Core43 | Es30, void, glClearDepthf, (GLfloat d))
+GL_ENTRY(Core33 | Core43 | Es30, void, glClearStencil, (GLint s))
+GL_ENTRY(Core33 | Core43 | Es30, void, glColorMask, (GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha))
+GL_ENTRY(Core33 | Core43 | Es30, void, glCompileShader, (GLuint shader))
+GL_ENTRY(Core33 | Core43 | Es30, void, glCompressedTexImage2D, (GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void *data))
+GL_ENTRY(Core33 | Core43 | Es30, void, glCompressedTexSubImage2D, (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLsizei imageSize, const void *data))
+GL_ENTRY(Core33 | Core43 | Es30, void, glCopyTexImage2D, (GLenum target, GLint level, GLenum internalformat, GLint x, GLint y, GLsizei width, GLsizei height, GLint border))
+GL_ENTRY(Core33 | Core43 | Es30, void, glCopyTexSubImage2D, (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint x, GLint y, GLsizei width, GLsizei height))
+GL_ENTRY(Core33 | Core43 | Es30, GLuint, glCreateProgram, (void))
+GL_ENTRY(Core33 | Core43 | Es30, GLuint, glCreateShader, (GLenum type))
+GL_ENTRY(Core33 | Core43 | Es30, void, glCullFace, (GLenum mode))
+GL_ENTRY(Core33 | Core43 | Es30, void, glDeleteBuffers, (GLsizei n, const GLuint *buffers))
+GL_ENTRY(Core33 | Core43 | Es30, void, glDeleteFramebuffers, (GLsizei n, const GLuint *framebuffers))
+GL_ENTRY(Core33 | Core43 | Es30, void, glDeleteProgram, (GLuint program))
+GL_ENTRY(Core33 | Core43 | Es30, void, glDeleteRenderbuffers, (GLsizei n, const GLuint *renderbuffers))
+GL_ENTRY(Core33 | Core43 | Es30, void, glDeleteShader, (GLuint shader))
+GL_ENTRY(Core33 | Core43 | Es30, void, glDeleteTextures, (GLsizei n, const GLuint *textures))
+GL_ENTRY(Core33 | Core43 | Es30, void, glDepthFunc, (GLenum func))
+GL_ENTRY(Core33 | Core43 | Es30, void, glDepthMask, (GLboolean flag))
+GL_ENTRY(Core33 | Core43 | Es30, void, glDetachShader, (GLuint program, GLuint shader))
+GL_ENTRY(Core33 | Core43 | Es30, void, glDisable, (GLenum cap))
+GL_ENTRY(Core33 | Core43 | Es30, void, glDisableVertexAttribArray, (GLuint index))
+GL_ENTRY(Core33 | Core43 | Es30, void, glDrawArrays, (GLenum mode, GLint first, GLsizei count))
+GL_ENTRY(Core33 | Core43 | Es30, void, glDrawElements, (GLenum mode, GLsizei count, GLenum type, const void *indices))
+GL_ENTRY(Core33 | Core43 | Es30, void, glEnable, (GLenum cap))
+GL_ENTRY(Core33 | Core43 | Es30, void, glEnableVertexAttribArray, (GLuint index))
+GL_ENTRY(Core33 | Core43 | Es30, void, glFinish, (void))
+GL_ENTRY(Core33 | Core43 | Es30, void, glFlush, (void))
+GL_ENTRY(Core33 | Core43 | Es30, void, glFramebufferRenderbuffer, (GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer))
+GL_ENTRY(Core33 | Core43 | Es30, void, glFramebufferTexture2D, (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level))
+GL_ENTRY(Core33 | Core43 | Es30, void, glFrontFace, (GLenum mode))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGenBuffers, (GLsizei n, GLuint *buffers))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGenerateMipmap, (GLenum target))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGenFramebuffers, (GLsizei n, GLuint *framebuffers))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGenRenderbuffers, (GLsizei n, GLuint *renderbuffers))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGenTextures, (GLsizei n, GLuint *textures))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetActiveAttrib, (GLuint program, GLuint index, GLsizei bufSize, GLsizei *length, GLint *size, GLenum *type, GLchar *name))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetActiveUniform, (GLuint program, GLuint index, GLsizei bufSize, GLsizei *length, GLint *size, GLenum *type, GLchar *name))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetAttachedShaders, (GLuint program, GLsizei maxCount, GLsizei *count, GLuint *shaders))
+GL_ENTRY(Core33 | Core43 | Es30, GLint, glGetAttribLocation, (GLuint program, const GLchar *name))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetBooleanv, (GLenum pname, GLboolean *data))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetBufferParameteriv, (GLenum target, GLenum pname, GLint *params))
+GL_ENTRY(Core33 | Core43 | Es30, GLenum, glGetError, (void))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetFloatv, (GLenum pname, GLfloat *data))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetFramebufferAttachmentParameteriv, (GLenum target, GLenum attachment, GLenum pname, GLint *params))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetIntegerv, (GLenum pname, GLint *data))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetProgramiv, (GLuint program, GLenum pname, GLint *params))
+GL_ENTRY(Core43 | Es30, void, glGetProgramBinary, (GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, GLvoid *binary))
+GL_ENTRY(Core43 | Es30, void, glProgramBinary, (GLuint program, GLenum binaryFormat, const GLvoid *binary, GLsizei length))
+GL_ENTRY(Core43 | Es30, void, glProgramParameteri, (GLuint program, GLenum pname, GLint value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetProgramInfoLog, (GLuint program, GLsizei bufSize, GLsizei *length, GLchar *infoLog))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetRenderbufferParameteriv, (GLenum target, GLenum pname, GLint *params))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetShaderiv, (GLuint shader, GLenum pname, GLint *params))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetShaderInfoLog, (GLuint shader, GLsizei bufSize, GLsizei *length, GLchar *infoLog))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetShaderSource, (GLuint shader, GLsizei bufSize, GLsizei *length, GLchar *source))
+GL_ENTRY(Core33 | Core43 | Es30, const GLubyte *, glGetString, (GLenum name))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetTexParameterfv, (GLenum target, GLenum pname, GLfloat *params))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetTexParameteriv, (GLenum target, GLenum pname, GLint *params))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetUniformfv, (GLuint program, GLint location, GLfloat *params))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetUniformiv, (GLuint program, GLint location, GLint *params))
+GL_ENTRY(Core33 | Core43 | Es30, GLint, glGetUniformLocation, (GLuint program, const GLchar *name))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetVertexAttribfv, (GLuint index, GLenum pname, GLfloat *params))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetVertexAttribiv, (GLuint index, GLenum pname, GLint *params))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetVertexAttribPointerv, (GLuint index, GLenum pname, void **pointer))
+GL_ENTRY(Core33 | Core43 | Es30, void, glHint, (GLenum target, GLenum mode))
+GL_ENTRY(Core33 | Core43 | Es30, GLboolean, glIsBuffer, (GLuint buffer))
+GL_ENTRY(Core33 | Core43 | Es30, GLboolean, glIsEnabled, (GLenum cap))
+GL_ENTRY(Core33 | Core43 | Es30, GLboolean, glIsFramebuffer, (GLuint framebuffer))
+GL_ENTRY(Core33 | Core43 | Es30, GLboolean, glIsProgram, (GLuint program))
+GL_ENTRY(Core33 | Core43 | Es30, GLboolean, glIsRenderbuffer, (GLuint renderbuffer))
+GL_ENTRY(Core33 | Core43 | Es30, GLboolean, glIsShader, (GLuint shader))
+GL_ENTRY(Core33 | Core43 | Es30, GLboolean, glIsTexture, (GLuint texture))
+GL_ENTRY(Core33 | Core43 | Es30, void, glLineWidth, (GLfloat width))
+GL_ENTRY(Core33 | Core43 | Es30, void, glLinkProgram, (GLuint program))
+GL_ENTRY(Core33 | Core43 | Es30, void, glPixelStorei, (GLenum pname, GLint param))
+GL_ENTRY(Core33 | Core43 | Es30, void, glPolygonOffset, (GLfloat factor, GLfloat units))
+GL_ENTRY(Core33 | Core43 | Es30, void, glReadPixels, (GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void *pixels))
+GL_ENTRY(Core33 | Core43 | Es30, void, glRenderbufferStorage, (GLenum target, GLenum internalformat, GLsizei width, GLsizei height))
+GL_ENTRY(Core33 | Core43 | Es30, void, glSampleCoverage, (GLfloat value, GLboolean invert))
+GL_ENTRY(Core33 | Core43 | Es30, void, glScissor, (GLint x, GLint y, GLsizei width, GLsizei height))
+GL_ENTRY(Core33 | Core43 | Es30, void, glShaderSource, (GLuint shader, GLsizei count, const GLchar *const*string, const GLint *length))
+GL_ENTRY(Core33 | Core43 | Es30, void, glStencilFunc, (GLenum func, GLint ref, GLuint mask))
+GL_ENTRY(Core33 | Core43 | Es30, void, glStencilFuncSeparate, (GLenum face, GLenum func, GLint ref, GLuint mask))
+GL_ENTRY(Core33 | Core43 | Es30, void, glStencilMask, (GLuint mask))
+GL_ENTRY(Core33 | Core43 | Es30, void, glStencilMaskSeparate, (GLenum face, GLuint mask))
+GL_ENTRY(Core33 | Core43 | Es30, void, glStencilOp, (GLenum fail, GLenum zfail, GLenum zpass))
+GL_ENTRY(Core33 | Core43 | Es30, void, glStencilOpSeparate, (GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass))
+GL_ENTRY(Core33 | Core43 | Es30, void, glTexImage2D, (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void *pixels))
+GL_ENTRY(Core33 | Core43 | Es30, void, glTexParameterf, (GLenum target, GLenum pname, GLfloat param))
+GL_ENTRY(Core33 | Core43 | Es30, void, glTexParameterfv, (GLenum target, GLenum pname, const GLfloat *params))
+GL_ENTRY(Core33 | Core43 | Es30, void, glTexParameteri, (GLenum target, GLenum pname, GLint param))
+GL_ENTRY(Core33 | Core43 | Es30, void, glTexParameteriv, (GLenum target, GLenum pname, const GLint *params))
+GL_ENTRY(Core33 | Core43 | Es30, void, glTexSubImage2D, (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void *pixels))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform1f, (GLint location, GLfloat v0))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform1fv, (GLint location, GLsizei count, const GLfloat *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform1i, (GLint location, GLint v0))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform1iv, (GLint location, GLsizei count, const GLint *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform2f, (GLint location, GLfloat v0, GLfloat v1))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform2fv, (GLint location, GLsizei count, const GLfloat *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform2i, (GLint location, GLint v0, GLint v1))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform2iv, (GLint location, GLsizei count, const GLint *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform3f, (GLint location, GLfloat v0, GLfloat v1, GLfloat v2))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform3fv, (GLint location, GLsizei count, const GLfloat *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform3i, (GLint location, GLint v0, GLint v1, GLint v2))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform3iv, (GLint location, GLsizei count, const GLint *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform4f, (GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform4fv, (GLint location, GLsizei count, const GLfloat *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform4i, (GLint location, GLint v0, GLint v1, GLint v2, GLint v3))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform4iv, (GLint location, GLsizei count, const GLint *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniformMatrix2fv, (GLint location, GLsizei count, GLboolean transpose, const GLfloat *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniformMatrix3fv, (GLint location, GLsizei count, GLboolean transpose, const GLfloat *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniformMatrix4fv, (GLint location, GLsizei count, GLboolean transpose, const GLfloat *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUseProgram, (GLuint program))
+GL_ENTRY(Core33 | Core43 | Es30, void, glValidateProgram, (GLuint program))
+GL_ENTRY(Core33 | Core43 | Es30, void, glVertexAttribPointer, (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer))
+GL_ENTRY(Core33 | Core43 | Es30, void, glViewport, (GLint x, GLint y, GLsizei width, GLsizei height))
+GL_ENTRY(Core33 | Core43 | Es30, void, glReadBuffer, (GLenum src))
+GL_ENTRY(Core33 | Core43 | Es30, void, glDrawRangeElements, (GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const void *indices))
+GL_ENTRY(Core33 | Core43 | Es30, void, glTexImage3D, (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const void *pixels))
+GL_ENTRY(Core33 | Core43 | Es30, void, glTexSubImage3D, (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void *pixels))
+GL_ENTRY(Core33 | Core43 | Es30, void, glCopyTexSubImage3D, (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLint x, GLint y, GLsizei width, GLsizei height))
+GL_ENTRY(Core33 | Core43 | Es30, void, glCompressedTexImage3D, (GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLsizei imageSize, const void *data))
+GL_ENTRY(Core33 | Core43 | Es30, void, glCompressedTexSubImage3D, (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLsizei imageSize, const void *data))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGenQueries, (GLsizei n, GLuint *ids))
+GL_ENTRY(Core33 | Core43 | Es30, void, glDeleteQueries, (GLsizei n, const GLuint *ids))
+GL_ENTRY(Core33 | Core43 | Es30, GLboolean, glIsQuery, (GLuint id))
+GL_ENTRY(Core33 | Core43 | Es30, void, glBeginQuery, (GLenum target, GLuint id))
+GL_ENTRY(Core33 | Core43 | Es30, void, glEndQuery, (GLenum target))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetQueryiv, (GLenum target, GLenum pname, GLint *params))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetQueryObjectuiv, (GLuint id, GLenum pname, GLuint *params))
+GL_ENTRY(Core33 | Core43 | Es30, GLboolean, glUnmapBuffer, (GLenum target))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetBufferPointerv, (GLenum target, GLenum pname, void **params))
+GL_ENTRY(Core33 | Core43 | Es30, void, glDrawBuffers, (GLsizei n, const GLenum *bufs))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniformMatrix2x3fv, (GLint location, GLsizei count, GLboolean transpose, const GLfloat *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniformMatrix3x2fv, (GLint location, GLsizei count, GLboolean transpose, const GLfloat *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniformMatrix2x4fv, (GLint location, GLsizei count, GLboolean transpose, const GLfloat *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniformMatrix4x2fv, (GLint location, GLsizei count, GLboolean transpose, const GLfloat *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniformMatrix3x4fv, (GLint location, GLsizei count, GLboolean transpose, const GLfloat *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniformMatrix4x3fv, (GLint location, GLsizei count, GLboolean transpose, const GLfloat *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glBlitFramebuffer, (GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter))
+GL_ENTRY(Core33 | Core43 | Es30, void, glRenderbufferStorageMultisample, (GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height))
+GL_ENTRY(Core33 | Core43 | Es30, void, glFramebufferTextureLayer, (GLenum target, GLenum attachment, GLuint texture, GLint level, GLint layer))
+GL_ENTRY(Core33 | Core43 | Es30, void *, glMapBufferRange, (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access))
+GL_ENTRY(Core33 | Core43 | Es30, void, glFlushMappedBufferRange, (GLenum target, GLintptr offset, GLsizeiptr length))
+GL_ENTRY(Core33 | Core43 | Es30, void, glBindVertexArray, (GLuint array))
+GL_ENTRY(Core33 | Core43 | Es30, void, glDeleteVertexArrays, (GLsizei n, const GLuint *arrays))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGenVertexArrays, (GLsizei n, GLuint *arrays))
+GL_ENTRY(Core33 | Core43 | Es30, GLboolean, glIsVertexArray, (GLuint array))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetIntegeri_v, (GLenum target, GLuint index, GLint *data))
+GL_ENTRY(Core33 | Core43 | Es30, void, glBeginTransformFeedback, (GLenum primitiveMode))
+GL_ENTRY(Core33 | Core43 | Es30, void, glEndTransformFeedback, (void))
+GL_ENTRY(Core33 | Core43 | Es30, void, glBindBufferRange, (GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size))
+GL_ENTRY(Core33 | Core43 | Es30, void, glBindBufferBase, (GLenum target, GLuint index, GLuint buffer))
+GL_ENTRY(Core33 | Core43 | Es30, void, glTransformFeedbackVaryings, (GLuint program, GLsizei count, const GLchar *const*varyings, GLenum bufferMode))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetTransformFeedbackVarying, (GLuint program, GLuint index, GLsizei bufSize, GLsizei *length, GLsizei *size, GLenum *type, GLchar *name))
+GL_ENTRY(Core33 | Core43 | Es30, void, glVertexAttribIPointer, (GLuint index, GLint size, GLenum type, GLsizei stride, const void *pointer))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetVertexAttribIiv, (GLuint index, GLenum pname, GLint *params))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetVertexAttribIuiv, (GLuint index, GLenum pname, GLuint *params))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetUniformuiv, (GLuint program, GLint location, GLuint *params))
+GL_ENTRY(Core33 | Core43 | Es30, GLint, glGetFragDataLocation, (GLuint program, const GLchar *name))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform1ui, (GLint location, GLuint v0))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform2ui, (GLint location, GLuint v0, GLuint v1))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform3ui, (GLint location, GLuint v0, GLuint v1, GLuint v2))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform4ui, (GLint location, GLuint v0, GLuint v1, GLuint v2, GLuint v3))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform1uiv, (GLint location, GLsizei count, const GLuint *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform2uiv, (GLint location, GLsizei count, const GLuint *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform3uiv, (GLint location, GLsizei count, const GLuint *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniform4uiv, (GLint location, GLsizei count, const GLuint *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glClearBufferiv, (GLenum buffer, GLint drawbuffer, const GLint *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glClearBufferuiv, (GLenum buffer, GLint drawbuffer, const GLuint *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glClearBufferfv, (GLenum buffer, GLint drawbuffer, const GLfloat *value))
+GL_ENTRY(Core33 | Core43 | Es30, void, glClearBufferfi, (GLenum buffer, GLint drawbuffer, GLfloat depth, GLint stencil))
+GL_ENTRY(Core33 | Core43 | Es30, const GLubyte *, glGetStringi, (GLenum name, GLuint index))
+GL_ENTRY(Core33 | Core43 | Es30, void, glCopyBufferSubData, (GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetUniformIndices, (GLuint program, GLsizei uniformCount, const GLchar *const*uniformNames, GLuint *uniformIndices))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetActiveUniformsiv, (GLuint program, GLsizei uniformCount, const GLuint *uniformIndices, GLenum pname, GLint *params))
+GL_ENTRY(Core33 | Core43 | Es30, GLuint, glGetUniformBlockIndex, (GLuint program, const GLchar *uniformBlockName))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetActiveUniformBlockiv, (GLuint program, GLuint uniformBlockIndex, GLenum pname, GLint *params))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetActiveUniformBlockName, (GLuint program, GLuint uniformBlockIndex, GLsizei bufSize, GLsizei *length, GLchar *uniformBlockName))
+GL_ENTRY(Core33 | Core43 | Es30, void, glUniformBlockBinding, (GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding))
+GL_ENTRY(Core33 | Core43 | Es30, void, glDrawArraysInstanced, (GLenum mode, GLint first, GLsizei count, GLsizei instancecount))
+GL_ENTRY(Core33 | Core43 | Es30, void, glDrawElementsInstanced, (GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instancecount))
+GL_ENTRY(Core33 | Core43 | Es30, GLsync, glFenceSync, (GLenum condition, GLbitfield flags))
+GL_ENTRY(Core33 | Core43 | Es30, GLboolean, glIsSync, (GLsync sync))
+GL_ENTRY(Core33 | Core43 | Es30, void, glDeleteSync, (GLsync sync))
+GL_ENTRY(Core33 | Core43 | Es30, GLenum, glClientWaitSync, (GLsync sync, GLbitfield flags, GLuint64 timeout))
+GL_ENTRY(Core33 | Core43 | Es30, void, glWaitSync, (GLsync sync, GLbitfield flags, GLuint64 timeout))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetInteger64v, (GLenum pname, GLint64 *data))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetSynciv, (GLsync sync, GLenum pname, GLsizei bufSize, GLsizei *length, GLint *values))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetInteger64i_v, (GLenum target, GLuint index, GLint64 *data))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetBufferParameteri64v, (GLenum target, GLenum pname, GLint64 *params))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGenSamplers, (GLsizei count, GLuint *samplers))
+GL_ENTRY(Core33 | Core43 | Es30, void, glDeleteSamplers, (GLsizei count, const GLuint *samplers))
+GL_ENTRY(Core33 | Core43 | Es30, GLboolean, glIsSampler, (GLuint sampler))
+GL_ENTRY(Core33 | Core43 | Es30, void, glBindSampler, (GLuint unit, GLuint sampler))
+GL_ENTRY(Core33 | Core43 | Es30, void, glSamplerParameteri, (GLuint sampler, GLenum pname, GLint param))
+GL_ENTRY(Core33 | Core43 | Es30, void, glSamplerParameteriv, (GLuint sampler, GLenum pname, const GLint *param))
+GL_ENTRY(Core33 | Core43 | Es30, void, glSamplerParameterf, (GLuint sampler, GLenum pname, GLfloat param))
+GL_ENTRY(Core33 | Core43 | Es30, void, glSamplerParameterfv, (GLuint sampler, GLenum pname, const GLfloat *param))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetSamplerParameteriv, (GLuint sampler, GLenum pname, GLint *params))
+GL_ENTRY(Core33 | Core43 | Es30, void, glGetSamplerParameterfv, (GLuint sampler, GLenum pname, GLfloat *params))
+GL_ENTRY(Core33 | Core43 | Es30, void, glVertexAttribDivisor, (GLuint index, GLuint divisor))
+
+#if !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
+GL_ENTRY(Core33 | Core43, void, glClearDepth, (GLdouble d))
+GL_ENTRY(Core33 | Core43, void, glDepthRange, (GLdouble n, GLdouble f))
+GL_ENTRY(Core33 | Core43, void, glDrawElementsInstancedBaseVertex, (GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instancecount, GLsizei basevertex))
+GL_ENTRY(Core43, void, glDispatchCompute, (GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z))
+GL_ENTRY(Core43, void, glDispatchComputeIndirect, (GLintptr indirect))
+GL_ENTRY(Core43, void, glDrawArraysIndirect, (GLenum mode, const void *indirect))
+GL_ENTRY(Core43, void, glDrawElementsIndirect, (GLenum mode, GLenum type, const void *indirect))
+GL_ENTRY(Core43, void, glFramebufferParameteri, (GLenum target, GLenum pname, GLint param))
+GL_ENTRY(Core43, void, glGetFramebufferParameteriv, (GLenum target, GLenum pname, GLint *params))
+GL_ENTRY(Core43, void, glGetProgramInterfaceiv, (GLuint program, GLenum programInterface, GLenum pname, GLint *params))
+GL_ENTRY(Core43, GLuint, glGetProgramResourceIndex, (GLuint program, GLenum programInterface, const GLchar *name))
+GL_ENTRY(Core43, void, glGetProgramResourceName, (GLuint program, GLenum programInterface, GLuint index, GLsizei bufSize, GLsizei *length, GLchar *name))
+GL_ENTRY(Core43, void, glGetProgramResourceiv, (GLuint program, GLenum programInterface, GLuint index, GLsizei propCount, const GLenum *props, GLsizei bufSize, GLsizei *length, GLint *params))
+GL_ENTRY(Core43, GLint, glGetProgramResourceLocation, (GLuint program, GLenum programInterface, const GLchar *name))
+GL_ENTRY(Core43, void, glUseProgramStages, (GLuint pipeline, GLbitfield stages, GLuint program))
+GL_ENTRY(Core43, void, glActiveShaderProgram, (GLuint pipeline, GLuint program))
+GL_ENTRY(Core43, GLuint, glCreateShaderProgramv, (GLenum type, GLsizei count, const GLchar *const*strings))
+GL_ENTRY(Core43, void, glBindProgramPipeline, (GLuint pipeline))
+GL_ENTRY(Core43, void, glDeleteProgramPipelines, (GLsizei n, const GLuint *pipelines))
+GL_ENTRY(Core43, void, glGenProgramPipelines, (GLsizei n, GLuint *pipelines))
+GL_ENTRY(Core43, GLboolean, glIsProgramPipeline, (GLuint pipeline))
+GL_ENTRY(Core43, void, glGetProgramPipelineiv, (GLuint pipeline, GLenum pname, GLint *params))
+GL_ENTRY(Core43, void, glProgramUniform1i, (GLuint program, GLint location, GLint v0))
+GL_ENTRY(Core43, void, glProgramUniform2i, (GLuint program, GLint location, GLint v0, GLint v1))
+GL_ENTRY(Core43, void, glProgramUniform3i, (GLuint program, GLint location, GLint v0, GLint v1, GLint v2))
+GL_ENTRY(Core43, void, glProgramUniform4i, (GLuint program, GLint location, GLint v0, GLint v1, GLint v2, GLint v3))
+GL_ENTRY(Core43, void, glProgramUniform1ui, (GLuint program, GLint location, GLuint v0))
+GL_ENTRY(Core43, void, glProgramUniform2ui, (GLuint program, GLint location, GLuint v0, GLuint v1))
+GL_ENTRY(Core43, void, glProgramUniform3ui, (GLuint program, GLint location, GLuint v0, GLuint v1, GLuint v2))
+GL_ENTRY(Core43, void, glProgramUniform4ui, (GLuint program, GLint location, GLuint v0, GLuint v1, GLuint v2, GLuint v3))
+GL_ENTRY(Core43, void, glProgramUniform1f, (GLuint program, GLint location, GLfloat v0))
+GL_ENTRY(Core43, void, glProgramUniform2f, (GLuint program, GLint location, GLfloat v0, GLfloat v1))
+GL_ENTRY(Core43, void, glProgramUniform3f, (GLuint program, GLint location, GLfloat v0, GLfloat v1, GLfloat v2))
+GL_ENTRY(Core43, void, glProgramUniform4f, (GLuint program, GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3))
+GL_ENTRY(Core43, void, glProgramUniform1iv, (GLuint program, GLint location, GLsizei count, const GLint *value))
+GL_ENTRY(Core43, void, glProgramUniform2iv, (GLuint program, GLint location, GLsizei count, const GLint *value))
+GL_ENTRY(Core43, void, glProgramUniform3iv, (GLuint program, GLint location, GLsizei count, const GLint *value))
+GL_ENTRY(Core43, void, glProgramUniform4iv, (GLuint program, GLint location, GLsizei count, const GLint *value))
+GL_ENTRY(Core43, void, glProgramUniform1uiv, (GLuint program, GLint location, GLsizei count, const GLuint *value))
+GL_ENTRY(Core43, void, glProgramUniform2uiv, (GLuint program, GLint location, GLsizei count, const GLuint *value))
+GL_ENTRY(Core43, void, glProgramUniform3uiv, (GLuint program, GLint location, GLsizei count, const GLuint *value))
+GL_ENTRY(Core43, void, glProgramUniform4uiv, (GLuint program, GLint location, GLsizei count, const GLuint *value))
+GL_ENTRY(Core43, void, glProgramUniform1fv, (GLuint program, GLint location, GLsizei count, const GLfloat *value))
+GL_ENTRY(Core43, void, glProgramUniform2fv, (GLuint program, GLint location, GLsizei count, const GLfloat *value))
+GL_ENTRY(Core43, void, glProgramUniform3fv, (GLuint program, GLint location, GLsizei count, const GLfloat *value))
+GL_ENTRY(Core43, void, glProgramUniform4fv, (GLuint program, GLint location, GLsizei count, const GLfloat *value))
+GL_ENTRY(Core43, void, glProgramUniformMatrix2fv, (GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value))
+GL_ENTRY(Core43, void, glProgramUniformMatrix3fv, (GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value))
+GL_ENTRY(Core43, void, glProgramUniformMatrix4fv, (GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value))
+GL_ENTRY(Core43, void, glProgramUniformMatrix2x3fv, (GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value))
+GL_ENTRY(Core43, void, glProgramUniformMatrix3x2fv, (GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value))
+GL_ENTRY(Core43, void, glProgramUniformMatrix2x4fv, (GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value))
+GL_ENTRY(Core43, void, glProgramUniformMatrix4x2fv, (GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value))
+GL_ENTRY(Core43, void, glProgramUniformMatrix3x4fv, (GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value))
+GL_ENTRY(Core43, void, glProgramUniformMatrix4x3fv, (GLuint program, GLint location, GLsizei count, GLboolean transpose, const GLfloat *value))
+GL_ENTRY(Core43, void, glValidateProgramPipeline, (GLuint pipeline))
+GL_ENTRY(Core43, void, glGetProgramPipelineInfoLog, (GLuint pipeline, GLsizei bufSize, GLsizei *length, GLchar *infoLog))
+GL_ENTRY(Core43, void, glBindImageTexture, (GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format))
+GL_ENTRY(Core33 | Core43, void, glGetBooleani_v, (GLenum target, GLuint index, GLboolean *data))
+GL_ENTRY(Core43, void, glMemoryBarrier, (GLbitfield barriers))
+GL_ENTRY(Core43, void, glTexStorage2DMultisample, (GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height, GLboolean fixedsamplelocations))
+GL_ENTRY(Core33 | Core43, void, glGetMultisamplefv, (GLenum pname, GLuint index, GLfloat *val))
+GL_ENTRY(Core33 | Core43, void, glSampleMaski, (GLuint maskNumber, GLbitfield mask))
+GL_ENTRY(Core33 | Core43, void, glGetTexLevelParameteriv, (GLenum target, GLint level, GLenum pname, GLint *params))
+GL_ENTRY(Core33 | Core43, void, glGetTexLevelParameterfv, (GLenum target, GLint level, GLenum pname, GLfloat *params))
+GL_ENTRY(Core43, void, glBindVertexBuffer, (GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride))
+GL_ENTRY(Core43, void, glVertexAttribFormat, (GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset))
+GL_ENTRY(Core43, void, glVertexAttribIFormat, (GLuint attribindex, GLint size, GLenum type, GLuint relativeoffset))
+GL_ENTRY(Core43, void, glVertexAttribBinding, (GLuint attribindex, GLuint bindingindex))
+GL_ENTRY(Core43, void, glVertexBindingDivisor, (GLuint bindingindex, GLuint divisor))
+GL_ENTRY(Core33 | Core43, void *, glMapBuffer, (GLenum target, GLenum access))
+GL_ENTRY(Core43, void, glShaderStorageBlockBinding, (GLuint program, GLuint storageBlockIndex, GLuint storageBlockBinding))
+GL_ENTRY(Core43, void, glGetUniformSubroutineuiv, (GLenum shadertype, GLint location, GLuint *params))
+GL_ENTRY(Core43, void, glUniformSubroutinesuiv, (GLenum shadertype, GLsizei count, const GLuint *indices))
+GL_ENTRY(Core43, void, glGetProgramStageiv, (GLuint program, GLenum shadertype, GLenum pname, GLint *values))
+GL_ENTRY(Core43, void, glGetActiveSubroutineName, (GLuint program, GLenum shadertype, GLuint index, GLsizei bufsize, GLsizei *length, GLchar *name))
+GL_ENTRY(Core43, void, glGetActiveSubroutineUniformName, (GLuint program, GLenum shadertype, GLuint index, GLsizei bufsize, GLsizei *length, GLchar *name))
+GL_ENTRY(Core43, void, glGetActiveSubroutineUniformiv, (GLuint program, GLenum shadertype, GLuint index, GLenum pname, GLint *values))
+GL_ENTRY(Core43, GLuint, glGetSubroutineIndex, (GLuint program, GLenum shadertype, const GLchar *name))
+GL_ENTRY(Core43, GLint, glGetSubroutineUniformLocation, (GLuint program, GLenum shadertype, const GLchar *name))
+GL_ENTRY(Core33 | Core43, void, glQueryCounter, (GLuint id, GLenum target))
+GL_ENTRY(Core33 | Core43, void, glGetQueryObjectui64v, (GLuint id, GLenum pname, GLuint64 *params))
+#endif
@@ -2,6 +2,7 @@
 #define OPENGLDYNAMICBUFFER_H OpenGLDynamicBuffer
 
 #include <OpenGLBuffer>
+#include <OpenGLRingBuffer>
 
 template <typename T>
 class OpenGLDynamicBuffer : public OpenGLBuffer
@@ -17,13 +18,30 @@ public:
   ElementPointer mapRange(size_t offset, size_t count, RangeAccessFlags access);
   void bindRangeElement(Type type, unsigned index, unsigned element);
   SizeType count() const;
+
+  // Streaming (Per-frame data through the shared OpenGLRingBuffer)
+  // Elements are aligned to their size, so streamIndex() can be used as the
+  // first vertex or instance. Without a ring buffer, or when it cannot make
+  // the allocation, the own storage is used.
+  ElementPointer mapStream(size_t count);
+  void unmapStream();
+  void bindStream();
+  GLuint streamBufferId() const;
+  size_t streamOffset() const;
+  size_t streamIndex() const;
+
+private:
+  OpenGLRingBuffer::Allocation m_stream;
 };
 
 template <typename T>
 OpenGLDynamicBuffer<T>::OpenGLDynamicBuffer(OpenGLBuffer::Type type) :
   OpenGLBuffer(type)
 {
-  // Intentionally Empty
+  m_stream.data = Q_NULLPTR;
+  m_stream.buffer = 0;
+  m_stream.offset = 0;
+  m_stream.size = 0;
 }
 
 template <typename T>
@@ -54,5 +72,63 @@ auto OpenGLDynamicBuffer<T>::count() const -> SizeType
   return size() / sizeof(ElementType);
 }
 
+template <typename T>
+auto OpenGLDynamicBuffer<T>::mapStream(size_t count) -> ElementPointer
+{
+  OpenGLRingBuffer *ring = OpenGLRingBuffer::ringBuffer();
+  if (ring && ring->isCreated())
+  {
+    m_stream = ring->allocate(sizeof(ElementType) * count, sizeof(ElementType));
+    if (m_stream.data) return static_cast<ElementPointer>(m_stream.data);
+  }
+
+  bind();
+  reserve(count);
+  m_stream.buffer = bufferId();
+  m_stream.offset = 0;
+  m_stream.size = sizeof(ElementType) * count;
+  m_stream.data = mapRange(0, count, RangeInvalidateBuffer | RangeWrite);
+  return static_cast<ElementPointer>(m_stream.data);
+}
+
+template <typename T>
+void OpenGLDynamicBuffer<T>::unmapStream()
+{
+  OpenGLRingBuffer *ring = OpenGLRingBuffer::ringBuffer();
+  if (ring && m_stream.buffer != bufferId())
+  {
+    ring->flush(m_stream);
+  }
+  else
+  {
+    unmap();
+    release();
+  }
+}
+
+template <typename T>
+void OpenGLDynamicBuffer<T>::bindStream()
+{
+  GL::glBindBuffer(static_cast<GLenum>(type()), m_stream.buffer);
+}
+
+template <typename T>
+GLuint OpenGLDynamicBuffer<T>::streamBufferId() const
+{
+  return m_stream.buffer;
+}
+
+template <typename T>
+size_t OpenGLDynamicBuffer<T>::streamOffset() const
+{
+  return m_stream.offset;
+}
+
+template <typename T>
+size_t OpenGLDynamicBuffer<T>::streamIndex() const
+{
+  return m_stream.offset / sizeof(ElementType);
+}
+
 #endif // OPENGLDYNAMICBUFFER_H
 
@@ -1,23 +1,52 @@
 #include "openglenvironment.h"
 
+#include <algorithm>
+#include <KDebug>
+#include <KElapsedTimer>
+#include <KEnvironmentBaker>
 #include <KMacros>
+#include <KMappedFile>
+#include <OpenGLCubeMapping>
+#include <OpenGLFunctions>
 #include <OpenGLTexture>
+#include <OpenGLHdrPacking>
 #include <OpenGLHdrTexture>
 #include <KBufferedBinaryFileReader>
+#include <QFileInfo>
+
+// Only used when the file cannot be memory mapped.
+static const size_t ReaderBufferSize = 64 * 1024;
+
+// Encoded textures are cached per source file, the file validates its source.
+static QString cacheFileName(char const *filePath, char const *suffix = ".ktex")
+{
+  return Karma::cacheFileName(QFileInfo(filePath).completeBaseName() + suffix);
+}
 
 class OpenGLEnvrionmentPrivate
 {
 public:
   OpenGLEnvrionmentPrivate();
   ~OpenGLEnvrionmentPrivate();
+  void bake(OpenGLHdrTextureLoader const &loader, char const *filePath);
+  void uploadPrefiltered();
   bool m_dirty;
+  bool m_hasIndirect;
+  bool m_cubeMapEnabled;
+  bool m_isCubeMap;
+  size_t m_directBytes;
+  size_t m_prefilteredBytes;
   OpenGLTexture m_directIllumination;
   OpenGLTexture m_indirectIllumination;
+  OpenGLTexture m_prefiltered;
+  KEnvironmentBaker m_baker;
   OpenGLToneMappingFunction *m_toneMapping;
+  OpenGLInternalFormat m_format;
+  KBc6hEncoder::Quality m_quality;
 };
 
 OpenGLEnvrionmentPrivate::OpenGLEnvrionmentPrivate() :
-  m_dirty(false), m_toneMapping(0)
+  m_dirty(false), m_hasIndirect(false), m_cubeMapEnabled(false), m_isCubeMap(false), m_directBytes(0), m_prefilteredBytes(0), m_toneMapping(0), m_format(OpenGLInternalFormat::Rgb32F), m_quality(KBc6hEncoder::FastQuality)
 {
   // Intentionally Empty
 }
@@ -27,6 +56,87 @@ OpenGLEnvrionmentPrivate::~OpenGLEnvrionmentPrivate()
   delete m_toneMapping;
 }
 
+void OpenGLEnvrionmentPrivate::bake(OpenGLHdrTextureLoader const &loader, char const *filePath)
+{
+  std::vector<float> const &rgb = loader.retainedData();
+  if (rgb.empty()) return;
+
+  // Keyed on the tone mapped texels and the bake settings.
+  QString cacheFile = cacheFileName(filePath, ".kenv");
+  uint64_t sourceHash = m_baker.sourceHash(rgb.data(), loader.width(), loader.height());
+  KElapsedTimer timer;
+  timer.start();
+  bool cached = m_baker.load(cacheFile, sourceHash);
+  if (!cached)
+  {
+    m_baker.bake(rgb.data(), loader.width(), loader.height());
+    m_baker.save(cacheFile, sourceHash);
+  }
+  uploadPrefiltered();
+  kDebug() << "Environment Bake |" << (cached ? "Cache hit" : "Baked") << "|" << timer.elapsed() << "ms";
+}
+
+void OpenGLEnvrionmentPrivate::uploadPrefiltered()
+{
+  // Half floats are plenty for the blurred levels, regardless of m_format.
+  static const OpenGLInternalFormat Format = OpenGLInternalFormat::Rgb16F;
+  OpenGLTexture::WrapMode wrap = m_isCubeMap ? OpenGLTexture::ClampToEdge : OpenGLTexture::Repeat;
+  int faces = m_isCubeMap ? int(OpenGLCubeMapping::FaceCount) : 1;
+  int faceSize = OpenGLCubeMapping::faceSize(m_baker.level(0).width);
+  m_prefiltered.create(m_isCubeMap ? OpenGLTexture::TextureCubeMap : OpenGLTexture::Texture2D);
+  m_prefiltered.bind();
+  m_prefiltered.setInternalFormat(Format);
+  m_prefiltered.setWrapMode(OpenGLTexture::DirectionS, wrap);
+  m_prefiltered.setWrapMode(OpenGLTexture::DirectionT, wrap);
+  if (m_isCubeMap) m_prefiltered.setWrapMode(OpenGLTexture::DirectionR, wrap);
+  m_prefiltered.setFilter(OpenGLTexture::Magnification, OpenGLTexture::Linear);
+  m_prefiltered.setFilter(OpenGLTexture::Minification, OpenGLTexture::LinearMipMap);
+  m_prefiltered.setSize(m_baker.level(0).width, m_baker.level(0).height);
+  m_prefiltered.setSwizzle(OpenGLTexture::Red, OpenGLTexture::Green, OpenGLTexture::Blue, OpenGLTexture::One);
+
+  // Packed rows are not always 4-byte aligned (Rgb16F with odd widths).
+  // Cube levels are resampled from the baked level of the same roughness, so
+  // the chain has to follow the mip sizes of the first face.
+  std::vector<RgbF> cube;
+  std::vector<unsigned char> packed;
+  m_prefilteredBytes = 0;
+  int unpackAlignment = GL::getInteger(GL_UNPACK_ALIGNMENT);
+  GL::glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  for (int i = 0; i < m_baker.levelCount(); ++i)
+  {
+    KEnvironmentBaker::Level const &level = m_baker.level(i);
+    RgbF const *pixels = reinterpret_cast<RgbF const*>(level.rgb.data());
+    int width = level.width, height = level.height;
+    if (m_isCubeMap)
+    {
+      width = height = std::max(faceSize >> i, 1);
+      cube.resize(OpenGLCubeMapping::faceTexels(width) * faces, RgbF(0.0f, 0.0f, 0.0f));
+      OpenGLCubeMapping::resampleParallel(pixels, level.width, level.height, width, cube.data());
+      pixels = cube.data();
+    }
+    size_t texels = size_t(width) * height;
+    size_t faceBytes = texels * OpenGLHdrPacking::texelSize(Format);
+    packed.resize(faceBytes * faces);
+    OpenGLHdrPacking::packParallel(Format, pixels, packed.data(), texels * faces);
+    if (m_isCubeMap)
+    {
+      for (int face = 0; face < faces; ++face)
+      {
+        OpenGLTexture::CubeMapFace target = OpenGLTexture::CubeMapFace(OpenGLTexture::PositiveX + face);
+        m_prefiltered.allocate(target, packed.data() + face * faceBytes, i, width, height, OpenGLHdrPacking::packedType(Format));
+      }
+    }
+    else
+    {
+      m_prefiltered.allocate(packed.data(), i, width, height, OpenGLHdrPacking::packedType(Format));
+    }
+    m_prefilteredBytes += faceBytes * faces;
+  }
+  GL::glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+  m_prefiltered.setMaxLevel(m_baker.levelCount() - 1);
+  m_prefiltered.release();
+}
+
 OpenGLEnvironment::OpenGLEnvironment() :
   m_private(new OpenGLEnvrionmentPrivate)
 {
@@ -46,17 +156,34 @@ void OpenGLEnvironment::create()
 void OpenGLEnvironment::setDirect(const char *filePath)
 {
   P(OpenGLEnvrionmentPrivate);
-  KBufferedBinaryFileReader reader(filePath, 1024);
+  KBufferedBinaryFileReader reader(filePath, ReaderBufferSize);
   OpenGLHdrTextureLoader loader(&reader, &p.m_directIllumination);
+  loader.setInternalFormat(p.m_format);
+  loader.setCompressionQuality(p.m_quality);
+  loader.setRetainData(true);
+  loader.setTarget(p.m_cubeMapEnabled ? OpenGLTexture::TextureCubeMap : OpenGLTexture::Texture2D);
+  if (p.m_format == OpenGLInternalFormat::RgbBptcUnsignedFloat)
+  {
+    loader.setCacheFile(cacheFileName(filePath, p.m_cubeMapEnabled ? ".cube.ktex" : ".ktex"));
+  }
   loader.parse(p.m_toneMapping);
+  p.m_isCubeMap = (loader.target() == OpenGLTexture::TextureCubeMap);
+  p.m_directBytes = loader.uploadedBytes();
+  p.bake(loader, filePath);
 }
 
 void OpenGLEnvironment::setIndirect(const char *filePath)
 {
   P(OpenGLEnvrionmentPrivate);
-  KBufferedBinaryFileReader reader(filePath, 1024);
+  KBufferedBinaryFileReader reader(filePath, ReaderBufferSize);
   OpenGLHdrTextureLoader loader(&reader, &p.m_indirectIllumination);
-  loader.parse(p.m_toneMapping);
+  loader.setInternalFormat(p.m_format);
+  loader.setCompressionQuality(p.m_quality);
+  if (p.m_format == OpenGLInternalFormat::RgbBptcUnsignedFloat)
+  {
+    loader.setCacheFile(cacheFileName(filePath));
+  }
+  p.m_hasIndirect = loader.parse(p.m_toneMapping);
 }
 
 void OpenGLEnvironment::setToneMappingFunction(OpenGLToneMappingFunction *fnc)
@@ -65,6 +192,24 @@ void OpenGLEnvironment::setToneMappingFunction(OpenGLToneMappingFunction *fnc)
   p.m_toneMapping = fnc;
 }
 
+void OpenGLEnvironment::setInternalFormat(OpenGLInternalFormat format)
+{
+  P(OpenGLEnvrionmentPrivate);
+  p.m_format = format;
+}
+
+OpenGLInternalFormat OpenGLEnvironment::internalFormat() const
+{
+  P(const OpenGLEnvrionmentPrivate);
+  return p.m_format;
+}
+
+void OpenGLEnvironment::setCompressionQuality(KBc6hEncoder::Quality quality)
+{
+  P(OpenGLEnvrionmentPrivate);
+  p.m_quality = quality;
+}
+
 OpenGLTexture &OpenGLEnvironment::direct()
 {
   P(OpenGLEnvrionmentPrivate);
@@ -82,3 +227,51 @@ const KSize &OpenGLEnvironment::directSize() const
   P(const OpenGLEnvrionmentPrivate);
   return p.m_directIllumination.size();
 }
+
+bool OpenGLEnvironment::hasIndirect() const
+{
+  P(const OpenGLEnvrionmentPrivate);
+  return p.m_hasIndirect;
+}
+
+OpenGLTexture &OpenGLEnvironment::prefiltered()
+{
+  P(OpenGLEnvrionmentPrivate);
+  return p.m_prefiltered;
+}
+
+float OpenGLEnvironment::prefilteredMaxLevel() const
+{
+  P(const OpenGLEnvrionmentPrivate);
+  return float(p.m_baker.levelCount() - 1);
+}
+
+float const *OpenGLEnvironment::irradiance() const
+{
+  P(const OpenGLEnvrionmentPrivate);
+  return &p.m_baker.irradiance()[0][0];
+}
+
+void OpenGLEnvironment::setCubeMapEnabled(bool enabled)
+{
+  P(OpenGLEnvrionmentPrivate);
+  p.m_cubeMapEnabled = enabled;
+}
+
+bool OpenGLEnvironment::isCubeMapEnabled() const
+{
+  P(const OpenGLEnvrionmentPrivate);
+  return p.m_cubeMapEnabled;
+}
+
+bool OpenGLEnvironment::isCubeMap() const
+{
+  P(const OpenGLEnvrionmentPrivate);
+  return p.m_isCubeMap;
+}
+
+size_t OpenGLEnvironment::textureBytes() const
+{
+  P(const OpenGLEnvrionmentPrivate);
+  return p.m_directBytes + p.m_prefilteredBytes;
+}
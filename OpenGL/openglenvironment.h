@@ -1,8 +1,11 @@
 #ifndef OPENGLENVIRONMENT_H
 #define OPENGLENVIRONMENT_H OpenGLEnvironment
 
+#include <cstddef>
 class KSize;
 class OpenGLTexture;
+#include <KBc6hEncoder>
+#include <OpenGLStorage>
 #include <OpenGLToneMappingFunction>
 
 class OpenGLEnvrionmentPrivate;
@@ -15,9 +18,26 @@ public:
   void setDirect(char const *filePath);
   void setIndirect(char const *filePath);
   void setToneMappingFunction(OpenGLToneMappingFunction *fnc);
+  void setInternalFormat(OpenGLInternalFormat format);
+  OpenGLInternalFormat internalFormat() const;
+  void setCompressionQuality(KBc6hEncoder::Quality quality);
   OpenGLTexture &direct();
   OpenGLTexture &indirect();
   KSize const &directSize() const;
+
+  // Baked from the direct map by setDirect() (cached next to the other
+  // textures). setIndirect() is optional and overrides the irradiance.
+  bool hasIndirect() const;
+  OpenGLTexture &prefiltered();
+  float prefilteredMaxLevel() const;
+  float const *irradiance() const;
+
+  // Uploads direct() and prefiltered() as cube maps resampled from the
+  // equirect sources (takes effect on the next setDirect()).
+  void setCubeMapEnabled(bool enabled);
+  bool isCubeMapEnabled() const;
+  bool isCubeMap() const;
+  size_t textureBytes() const;
 private:
   OpenGLEnvrionmentPrivate *m_private;
 };
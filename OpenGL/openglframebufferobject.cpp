@@ -50,7 +50,7 @@ void OpenGLFramebufferObject::bind()
 {
   P(OpenGLFramebufferObjectPrivate);
   sg_currentFbo = p.m_objectId;
-  p.m_functions.glBindFramebuffer(GL_FRAMEBUFFER, p.m_objectId);
+  GL::glBindFramebuffer(GL_FRAMEBUFFER, p.m_objectId);
 }
 
 void OpenGLFramebufferObject::release()
@@ -1,48 +1,105 @@
 #include "openglframeresults.h"
+#include <algorithm>
 #include <QDebug>
 
-OpenGLFrameResults::OpenGLFrameResults()
+OpenGLFrameResults::OpenGLFrameResults() :
+  m_maxDepth(0), m_maxCpuDepth(0), m_cpuThreads(0), m_startTime(0), m_endTime(0),
+  m_issuedStateCalls(0), m_filteredStateCalls(0)
 {
   // Intentionally Empty
 }
 
 OpenGLFrameResults::OpenGLFrameResults(OpenGLFrameResults &&rhs) :
-  m_maxDepth(rhs.m_maxDepth), m_startTime(rhs.m_startTime), m_endTime(rhs.m_endTime),
-  m_gpuResults(std::move(rhs.m_gpuResults))
+  m_maxDepth(rhs.m_maxDepth), m_maxCpuDepth(rhs.m_maxCpuDepth), m_cpuThreads(rhs.m_cpuThreads),
+  m_startTime(rhs.m_startTime), m_endTime(rhs.m_endTime),
+  m_issuedStateCalls(rhs.m_issuedStateCalls), m_filteredStateCalls(rhs.m_filteredStateCalls),
+  m_gpuResults(std::move(rhs.m_gpuResults)), m_cpuResults(std::move(rhs.m_cpuResults)), m_callResults(std::move(rhs.m_callResults))
 {
   // Intentionally Empty
 }
 
 OpenGLFrameResults::OpenGLFrameResults(size_t maxDepth, quint64 startTime, quint64 endTime) :
-  m_maxDepth(maxDepth), m_startTime(startTime), m_endTime(endTime)
+  m_maxDepth(maxDepth), m_maxCpuDepth(0), m_cpuThreads(0), m_startTime(startTime), m_endTime(endTime),
+  m_issuedStateCalls(0), m_filteredStateCalls(0)
 {
   // Intentionally Empty
 }
 
-void OpenGLFrameResults::addGpuResult(const QString &name, size_t depth, quint64 startTime, quint64 endTime)
+void OpenGLFrameResults::reset(size_t maxDepth, quint64 startTime, quint64 endTime)
+{
+  // Results are refilled every frame, the containers keep their capacity.
+  m_maxDepth = maxDepth;
+  m_maxCpuDepth = 0;
+  m_cpuThreads = 0;
+  m_startTime = startTime;
+  m_endTime = endTime;
+  m_issuedStateCalls = m_filteredStateCalls = 0;
+  m_gpuResults.clear();
+  m_cpuResults.clear();
+  m_callResults.clear();
+}
+
+void OpenGLFrameResults::addGpuResult(OpenGLMarkerId id, size_t depth, quint64 startTime, quint64 endTime)
 {
   OpenGLMarkerResult res;
-  res.setName(name);
+  res.setId(id);
   res.setDepth(static_cast<int>(depth));
   res.setStartTime(startTime);
   res.setEndTime(endTime);
   m_gpuResults.push_back(res);
 }
 
+void OpenGLFrameResults::addCpuResult(OpenGLMarkerId id, size_t depth, unsigned thread, quint64 startTime, quint64 endTime)
+{
+  OpenGLMarkerResult res;
+  res.setId(id);
+  res.setDepth(static_cast<int>(depth));
+  res.setTrack(OpenGLMarkerResult::CpuTrack);
+  res.setThread(thread);
+  res.setStartTime(startTime);
+  res.setEndTime(endTime);
+  m_cpuResults.push_back(res);
+  m_maxCpuDepth = std::max(m_maxCpuDepth, depth + 1);
+  m_cpuThreads = std::max(m_cpuThreads, thread + 1);
+}
+
+void OpenGLFrameResults::setStateCalls(unsigned issued, unsigned filtered)
+{
+  m_issuedStateCalls = issued;
+  m_filteredStateCalls = filtered;
+}
+
+void OpenGLFrameResults::setCallResults(const OpenGLCallResults &results)
+{
+  m_callResults = results;
+}
+
 void OpenGLFrameResults::operator=(OpenGLFrameResults const &rhs)
 {
   m_maxDepth = rhs.m_maxDepth;
+  m_maxCpuDepth = rhs.m_maxCpuDepth;
+  m_cpuThreads = rhs.m_cpuThreads;
   m_startTime = rhs.m_startTime;
   m_endTime = rhs.m_endTime;
+  m_issuedStateCalls = rhs.m_issuedStateCalls;
+  m_filteredStateCalls = rhs.m_filteredStateCalls;
   m_gpuResults = rhs.m_gpuResults;
+  m_cpuResults = rhs.m_cpuResults;
+  m_callResults = rhs.m_callResults;
 }
 
 void OpenGLFrameResults::operator=(OpenGLFrameResults &&rhs)
 {
   m_maxDepth = rhs.m_maxDepth;
+  m_maxCpuDepth = rhs.m_maxCpuDepth;
+  m_cpuThreads = rhs.m_cpuThreads;
   m_startTime = rhs.m_startTime;
   m_endTime = rhs.m_endTime;
+  m_issuedStateCalls = rhs.m_issuedStateCalls;
+  m_filteredStateCalls = rhs.m_filteredStateCalls;
   m_gpuResults = std::move(rhs.m_gpuResults);
+  m_cpuResults = std::move(rhs.m_cpuResults);
+  m_callResults = std::move(rhs.m_callResults);
 }
 
 QDebug &operator<<(QDebug &dbg, const OpenGLFrameResults &results)
@@ -51,5 +108,9 @@ QDebug &operator<<(QDebug &dbg, const OpenGLFrameResults &results)
   {
     dbg << result;
   }
+  foreach (OpenGLMarkerResult const& result, results.cpuResults())
+  {
+    dbg << result;
+  }
   return dbg;
 }
@@ -1,6 +1,7 @@
 #ifndef OPENGLFRAMERESULTS_H
 #define OPENGLFRAMERESULTS_H OpenGLFrameResults
 
+#include <OpenGLCallProfiler>
 #include <OpenGLMarkerResult>
 #include <QString>
 #include <QVector>
@@ -14,7 +15,11 @@ public:
   OpenGLFrameResults(size_t maxDepth, quint64 startTime, quint64 endTime);
 
   // Public Methods
-  void addGpuResult(const QString &name, size_t depth, quint64 startTime, quint64 endTime);
+  void reset(size_t maxDepth, quint64 startTime, quint64 endTime);
+  void addGpuResult(OpenGLMarkerId id, size_t depth, quint64 startTime, quint64 endTime);
+  void addCpuResult(OpenGLMarkerId id, size_t depth, unsigned thread, quint64 startTime, quint64 endTime);
+  void setStateCalls(unsigned issued, unsigned filtered);
+  void setCallResults(const OpenGLCallResults &results);
 
   // Operators
   void operator=(OpenGLFrameResults const &rhs);
@@ -25,17 +30,33 @@ public:
   inline quint64 startTime() const;
   inline quint64 endTime() const;
   inline const OpenGLMarkerResults &gpuResults() const;
+  inline const OpenGLMarkerResults &cpuResults() const;
+  inline size_t maxCpuDepth() const;
+  inline unsigned cpuThreads() const;
+  inline unsigned issuedStateCalls() const;
+  inline unsigned filteredStateCalls() const;
+  inline const OpenGLCallResults &callResults() const;
 
 private:
-  size_t m_maxDepth;
+  size_t m_maxDepth, m_maxCpuDepth;
+  unsigned m_cpuThreads;
   quint64 m_startTime, m_endTime;
+  unsigned m_issuedStateCalls, m_filteredStateCalls;
   OpenGLMarkerResults m_gpuResults;
+  OpenGLMarkerResults m_cpuResults;
+  OpenGLCallResults m_callResults;
 };
 
 inline size_t OpenGLFrameResults::maxDepth() const { return m_maxDepth; }
 inline quint64 OpenGLFrameResults::startTime() const { return m_startTime; }
 inline quint64 OpenGLFrameResults::endTime() const { return m_endTime; }
 inline const OpenGLMarkerResults &OpenGLFrameResults::gpuResults() const { return m_gpuResults; }
+inline const OpenGLMarkerResults &OpenGLFrameResults::cpuResults() const { return m_cpuResults; }
+inline size_t OpenGLFrameResults::maxCpuDepth() const { return m_maxCpuDepth; }
+inline unsigned OpenGLFrameResults::cpuThreads() const { return m_cpuThreads; }
+inline unsigned OpenGLFrameResults::issuedStateCalls() const { return m_issuedStateCalls; }
+inline unsigned OpenGLFrameResults::filteredStateCalls() const { return m_filteredStateCalls; }
+inline const OpenGLCallResults &OpenGLFrameResults::callResults() const { return m_callResults; }
 
 // Qt Streams
 #ifndef QT_NO_DEBUG_STREAM
@@ -1,11 +1,136 @@
 #include "openglfunctions.h"
+#include <array>
 #include <KRect>
 #include <KStack>
+#include <QOpenGLContext>
+
+#ifdef    KARMA_BENCHMARK
+#include <KDebug>
+#include <KElapsedTimer>
+
+// Calls timed per path of the dispatch benchmark.
+static const unsigned BenchmarkCalls = 1 << 20;
+#endif // KARMA_BENCHMARK
 
 OpenGLFunctions *GL::m_functions;
+OpenGLDispatch GL::m_dispatch;
+OpenGLCapabilities GL::m_capabilities;
 KRect sg_currViewport;
 KStack<KRect> sg_viewportStack;
 
+/*******************************************************************************
+ * State Cache
+ ******************************************************************************/
+// Binding points beyond these limits are never filtered.
+static const unsigned CachedTextureUnits = 32;
+static const unsigned CachedUniformBindings = 64;
+
+// Only the capabilities this renderer toggles, everything else goes through.
+static const GLenum sg_cachedCaps[] =
+{
+  GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST, GL_STENCIL_TEST, GL_SCISSOR_TEST,
+  GL_POLYGON_OFFSET_FILL, GL_RASTERIZER_DISCARD, GL_SAMPLE_ALPHA_TO_COVERAGE,
+#if !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
+  GL_TEXTURE_CUBE_MAP_SEAMLESS, GL_FRAMEBUFFER_SRGB, GL_PROGRAM_POINT_SIZE,
+#endif
+};
+static const unsigned CachedCapCount = sizeof(sg_cachedCaps) / sizeof(sg_cachedCaps[0]);
+
+static const GLenum sg_cachedTextureTargets[] =
+{
+  GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_3D
+};
+static const unsigned CachedTextureTargetCount = sizeof(sg_cachedTextureTargets) / sizeof(sg_cachedTextureTargets[0]);
+
+template <typename T>
+struct GLCachedState
+{
+  bool known;
+  T value;
+};
+
+struct GLStateCache
+{
+  GLCachedState<bool> caps[CachedCapCount];
+  GLCachedState<std::array<GLenum, 4>> blendFunc;
+  GLCachedState<GLenum> depthFunc;
+  GLCachedState<GLboolean> depthMask;
+  GLCachedState<GLenum> cullFace;
+  GLCachedState<std::array<GLboolean, 4>> colorMask;
+  GLCachedState<std::array<GLfloat, 4>> clearColor;
+  GLCachedState<std::array<GLint, 4>> viewport;
+  GLCachedState<GLuint> program;
+  GLCachedState<GLuint> vertexArray;
+  GLCachedState<std::array<GLuint, 2>> framebuffers;
+  GLCachedState<GLenum> activeTexture;
+  GLCachedState<GLuint> textures[CachedTextureUnits][CachedTextureTargetCount];
+  GLCachedState<std::array<GLintptr, 3>> uniformBuffers[CachedUniformBindings];
+};
+
+static bool sg_tracking = false;
+static GLStateCache sg_state;
+static GL::StateCounters sg_counters = { 0, 0 };
+
+template <typename T>
+static inline void forget(GLCachedState<T> &state)
+{
+  state.known = false;
+}
+
+static inline void issue()
+{
+  if (sg_tracking) ++sg_counters.issued;
+}
+
+// Returns true if the call would not change anything and can be dropped,
+// otherwise remembers the new value and counts the call as issued.
+template <typename T>
+static bool redundant(GLCachedState<T> &state, T const &value)
+{
+  if (!sg_tracking) return false;
+  if (state.known && state.value == value)
+  {
+    ++sg_counters.filtered;
+    return true;
+  }
+  state.known = true;
+  state.value = value;
+  ++sg_counters.issued;
+  return false;
+}
+
+static GLCachedState<bool> *cachedCap(GLenum cap)
+{
+  for (unsigned i = 0; i < CachedCapCount; ++i)
+  {
+    if (sg_cachedCaps[i] == cap) return &sg_state.caps[i];
+  }
+  return Q_NULLPTR;
+}
+
+static GLCachedState<GLuint> *cachedTexture(GLenum target)
+{
+  if (!sg_state.activeTexture.known) return Q_NULLPTR;
+  unsigned unit = sg_state.activeTexture.value - GL_TEXTURE0;
+  if (unit >= CachedTextureUnits) return Q_NULLPTR;
+  for (unsigned i = 0; i < CachedTextureTargetCount; ++i)
+  {
+    if (sg_cachedTextureTargets[i] == target) return &sg_state.textures[unit][i];
+  }
+  return Q_NULLPTR;
+}
+
+static bool setCap(GLenum cap, bool enabled)
+{
+  GLCachedState<bool> *state = cachedCap(cap);
+  if (state) return redundant(*state, enabled);
+  issue();
+  return false;
+}
+
+/*******************************************************************************
+ * GL
+ ******************************************************************************/
 OpenGLFunctions *GL::getInstance()
 {
   return GL::m_functions;
@@ -16,6 +141,13 @@ void GL::setInstance(OpenGLFunctions *f)
   GL::m_functions = f;
 }
 
+bool GL::resolve(QOpenGLContext *ctx, std::vector<char const*> *missing)
+{
+  bool resolved = m_dispatch.resolve(ctx, OpenGLDispatch::profile(ctx), missing);
+  m_capabilities.query(ctx, m_dispatch);
+  return resolved;
+}
+
 int GL::getInteger(GLenum property)
 {
   GLint value;
@@ -30,12 +162,277 @@ void GL::pushViewport()
 
 void GL::popViewport()
 {
-  sg_currViewport = sg_viewportStack.pop();
-  GL::getInstance()->glViewport (sg_currViewport.x(), sg_currViewport.y(), sg_currViewport.width(), sg_currViewport.height());
+  KRect viewport = sg_viewportStack.pop();
+  GL::glViewport(viewport.x(), viewport.y(), viewport.width(), viewport.height());
+}
+
+void GL::beginFrame()
+{
+  resetState();
+  sg_counters.issued = sg_counters.filtered = 0;
+  sg_tracking = true;
+}
+
+void GL::endFrame()
+{
+  sg_tracking = false;
+}
+
+void GL::resetState()
+{
+  // Every entry starts out unknown, so the first call always goes through.
+  sg_state = GLStateCache();
+}
+
+GL::StateCounters const &GL::stateCounters()
+{
+  return sg_counters;
+}
+
+void GL::glActiveTexture(GLenum texture)
+{
+  if (redundant(sg_state.activeTexture, texture)) return;
+  GL_DISPATCH->glActiveTexture (texture);
+}
+
+void GL::glBindFramebuffer(GLenum target, GLuint framebuffer)
+{
+  // Draw and read bindings are cached as a pair, GL_FRAMEBUFFER sets both.
+  GLCachedState<std::array<GLuint, 2>> &state = sg_state.framebuffers;
+  std::array<GLuint, 2> framebuffers = {{ framebuffer, framebuffer }};
+  if (target == GL_DRAW_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER)
+  {
+    framebuffers = state.value;
+    framebuffers[(target == GL_DRAW_FRAMEBUFFER) ? 0 : 1] = framebuffer;
+  }
+  if (state.known || target == GL_FRAMEBUFFER)
+  {
+    if (redundant(state, framebuffers)) return;
+  }
+  else
+  {
+    issue();
+  }
+  GL_DISPATCH->glBindFramebuffer (target, framebuffer);
+}
+
+void GL::glBindTexture(GLenum target, GLuint texture)
+{
+  GLCachedState<GLuint> *state = cachedTexture(target);
+  if (state)
+  {
+    if (redundant(*state, texture)) return;
+  }
+  else
+  {
+    issue();
+  }
+  GL_DISPATCH->glBindTexture (target, texture);
+}
+
+void GL::glBlendFunc(GLenum sfactor, GLenum dfactor)
+{
+  std::array<GLenum, 4> factors = {{ sfactor, dfactor, sfactor, dfactor }};
+  if (redundant(sg_state.blendFunc, factors)) return;
+  GL_DISPATCH->glBlendFunc (sfactor, dfactor);
+}
+
+void GL::glBlendFuncSeparate(GLenum sfactorRGB, GLenum dfactorRGB, GLenum sfactorAlpha, GLenum dfactorAlpha)
+{
+  std::array<GLenum, 4> factors = {{ sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha }};
+  if (redundant(sg_state.blendFunc, factors)) return;
+  GL_DISPATCH->glBlendFuncSeparate (sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha);
+}
+
+void GL::glClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+  std::array<GLfloat, 4> color = {{ red, green, blue, alpha }};
+  if (redundant(sg_state.clearColor, color)) return;
+  GL_DISPATCH->glClearColor (red, green, blue, alpha);
+}
+
+void GL::glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
+{
+  std::array<GLboolean, 4> mask = {{ red, green, blue, alpha }};
+  if (redundant(sg_state.colorMask, mask)) return;
+  GL_DISPATCH->glColorMask (red, green, blue, alpha);
+}
+
+void GL::glCullFace(GLenum mode)
+{
+  if (redundant(sg_state.cullFace, mode)) return;
+  GL_DISPATCH->glCullFace (mode);
+}
+
+void GL::glDeleteBuffers(GLsizei n, const GLuint *buffers)
+{
+  // Deleting a bound buffer unbinds it, and the name may come back.
+  for (GLsizei i = 0; i < n; ++i)
+  {
+    for (GLCachedState<std::array<GLintptr, 3>> &state : sg_state.uniformBuffers)
+    {
+      if (state.known && state.value[0] == GLintptr(buffers[i])) forget(state);
+    }
+  }
+  GL_DISPATCH->glDeleteBuffers (n, buffers);
+}
+
+void GL::glDeleteFramebuffers(GLsizei n, const GLuint *framebuffers)
+{
+  for (GLsizei i = 0; i < n; ++i)
+  {
+    std::array<GLuint, 2> const &bound = sg_state.framebuffers.value;
+    if (bound[0] == framebuffers[i] || bound[1] == framebuffers[i]) forget(sg_state.framebuffers);
+  }
+  GL_DISPATCH->glDeleteFramebuffers (n, framebuffers);
+}
+
+void GL::glDeleteProgram(GLuint program)
+{
+  if (sg_state.program.value == program) forget(sg_state.program);
+  GL_DISPATCH->glDeleteProgram (program);
+}
+
+void GL::glDeleteTextures(GLsizei n, const GLuint *textures)
+{
+  for (GLsizei i = 0; i < n; ++i)
+  {
+    for (auto &unit : sg_state.textures)
+    {
+      for (GLCachedState<GLuint> &state : unit)
+      {
+        if (state.value == textures[i]) forget(state);
+      }
+    }
+  }
+  GL_DISPATCH->glDeleteTextures (n, textures);
+}
+
+void GL::glDepthFunc(GLenum func)
+{
+  if (redundant(sg_state.depthFunc, func)) return;
+  GL_DISPATCH->glDepthFunc (func);
+}
+
+void GL::glDepthMask(GLboolean flag)
+{
+  if (redundant(sg_state.depthMask, flag)) return;
+  GL_DISPATCH->glDepthMask (flag);
+}
+
+void GL::glDisable(GLenum cap)
+{
+  if (setCap(cap, false)) return;
+  GL_DISPATCH->glDisable (cap);
+}
+
+void GL::glEnable(GLenum cap)
+{
+  if (setCap(cap, true)) return;
+  GL_DISPATCH->glEnable (cap);
+}
+
+void GL::glUseProgram(GLuint program)
+{
+  if (redundant(sg_state.program, program)) return;
+  GL_DISPATCH->glUseProgram (program);
 }
 
 void GL::glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
 {
   sg_currViewport = KRect(x, y, width, height);
-  GL::getInstance()->glViewport (x, y, width, height);
+  std::array<GLint, 4> viewport = {{ x, y, width, height }};
+  if (redundant(sg_state.viewport, viewport)) return;
+  GL_DISPATCH->glViewport (x, y, width, height);
+}
+
+void GL::glBindVertexArray(GLuint array)
+{
+  if (redundant(sg_state.vertexArray, array)) return;
+  GL_DISPATCH->glBindVertexArray (array);
+}
+
+void GL::glDeleteVertexArrays(GLsizei n, const GLuint *arrays)
+{
+  for (GLsizei i = 0; i < n; ++i)
+  {
+    if (sg_state.vertexArray.value == arrays[i]) forget(sg_state.vertexArray);
+  }
+  GL_DISPATCH->glDeleteVertexArrays (n, arrays);
+}
+
+void GL::glBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+  if (target == GL_UNIFORM_BUFFER && index < CachedUniformBindings)
+  {
+    std::array<GLintptr, 3> range = {{ GLintptr(buffer), offset, GLintptr(size) }};
+    if (redundant(sg_state.uniformBuffers[index], range)) return;
+  }
+  else
+  {
+    issue();
+  }
+  GL_DISPATCH->glBindBufferRange (target, index, buffer, offset, size);
+}
+
+void GL::glBindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+  if (target == GL_UNIFORM_BUFFER && index < CachedUniformBindings)
+  {
+    // Never equal to a range binding, those have a non-negative offset.
+    std::array<GLintptr, 3> range = {{ GLintptr(buffer), -1, -1 }};
+    if (redundant(sg_state.uniformBuffers[index], range)) return;
+  }
+  else
+  {
+    issue();
+  }
+  GL_DISPATCH->glBindBufferBase (target, index, buffer);
+}
+
+#ifdef    KARMA_BENCHMARK
+/*******************************************************************************
+ * Dispatch Benchmark
+ ******************************************************************************/
+// Null driver, so only the cost of getting to the entry point is measured.
+static void QOPENGLF_APIENTRY nullUniform1i(GLint, GLint) {}
+static void QOPENGLF_APIENTRY nullBindVertexArray(GLuint) {}
+
+template <typename Function>
+static float nsPerCall(Function function)
+{
+  KElapsedTimer timer;
+  timer.start();
+  for (unsigned i = 0; i < BenchmarkCalls; ++i)
+  {
+    function(i);
+  }
+  return float(timer.nsecsElapsed()) / BenchmarkCalls;
+}
+
+void GL::benchmark()
+{
+  OpenGLDispatch resolved = m_dispatch;
+  m_dispatch.glUniform1i = nullUniform1i;
+  m_dispatch.glBindVertexArray = nullBindVertexArray;
+
+  void (QOPENGLF_APIENTRYP volatile direct)(GLint, GLint) = nullUniform1i;
+  float directNs = nsPerCall([direct](unsigned i) { direct(-1, GLint(i)); });
+  float wrapperNs = nsPerCall([](unsigned i) { GL::glUniform1i(-1, GLint(i)); });
+  beginFrame();
+  float trackedNs = nsPerCall([](unsigned i) { GL::glBindVertexArray(i & 1); });
+  endFrame();
+  m_dispatch = resolved;
+
+  // A call the driver returns from right away, through both paths.
+  float tableNs = nsPerCall([](unsigned) { m_dispatch.glGetError(); });
+  float qtNs = nsPerCall([](unsigned) { m_functions->glGetError(); });
+
+  kDebug() << "GL Dispatch | Path | ns / Call";
+  kDebug() << "GL Dispatch | Null Driver (direct) |" << directNs;
+  kDebug() << "GL Dispatch | Null Driver (GL::glUniform1i) |" << wrapperNs;
+  kDebug() << "GL Dispatch | Null Driver (GL::glBindVertexArray, state cache) |" << trackedNs;
+  kDebug() << "GL Dispatch | glGetError (dispatch table) |" << tableNs;
+  kDebug() << "GL Dispatch | glGetError (OpenGLFunctions) |" << qtNs;
 }
+#endif // KARMA_BENCHMARK
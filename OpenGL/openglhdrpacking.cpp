@@ -0,0 +1,353 @@
+#include "openglhdrpacking.h"
+
+#include <cstring>
+#include <KParallel>
+#include <OpenGLToneMappingFunction>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OPENGLHDRPACKING_SSE2
+#include <emmintrin.h>
+#endif
+
+// Texels converted per task, and mip rows filtered per task.
+static const size_t TexelGrain = 16 * 1024;
+static const size_t RowGrain = 16;
+
+// Largest finite values of the packed formats.
+static const float MaxHalf = 65504.0f;
+static const float MaxFloat11 = 65024.0f;
+static const float MaxFloat10 = 64512.0f;
+static const float MaxRgb9E5 = 65408.0f;
+
+/*******************************************************************************
+ * Scalar Helpers
+ ******************************************************************************/
+// Same NaN behaviour as minps/maxps (the second operand wins), so the scalar
+// tails produce exactly what the vector loops do.
+static inline float minPs(float a, float b)
+{
+  return (a < b) ? a : b;
+}
+
+static inline float maxPs(float a, float b)
+{
+  return (a > b) ? a : b;
+}
+
+static inline uint32_t floatBits(float f)
+{
+  uint32_t u;
+  std::memcpy(&u, &f, sizeof(u));
+  return u;
+}
+
+static inline float bitsFloat(uint32_t u)
+{
+  float f;
+  std::memcpy(&f, &u, sizeof(f));
+  return f;
+}
+
+// Converts a non-negative, clamped float to a 5-bit exponent float with the
+// given mantissa width, rounding to nearest even.
+template <int Mantissa>
+static inline uint32_t packSmallFloat(float f)
+{
+  const int Shift = 23 - Mantissa;
+  const uint32_t DenormMagic = uint32_t((127 - 15) + Shift + 1) << 23;
+  uint32_t u = floatBits(f);
+  if (u < (113u << 23))
+  {
+    return floatBits(f + bitsFloat(DenormMagic)) - DenormMagic;
+  }
+  uint32_t mantissaOdd = (u >> Shift) & 1;
+  u += (uint32_t(15 - 127) << 23) + (1u << (Shift - 1)) - 1;
+  return (u + mantissaOdd) >> Shift;
+}
+
+static inline uint16_t packHalf(float f)
+{
+  f = maxPs(minPs(f, MaxHalf), -MaxHalf);
+  uint32_t sign = floatBits(f) & 0x80000000u;
+  f = bitsFloat(floatBits(f) ^ sign);
+  return uint16_t(packSmallFloat<10>(f) | (sign >> 16));
+}
+
+static inline uint32_t packRg11B10FTexel(float r, float g, float b)
+{
+  r = minPs(maxPs(r, 0.0f), MaxFloat11);
+  g = minPs(maxPs(g, 0.0f), MaxFloat11);
+  b = minPs(maxPs(b, 0.0f), MaxFloat10);
+  return packSmallFloat<6>(r) | (packSmallFloat<6>(g) << 11) | (packSmallFloat<5>(b) << 22);
+}
+
+// See EXT_texture_shared_exponent (N = 9, B = 15, Emax = 31).
+static inline uint32_t packRgb9E5Texel(float r, float g, float b)
+{
+  r = minPs(maxPs(r, 0.0f), MaxRgb9E5);
+  g = minPs(maxPs(g, 0.0f), MaxRgb9E5);
+  b = minPs(maxPs(b, 0.0f), MaxRgb9E5);
+  float maxRgb = maxPs(r, maxPs(g, b));
+  int exponent = int(floatBits(maxRgb) >> 23) - 127;
+  exponent = ((exponent > -16) ? exponent : -16) + 16;
+  float scale = bitsFloat(uint32_t(151 - exponent) << 23);
+  if (int(maxRgb * scale + 0.5f) == 512)
+  {
+    ++exponent;
+    scale *= 0.5f;
+  }
+  uint32_t rs = uint32_t(r * scale + 0.5f);
+  uint32_t gs = uint32_t(g * scale + 0.5f);
+  uint32_t bs = uint32_t(b * scale + 0.5f);
+  return rs | (gs << 9) | (bs << 18) | (uint32_t(exponent) << 27);
+}
+
+/*******************************************************************************
+ * SSE2 Helpers
+ ******************************************************************************/
+#ifdef OPENGLHDRPACKING_SSE2
+static inline __m128i selectEpi32(__m128i mask, __m128i a, __m128i b)
+{
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+template <int Mantissa>
+static inline __m128i packSmallFloatPs(__m128 f)
+{
+  const int Shift = 23 - Mantissa;
+  const int DenormMagic = ((127 - 15) + Shift + 1) << 23;
+  __m128i u = _mm_castps_si128(f);
+  __m128 magic = _mm_castsi128_ps(_mm_set1_epi32(DenormMagic));
+  __m128i denorm = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(f, magic)), _mm_set1_epi32(DenormMagic));
+  __m128i mantissaOdd = _mm_and_si128(_mm_srli_epi32(u, Shift), _mm_set1_epi32(1));
+  __m128i normal = _mm_add_epi32(u, _mm_set1_epi32(int(uint32_t(15 - 127) << 23) + (1 << (Shift - 1)) - 1));
+  normal = _mm_srli_epi32(_mm_add_epi32(normal, mantissaOdd), Shift);
+  __m128i isNormal = _mm_cmpgt_epi32(u, _mm_set1_epi32((113 << 23) - 1));
+  return selectEpi32(isNormal, normal, denorm);
+}
+
+static inline __m128i packHalfPs(__m128 f)
+{
+  f = _mm_max_ps(_mm_min_ps(f, _mm_set1_ps(MaxHalf)), _mm_set1_ps(-MaxHalf));
+  __m128i sign = _mm_and_si128(_mm_castps_si128(f), _mm_set1_epi32(int(0x80000000u)));
+  f = _mm_castsi128_ps(_mm_xor_si128(_mm_castps_si128(f), sign));
+  __m128i h = _mm_or_si128(packSmallFloatPs<10>(f), _mm_srli_epi32(sign, 16));
+
+  // Sign extend so the saturating pack keeps all 16 bits.
+  return _mm_srai_epi32(_mm_slli_epi32(h, 16), 16);
+}
+
+// Loads 4 interleaved RGB texels as planar r, g and b vectors.
+static inline void loadRgb4(float const *src, __m128 &r, __m128 &g, __m128 &b)
+{
+  __m128 a = _mm_loadu_ps(src + 0);
+  __m128 m = _mm_loadu_ps(src + 4);
+  __m128 c = _mm_loadu_ps(src + 8);
+  r = _mm_shuffle_ps(a, _mm_shuffle_ps(m, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+  g = _mm_shuffle_ps(_mm_shuffle_ps(a, m, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(m, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+  b = _mm_shuffle_ps(_mm_shuffle_ps(a, m, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+static inline __m128 clampPs(__m128 f, float maxValue)
+{
+  return _mm_min_ps(_mm_max_ps(f, _mm_setzero_ps()), _mm_set1_ps(maxValue));
+}
+#endif // OPENGLHDRPACKING_SSE2
+
+/*******************************************************************************
+ * OpenGLHdrPacking
+ ******************************************************************************/
+bool OpenGLHdrPacking::isSupported(OpenGLInternalFormat format)
+{
+  switch (format)
+  {
+  case OpenGLInternalFormat::Rgb32F:
+  case OpenGLInternalFormat::Rgb16F:
+  case OpenGLInternalFormat::Rg11B10F:
+  case OpenGLInternalFormat::Rgb9E5:
+    return true;
+  default:
+    return false;
+  }
+}
+
+size_t OpenGLHdrPacking::texelSize(OpenGLInternalFormat format)
+{
+  switch (format)
+  {
+  case OpenGLInternalFormat::Rgb32F:
+    return 3 * sizeof(float);
+  case OpenGLInternalFormat::Rgb16F:
+    return 3 * sizeof(uint16_t);
+  case OpenGLInternalFormat::Rg11B10F:
+  case OpenGLInternalFormat::Rgb9E5:
+    return sizeof(uint32_t);
+  default:
+    return 0;
+  }
+}
+
+OpenGLType OpenGLHdrPacking::packedType(OpenGLInternalFormat format)
+{
+  switch (format)
+  {
+  case OpenGLInternalFormat::Rgb16F:
+    return OpenGLType::HalfFloat;
+  case OpenGLInternalFormat::Rg11B10F:
+    return OpenGLType::UnsignedInt_10F_11F_11F;
+  case OpenGLInternalFormat::Rgb9E5:
+    return OpenGLType::UnsignedInt_5_9_9_9_9;
+  default:
+    return OpenGLType::Float;
+  }
+}
+
+char const *OpenGLHdrPacking::formatName(OpenGLInternalFormat format)
+{
+  switch (format)
+  {
+  case OpenGLInternalFormat::Rgb32F:
+    return "Rgb32F";
+  case OpenGLInternalFormat::Rgb16F:
+    return "Rgb16F";
+  case OpenGLInternalFormat::Rg11B10F:
+    return "Rg11B10F";
+  case OpenGLInternalFormat::Rgb9E5:
+    return "Rgb9E5";
+  default:
+    return "Unknown";
+  }
+}
+
+void OpenGLHdrPacking::packRgb16F(RgbF const *src, uint16_t *dst, size_t count)
+{
+  float const *in = &src->r;
+  size_t floats = 3 * count;
+  size_t i = 0;
+#ifdef OPENGLHDRPACKING_SSE2
+  for (; i + 8 <= floats; i += 8)
+  {
+    __m128i lo = packHalfPs(_mm_loadu_ps(in + i));
+    __m128i hi = packHalfPs(_mm_loadu_ps(in + i + 4));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(lo, hi));
+  }
+#endif
+  for (; i < floats; ++i)
+  {
+    dst[i] = packHalf(in[i]);
+  }
+}
+
+void OpenGLHdrPacking::packRg11B10F(RgbF const *src, uint32_t *dst, size_t count)
+{
+  size_t i = 0;
+#ifdef OPENGLHDRPACKING_SSE2
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 r, g, b;
+    loadRgb4(&src[i].r, r, g, b);
+    __m128i rp = packSmallFloatPs<6>(clampPs(r, MaxFloat11));
+    __m128i gp = packSmallFloatPs<6>(clampPs(g, MaxFloat11));
+    __m128i bp = packSmallFloatPs<5>(clampPs(b, MaxFloat10));
+    __m128i packed = _mm_or_si128(rp, _mm_or_si128(_mm_slli_epi32(gp, 11), _mm_slli_epi32(bp, 22)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+  }
+#endif
+  for (; i < count; ++i)
+  {
+    dst[i] = packRg11B10FTexel(src[i].r, src[i].g, src[i].b);
+  }
+}
+
+void OpenGLHdrPacking::packRgb9E5(RgbF const *src, uint32_t *dst, size_t count)
+{
+  size_t i = 0;
+#ifdef OPENGLHDRPACKING_SSE2
+  for (; i + 4 <= count; i += 4)
+  {
+    __m128 r, g, b;
+    loadRgb4(&src[i].r, r, g, b);
+    r = clampPs(r, MaxRgb9E5);
+    g = clampPs(g, MaxRgb9E5);
+    b = clampPs(b, MaxRgb9E5);
+    __m128 maxRgb = _mm_max_ps(r, _mm_max_ps(g, b));
+
+    // Shared exponent from the largest component, bumped when rounding overflows.
+    __m128i exponent = _mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(maxRgb), 23), _mm_set1_epi32(127));
+    exponent = selectEpi32(_mm_cmpgt_epi32(exponent, _mm_set1_epi32(-16)), exponent, _mm_set1_epi32(-16));
+    exponent = _mm_add_epi32(exponent, _mm_set1_epi32(16));
+    __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_sub_epi32(_mm_set1_epi32(151), exponent), 23));
+    __m128i maxScaled = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(maxRgb, scale), _mm_set1_ps(0.5f)));
+    __m128i overflow = _mm_cmpeq_epi32(maxScaled, _mm_set1_epi32(512));
+    exponent = _mm_sub_epi32(exponent, overflow);
+    scale = _mm_castsi128_ps(selectEpi32(overflow, _mm_castps_si128(_mm_mul_ps(scale, _mm_set1_ps(0.5f))), _mm_castps_si128(scale)));
+
+    __m128 half = _mm_set1_ps(0.5f);
+    __m128i rs = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(r, scale), half));
+    __m128i gs = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(g, scale), half));
+    __m128i bs = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(b, scale), half));
+    __m128i packed = _mm_or_si128(_mm_or_si128(rs, _mm_slli_epi32(gs, 9)), _mm_or_si128(_mm_slli_epi32(bs, 18), _mm_slli_epi32(exponent, 27)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+  }
+#endif
+  for (; i < count; ++i)
+  {
+    dst[i] = packRgb9E5Texel(src[i].r, src[i].g, src[i].b);
+  }
+}
+
+void OpenGLHdrPacking::pack(OpenGLInternalFormat format, RgbF const *src, void *dst, size_t count)
+{
+  switch (format)
+  {
+  case OpenGLInternalFormat::Rgb32F:
+    std::memcpy(dst, src, count * sizeof(RgbF));
+    break;
+  case OpenGLInternalFormat::Rgb16F:
+    packRgb16F(src, static_cast<uint16_t*>(dst), count);
+    break;
+  case OpenGLInternalFormat::Rg11B10F:
+    packRg11B10F(src, static_cast<uint32_t*>(dst), count);
+    break;
+  case OpenGLInternalFormat::Rgb9E5:
+    packRgb9E5(src, static_cast<uint32_t*>(dst), count);
+    break;
+  default:
+    qFatal("Unsupported HDR packing format");
+    break;
+  }
+}
+
+void OpenGLHdrPacking::packParallel(OpenGLInternalFormat format, RgbF const *src, void *dst, size_t count)
+{
+  size_t stride = texelSize(format);
+  unsigned char *out = static_cast<unsigned char*>(dst);
+  Karma::parallelFor(0, count, TexelGrain, [format, src, out, stride](size_t b, size_t e)
+  {
+    pack(format, src + b, out + b * stride, e - b);
+  });
+}
+
+void OpenGLHdrPacking::downsampleParallel(RgbF const *src, int width, int height, RgbF *dst)
+{
+  int dstWidth = (width > 1) ? width / 2 : 1;
+  int dstHeight = (height > 1) ? height / 2 : 1;
+  Karma::parallelFor(0, size_t(dstHeight), RowGrain, [src, width, height, dst, dstWidth](size_t b, size_t e)
+  {
+    for (size_t y = b; y < e; ++y)
+    {
+      // Odd edges clamp, which matches glGenerateMipmap's box filter closely enough.
+      RgbF const *row0 = src + std::min<size_t>(2 * y, height - 1) * width;
+      RgbF const *row1 = src + std::min<size_t>(2 * y + 1, height - 1) * width;
+      RgbF *out = dst + y * dstWidth;
+      for (int x = 0; x < dstWidth; ++x)
+      {
+        int x0 = std::min(2 * x, width - 1);
+        int x1 = std::min(2 * x + 1, width - 1);
+        out[x].r = 0.25f * (row0[x0].r + row0[x1].r + row1[x0].r + row1[x1].r);
+        out[x].g = 0.25f * (row0[x0].g + row0[x1].g + row1[x0].g + row1[x1].g);
+        out[x].b = 0.25f * (row0[x0].b + row0[x1].b + row1[x0].b + row1[x1].b);
+      }
+    }
+  });
+}
@@ -0,0 +1,30 @@
+#ifndef OPENGLHDRPACKING_H
+#define OPENGLHDRPACKING_H OpenGLHdrPacking
+
+#include <cstddef>
+#include <cstdint>
+#include <OpenGLStorage>
+
+struct RgbF;
+
+namespace OpenGLHdrPacking
+{
+  // Formats which can be packed on the CPU (Rgb32F is passed through as-is).
+  bool isSupported(OpenGLInternalFormat format);
+  size_t texelSize(OpenGLInternalFormat format);
+  OpenGLType packedType(OpenGLInternalFormat format);
+  char const *formatName(OpenGLInternalFormat format);
+
+  // Converters (Values are clamped to the largest finite value of the format,
+  // negative values are clamped to zero for the unsigned formats).
+  void packRgb16F(RgbF const *src, uint16_t *dst, size_t count);
+  void packRg11B10F(RgbF const *src, uint32_t *dst, size_t count);
+  void packRgb9E5(RgbF const *src, uint32_t *dst, size_t count);
+  void pack(OpenGLInternalFormat format, RgbF const *src, void *dst, size_t count);
+  void packParallel(OpenGLInternalFormat format, RgbF const *src, void *dst, size_t count);
+
+  // 2x2 box filter into the next mip level (dst is max(1, w/2) x max(1, h/2)).
+  void downsampleParallel(RgbF const *src, int width, int height, RgbF *dst);
+}
+
+#endif // OPENGLHDRPACKING_H
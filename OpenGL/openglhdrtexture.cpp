@@ -1,33 +1,282 @@
 #include "openglhdrtexture.h"
 
+#include <cstring>
+#include <KDebug>
+#include <KElapsedTimer>
+#include <KHash>
 #include <KMacros>
 #include <KMath>
+#include <KTextureFile>
+#include <OpenGLCubeMapping>
+#include <OpenGLFunctions>
+#include <OpenGLHdrPacking>
 #include <OpenGLTexture>
 #include <OpenGLToneMappingFunction>
+#include <QString>
+
+// Cube map caches are keyed separately, the texels differ entirely.
+static const uint32_t CubeMapMethod = 0x100;
+// The encoder version sits above, so caches of an older encoder are rebuilt.
+static const uint32_t EncoderVersionShift = 16;
+
+// True if the cached levels are the full mip chain of the image, since their
+// sizes (checked by KTextureFile) are only right for their own dimensions.
+static bool isMipChain(KTextureFile::Description const &desc, int width, int height, int faces)
+{
+  if (desc.faces != uint32_t(faces)) return false;
+  for (size_t level = 0; level < desc.levelCount; ++level)
+  {
+    if (desc.levels[level].width != uint32_t(width) || desc.levels[level].height != uint32_t(height)) return false;
+    width = (width > 1) ? width / 2 : 1;
+    height = (height > 1) ? height / 2 : 1;
+  }
+  return (desc.levels[desc.levelCount - 1].width == 1 && desc.levels[desc.levelCount - 1].height == 1);
+}
 
 class OpenGLHdrTextureLoaderPrivate
 {
 public:
   OpenGLHdrTextureLoaderPrivate(OpenGLTexture *texture);
+  bool downsample(int &width, int &height);
+  void resampleCubeMap();
+  void allocate(void const *data, size_t faceBytes, int level, int width, int height, OpenGLType type);
+  void allocateCompressed(void const *data, size_t faceBytes, int level, int width, int height);
+  void releaseData();
+  void uploadFloat();
+  void uploadPacked();
+  void uploadCompressed();
   OpenGLTexture *m_texture;
+  OpenGLTexture::Target m_target;
+  OpenGLInternalFormat m_format;
+  KBc6hEncoder m_encoder;
+  QString m_cacheFile;
+  bool m_retainData;
   int m_width, m_height;
+  int m_faces, m_imageWidth, m_imageHeight;
+  size_t m_uploadedBytes;
   std::vector<float> m_textureData;
+  std::vector<float> m_retainedData;
   std::vector<float> m_lodData;
   OpenGLToneMappingFunction *m_toneMapping;
 };
 
 OpenGLHdrTextureLoaderPrivate::OpenGLHdrTextureLoaderPrivate(OpenGLTexture *texture) :
-  m_texture(texture), m_toneMapping(0)
+  m_texture(texture), m_target(OpenGLTexture::Texture2D), m_format(OpenGLInternalFormat::Rgb32F), m_retainData(false), m_width(0), m_height(0),
+  m_faces(1), m_imageWidth(0), m_imageHeight(0), m_uploadedBytes(0), m_toneMapping(0)
 {
   // Intentionally Empty
 }
 
+bool OpenGLHdrTextureLoaderPrivate::downsample(int &width, int &height)
+{
+  if (width == 1 && height == 1) return false;
+
+  // Each level is filtered from the previous float level, not the encoded one.
+  int nextWidth = (width > 1) ? width / 2 : 1;
+  int nextHeight = (height > 1) ? height / 2 : 1;
+  m_lodData.resize(3 * size_t(nextWidth) * nextHeight * m_faces);
+  RgbF const *pixels = reinterpret_cast<RgbF const*>(m_textureData.data());
+  if (m_faces == OpenGLCubeMapping::FaceCount)
+  {
+    OpenGLCubeMapping::downsampleParallel(pixels, width, reinterpret_cast<RgbF*>(m_lodData.data()));
+  }
+  else
+  {
+    OpenGLHdrPacking::downsampleParallel(pixels, width, height, reinterpret_cast<RgbF*>(m_lodData.data()));
+  }
+  m_textureData.swap(m_lodData);
+  width = nextWidth;
+  height = nextHeight;
+  return true;
+}
+
+void OpenGLHdrTextureLoaderPrivate::resampleCubeMap()
+{
+  int size = OpenGLCubeMapping::faceSize(m_width);
+  KElapsedTimer timer;
+  timer.start();
+  m_lodData.resize(3 * OpenGLCubeMapping::faceTexels(size) * OpenGLCubeMapping::FaceCount);
+  RgbF const *pixels = reinterpret_cast<RgbF const*>(m_textureData.data());
+  OpenGLCubeMapping::resampleParallel(pixels, m_width, m_height, size, reinterpret_cast<RgbF*>(m_lodData.data()));
+  m_textureData.swap(m_lodData);
+  m_faces = OpenGLCubeMapping::FaceCount;
+  m_imageWidth = m_imageHeight = size;
+  kDebug() << "HDR Texture | Cube Map |" << m_width << "x" << m_height << "->" << size << "x" << size << "x 6 |" << timer.elapsed() << "ms";
+}
+
+void OpenGLHdrTextureLoaderPrivate::allocate(void const *data, size_t faceBytes, int level, int width, int height, OpenGLType type)
+{
+  if (m_faces == 1)
+  {
+    m_texture->allocate(data, level, width, height, type);
+  }
+  else
+  {
+    unsigned char const *bytes = static_cast<unsigned char const*>(data);
+    for (int face = 0; face < m_faces; ++face)
+    {
+      OpenGLTexture::CubeMapFace target = OpenGLTexture::CubeMapFace(OpenGLTexture::PositiveX + face);
+      m_texture->allocate(target, bytes + face * faceBytes, level, width, height, type);
+    }
+  }
+  m_uploadedBytes += faceBytes * m_faces;
+}
+
+void OpenGLHdrTextureLoaderPrivate::allocateCompressed(void const *data, size_t faceBytes, int level, int width, int height)
+{
+  if (m_faces == 1)
+  {
+    m_texture->allocateCompressed(data, faceBytes, level, width, height);
+  }
+  else
+  {
+    unsigned char const *bytes = static_cast<unsigned char const*>(data);
+    for (int face = 0; face < m_faces; ++face)
+    {
+      OpenGLTexture::CubeMapFace target = OpenGLTexture::CubeMapFace(OpenGLTexture::PositiveX + face);
+      m_texture->allocateCompressed(target, bytes + face * faceBytes, faceBytes, level, width, height);
+    }
+  }
+  m_uploadedBytes += faceBytes * m_faces;
+}
+
+void OpenGLHdrTextureLoaderPrivate::releaseData()
+{
+  // The float data is not needed anymore once everything is on the GPU.
+  std::vector<float>().swap(m_textureData);
+  std::vector<float>().swap(m_lodData);
+}
+
+void OpenGLHdrTextureLoaderPrivate::uploadFloat()
+{
+  allocate(m_textureData.data(), size_t(m_imageWidth) * m_imageHeight * sizeof(RgbF), 0, m_imageWidth, m_imageHeight, OpenGLType::Float);
+  m_texture->generateMipMaps();
+
+  // The driver allocates the rest of the chain.
+  for (int width = m_imageWidth, height = m_imageHeight; width > 1 || height > 1;)
+  {
+    width = (width > 1) ? width / 2 : 1;
+    height = (height > 1) ? height / 2 : 1;
+    m_uploadedBytes += size_t(width) * height * sizeof(RgbF) * m_faces;
+  }
+  releaseData();
+}
+
+void OpenGLHdrTextureLoaderPrivate::uploadPacked()
+{
+  size_t texelSize = OpenGLHdrPacking::texelSize(m_format);
+  size_t packedBytes = 0, floatBytes = 0;
+  std::vector<unsigned char> packed(texelSize * m_imageWidth * m_imageHeight * m_faces);
+  int width = m_imageWidth, height = m_imageHeight, level = 0;
+
+  // Packed rows are not always 4-byte aligned (Rgb16F with odd widths).
+  int unpackAlignment = GL::getInteger(GL_UNPACK_ALIGNMENT);
+  GL::glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  do
+  {
+    size_t texels = size_t(width) * height;
+    RgbF const *pixels = reinterpret_cast<RgbF const*>(m_textureData.data());
+    OpenGLHdrPacking::packParallel(m_format, pixels, packed.data(), texels * m_faces);
+    allocate(packed.data(), texels * texelSize, level++, width, height, OpenGLHdrPacking::packedType(m_format));
+    packedBytes += texels * texelSize * m_faces;
+    floatBytes += texels * sizeof(RgbF) * m_faces;
+  } while (downsample(width, height));
+  GL::glPixelStorei(GL_UNPACK_ALIGNMENT, unpackAlignment);
+  m_texture->setMaxLevel(level - 1);
+
+  kDebug() << "HDR Texture |" << OpenGLHdrPacking::formatName(m_format)
+           << "|" << float(packedBytes) / 1024.0f << "KiB"
+           << "| saved" << float(floatBytes - packedBytes) / 1024.0f << "KiB";
+  releaseData();
+}
+
+void OpenGLHdrTextureLoaderPrivate::uploadCompressed()
+{
+  // The cache is keyed on the tone mapped texels, so any source or tone
+  // mapping change invalidates it.
+  int dimensions[3] = { m_imageWidth, m_imageHeight, m_faces };
+  uint64_t sourceHash = Karma::hash(dimensions, sizeof(dimensions));
+  sourceHash = Karma::hash(m_textureData.data(), m_textureData.size() * sizeof(float), sourceHash);
+  uint32_t method = static_cast<uint32_t>(m_encoder.quality()) | (KBc6hEncoder::Version << EncoderVersionShift);
+  if (m_faces != 1) method |= CubeMapMethod;
+
+  KTextureFile cache;
+  if (!m_cacheFile.isEmpty() && cache.map(m_cacheFile, KTextureFile::Bc6hUnsignedFormat, method, sourceHash) &&
+      isMipChain(cache.description(), m_imageWidth, m_imageHeight, m_faces))
+  {
+    KTextureFile::Description const &desc = cache.description();
+    for (size_t level = 0; level < desc.levelCount; ++level)
+    {
+      KTextureFile::Level const &l = desc.levels[level];
+      allocateCompressed(l.data, l.size / m_faces, int(level), int(l.width), int(l.height));
+    }
+    m_texture->setMaxLevel(int(desc.levelCount) - 1);
+    kDebug() << "HDR Texture | BC6H | Cache hit" << m_cacheFile;
+    releaseData();
+    return;
+  }
+
+  // Encode every level (faces back to back), keeping the blocks for the cache.
+  std::vector<std::vector<unsigned char> > levels;
+  levels.reserve(2 * KTextureFile::MaxLevels);
+  KTextureFile::Description desc;
+  std::memset(&desc, 0, sizeof(desc));
+  desc.format = KTextureFile::Bc6hUnsignedFormat;
+  desc.method = method;
+  desc.sourceHash = sourceHash;
+  desc.faces = uint32_t(m_faces);
+
+  size_t compressedBytes = 0, floatBytes = 0, texels = 0;
+  int width = m_imageWidth, height = m_imageHeight;
+  KElapsedTimer timer;
+  timer.start();
+  do
+  {
+    size_t faceBytes = KBc6hEncoder::compressedSize(width, height);
+    size_t faceTexels = size_t(width) * height;
+    levels.push_back(std::vector<unsigned char>(faceBytes * m_faces));
+    for (int face = 0; face < m_faces; ++face)
+    {
+      m_encoder.encode(m_textureData.data() + 3 * faceTexels * face, width, height, levels.back().data() + faceBytes * face);
+    }
+    allocateCompressed(levels.back().data(), faceBytes, int(levels.size() - 1), width, height);
+    if (levels.size() <= KTextureFile::MaxLevels)
+    {
+      KTextureFile::Level &l = desc.levels[desc.levelCount++];
+      l.width = width;
+      l.height = height;
+      l.data = levels.back().data();
+      l.size = levels.back().size();
+    }
+    compressedBytes += levels.back().size();
+    floatBytes += faceTexels * sizeof(RgbF) * m_faces;
+    texels += faceTexels * m_faces;
+  } while (downsample(width, height));
+  quint64 ms = timer.elapsed();
+  m_texture->setMaxLevel(int(levels.size()) - 1);
+
+  if (!m_cacheFile.isEmpty() && levels.size() == desc.levelCount)
+  {
+    KTextureFile::write(m_cacheFile, desc);
+  }
+
+  kDebug() << "HDR Texture | BC6H |" << float(compressedBytes) / 1024.0f << "KiB"
+           << "| saved" << float(floatBytes - compressedBytes) / 1024.0f << "KiB"
+           << "|" << float(texels) / (float(std::max<quint64>(ms, 1)) * 1e3f) << "MPix/s";
+  releaseData();
+}
+
 OpenGLHdrTextureLoader::OpenGLHdrTextureLoader(KAbstractReader *reader, OpenGLTexture *texture) :
   KAbstractHdrParser(reader), m_private(new OpenGLHdrTextureLoaderPrivate(texture))
 {
   // Intentionally Empty
 }
 
+OpenGLHdrTextureLoader::~OpenGLHdrTextureLoader()
+{
+  delete m_private;
+}
+
 bool OpenGLHdrTextureLoader::parse(OpenGLToneMappingFunction *toneMap)
 {
   P(OpenGLHdrTextureLoaderPrivate);
@@ -35,6 +284,82 @@ bool OpenGLHdrTextureLoader::parse(OpenGLToneMappingFunction *toneMap)
   return KAbstractHdrParser::parse();
 }
 
+void OpenGLHdrTextureLoader::setInternalFormat(OpenGLInternalFormat format)
+{
+  P(OpenGLHdrTextureLoaderPrivate);
+  if (!OpenGLHdrPacking::isSupported(format) && format != OpenGLInternalFormat::RgbBptcUnsignedFloat)
+  {
+    qWarning("Unsupported HDR texture format, falling back to Rgb32F");
+    format = OpenGLInternalFormat::Rgb32F;
+  }
+  p.m_format = format;
+}
+
+OpenGLInternalFormat OpenGLHdrTextureLoader::internalFormat() const
+{
+  P(const OpenGLHdrTextureLoaderPrivate);
+  return p.m_format;
+}
+
+void OpenGLHdrTextureLoader::setCompressionQuality(KBc6hEncoder::Quality quality)
+{
+  P(OpenGLHdrTextureLoaderPrivate);
+  p.m_encoder.setQuality(quality);
+}
+
+void OpenGLHdrTextureLoader::setCacheFile(QString const &fileName)
+{
+  P(OpenGLHdrTextureLoaderPrivate);
+  p.m_cacheFile = fileName;
+}
+
+void OpenGLHdrTextureLoader::setRetainData(bool retain)
+{
+  P(OpenGLHdrTextureLoaderPrivate);
+  p.m_retainData = retain;
+}
+
+std::vector<float> const &OpenGLHdrTextureLoader::retainedData() const
+{
+  P(const OpenGLHdrTextureLoaderPrivate);
+  return p.m_retainedData;
+}
+
+void OpenGLHdrTextureLoader::setTarget(OpenGLTexture::Target target)
+{
+  P(OpenGLHdrTextureLoaderPrivate);
+  if (target != OpenGLTexture::Texture2D && target != OpenGLTexture::TextureCubeMap)
+  {
+    qWarning("Unsupported HDR texture target, falling back to Texture2D");
+    target = OpenGLTexture::Texture2D;
+  }
+  p.m_target = target;
+}
+
+OpenGLTexture::Target OpenGLHdrTextureLoader::target() const
+{
+  P(const OpenGLHdrTextureLoaderPrivate);
+  return p.m_target;
+}
+
+size_t OpenGLHdrTextureLoader::uploadedBytes() const
+{
+  P(const OpenGLHdrTextureLoaderPrivate);
+  return p.m_uploadedBytes;
+}
+
+int OpenGLHdrTextureLoader::width() const
+{
+  P(const OpenGLHdrTextureLoaderPrivate);
+  return p.m_width;
+}
+
+int OpenGLHdrTextureLoader::height() const
+{
+  P(const OpenGLHdrTextureLoaderPrivate);
+  return p.m_height;
+}
+
 void OpenGLHdrTextureLoader::onKeyValue(const char *, const char *)
 {
   // Handle key/value pairs here
@@ -61,29 +386,49 @@ void OpenGLHdrTextureLoader::endData()
   P(OpenGLHdrTextureLoaderPrivate);
 
   // Apply Tone Mapping
-  for (int j=0;  j<p.m_height;  j++)
+  if (p.m_toneMapping)
   {
-    int jk = (j*p.m_width*3);
-    for (int i=0;  i<p.m_width; i++)
-    {
-      RgbF &color = reinterpret_cast<RgbF&>(p.m_textureData[jk + i * 3]);
-      if (p.m_toneMapping) color = (*p.m_toneMapping)(color);
-      //color = std::pow(color, 2.2f); // Gamma Correction
-    }
+    RgbF *pixels = reinterpret_cast<RgbF*>(p.m_textureData.data());
+    p.m_toneMapping->applyParallel(pixels, p.m_width, p.m_height);
+  }
+  if (p.m_retainData)
+  {
+    p.m_retainedData = p.m_textureData;
+  }
+
+  // The cube faces are resampled from the tone mapped texels.
+  p.m_faces = 1;
+  p.m_imageWidth = p.m_width;
+  p.m_imageHeight = p.m_height;
+  p.m_uploadedBytes = 0;
+  if (p.m_target == OpenGLTexture::TextureCubeMap)
+  {
+    p.resampleCubeMap();
   }
 
   // Create the textures
-  p.m_texture->create(OpenGLTexture::Texture2D);
+  OpenGLTexture::WrapMode wrap = (p.m_faces == 1) ? OpenGLTexture::Repeat : OpenGLTexture::ClampToEdge;
+  p.m_texture->create(p.m_target);
   p.m_texture->bind();
-  p.m_texture->setInternalFormat(OpenGLInternalFormat::Rgb32F);
-  p.m_texture->setWrapMode(OpenGLTexture::DirectionS, OpenGLTexture::Repeat);
-  p.m_texture->setWrapMode(OpenGLTexture::DirectionT, OpenGLTexture::Repeat);
+  p.m_texture->setInternalFormat(p.m_format);
+  p.m_texture->setWrapMode(OpenGLTexture::DirectionS, wrap);
+  p.m_texture->setWrapMode(OpenGLTexture::DirectionT, wrap);
+  if (p.m_faces != 1) p.m_texture->setWrapMode(OpenGLTexture::DirectionR, wrap);
   p.m_texture->setFilter(OpenGLTexture::Magnification, OpenGLTexture::Linear);
   p.m_texture->setFilter(OpenGLTexture::Minification, OpenGLTexture::LinearMipMap);
-  p.m_texture->setSize(p.m_width, p.m_height);
+  p.m_texture->setSize(p.m_imageWidth, p.m_imageHeight);
   p.m_texture->setSwizzle(OpenGLTexture::Red, OpenGLTexture::Green, OpenGLTexture::Blue, OpenGLTexture::One);
-  p.m_texture->allocate(p.m_textureData.data(), 0);
-  p.m_texture->generateMipMaps();
-  p.m_texture->getMaxLevel();
+  if (p.m_format == OpenGLInternalFormat::Rgb32F)
+  {
+    p.uploadFloat();
+  }
+  else if (p.m_format == OpenGLInternalFormat::RgbBptcUnsignedFloat)
+  {
+    p.uploadCompressed();
+  }
+  else
+  {
+    p.uploadPacked();
+  }
   p.m_texture->release();
 }
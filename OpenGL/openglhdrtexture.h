@@ -1,16 +1,45 @@
 #ifndef OPENGLHDRTEXTURE_H
 #define OPENGLHDRTEXTURE_H OpenGLHdrTexture
 
-class OpenGLTexture;
 class OpenGLToneMappingFunction;
+class QString;
 #include <KAbstractHdrParser>
+#include <KBc6hEncoder>
+#include <OpenGLStorage>
+#include <OpenGLTexture>
+#include <vector>
 
 class OpenGLHdrTextureLoaderPrivate;
 class OpenGLHdrTextureLoader : public KAbstractHdrParser
 {
 public:
   OpenGLHdrTextureLoader(KAbstractReader *reader, OpenGLTexture *texture);
+  ~OpenGLHdrTextureLoader();
   bool parse(OpenGLToneMappingFunction *toneMap);
+
+  // Rgb32F (default) is mipmapped on the GPU, while Rgb16F, Rg11B10F and
+  // Rgb9E5 are packed and mipmapped on the CPU before upload.
+  // RgbBptcUnsignedFloat is BC6H encoded on the CPU, and the encoded mips are
+  // stored in the cache file (if set) to skip encoding on the next load.
+  void setInternalFormat(OpenGLInternalFormat format);
+  OpenGLInternalFormat internalFormat() const;
+  void setCompressionQuality(KBc6hEncoder::Quality quality);
+  void setCacheFile(QString const &fileName);
+
+  // TextureCubeMap resamples the equirect source into six faces (see
+  // OpenGLCubeMapping) before any of the above, Texture2D keeps it as is.
+  void setTarget(OpenGLTexture::Target target);
+  OpenGLTexture::Target target() const;
+
+  // Bytes of all uploaded levels (and faces), valid after parse().
+  size_t uploadedBytes() const;
+
+  // Keeps a copy of the tone mapped level 0 texels (RGB floats) for CPU side
+  // processing, like baking the environment lighting.
+  void setRetainData(bool retain);
+  std::vector<float> const &retainedData() const;
+  int width() const;
+  int height() const;
 protected:
   virtual void onKeyValue(char const *key, char const *value);
   virtual void onResolution(PixelOrder xOrder, PixelOrder yOrder, int width, int height);
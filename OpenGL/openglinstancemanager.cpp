@@ -11,6 +11,7 @@
 #include <OpenGLViewport>
 #include <OpenGLRenderBlock>
 #include <OpenGLMaterial>
+#include <OpenGLCpuMarkerScoped>
 
 struct OpenGLInstancePartitionWithinView : public std::unary_function<bool, OpenGLInstance*>
 {
@@ -144,6 +145,7 @@ void OpenGLInstanceManager::create()
 void OpenGLInstanceManager::commit(const OpenGLViewport &view)
 {
   P(OpenGLInstanceManagerPrivate);
+  OpenGLCpuMarkerScoped _(OPENGL_MARKER_ID("Instance Commit"));
   p.commit(view);
 }
 
@@ -5,6 +5,7 @@
 #include <KRectF>
 #include <OpenGLMesh>
 #include <OpenGLDynamicBuffer>
+#include <OpenGLRingBuffer>
 #include <OpenGLAbstractLightGroup>
 #include <OpenGLLight>
 #include <OpenGLUniformBufferObject>
@@ -16,6 +17,7 @@
 #include <OpenGLDebugDraw>
 #include <KPoint>
 #include <OpenGLBindings>
+#include <OpenGLCpuMarkerScoped>
 
 class OpenGLRenderBlock;
 
@@ -47,7 +49,7 @@ public:
   void commit(const OpenGLViewport &view);
   void draw();
   void drawShadowed(OpenGLScene &scene);
-  virtual void initializeMesh(OpenGLMesh &mesh) = 0;
+  virtual void initializeMesh(OpenGLMesh &mesh, int base) = 0;
   virtual void translateBuffer(const OpenGLRenderBlock &stats, DataPointer data, ConstLightIterator begin, ConstLightIterator end) = 0;
   virtual void translateUniforms(const OpenGLRenderBlock &stats, Byte *data, SizeType step, ConstLightIterator begin, ConstLightIterator end) = 0;
 
@@ -75,7 +77,8 @@ public:
 
 protected:
   BufferType m_buffer;
-  OpenGLUniformBufferObject m_uniforms;
+  OpenGLRingBuffer::Allocation m_uniforms;
+  OpenGLUniformBufferObject m_uniformBuffer;
   std::vector<OpenGLViewport> m_viewports;
   unsigned m_uniformOffset;
   unsigned m_numShadowLights;
@@ -87,7 +90,7 @@ template <typename T, typename D>
 void OpenGLLightGroup<T, D>::prepMesh(OpenGLMesh &mesh)
 {
   m_buffer.bind();
-  initializeMesh(mesh);
+  initializeMesh(mesh, 0);
 }
 
 template <typename T, typename D>
@@ -106,27 +109,28 @@ void OpenGLLightGroup<T, D>::commit(const OpenGLViewport &view)
     if (!light->active()) --m_numShadowLights;
   }
 
-  typename BufferType::RangeAccessFlags flags =
-      BufferType::RangeInvalidate
-    | BufferType::RangeUnsynchronized
-    | BufferType::RangeWrite;
-
   // Upload regular light information
+  // Note: The instance attributes follow the data through the ring buffer.
   if (m_numRegularLights > 0)
   {
-    m_buffer.bind();
-    m_buffer.reserve(m_numRegularLights);
-    DataPointer data = m_buffer.mapRange(0, m_numRegularLights, flags);
+    DataPointer data = m_buffer.mapStream(m_numRegularLights);
 
     if (data == NULL)
     {
       qFatal("Failed to map the buffer range!");
     }
 
-    translateBuffer(view.current(), data, regularLights, m_lights.end());
+    {
+      OpenGLCpuMarkerScoped _(OPENGL_MARKER_ID("Light Translate Buffer"));
+      translateBuffer(view.current(), data, regularLights, m_lights.end());
+    }
 
-    m_buffer.unmap();
-    m_buffer.release();
+    m_buffer.unmapStream();
+    m_mesh.bind();
+    m_buffer.bindStream();
+    initializeMesh(m_mesh, static_cast<int>(m_buffer.streamOffset()));
+    m_mesh.release();
+    BufferType::release(BufferType::VertexBuffer);
   }
 
   if (m_viewports.size() < m_numShadowLights)
@@ -139,9 +143,27 @@ void OpenGLLightGroup<T, D>::commit(const OpenGLViewport &view)
   //       The UBO must increment preciecely by GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT.
   if (m_numShadowLights > 0)
   {
-    m_uniforms.bind();
-    m_uniformOffset = m_uniforms.reserve(sizeof(DataType), m_numShadowLights);
-    Byte *data = static_cast<Byte*>(m_uniforms.mapRange(0, m_uniformOffset * m_numShadowLights, flags));
+    OpenGLRingBuffer *ring = OpenGLRingBuffer::ringBuffer();
+    unsigned alignment = OpenGLUniformBufferObject::alignmentOffset();
+    m_uniformOffset = ((sizeof(DataType) + alignment - 1) / alignment) * alignment;
+    m_uniforms.data = Q_NULLPTR;
+    if (ring && ring->isCreated())
+    {
+      m_uniforms = ring->allocate(m_uniformOffset * m_numShadowLights, alignment);
+    }
+
+    // Without a ring buffer (or space in it) the blocks use the own storage.
+    bool streamed = (m_uniforms.data != Q_NULLPTR);
+    if (!streamed)
+    {
+      m_uniformBuffer.bind();
+      m_uniformBuffer.reserve(sizeof(DataType), m_numShadowLights);
+      m_uniforms.data = m_uniformBuffer.mapRange(0, static_cast<int>(m_uniformOffset * m_numShadowLights), BufferType::RangeInvalidateBuffer | BufferType::RangeWrite);
+      m_uniforms.buffer = m_uniformBuffer.bufferId();
+      m_uniforms.offset = 0;
+      m_uniforms.size = m_uniformOffset * m_numShadowLights;
+    }
+    Byte *data = static_cast<Byte*>(m_uniforms.data);
 
     if (data == NULL)
     {
@@ -150,8 +172,15 @@ void OpenGLLightGroup<T, D>::commit(const OpenGLViewport &view)
 
     translateUniforms(view.current(), data, m_uniformOffset, m_lights.begin(), regularLights);
 
-    m_uniforms.unmap();
-    m_uniforms.release();
+    if (streamed)
+    {
+      ring->flush(m_uniforms);
+    }
+    else
+    {
+      m_uniformBuffer.unmap();
+      m_uniformBuffer.release();
+    }
   }
 }
 
@@ -166,19 +195,12 @@ void OpenGLLightGroup<T, D>::draw()
   m_regularLight->bind();
 
 #if !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
-  std::string fName = "s" + FToCStr(FFactor());
-  std::string gName = "s" + GToCStr(GFactor());
-  std::string dName = "s" + DToCStr(DFactor());
-  std::string sName = dName + "Sample";
-  unsigned fIndex = GL::glGetSubroutineIndex(m_regularLight->programId(), GL_FRAGMENT_SHADER, fName.c_str());
-  unsigned gIndex = GL::glGetSubroutineIndex(m_regularLight->programId(), GL_FRAGMENT_SHADER, gName.c_str());
-  unsigned dIndex = GL::glGetSubroutineIndex(m_regularLight->programId(), GL_FRAGMENT_SHADER, dName.c_str());
   if (m_uFresnel != -1)
   {
     unsigned locations[3];
-    locations[m_uFresnel] = fIndex;
-    locations[m_uGeometry] = gIndex;
-    locations[m_uDistribution] = dIndex;
+    locations[m_uFresnel] = m_subroutines.fresnel[FFactor()];
+    locations[m_uGeometry] = m_subroutines.geometry[GFactor()];
+    locations[m_uDistribution] = m_subroutines.distribution[DFactor()];
     GL::glUniformSubroutinesuiv(GL_FRAGMENT_SHADER, 3, locations);
   }
 #endif
@@ -203,7 +225,7 @@ void OpenGLLightGroup<T, D>::drawShadowed(OpenGLScene &scene)
   {
     int W = 1024;
     int H = 768;
-    m_uniforms.bindRange(BufferType::UniformBuffer, K_LIGHT_BINDING, static_cast<int>(m_uniformOffset * i), static_cast<int>(sizeof(DataType)));
+    GL::glBindBufferRange(GL_UNIFORM_BUFFER, K_LIGHT_BINDING, m_uniforms.buffer, static_cast<GLintptr>(m_uniforms.offset + m_uniformOffset * i), sizeof(DataType));
 
     // Draw from Light's Perspective
     OpenGLFramebufferObject::push();
@@ -226,7 +248,7 @@ void OpenGLLightGroup<T, D>::drawShadowed(OpenGLScene &scene)
     m_blurData.bind();
     m_blurData.allocate(&data, sizeof(OpenGLBlurData));
     m_blurData.release();
-    GLint loc = m_blurProgram->uniformLocation("Direction");
+    GLint loc = m_uBlurDirection;
     m_blurProgram->bind();
     m_blurData.bindBase(K_BLUR_BINDING);
     GL::glBindImageTexture(0, m_shadowTexture.textureId(), 0, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
@@ -262,9 +284,9 @@ auto OpenGLLightGroup<T, D>::operator[](int idx) -> LightPointer
 template <typename T, typename D>
 auto OpenGLLightGroup<T, D>::create() -> bool
 {
-  m_uniforms.setUsagePattern(BufferType::DynamicDraw);
+  m_uniformBuffer.setUsagePattern(BufferType::DynamicDraw);
   m_buffer.setUsagePattern(BufferType::DynamicDraw);
-  return m_buffer.create() && m_uniforms.create() && OpenGLAbstractLightGroup::create();
+  return m_buffer.create() && m_uniformBuffer.create() && OpenGLAbstractLightGroup::create();
 }
 
 template <typename T, typename D>
@@ -7,6 +7,7 @@
 #include <OpenGLDirectionLightGroup>
 #include <OpenGLSphereLightGroup>
 #include <OpenGLRectangleLightGroup>
+#include <OpenGLShaderProgram>
 
 class OpenGLLightManagerPrivate
 {
@@ -32,6 +33,9 @@ OpenGLLightManager::~OpenGLLightManager()
 void OpenGLLightManager::create()
 {
   P(OpenGLLightManagerPrivate);
+
+  // Every light program compiles in one batch.
+  OpenGLShaderProgram::beginBatch();
   p.m_spotLights.create();
   p.m_spotLights.setMesh(":/resources/objects/spotLight.obj");
   p.m_pointLights.create();
@@ -40,6 +44,11 @@ void OpenGLLightManager::create()
   p.m_directionLights.setMesh(":/resources/objects/quad.obj");
   p.m_sphereLights.create();
   p.m_rectangleLights.create();
+  OpenGLShaderProgram::endBatch();
+
+  p.m_spotLights.resolveLocations();
+  p.m_pointLights.resolveLocations();
+  p.m_directionLights.resolveLocations();
 }
 
 void OpenGLLightManager::commit(const OpenGLViewport &view)
@@ -0,0 +1,41 @@
+#include "openglmarkerregistry.h"
+
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <QByteArray>
+
+// Names are published by bumping the count, they never change afterwards.
+static std::mutex sg_mutex;
+static char const *sg_names[OpenGLMarkerRegistry::MaxMarkers] = { "Other" };
+static std::atomic<unsigned> sg_nameCount(1);
+
+static OpenGLMarkerId find(char const *name, unsigned begin, unsigned end)
+{
+  for (unsigned id = begin; id < end; ++id)
+  {
+    if (std::strcmp(sg_names[id], name) == 0) return static_cast<OpenGLMarkerId>(id);
+  }
+  return OpenGLMarkerRegistry::OtherMarker;
+}
+
+OpenGLMarkerId OpenGLMarkerRegistry::intern(char const *name)
+{
+  unsigned count = sg_nameCount.load(std::memory_order_acquire);
+  OpenGLMarkerId id = find(name, 1, count);
+  if (id != OtherMarker) return id;
+
+  // Another thread may have added it meanwhile
+  std::lock_guard<std::mutex> lock(sg_mutex);
+  unsigned current = sg_nameCount.load(std::memory_order_relaxed);
+  id = find(name, count, current);
+  if (id != OtherMarker || current == MaxMarkers) return id;
+  sg_names[current] = qstrdup(name);
+  sg_nameCount.store(current + 1, std::memory_order_release);
+  return static_cast<OpenGLMarkerId>(current);
+}
+
+char const *OpenGLMarkerRegistry::name(OpenGLMarkerId id)
+{
+  return (id < sg_nameCount.load(std::memory_order_acquire)) ? sg_names[id] : sg_names[OtherMarker];
+}
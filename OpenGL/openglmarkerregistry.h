@@ -0,0 +1,30 @@
+#ifndef OPENGLMARKERREGISTRY_H
+#define OPENGLMARKERREGISTRY_H OpenGLMarkerRegistry
+
+#include <QtGlobal>
+
+typedef quint16 OpenGLMarkerId;
+
+// Profiler markers only carry an id, the name is looked up when results are
+// shown or exported. Interning copies the name once; after that, looking up
+// a known name neither locks nor allocates. Call sites which push a marker
+// every frame keep the id in a static (see OPENGL_MARKER_ID).
+class OpenGLMarkerRegistry
+{
+public:
+  enum
+  {
+    MaxMarkers = 4096,
+    OtherMarker = 0
+  };
+
+  // Once MaxMarkers are interned, further names map to OtherMarker.
+  static OpenGLMarkerId intern(char const *name);
+  static char const *name(OpenGLMarkerId id);
+};
+
+// Interns a literal name once per call site, e.g.
+// OpenGLMarkerScoped _(OPENGL_MARKER_ID("Render Scene"));
+#define OPENGL_MARKER_ID(name) ([]() -> OpenGLMarkerId { static const OpenGLMarkerId id = OpenGLMarkerRegistry::intern(name); return id; }())
+
+#endif // OPENGLMARKERREGISTRY_H
@@ -3,5 +3,5 @@
 
 QDebug &operator<<(QDebug &dbg, const OpenGLMarkerResult &result)
 {
-  return dbg << qPrintable(result.name()) << ": " << result.elapsedMilliseconds() << "\n";
+  return dbg << result.name() << ": " << result.elapsedMilliseconds() << "\n";
 }
@@ -2,22 +2,34 @@
 #define OPENGLMARKERRESULT_H OpenGLMarkerResult
 
 #include <vector>
-#include <QString>
+#include <OpenGLMarkerRegistry>
 class QDebug;
 
 class OpenGLMarkerResult
 {
 public:
+  // GPU markers time command execution, CPU markers time the calling thread.
+  enum Track
+  {
+    GpuTrack,
+    CpuTrack
+  };
+
   // Constructors / Destructor
   inline OpenGLMarkerResult();
   inline OpenGLMarkerResult(OpenGLMarkerResult const &rhs);
   inline OpenGLMarkerResult(OpenGLMarkerResult &&rhs);
 
   // Query Information
-  inline QString const &name() const;
-  inline void setName(QString const &name);
+  inline OpenGLMarkerId id() const;
+  inline void setId(OpenGLMarkerId id);
+  inline char const *name() const;
   inline int depth() const;
   inline void setDepth(int depth);
+  inline Track track() const;
+  inline void setTrack(Track track);
+  inline unsigned thread() const;
+  inline void setThread(unsigned thread);
   inline quint64 startTime() const;
   inline void setStartTime(quint64 startTime);
   inline quint64 endTime() const;
@@ -32,21 +44,28 @@ public:
 
 private:
   int m_depth;
-  QString m_name;
+  Track m_track;
+  unsigned m_thread;
+  OpenGLMarkerId m_id;
   quint64 m_startTime;
   quint64 m_endTime;
 };
 
 // Constructors / Destructor
-inline OpenGLMarkerResult::OpenGLMarkerResult() {}
-inline OpenGLMarkerResult::OpenGLMarkerResult(OpenGLMarkerResult const &rhs) : m_depth(rhs.m_depth), m_name(rhs.m_name), m_startTime(rhs.m_startTime), m_endTime(rhs.m_endTime) {}
-inline OpenGLMarkerResult::OpenGLMarkerResult(OpenGLMarkerResult &&rhs) : m_depth(rhs.m_depth), m_name(std::move(rhs.m_name)), m_startTime(rhs.m_startTime), m_endTime(rhs.m_endTime) {}
+inline OpenGLMarkerResult::OpenGLMarkerResult() : m_track(GpuTrack), m_thread(0), m_id(OpenGLMarkerRegistry::OtherMarker) {}
+inline OpenGLMarkerResult::OpenGLMarkerResult(OpenGLMarkerResult const &rhs) : m_depth(rhs.m_depth), m_track(rhs.m_track), m_thread(rhs.m_thread), m_id(rhs.m_id), m_startTime(rhs.m_startTime), m_endTime(rhs.m_endTime) {}
+inline OpenGLMarkerResult::OpenGLMarkerResult(OpenGLMarkerResult &&rhs) : m_depth(rhs.m_depth), m_track(rhs.m_track), m_thread(rhs.m_thread), m_id(rhs.m_id), m_startTime(rhs.m_startTime), m_endTime(rhs.m_endTime) {}
 
 // Query Information
-inline QString const &OpenGLMarkerResult::name() const { return m_name; }
-inline void OpenGLMarkerResult::setName(QString const &name) { m_name = name; }
+inline OpenGLMarkerId OpenGLMarkerResult::id() const { return m_id; }
+inline void OpenGLMarkerResult::setId(OpenGLMarkerId id) { m_id = id; }
+inline char const *OpenGLMarkerResult::name() const { return OpenGLMarkerRegistry::name(m_id); }
 inline int OpenGLMarkerResult::depth() const { return m_depth; }
 inline void OpenGLMarkerResult::setDepth(int depth) { m_depth = depth; }
+inline OpenGLMarkerResult::Track OpenGLMarkerResult::track() const { return m_track; }
+inline void OpenGLMarkerResult::setTrack(Track track) { m_track = track; }
+inline unsigned OpenGLMarkerResult::thread() const { return m_thread; }
+inline void OpenGLMarkerResult::setThread(unsigned thread) { m_thread = thread; }
 inline quint64 OpenGLMarkerResult::startTime() const { return m_startTime; }
 inline void OpenGLMarkerResult::setStartTime(quint64 startTime) { m_startTime = startTime; }
 inline quint64 OpenGLMarkerResult::endTime() const { return m_endTime; }
@@ -59,7 +78,9 @@ inline float OpenGLMarkerResult::elapsedNanoseconds() const { return m_endTime -
 inline void OpenGLMarkerResult::operator=(OpenGLMarkerResult const &rhs)
 {
   m_depth = rhs.m_depth;
-  m_name = rhs.m_name;
+  m_track = rhs.m_track;
+  m_thread = rhs.m_thread;
+  m_id = rhs.m_id;
   m_startTime = rhs.m_startTime;
   m_endTime = rhs.m_endTime;
 }
@@ -67,7 +88,9 @@ inline void OpenGLMarkerResult::operator=(OpenGLMarkerResult const &rhs)
 inline void OpenGLMarkerResult::operator=(OpenGLMarkerResult &&rhs)
 {
   m_depth = rhs.m_depth;
-  m_name = std::move(rhs.m_name);
+  m_track = rhs.m_track;
+  m_thread = rhs.m_thread;
+  m_id = rhs.m_id;
   m_startTime = rhs.m_startTime;
   m_endTime = rhs.m_endTime;
 }
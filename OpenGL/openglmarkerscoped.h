@@ -3,17 +3,20 @@
 
 #include <string>
 #include <KString>
+#include <OpenGLMarkerRegistry>
 #include <OpenGLProfiler>
 
 class OpenGLMarkerScoped
 {
 public:
+  OpenGLMarkerScoped(OpenGLMarkerId id);
   OpenGLMarkerScoped(const char *name);
   OpenGLMarkerScoped(const std::string &name);
   OpenGLMarkerScoped(const KString &name);
   ~OpenGLMarkerScoped();
 };
 
+inline OpenGLMarkerScoped::OpenGLMarkerScoped(OpenGLMarkerId id) { OpenGLProfiler::PushGpuMarker(id); }
 inline OpenGLMarkerScoped::OpenGLMarkerScoped(const char *name) { OpenGLProfiler::PushGpuMarker(name); }
 inline OpenGLMarkerScoped::OpenGLMarkerScoped(const KString &name) { OpenGLProfiler::PushGpuMarker(qPrintable(name)); }
 inline OpenGLMarkerScoped::OpenGLMarkerScoped(const std::string &name) { OpenGLProfiler::PushGpuMarker(name.c_str()); }
@@ -18,7 +18,7 @@ class OpenGLPointLightGroup : public OpenGLLightGroup<OpenGLPointLight, OpenGLLi
 {
 public:
   bool create();
-  void initializeMesh(OpenGLMesh &mesh);
+  void initializeMesh(OpenGLMesh &mesh, int base);
   void translateBuffer(const OpenGLRenderBlock &stats, DataPointer data, ConstLightIterator begin, ConstLightIterator end);
   void translateUniforms(const OpenGLRenderBlock &stats, Byte *data, SizeType step, ConstLightIterator begin, ConstLightIterator end);
 };
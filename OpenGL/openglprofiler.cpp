@@ -1,309 +1,276 @@
 #include "openglprofiler.h"
 #include "openglframeresults.h"
-#include <stack>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
 #include <vector>
 #include <QOpenGLContext>
-#include <QOpenGLTimerQuery>
 #include <KMacros>
+#include <OpenGLCallProfiler>
+#include <OpenGLFunctions>
 
 #if !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
 
+// Names are resolved through OpenGLMarkerRegistry once results are shown.
 struct Marker
 {
-  QString name;
+  OpenGLMarkerId id;
   size_t depth;
 };
 
+// Markers past the capacity of a frame are not recorded, only counted.
+static const size_t MaxGpuMarkers = OpenGLProfiler::MaxGpuMarkers;
+
+// Timestamp queries of a frame: its start and end, then a pair per marker.
+static const size_t FrameQueries = 2 + 2 * MaxGpuMarkers;
+
 /*******************************************************************************
- * GpuMarker Type
+ * CpuMarker Type
  ******************************************************************************/
 
-struct GpuMarker : public Marker
-{
-  // Constructors / Destructor
-  GpuMarker(QObject *obj = 0);
+// Deeper CPU markers are not recorded, only counted so pops still match.
+static const size_t MaxCpuDepth = 32;
 
-  // Marker manipulation
-  inline void start();
-  inline void stop();
+// Markers past the capacity of a frame are not recorded, only counted.
+static const size_t MaxCpuMarkers = OpenGLProfiler::MaxCpuMarkers;
+static const size_t DroppedCpuMarker = MaxCpuMarkers;
 
-  // Query information
-  inline bool isValid() const;
-  inline bool isResultAvailable() const;
-  inline GLuint64 startTime() const;
-  inline GLuint64 endTime() const;
+// Recalibrate CPU against GPU time every so many frames, the clocks drift.
+static const unsigned CalibrationFrames = 600;
 
-private:
-  bool m_valid;
-  QOpenGLTimerQuery m_startTimer;
-  QOpenGLTimerQuery m_endTimer;
+struct CpuMarker : public Marker
+{
+  unsigned thread;
+  quint64 startTime;
+  quint64 endTime;
 };
 
-GpuMarker::GpuMarker(QObject *obj) :
-  m_valid(false), m_startTimer(obj), m_endTimer(obj)
+// Markers a thread has open, and the frame they were recorded into.
+struct CpuMarkerThread
 {
-  if (!m_startTimer.create()) return;
-  if (!m_endTimer.create()) return;
-  m_valid = true;
-}
+  CpuMarkerThread();
+  unsigned index;
+  size_t depth;
+  quint64 frames[MaxCpuDepth];
+  size_t markers[MaxCpuDepth];
+};
 
-inline void GpuMarker::start()
-{
-  m_startTimer.recordTimestamp();
-}
+static std::atomic<unsigned> sg_cpuThreadCount(0);
+static thread_local CpuMarkerThread sg_cpuThread;
 
-inline void GpuMarker::stop()
+CpuMarkerThread::CpuMarkerThread() :
+  index(sg_cpuThreadCount++), depth(0)
 {
-  m_endTimer.recordTimestamp();
+  // Intentionally Empty
 }
 
-bool GpuMarker::isValid() const
+static quint64 cpuTime()
 {
-  return m_valid;
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
-inline bool GpuMarker::isResultAvailable() const
-{
-  return m_startTimer.isResultAvailable() &&
-         m_endTimer.isResultAvailable();
-}
+/*******************************************************************************
+ * Timer Queries
+ ******************************************************************************/
 
-inline GLuint64 GpuMarker::startTime() const
+// Only ever asks for results which are available, never waits on the GPU.
+static inline bool isQueryAvailable(GLuint query)
 {
-  return m_startTimer.waitForResult();
+  GLuint available = GL_FALSE;
+  GL::glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+  return (available != GL_FALSE);
 }
 
-inline GLuint64 GpuMarker::endTime() const
+static inline quint64 queryResult(GLuint query)
 {
-  return m_endTimer.waitForResult();
+  GLuint64 result = 0;
+  GL::glGetQueryObjectui64v(query, GL_QUERY_RESULT, &result);
+  return result;
 }
 
 /*******************************************************************************
- * Marker Groups
+ * Frame Pool
  ******************************************************************************/
 
-#define INVALID_MARKER_INDEX ((size_t)-1)
-template <typename T>
-struct MarkerGroup
+// Everything recorded for one frame in flight. The queries are generated
+// once, a pool is recorded again after its results were read or its frame
+// was dropped.
+struct FramePool
 {
-  // Typedefs
-  typedef T MarkerType;
-  typedef std::vector<MarkerType*> MarkerContainer;
-  typedef std::stack<size_t> IndexContainer;
-
   // Constructors / Destructor
-  MarkerGroup(QObject *parent = 0);
+  FramePool();
+  void create();
+  void destroy();
 
-  // Manipulate Markers
-  void pushMarker(const QString &name);
-  void popMarker();
+  // Frame manipulation
+  inline void startFrame(qint64 cpuToGpu);
+  inline void pushGpuMarker(OpenGLMarkerId id);
+  inline void popGpuMarker();
+  inline size_t pushCpuMarker(OpenGLMarkerId id, size_t depth, unsigned thread, quint64 time);
+  inline void popCpuMarker(size_t index, quint64 time);
+  inline void endFrame();
   inline void clear();
 
-  // Query information
-  bool isResultAvailable() const;
-  inline size_t maxDepth() const;
-  inline const MarkerContainer &markers() const;
-
-private:
-  QObject *m_parent;
-  MarkerContainer m_markers; //< Actual marker container
-  IndexContainer m_activeMarkerIndex; //< Markers which have been started, but not stopped.
-  size_t m_currMarker; //< Our current index through allocated markers.
-  size_t m_currDepth; //< The current depth of push/pop of markers.
-  size_t m_maxDepth; //< The maximum known depth of push/pop of markers.
-  mutable size_t m_statusMarker; //< Caches last failed isResultAvailable index.
+  // Aggregate results
+  bool isResultAvailable();
+  void readResults(OpenGLFrameResults &results) const;
+
+  GLuint m_queries[FrameQueries]; //< Frame start, end, then start/end per marker.
+  Marker m_gpuMarkers[MaxGpuMarkers];
+  size_t m_openMarkers[MaxGpuMarkers]; //< Markers which have been started, but not stopped.
+  size_t m_gpuCount;
+  size_t m_openCount;
+  size_t m_overflowDepth; //< Open markers which did not fit into the pool.
+  size_t m_maxDepth;
+  size_t m_droppedMarkers;
+  size_t m_statusQuery; //< Caches the first query not known to be available.
+  GL::StateCounters m_stateCalls;
+  OpenGLCallResults m_calls;
+  CpuMarker m_cpuMarkers[MaxCpuMarkers];
+  size_t m_cpuCount;
+  qint64 m_cpuToGpu;
 };
 
-template <typename T>
-MarkerGroup<T>::MarkerGroup(QObject *parent) :
-  m_parent(parent), m_currMarker(0), m_currDepth(0),
-  m_maxDepth(0), m_statusMarker(0)
+FramePool::FramePool() :
+  m_gpuCount(0), m_openCount(0), m_overflowDepth(0), m_maxDepth(0),
+  m_droppedMarkers(0), m_statusQuery(0), m_cpuCount(0), m_cpuToGpu(0)
 {
-  // Intentionally Blank
+  m_stateCalls.issued = m_stateCalls.filtered = 0;
+  std::fill(m_queries, m_queries + FrameQueries, 0);
 }
 
-template <typename T>
-void MarkerGroup<T>::pushMarker(const QString &name)
+void FramePool::create()
 {
-  // See if we need to grow our marker container
-  if (m_currMarker >= m_markers.size())
-  {
-    m_markers.push_back(new MarkerType(m_parent));
-  }
-
-  // Early-out to see if the marker is valid
-  // If the marker is invalid, we cannot continue.
-  MarkerType *currMarker = m_markers[m_currMarker];
-  if (!currMarker->isValid())
-  {
-    m_activeMarkerIndex.push(INVALID_MARKER_INDEX);
-  }
-
-  // Instantiate the marker
-  currMarker->name = name;
-  currMarker->depth = m_currDepth;
-  currMarker->start();
-
-  // Alter MarkerGroup meta information
-  m_activeMarkerIndex.push(m_currMarker);
-  ++m_currDepth;
-  ++m_currMarker;
-  m_maxDepth = std::max(m_maxDepth, m_currDepth);
+  GL::glGenQueries(static_cast<GLsizei>(FrameQueries), m_queries);
 }
 
-template <typename T>
-void MarkerGroup<T>::popMarker()
+void FramePool::destroy()
 {
-  size_t topIdx = m_activeMarkerIndex.top();
-  m_activeMarkerIndex.pop();
-
-  // Early-out if the last pushed marker was invalid
-  if (topIdx == INVALID_MARKER_INDEX) return;
-
-  // Finalize the marker
-  m_markers[topIdx]->stop();
-  --m_currDepth;
+  GL::glDeleteQueries(static_cast<GLsizei>(FrameQueries), m_queries);
+  std::fill(m_queries, m_queries + FrameQueries, 0);
 }
 
-template <typename T>
-inline void MarkerGroup<T>::clear()
+inline void FramePool::startFrame(qint64 cpuToGpu)
 {
-  m_currMarker = m_statusMarker = m_currDepth = m_maxDepth = 0;
+  // CPU markers taken since the last frame are kept.
+  m_gpuCount = m_openCount = m_overflowDepth = m_maxDepth = 0;
+  m_droppedMarkers = m_statusQuery = 0;
+  m_cpuToGpu = cpuToGpu;
+  GL::glQueryCounter(m_queries[0], GL_TIMESTAMP);
 }
 
-template <typename T>
-bool MarkerGroup<T>::isResultAvailable() const
+inline void FramePool::pushGpuMarker(OpenGLMarkerId id)
 {
-  while(m_statusMarker < m_currMarker)
+  // Once full, every later marker is dropped, so these always pop first.
+  if (m_gpuCount == MaxGpuMarkers)
   {
-    if (!m_markers[m_statusMarker]->isResultAvailable())
-    {
-      return false;
-    }
-    ++m_statusMarker;
+    ++m_overflowDepth;
+    ++m_droppedMarkers;
+    return;
   }
-  return true;
-}
-
-template <typename T>
-inline size_t MarkerGroup<T>::maxDepth() const
-{
-  return m_maxDepth;
-}
 
-template <typename T>
-inline const typename MarkerGroup<T>::MarkerContainer &MarkerGroup<T>::markers() const
-{
-  return m_markers;
+  Marker &marker = m_gpuMarkers[m_gpuCount];
+  marker.id = id;
+  marker.depth = m_openCount;
+  GL::glQueryCounter(m_queries[2 + 2 * m_gpuCount], GL_TIMESTAMP);
+  m_openMarkers[m_openCount++] = m_gpuCount++;
+  m_maxDepth = std::max(m_maxDepth, m_openCount);
 }
 
-/*******************************************************************************
- * Frame Info
- ******************************************************************************/
-
-struct FrameInfo
+inline void FramePool::popGpuMarker()
 {
-  // Typedefs
-  typedef MarkerGroup<GpuMarker> GpuGroup;
-
-  // Constructors / Destructor
-  FrameInfo(QObject *parent = 0);
-
-  // Frame manipulation
-  inline void startFrame();
-  inline void pushGpuMarker(const QString &name);
-  inline void popGpuMarker();
-  inline void endFrame();
-  inline void clear();
-
-  // Aggregate results
-  OpenGLFrameResults waitForResult();
-
-  // Query information
-  inline bool isValid() const;
-  inline bool isResultAvailable() const;
-
-private:
-  bool m_valid;
-  QObject *m_parent;
-  GpuGroup m_gpuMarkers;
-  QOpenGLTimerQuery m_startTimer;
-  QOpenGLTimerQuery m_endTimer;
-};
-
-FrameInfo::FrameInfo(QObject *parent) :
-  m_valid(false), m_parent(parent), m_startTimer(parent), m_endTimer(parent)
-{
-  if (!m_startTimer.create()) return;
-  if (!m_endTimer.create()) return;
-  m_valid = true;
+  if (m_overflowDepth)
+  {
+    --m_overflowDepth;
+    return;
+  }
+  if (m_openCount == 0) return;
+  GL::glQueryCounter(m_queries[3 + 2 * m_openMarkers[--m_openCount]], GL_TIMESTAMP);
 }
 
-inline void FrameInfo::startFrame()
+inline size_t FramePool::pushCpuMarker(OpenGLMarkerId id, size_t depth, unsigned thread, quint64 time)
 {
-  m_startTimer.recordTimestamp();
+  // Fixed like the GPU markers, so pushing never allocates.
+  if (m_cpuCount == MaxCpuMarkers) return DroppedCpuMarker;
+  CpuMarker &marker = m_cpuMarkers[m_cpuCount];
+  marker.id = id;
+  marker.depth = depth;
+  marker.thread = thread;
+  marker.startTime = time;
+  marker.endTime = 0;
+  return m_cpuCount++;
 }
 
-inline void FrameInfo::pushGpuMarker(const QString &name)
+inline void FramePool::popCpuMarker(size_t index, quint64 time)
 {
-  m_gpuMarkers.pushMarker(name);
+  if (index == DroppedCpuMarker) return;
+  m_cpuMarkers[index].endTime = time;
 }
 
-inline void FrameInfo::popGpuMarker()
+inline void FramePool::endFrame()
 {
-  m_gpuMarkers.popMarker();
+  // Markers still open are cut off at the end of the frame, every used
+  // query must have been recorded before it is asked for its result.
+  quint64 time = cpuTime();
+  for (size_t i = 0; i < m_cpuCount; ++i)
+  {
+    if (!m_cpuMarkers[i].endTime) m_cpuMarkers[i].endTime = time;
+  }
+  m_overflowDepth = 0;
+  while (m_openCount) popGpuMarker();
+  GL::glQueryCounter(m_queries[1], GL_TIMESTAMP);
+  m_stateCalls = GL::stateCounters();
+  OpenGLCallProfiler::flush(m_calls);
 }
 
-inline void FrameInfo::endFrame()
+inline void FramePool::clear()
 {
-  m_endTimer.recordTimestamp();
+  m_gpuCount = m_openCount = m_overflowDepth = m_maxDepth = 0;
+  m_cpuCount = 0;
 }
 
-inline void FrameInfo::clear()
+bool FramePool::isResultAvailable()
 {
-  m_gpuMarkers.clear();
+  // The end of the frame is the last timestamp, it is checked first.
+  if (!isQueryAvailable(m_queries[1])) return false;
+  size_t usedQueries = 2 + 2 * m_gpuCount;
+  while (m_statusQuery < usedQueries)
+  {
+    if (!isQueryAvailable(m_queries[m_statusQuery])) return false;
+    ++m_statusQuery;
+  }
+  return true;
 }
 
-OpenGLFrameResults FrameInfo::waitForResult()
+void FramePool::readResults(OpenGLFrameResults &results) const
 {
-  // Poll until available
-  while (!isResultAvailable());
-
-  // Grab useful information for the results
-  quint64 startTime = m_startTimer.waitForResult();
-  quint64 endTime = m_endTimer.waitForResult();
-  size_t maxDepth = m_gpuMarkers.maxDepth();
-  OpenGLFrameResults results(maxDepth, startTime, endTime);
+  results.reset(m_maxDepth, queryResult(m_queries[0]), queryResult(m_queries[1]));
+  results.setStateCalls(m_stateCalls.issued, m_stateCalls.filtered);
+  results.setCallResults(m_calls);
 
-  // Aggregate frame information
-  const GpuGroup::MarkerContainer &gpuMarkers = m_gpuMarkers.markers();
-  for (GpuMarker const* marker : gpuMarkers)
+  for (size_t i = 0; i < m_gpuCount; ++i)
   {
-    // If the current marker is invalid,
-    // subsequent markers also will be.
-    if (!marker->isValid()) break;
-
     results.addGpuResult(
-      marker->name,
-      marker->depth,
-      marker->startTime(),
-      marker->endTime()
+      m_gpuMarkers[i].id,
+      m_gpuMarkers[i].depth,
+      queryResult(m_queries[2 + 2 * i]),
+      queryResult(m_queries[3 + 2 * i])
     );
   }
 
-  return std::move(results);
-}
-
-bool FrameInfo::isValid() const
-{
-  return m_valid;
-}
-
-inline bool FrameInfo::isResultAvailable() const
-{
-  return m_startTimer.isResultAvailable() &&
-         m_endTimer.isResultAvailable() &&
-         m_gpuMarkers.isResultAvailable();
+  // CPU markers are moved onto the GPU timeline
+  for (size_t i = 0; i < m_cpuCount; ++i)
+  {
+    CpuMarker const &marker = m_cpuMarkers[i];
+    results.addCpuResult(
+      marker.id,
+      marker.depth,
+      marker.thread,
+      quint64(qint64(marker.startTime) + m_cpuToGpu),
+      quint64(qint64(marker.endTime) + m_cpuToGpu)
+    );
+  }
 }
 
 /*******************************************************************************
@@ -314,17 +281,33 @@ class OpenGLProfilerPrivate
 {
 public:
   // Type Definitions
-  typedef std::vector<FrameInfo*> FrameContainer;
+  typedef std::vector<FramePool> FrameContainer;
 
   // Constructors / Destructor
   OpenGLProfilerPrivate();
   ~OpenGLProfilerPrivate();
 
+  // Profiler Helpers
+  inline FramePool &currentFrame();
+  inline FramePool &oldestPendingFrame();
+  void calibrate();
+
   // Member Information
   bool m_valid;
   bool m_started;
+  unsigned m_latency;
   size_t m_currFrame;
-  FrameContainer m_frames;
+  size_t m_pendingFrames; //< Frames ended, but not yet read back.
+  FrameContainer m_frames; //< Ring of one pool per frame in flight.
+  OpenGLFrameResults m_results;
+  quint64 m_droppedFrames;
+  quint64 m_droppedMarkers;
+
+  // CPU markers may come from any thread, the frames are locked for them.
+  std::mutex m_cpuMutex;
+  quint64 m_frameSerial;
+  qint64 m_cpuToGpu;
+  unsigned m_calibrationFrames;
 
   // Static Information
   static OpenGLProfiler *CurrentProfiler;
@@ -334,19 +317,42 @@ public:
 OpenGLProfiler *OpenGLProfilerPrivate::CurrentProfiler = new OpenGLProfiler(Q_NULLPTR);
 
 OpenGLProfilerPrivate::OpenGLProfilerPrivate() :
-  m_valid(false), m_started(false), m_currFrame(0)
+  m_valid(false), m_started(false), m_latency(OpenGLProfiler::DefaultLatency), m_currFrame(0), m_pendingFrames(0),
+  m_droppedFrames(0), m_droppedMarkers(0), m_frameSerial(0), m_cpuToGpu(0), m_calibrationFrames(0)
 {
   // Intentionally Empty
 }
 
 OpenGLProfilerPrivate::~OpenGLProfilerPrivate()
 {
-  for (size_t i = 0; i < m_frames.size(); ++i)
+  // Queries can only be deleted with the context current
+  if (!QOpenGLContext::currentContext()) return;
+  for (FramePool &frame : m_frames)
   {
-    delete m_frames[i];
+    frame.destroy();
   }
 }
 
+inline FramePool &OpenGLProfilerPrivate::currentFrame()
+{
+  return m_frames[m_currFrame];
+}
+
+inline FramePool &OpenGLProfilerPrivate::oldestPendingFrame()
+{
+  return m_frames[(m_currFrame + m_frames.size() - m_pendingFrames) % m_frames.size()];
+}
+
+void OpenGLProfilerPrivate::calibrate()
+{
+  // GL_TIMESTAMP does not wait for queued commands to execute, but it does
+  // round-trip to the GPU clock, so only every few hundred frames.
+  GLint64 gpuTime = 0;
+  GL::glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+  m_cpuToGpu = qint64(gpuTime) - qint64(cpuTime());
+  m_calibrationFrames = CalibrationFrames;
+}
+
 /*******************************************************************************
  * Profiler
  ******************************************************************************/
@@ -370,50 +376,65 @@ bool OpenGLProfiler::initialize()
   if (ctx->isOpenGLES())
     return false;
 
-  // Attempt to create the first frame
-  // This can fail if OpenGL Desktop without Timer Query support.
-  FrameInfo *frame = new FrameInfo(this);
-  if (!frame->isValid())
-  {
-    delete frame;
+  // Desktop OpenGL without timestamp queries (ARB_timer_query).
+  if (!GL::dispatch()->glQueryCounter || !GL::dispatch()->glGetQueryObjectui64v)
     return false;
+
+  // Every frame in flight gets its pool up front
+  p.m_frames.resize(p.m_latency);
+  for (FramePool &frame : p.m_frames)
+  {
+    frame.create();
   }
 
   // Profiler is valid
   p.m_valid = true;
-  p.m_frames.push_back(frame);
+  p.calibrate();
   OpenGLProfilerPrivate::CurrentProfiler = this;
 
   return true;
 }
 
+void OpenGLProfiler::setLatency(unsigned frames)
+{
+  P(OpenGLProfilerPrivate);
+  if (p.m_valid) return;
+  p.m_latency = std::min<unsigned>(std::max<unsigned>(frames, MinLatency), MaxLatency);
+}
+
+unsigned OpenGLProfiler::latency() const
+{
+  P(const OpenGLProfilerPrivate);
+  return p.m_latency;
+}
+
+quint64 OpenGLProfiler::droppedFrames() const
+{
+  P(const OpenGLProfilerPrivate);
+  return p.m_droppedFrames;
+}
+
+quint64 OpenGLProfiler::droppedMarkers() const
+{
+  P(const OpenGLProfilerPrivate);
+  return p.m_droppedMarkers;
+}
+
 void OpenGLProfiler::beginFrame()
 {
   P(OpenGLProfilerPrivate);
 
   // Early-out if Profiler doesn't support Timers
   if (!p.m_valid) return;
+  if (--p.m_calibrationFrames == 0) p.calibrate();
 
-  // Even though we recycle frames, it's possible
-  // that one frame may not be done processing.
-  // So we must create new frames if needed.
-  if (p.m_currFrame >= p.m_frames.size())
-  {
-    p.m_frames.push_back(new FrameInfo(this));
-  }
-
-  // Likewise, the frame may have run out of
-  // timer queries. We must check if it is valid.
-  FrameInfo *currFrame = p.m_frames[p.m_currFrame];
-  if (currFrame->isValid())
-  {
-    currFrame->startFrame();
-  }
-
+  // The current pool is never pending, see endFrame().
+  std::lock_guard<std::mutex> lock(p.m_cpuMutex);
+  p.currentFrame().startFrame(p.m_cpuToGpu);
   p.m_started = true;
 }
 
-void OpenGLProfiler::pushGpuMarker(const char *name)
+void OpenGLProfiler::pushGpuMarker(OpenGLMarkerId id)
 {
   P(OpenGLProfilerPrivate);
 
@@ -421,16 +442,12 @@ void OpenGLProfiler::pushGpuMarker(const char *name)
   if (!p.m_valid) return;
   if (!p.m_started) return;
 
-  // At this point, it's impossible for there not
-  // to at least be one allocated frame. Since initialize()
-  // both allocates a frame, and sets the Profiler to valid.
-  FrameInfo *currFrame = p.m_frames[p.m_currFrame];
+  p.currentFrame().pushGpuMarker(id);
+}
 
-  // However, the frame can still be invalid.
-  if (currFrame->isValid())
-  {
-    currFrame->pushGpuMarker(name);
-  }
+void OpenGLProfiler::pushGpuMarker(const char *name)
+{
+  pushGpuMarker(OpenGLMarkerRegistry::intern(name));
 }
 
 void OpenGLProfiler::popGpuMarker()
@@ -441,16 +458,50 @@ void OpenGLProfiler::popGpuMarker()
   if (!p.m_valid) return;
   if (!p.m_started) return;
 
-  // At this point, it's impossible for there not
-  // to at least be one allocated frame. Since initialize()
-  // both allocates a frame, and sets the Profiler to valid.
-  FrameInfo *currFrame = p.m_frames[p.m_currFrame];
+  p.currentFrame().popGpuMarker();
+}
+
+void OpenGLProfiler::pushCpuMarker(OpenGLMarkerId id)
+{
+  P(OpenGLProfilerPrivate);
 
-  // However, the frame can still be invalid.
-  if (currFrame->isValid())
+  // Early-out if Profiler doesn't support Timers
+  if (!p.m_valid) return;
+
+  // Unlike GPU markers, these are taken between frames too. They count
+  // towards the frame which is started next.
+  CpuMarkerThread &thread = sg_cpuThread;
+  if (thread.depth < MaxCpuDepth)
   {
-    currFrame->popGpuMarker();
+    std::lock_guard<std::mutex> lock(p.m_cpuMutex);
+    thread.frames[thread.depth] = p.m_frameSerial;
+    thread.markers[thread.depth] = p.currentFrame().pushCpuMarker(id, thread.depth, thread.index, cpuTime());
+    if (thread.markers[thread.depth] == DroppedCpuMarker) ++p.m_droppedMarkers;
   }
+  ++thread.depth;
+}
+
+void OpenGLProfiler::pushCpuMarker(const char *name)
+{
+  pushCpuMarker(OpenGLMarkerRegistry::intern(name));
+}
+
+void OpenGLProfiler::popCpuMarker()
+{
+  P(OpenGLProfilerPrivate);
+
+  // Early-out if Profiler doesn't support Timers
+  if (!p.m_valid) return;
+
+  CpuMarkerThread &thread = sg_cpuThread;
+  if (thread.depth == 0) return;
+  if (--thread.depth >= MaxCpuDepth) return;
+
+  // Markers outliving their frame have been ended with it.
+  quint64 time = cpuTime();
+  std::lock_guard<std::mutex> lock(p.m_cpuMutex);
+  if (thread.frames[thread.depth] != p.m_frameSerial) return;
+  p.currentFrame().popCpuMarker(thread.markers[thread.depth], time);
 }
 
 void OpenGLProfiler::endFrame()
@@ -462,39 +513,36 @@ void OpenGLProfiler::endFrame()
   if (!p.m_started) return;
 
   // Mark the frame as completed
-  p.m_frames[p.m_currFrame]->endFrame();
-  ++p.m_currFrame;
-
-  // Loop through all completed frames, emitting results
-  size_t idx;
-  FrameInfo *currFrame;
-  OpenGLFrameResults currResults;
-  for (idx = 0; idx < p.m_currFrame; ++idx)
+  std::unique_lock<std::mutex> lock(p.m_cpuMutex);
+  FramePool &endedFrame = p.currentFrame();
+  endedFrame.endFrame();
+  p.m_droppedMarkers += endedFrame.m_droppedMarkers;
+  p.m_currFrame = (p.m_currFrame + 1) % p.m_frames.size();
+  ++p.m_pendingFrames;
+  ++p.m_frameSerial;
+
+  // Emit the frames which are available, oldest first. The others
+  // are checked again at the end of the next frame.
+  while (p.m_pendingFrames)
   {
-    currFrame = p.m_frames[idx];
-
-    if (currFrame->isValid())
-    {
-      // If results of current frame are unavailable,
-      // the results of the next frame surely won't be
-      // available either. So we can break from our loop.
-      if (!currFrame->isResultAvailable()) break;
-
-      // Otherwise, we'll simply emit the results
-      currResults = std::move(currFrame->waitForResult());
-      emit frameResultsAvailable(currResults);
-      currFrame->clear();
-    }
-
-    // Always push frames back, this moves the
-    // pre-allocated information to the back for re-use.
-    p.m_frames.push_back(currFrame);
+    FramePool &frame = p.oldestPendingFrame();
+    if (!frame.isResultAvailable()) break;
+    frame.readResults(p.m_results);
+    frame.clear();
+    --p.m_pendingFrames;
+    lock.unlock();
+    emit frameResultsAvailable(p.m_results);
+    lock.lock();
   }
 
-  // Remove the duplicate N first frames from
-  // when we moved them to the back of the vector.
-  p.m_currFrame -= idx;
-  p.m_frames.erase(p.m_frames.begin(), p.m_frames.begin() + idx);
+  // The GPU is more than latency() frames behind. Rather than wait, the
+  // oldest frame is dropped and its pool recorded next.
+  if (p.m_pendingFrames == p.m_frames.size())
+  {
+    p.currentFrame().clear();
+    --p.m_pendingFrames;
+    ++p.m_droppedFrames;
+  }
   p.m_started = false;
 }
 
@@ -515,6 +563,26 @@ bool OpenGLProfiler::initialize()
   return false;
 }
 
+void OpenGLProfiler::setLatency(unsigned frames)
+{
+  (void)frames;
+}
+
+unsigned OpenGLProfiler::latency() const
+{
+  return 0;
+}
+
+quint64 OpenGLProfiler::droppedFrames() const
+{
+  return 0;
+}
+
+quint64 OpenGLProfiler::droppedMarkers() const
+{
+  return 0;
+}
+
 OpenGLProfiler::OpenGLProfiler(QObject *parent)
 {
   (void)parent;
@@ -530,6 +598,11 @@ void OpenGLProfiler::beginFrame()
   // Intentionally Empty
 }
 
+void OpenGLProfiler::pushGpuMarker(OpenGLMarkerId id)
+{
+  (void)id;
+}
+
 void OpenGLProfiler::pushGpuMarker(const char *name)
 {
   (void)name;
@@ -540,6 +613,21 @@ void OpenGLProfiler::popGpuMarker()
   // Intentionally Empty
 }
 
+void OpenGLProfiler::pushCpuMarker(OpenGLMarkerId id)
+{
+  (void)id;
+}
+
+void OpenGLProfiler::pushCpuMarker(const char *name)
+{
+  (void)name;
+}
+
+void OpenGLProfiler::popCpuMarker()
+{
+  // Intentionally Empty
+}
+
 void OpenGLProfiler::endFrame()
 {
   // Intentionally Empty
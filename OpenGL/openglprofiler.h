@@ -2,6 +2,7 @@
 #define OPENGLPROFILER_H OpenGLProfiler
 
 #include <QObject>
+#include <OpenGLMarkerRegistry>
 class OpenGLFrameResults;
 
 class OpenGLProfilerPrivate;
@@ -9,21 +10,47 @@ class OpenGLProfiler : public QObject
 {
   Q_OBJECT
 public:
+  enum
+  {
+    MinLatency = 2,
+    DefaultLatency = 4,
+    MaxLatency = 8,
+    MaxGpuMarkers = 256,
+    MaxCpuMarkers = 1024
+  };
+
   // Constructors / Destructors
   explicit OpenGLProfiler(QObject *parent = 0);
   ~OpenGLProfiler();
 
+  // Profiler Settings
+  // Results are read once the GPU is done with a frame, without waiting for
+  // it. Up to latency() frames are in flight, if the GPU falls further
+  // behind the oldest frame is dropped. Set before initialize().
+  void setLatency(unsigned frames);
+  unsigned latency() const;
+  quint64 droppedFrames() const;
+  quint64 droppedMarkers() const;
+
   // Profiler Actions
   bool initialize();
   void beginFrame();
+  void pushGpuMarker(OpenGLMarkerId id);
   void pushGpuMarker(char const *name);
   void popGpuMarker();
+  void pushCpuMarker(OpenGLMarkerId id);
+  void pushCpuMarker(char const *name);
+  void popCpuMarker();
   void endFrame();
 
   // Global Profiler Action
   inline static void BeginFrame();
+  inline static void PushGpuMarker(OpenGLMarkerId id);
   inline static void PushGpuMarker(char const *name);
   inline static void PopGpuMarker();
+  inline static void PushCpuMarker(OpenGLMarkerId id);
+  inline static void PushCpuMarker(char const *name);
+  inline static void PopCpuMarker();
   inline static void EndFrame();
 
   // Global Settings
@@ -39,13 +66,21 @@ private:
 
 #if !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
 inline void OpenGLProfiler::BeginFrame() { profiler()->beginFrame(); }
+inline void OpenGLProfiler::PushGpuMarker(OpenGLMarkerId id) { profiler()->pushGpuMarker(id); }
 inline void OpenGLProfiler::PushGpuMarker(char const *name) { profiler()->pushGpuMarker(name); }
 inline void OpenGLProfiler::PopGpuMarker() { profiler()->popGpuMarker(); }
+inline void OpenGLProfiler::PushCpuMarker(OpenGLMarkerId id) { profiler()->pushCpuMarker(id); }
+inline void OpenGLProfiler::PushCpuMarker(char const *name) { profiler()->pushCpuMarker(name); }
+inline void OpenGLProfiler::PopCpuMarker() { profiler()->popCpuMarker(); }
 inline void OpenGLProfiler::EndFrame() { profiler()->endFrame(); }
 #else
 inline void OpenGLProfiler::BeginFrame() { }
+inline void OpenGLProfiler::PushGpuMarker(OpenGLMarkerId id) { (void)id; }
 inline void OpenGLProfiler::PushGpuMarker(char const *name) { (void)name; }
 inline void OpenGLProfiler::PopGpuMarker() { }
+inline void OpenGLProfiler::PushCpuMarker(OpenGLMarkerId id) { (void)id; }
+inline void OpenGLProfiler::PushCpuMarker(char const *name) { (void)name; }
+inline void OpenGLProfiler::PopCpuMarker() { }
 inline void OpenGLProfiler::EndFrame() { }
 #endif
 
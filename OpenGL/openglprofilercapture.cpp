@@ -0,0 +1,279 @@
+#include "openglprofilercapture.h"
+#include "openglframeresults.h"
+#include <algorithm>
+#include <vector>
+#include <QFile>
+#include <QTextStream>
+#include <KMacros>
+#include <OpenGLMarkerRegistry>
+
+// GPU markers go to trace thread 0, CPU thread N to trace thread N + 1.
+static const unsigned GpuTraceThread = 0;
+
+/*******************************************************************************
+ * Capture Types
+ ******************************************************************************/
+struct CaptureMarker
+{
+  OpenGLMarkerId id;
+  quint16 depth;
+  unsigned traceThread;
+  quint64 startTime;
+  quint64 endTime;
+};
+
+struct CaptureFrame
+{
+  quint64 startTime;
+  quint64 endTime;
+  quint64 beginTime; //< Includes CPU markers starting ahead of the GPU.
+  unsigned issuedStateCalls;
+  unsigned filteredStateCalls;
+  unsigned calls;
+  quint64 callNs;
+  size_t markerCount;
+};
+
+static void writeName(QTextStream &out, char const *name)
+{
+  out << '"';
+  for (; *name; ++name)
+  {
+    if (*name == '"' || *name == '\\') out << '\\' << *name;
+    else if (static_cast<unsigned char>(*name) >= 0x20) out << *name;
+  }
+  out << '"';
+}
+
+// Trace timestamps are microseconds, this keeps the nanoseconds.
+static void writeTime(QTextStream &out, quint64 ns)
+{
+  out << (ns / 1000) << '.' << char('0' + ns / 100 % 10) << char('0' + ns / 10 % 10) << char('0' + ns % 10);
+}
+
+/*******************************************************************************
+ * OpenGLProfilerCapturePrivate
+ ******************************************************************************/
+class OpenGLProfilerCapturePrivate
+{
+public:
+  OpenGLProfilerCapturePrivate();
+
+  // Ring Helpers
+  size_t frameIndex(size_t age) const;
+  CaptureMarker *frameMarkers(size_t frame);
+  CaptureMarker const *frameMarkers(size_t frame) const;
+  void addMarker(CaptureFrame &frame, CaptureMarker *markers, CaptureMarker const &marker);
+
+  // Every frame owns a fixed slice of the markers, no allocation while recording.
+  bool m_recording;
+  size_t m_markersPerFrame;
+  size_t m_nextFrame;
+  size_t m_frameCount;
+  size_t m_droppedMarkers;
+  std::vector<CaptureFrame> m_frames;
+  std::vector<CaptureMarker> m_markers;
+};
+
+OpenGLProfilerCapturePrivate::OpenGLProfilerCapturePrivate() :
+  m_recording(false), m_markersPerFrame(0), m_nextFrame(0), m_frameCount(0), m_droppedMarkers(0)
+{
+  // Intentionally Empty
+}
+
+size_t OpenGLProfilerCapturePrivate::frameIndex(size_t age) const
+{
+  // Age 0 is the oldest frame still held.
+  return (m_nextFrame + m_frames.size() - m_frameCount + age) % m_frames.size();
+}
+
+CaptureMarker *OpenGLProfilerCapturePrivate::frameMarkers(size_t frame)
+{
+  return m_markers.data() + frame * m_markersPerFrame;
+}
+
+CaptureMarker const *OpenGLProfilerCapturePrivate::frameMarkers(size_t frame) const
+{
+  return m_markers.data() + frame * m_markersPerFrame;
+}
+
+void OpenGLProfilerCapturePrivate::addMarker(CaptureFrame &frame, CaptureMarker *markers, CaptureMarker const &marker)
+{
+  if (frame.markerCount == m_markersPerFrame)
+  {
+    ++m_droppedMarkers;
+    return;
+  }
+  markers[frame.markerCount++] = marker;
+  frame.beginTime = std::min(frame.beginTime, marker.startTime);
+}
+
+/*******************************************************************************
+ * OpenGLProfilerCapture
+ ******************************************************************************/
+OpenGLProfilerCapture::OpenGLProfilerCapture(QObject *parent) :
+  QObject(parent), m_private(new OpenGLProfilerCapturePrivate)
+{
+  allocate(DefaultFrames, DefaultMarkersPerFrame);
+}
+
+OpenGLProfilerCapture::~OpenGLProfilerCapture()
+{
+  delete m_private;
+}
+
+void OpenGLProfilerCapture::allocate(size_t frames, size_t markersPerFrame)
+{
+  P(OpenGLProfilerCapturePrivate);
+  p.m_markersPerFrame = markersPerFrame;
+  p.m_frames.resize(std::max<size_t>(frames, 1));
+  p.m_markers.resize(p.m_frames.size() * markersPerFrame);
+  clear();
+}
+
+void OpenGLProfilerCapture::setRecording(bool recording)
+{
+  P(OpenGLProfilerCapturePrivate);
+  p.m_recording = recording;
+}
+
+bool OpenGLProfilerCapture::isRecording() const
+{
+  P(const OpenGLProfilerCapturePrivate);
+  return p.m_recording;
+}
+
+void OpenGLProfilerCapture::clear()
+{
+  P(OpenGLProfilerCapturePrivate);
+  p.m_nextFrame = p.m_frameCount = p.m_droppedMarkers = 0;
+}
+
+size_t OpenGLProfilerCapture::frames() const
+{
+  P(const OpenGLProfilerCapturePrivate);
+  return p.m_frames.size();
+}
+
+size_t OpenGLProfilerCapture::frameCount() const
+{
+  P(const OpenGLProfilerCapturePrivate);
+  return p.m_frameCount;
+}
+
+size_t OpenGLProfilerCapture::droppedMarkers() const
+{
+  P(const OpenGLProfilerCapturePrivate);
+  return p.m_droppedMarkers;
+}
+
+bool OpenGLProfilerCapture::save(QString const &fileName) const
+{
+  P(const OpenGLProfilerCapturePrivate);
+  QFile file(fileName);
+  if (!file.open(QFile::WriteOnly | QFile::Truncate | QFile::Text)) return false;
+
+  // Times are written relative to the start of the capture.
+  quint64 captureBegin = 0;
+  unsigned traceThreads = GpuTraceThread + 1;
+  for (size_t age = 0; age < p.m_frameCount; ++age)
+  {
+    size_t frame = p.frameIndex(age);
+    CaptureMarker const *markers = p.frameMarkers(frame);
+    if (age == 0 || p.m_frames[frame].beginTime < captureBegin) captureBegin = p.m_frames[frame].beginTime;
+    for (size_t i = 0; i < p.m_frames[frame].markerCount; ++i)
+    {
+      traceThreads = std::max(traceThreads, markers[i].traceThread + 1);
+    }
+  }
+
+  QTextStream out(&file);
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+  out << "{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"OpenGLProfiler\"}}";
+  for (unsigned thread = 0; thread < traceThreads; ++thread)
+  {
+    out << ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":" << thread << ",\"name\":\"thread_name\",\"args\":{\"name\":\"";
+    if (thread == GpuTraceThread) out << "GPU";
+    else out << "CPU Thread " << (thread - 1);
+    out << "\"}}";
+  }
+
+  for (size_t age = 0; age < p.m_frameCount; ++age)
+  {
+    size_t index = p.frameIndex(age);
+    CaptureFrame const &frame = p.m_frames[index];
+    CaptureMarker const *markers = p.frameMarkers(index);
+
+    // The frame itself, then its markers
+    out << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << GpuTraceThread << ",\"name\":\"Frame\",\"ts\":";
+    writeTime(out, frame.startTime - captureBegin);
+    out << ",\"dur\":";
+    writeTime(out, frame.endTime - frame.startTime);
+    out << "}";
+    for (size_t i = 0; i < frame.markerCount; ++i)
+    {
+      CaptureMarker const &marker = markers[i];
+      out << ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":" << marker.traceThread << ",\"name\":";
+      writeName(out, OpenGLMarkerRegistry::name(marker.id));
+      out << ",\"ts\":";
+      writeTime(out, marker.startTime - captureBegin);
+      out << ",\"dur\":";
+      writeTime(out, marker.endTime - marker.startTime);
+      out << ",\"args\":{\"depth\":" << marker.depth << "}}";
+    }
+
+    // Counters are sampled at the start of the frame
+    out << ",\n{\"ph\":\"C\",\"pid\":1,\"name\":\"State Calls\",\"ts\":";
+    writeTime(out, frame.startTime - captureBegin);
+    out << ",\"args\":{\"issued\":" << frame.issuedStateCalls << ",\"filtered\":" << frame.filteredStateCalls << "}}";
+    out << ",\n{\"ph\":\"C\",\"pid\":1,\"name\":\"Profiled GL Calls\",\"ts\":";
+    writeTime(out, frame.startTime - captureBegin);
+    out << ",\"args\":{\"calls\":" << frame.calls << ",\"us\":";
+    writeTime(out, frame.callNs);
+    out << "}}";
+  }
+  out << "\n]}\n";
+  out.flush();
+
+  return (file.error() == QFile::NoError);
+}
+
+/*******************************************************************************
+ * Public Slots
+ ******************************************************************************/
+void OpenGLProfilerCapture::frameResultsAvailable(OpenGLFrameResults const &results)
+{
+  P(OpenGLProfilerCapturePrivate);
+  if (!p.m_recording) return;
+
+  // Overwrite the oldest frame once the ring is full.
+  size_t index = p.m_nextFrame;
+  p.m_nextFrame = (p.m_nextFrame + 1) % p.m_frames.size();
+  p.m_frameCount = std::min(p.m_frameCount + 1, p.m_frames.size());
+
+  CaptureFrame &frame = p.m_frames[index];
+  CaptureMarker *markers = p.frameMarkers(index);
+  frame.startTime = frame.beginTime = results.startTime();
+  frame.endTime = results.endTime();
+  frame.issuedStateCalls = results.issuedStateCalls();
+  frame.filteredStateCalls = results.filteredStateCalls();
+  frame.calls = 0;
+  frame.callNs = 0;
+  frame.markerCount = 0;
+  for (OpenGLCallResult const &call : results.callResults())
+  {
+    frame.calls += call.calls;
+    frame.callNs += call.ns;
+  }
+
+  for (OpenGLMarkerResult const &result : results.gpuResults())
+  {
+    CaptureMarker marker = { result.id(), quint16(result.depth()), GpuTraceThread, result.startTime(), result.endTime() };
+    p.addMarker(frame, markers, marker);
+  }
+  for (OpenGLMarkerResult const &result : results.cpuResults())
+  {
+    CaptureMarker marker = { result.id(), quint16(result.depth()), result.thread() + 1, result.startTime(), result.endTime() };
+    p.addMarker(frame, markers, marker);
+  }
+}
@@ -0,0 +1,49 @@
+#ifndef OPENGLPROFILERCAPTURE_H
+#define OPENGLPROFILERCAPTURE_H OpenGLProfilerCapture
+
+#include <QObject>
+class OpenGLFrameResults;
+
+// Keeps the last frames of OpenGLProfiler results in a ring which is
+// allocated up front, and saves them as Chrome Trace Event JSON. Captures
+// load in chrome://tracing or ui.perfetto.dev.
+//
+// Recording continuously keeps the last frames() frames. For a triggered
+// range, clear() and start recording where it begins, stop where it ends.
+class OpenGLProfilerCapturePrivate;
+class OpenGLProfilerCapture : public QObject
+{
+  Q_OBJECT
+public:
+  enum
+  {
+    DefaultFrames = 300,
+    DefaultMarkersPerFrame = 256
+  };
+
+  // Constructors / Destructors
+  explicit OpenGLProfilerCapture(QObject *parent = 0);
+  ~OpenGLProfilerCapture();
+
+  // Capture Settings
+  void allocate(size_t frames, size_t markersPerFrame);
+  void setRecording(bool recording);
+  bool isRecording() const;
+  void clear();
+
+  // Query Information
+  size_t frames() const;
+  size_t frameCount() const;
+  size_t droppedMarkers() const;
+
+  // Returns false if the file could not be written.
+  bool save(QString const &fileName) const;
+
+public slots:
+  void frameResultsAvailable(OpenGLFrameResults const &results);
+
+private:
+  OpenGLProfilerCapturePrivate *m_private;
+};
+
+#endif // OPENGLPROFILERCAPTURE_H
@@ -0,0 +1,581 @@
+#include "openglprofilerstatistics.h"
+#include "openglframeresults.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <QFile>
+#include <QTextStream>
+#include <KMacros>
+
+// Frames waiting for the worker, markers past a frame's slots are left out.
+static const size_t QueueFrames = 64;
+static const size_t QueueSamplesPerFrame = 256;
+
+// Log-scale histogram: bucket 0 is below 1us, then 8 buckets per doubling.
+static const size_t HistogramBuckets = 256;
+static const double HistogramBase = 1000.0;
+static const double BucketsPerOctave = 8.0;
+
+// One sample per marker and frame, keyed by marker id and track.
+static const size_t MarkerKeys = 2 * OpenGLMarkerRegistry::MaxMarkers;
+
+static const unsigned DefaultWindows[] = { 120, 3600 };
+static const float DefaultFrameBudget = 1000.0f / 60.0f;
+
+// Vsync jitter around the budget is normal, missing a whole interval is not.
+static const double IntervalTolerance = 1.5;
+
+static inline size_t bucket(quint32 ns)
+{
+  if (ns < HistogramBase) return 0;
+  size_t b = 1 + static_cast<size_t>(BucketsPerOctave * std::log2(ns / HistogramBase));
+  return std::min(b, HistogramBuckets - 1);
+}
+
+static inline double bucketValue(size_t b)
+{
+  if (b == 0) return HistogramBase / 2.0;
+  return HistogramBase * std::exp2((b - 0.5) / BucketsPerOctave);
+}
+
+/*******************************************************************************
+ * RollingStatistics
+ ******************************************************************************/
+// Sample numbers with monotonic values, the front is the window's extreme.
+// Never holds more than the window, so the ring is allocated once.
+struct MonotonicQueue
+{
+  std::vector<quint64> order;
+  size_t head;
+  size_t count;
+};
+
+struct StatisticsWindow
+{
+  unsigned size;
+  unsigned count;
+  quint64 sum;
+  unsigned buckets[HistogramBuckets];
+  MonotonicQueue minimum;
+  MonotonicQueue maximum;
+};
+
+// The samples of the largest window, each window evicts what falls out of it.
+class RollingStatistics
+{
+public:
+  void reset(std::vector<unsigned> const &windows);
+  void add(quint64 ns);
+  bool summary(size_t window, OpenGLProfilerStatistics::Summary &summary) const;
+
+private:
+  template <typename Compare>
+  void push(MonotonicQueue &queue, quint64 first, quint32 sample, Compare keeps);
+  quint32 front(MonotonicQueue const &queue) const;
+  float percentile(StatisticsWindow const &window, double p, quint32 min, quint32 max) const;
+
+  std::vector<quint32> m_samples;
+  std::vector<StatisticsWindow> m_windows;
+  quint64 m_total;
+};
+
+void RollingStatistics::reset(std::vector<unsigned> const &windows)
+{
+  m_windows.resize(windows.size());
+  m_samples.assign(*std::max_element(windows.begin(), windows.end()), 0);
+  m_total = 0;
+  for (size_t i = 0; i < windows.size(); ++i)
+  {
+    StatisticsWindow &window = m_windows[i];
+    window.size = windows[i];
+    window.count = 0;
+    window.sum = 0;
+    std::fill(window.buckets, window.buckets + HistogramBuckets, 0);
+    for (MonotonicQueue *queue : { &window.minimum, &window.maximum })
+    {
+      queue->order.assign(window.size, 0);
+      queue->head = 0;
+      queue->count = 0;
+    }
+  }
+}
+
+void RollingStatistics::add(quint64 ns)
+{
+  quint32 sample = static_cast<quint32>(std::min<quint64>(ns, std::numeric_limits<quint32>::max()));
+  size_t capacity = m_samples.size();
+  for (StatisticsWindow &window : m_windows)
+  {
+    if (window.count == window.size)
+    {
+      quint32 oldest = m_samples[(m_total - window.size) % capacity];
+      window.sum -= oldest;
+      --window.buckets[bucket(oldest)];
+      --window.count;
+    }
+    window.sum += sample;
+    ++window.buckets[bucket(sample)];
+    ++window.count;
+    quint64 first = m_total + 1 - window.count;
+    push(window.minimum, first, sample, [](quint32 kept, quint32 added) { return kept < added; });
+    push(window.maximum, first, sample, [](quint32 kept, quint32 added) { return kept > added; });
+  }
+  m_samples[m_total % capacity] = sample;
+  ++m_total;
+}
+
+bool RollingStatistics::summary(size_t window, OpenGLProfilerStatistics::Summary &summary) const
+{
+  if (window >= m_windows.size() || m_windows[window].count == 0) return false;
+  StatisticsWindow const &w = m_windows[window];
+
+  // Extremes are exact, the histogram only has to place percentiles.
+  quint32 min = front(w.minimum);
+  quint32 max = front(w.maximum);
+
+  summary.samples = w.count;
+  summary.mean = float(double(w.sum) / w.count / 1e6);
+  summary.min = min / 1e6f;
+  summary.max = max / 1e6f;
+  summary.p50 = percentile(w, 0.50, min, max);
+  summary.p95 = percentile(w, 0.95, min, max);
+  summary.p99 = percentile(w, 0.99, min, max);
+  return true;
+}
+
+// Drops samples older than first from the front, and samples which can no
+// longer be the extreme from the back, before appending sample m_total.
+template <typename Compare>
+void RollingStatistics::push(MonotonicQueue &queue, quint64 first, quint32 sample, Compare keeps)
+{
+  size_t capacity = queue.order.size();
+  if (queue.count && queue.order[queue.head] < first)
+  {
+    queue.head = (queue.head + 1) % capacity;
+    --queue.count;
+  }
+  while (queue.count && !keeps(m_samples[queue.order[(queue.head + queue.count - 1) % capacity] % m_samples.size()], sample))
+  {
+    --queue.count;
+  }
+  queue.order[(queue.head + queue.count) % capacity] = m_total;
+  ++queue.count;
+}
+
+quint32 RollingStatistics::front(MonotonicQueue const &queue) const
+{
+  return m_samples[queue.order[queue.head] % m_samples.size()];
+}
+
+float RollingStatistics::percentile(StatisticsWindow const &window, double p, quint32 min, quint32 max) const
+{
+  unsigned rank = std::max(1u, static_cast<unsigned>(std::ceil(p * window.count)));
+  unsigned seen = 0;
+  for (size_t b = 0; b < HistogramBuckets; ++b)
+  {
+    seen += window.buckets[b];
+    if (seen >= rank) return float(std::min<double>(std::max<double>(bucketValue(b), min), max) / 1e6);
+  }
+  return max / 1e6f;
+}
+
+/*******************************************************************************
+ * OpenGLProfilerStatisticsPrivate
+ ******************************************************************************/
+struct QueuedSample
+{
+  OpenGLMarkerId id;
+  OpenGLMarkerResult::Track track;
+  quint64 ns;
+};
+
+struct QueuedFrame
+{
+  quint64 startTime;
+  quint64 endTime;
+  size_t count;
+};
+
+class OpenGLProfilerStatisticsPrivate
+{
+public:
+  OpenGLProfilerStatisticsPrivate();
+  ~OpenGLProfilerStatisticsPrivate();
+
+  // Worker Helpers
+  void run();
+  void process(QueuedFrame const &frame, QueuedSample const *samples);
+  void reset();
+
+  // Queue, only the render thread moves the head and only the worker the tail.
+  std::vector<QueuedFrame> m_queue;
+  std::vector<QueuedSample> m_queueSamples;
+  std::atomic<size_t> m_queueHead;
+  std::atomic<size_t> m_queueTail;
+  std::atomic<quint64> m_droppedFrames;
+
+  // Statistics, the worker updates them while queries read them.
+  mutable std::mutex m_mutex;
+  std::vector<unsigned> m_windows;
+  quint64 m_frameBudget;
+  quint64 m_frames;
+  quint64 m_lastStartTime;
+  bool m_lastOverBudget;
+  RollingStatistics m_frameStatistics;
+  RollingStatistics m_intervalStatistics;
+  std::vector<RollingStatistics*> m_markers;
+  std::vector<size_t> m_activeKeys;
+  quint64 m_stutterCount;
+  OpenGLProfilerStatistics::Stutter m_stutters[OpenGLProfilerStatistics::MaxStutters];
+
+  // Per-frame sums of the worker
+  std::vector<quint64> m_frameSums;
+  std::vector<size_t> m_frameKeys;
+
+  // Worker
+  std::mutex m_wakeMutex;
+  std::condition_variable m_wake;
+  bool m_quit;
+  std::thread m_worker;
+};
+
+OpenGLProfilerStatisticsPrivate::OpenGLProfilerStatisticsPrivate() :
+  m_queue(QueueFrames), m_queueSamples(QueueFrames * QueueSamplesPerFrame), m_queueHead(0), m_queueTail(0), m_droppedFrames(0),
+  m_windows(DefaultWindows, DefaultWindows + sizeof(DefaultWindows) / sizeof(DefaultWindows[0])),
+  m_frameBudget(static_cast<quint64>(DefaultFrameBudget * 1e6f)), m_markers(MarkerKeys, Q_NULLPTR), m_frameSums(MarkerKeys, 0), m_quit(false)
+{
+  m_frameKeys.reserve(MarkerKeys);
+  reset();
+  m_worker = std::thread(&OpenGLProfilerStatisticsPrivate::run, this);
+}
+
+OpenGLProfilerStatisticsPrivate::~OpenGLProfilerStatisticsPrivate()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_wakeMutex);
+    m_quit = true;
+  }
+  m_wake.notify_one();
+  m_worker.join();
+  for (RollingStatistics *statistics : m_markers)
+  {
+    delete statistics;
+  }
+}
+
+void OpenGLProfilerStatisticsPrivate::run()
+{
+  std::unique_lock<std::mutex> lock(m_wakeMutex);
+  for (;;)
+  {
+    m_wake.wait(lock, [this] { return m_quit || m_queueTail.load(std::memory_order_relaxed) != m_queueHead.load(std::memory_order_acquire); });
+    if (m_quit) return;
+    lock.unlock();
+
+    size_t tail = m_queueTail.load(std::memory_order_relaxed);
+    while (tail != m_queueHead.load(std::memory_order_acquire))
+    {
+      process(m_queue[tail], &m_queueSamples[tail * QueueSamplesPerFrame]);
+      tail = (tail + 1) % QueueFrames;
+      m_queueTail.store(tail, std::memory_order_release);
+    }
+
+    lock.lock();
+  }
+}
+
+void OpenGLProfilerStatisticsPrivate::process(QueuedFrame const &frame, QueuedSample const *samples)
+{
+  // A marker occurring several times per frame gives one sample, its total.
+  for (size_t i = 0; i < frame.count; ++i)
+  {
+    size_t key = 2 * samples[i].id + samples[i].track;
+    if (!m_frameSums[key]) m_frameKeys.push_back(key);
+    m_frameSums[key] += std::max<quint64>(samples[i].ns, 1);
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (size_t key : m_frameKeys)
+  {
+    RollingStatistics *&statistics = m_markers[key];
+    if (!statistics)
+    {
+      statistics = new RollingStatistics;
+      statistics->reset(m_windows);
+      m_activeKeys.push_back(key);
+    }
+    statistics->add(m_frameSums[key]);
+    m_frameSums[key] = 0;
+  }
+  m_frameKeys.clear();
+
+  // Stutters are frames over budget, or late by more than the tolerance.
+  // A frame over budget delays the next one, which is not counted again.
+  quint64 frameTime = frame.endTime - frame.startTime;
+  quint64 interval = (m_frames && frame.startTime > m_lastStartTime) ? frame.startTime - m_lastStartTime : 0;
+  bool overBudget = (frameTime > m_frameBudget);
+  m_frameStatistics.add(frameTime);
+  if (interval) m_intervalStatistics.add(interval);
+  if (overBudget || (interval > m_frameBudget * IntervalTolerance && !m_lastOverBudget))
+  {
+    OpenGLProfilerStatistics::Stutter &stutter = m_stutters[m_stutterCount++ % OpenGLProfilerStatistics::MaxStutters];
+    stutter.frame = m_frames;
+    stutter.frameMs = frameTime / 1e6f;
+    stutter.intervalMs = interval / 1e6f;
+  }
+  m_lastStartTime = frame.startTime;
+  m_lastOverBudget = overBudget;
+  ++m_frames;
+}
+
+void OpenGLProfilerStatisticsPrivate::reset()
+{
+  m_frames = 0;
+  m_lastStartTime = 0;
+  m_lastOverBudget = false;
+  m_stutterCount = 0;
+  m_frameStatistics.reset(m_windows);
+  m_intervalStatistics.reset(m_windows);
+  for (size_t key : m_activeKeys)
+  {
+    m_markers[key]->reset(m_windows);
+  }
+}
+
+/*******************************************************************************
+ * JSON Helpers
+ ******************************************************************************/
+static void writeName(QTextStream &out, char const *name)
+{
+  out << '"';
+  for (; *name; ++name)
+  {
+    if (*name == '"' || *name == '\\') out << '\\' << *name;
+    else if (static_cast<unsigned char>(*name) >= 0x20) out << *name;
+  }
+  out << '"';
+}
+
+static void writeSummaries(QTextStream &out, RollingStatistics const &statistics, std::vector<unsigned> const &windows)
+{
+  out << '[';
+  for (size_t i = 0; i < windows.size(); ++i)
+  {
+    OpenGLProfilerStatistics::Summary summary;
+    if (i) out << ',';
+    out << "{\"window\":" << windows[i];
+    if (statistics.summary(i, summary))
+    {
+      out << ",\"samples\":" << summary.samples << ",\"mean\":" << summary.mean << ",\"min\":" << summary.min << ",\"max\":" << summary.max
+          << ",\"p50\":" << summary.p50 << ",\"p95\":" << summary.p95 << ",\"p99\":" << summary.p99;
+    }
+    else
+    {
+      out << ",\"samples\":0";
+    }
+    out << '}';
+  }
+  out << ']';
+}
+
+/*******************************************************************************
+ * OpenGLProfilerStatistics
+ ******************************************************************************/
+OpenGLProfilerStatistics::OpenGLProfilerStatistics(QObject *parent) :
+  QObject(parent), m_private(new OpenGLProfilerStatisticsPrivate)
+{
+  // Intentionally Empty
+}
+
+OpenGLProfilerStatistics::~OpenGLProfilerStatistics()
+{
+  delete m_private;
+}
+
+void OpenGLProfilerStatistics::setWindows(std::vector<unsigned> const &samples)
+{
+  P(OpenGLProfilerStatisticsPrivate);
+  std::vector<unsigned> windows;
+  for (unsigned window : samples)
+  {
+    if (window && windows.size() < MaxWindows) windows.push_back(window);
+  }
+  if (windows.empty()) return;
+
+  std::lock_guard<std::mutex> lock(p.m_mutex);
+  p.m_windows = windows;
+  p.reset();
+}
+
+std::vector<unsigned> OpenGLProfilerStatistics::windows() const
+{
+  P(const OpenGLProfilerStatisticsPrivate);
+  std::lock_guard<std::mutex> lock(p.m_mutex);
+  return p.m_windows;
+}
+
+void OpenGLProfilerStatistics::setFrameBudget(float ms)
+{
+  P(OpenGLProfilerStatisticsPrivate);
+  std::lock_guard<std::mutex> lock(p.m_mutex);
+  p.m_frameBudget = static_cast<quint64>(ms * 1e6f);
+}
+
+float OpenGLProfilerStatistics::frameBudget() const
+{
+  P(const OpenGLProfilerStatisticsPrivate);
+  std::lock_guard<std::mutex> lock(p.m_mutex);
+  return p.m_frameBudget / 1e6f;
+}
+
+void OpenGLProfilerStatistics::clear()
+{
+  P(OpenGLProfilerStatisticsPrivate);
+  std::lock_guard<std::mutex> lock(p.m_mutex);
+  p.reset();
+}
+
+bool OpenGLProfilerStatistics::markerSummary(OpenGLMarkerId id, OpenGLMarkerResult::Track track, size_t window, Summary &summary) const
+{
+  P(const OpenGLProfilerStatisticsPrivate);
+  std::lock_guard<std::mutex> lock(p.m_mutex);
+  RollingStatistics const *statistics = p.m_markers[2 * id + track];
+  return statistics && statistics->summary(window, summary);
+}
+
+bool OpenGLProfilerStatistics::frameSummary(size_t window, Summary &summary) const
+{
+  P(const OpenGLProfilerStatisticsPrivate);
+  std::lock_guard<std::mutex> lock(p.m_mutex);
+  return p.m_frameStatistics.summary(window, summary);
+}
+
+bool OpenGLProfilerStatistics::intervalSummary(size_t window, Summary &summary) const
+{
+  P(const OpenGLProfilerStatisticsPrivate);
+  std::lock_guard<std::mutex> lock(p.m_mutex);
+  return p.m_intervalStatistics.summary(window, summary);
+}
+
+quint64 OpenGLProfilerStatistics::frames() const
+{
+  P(const OpenGLProfilerStatisticsPrivate);
+  std::lock_guard<std::mutex> lock(p.m_mutex);
+  return p.m_frames;
+}
+
+quint64 OpenGLProfilerStatistics::droppedFrames() const
+{
+  P(const OpenGLProfilerStatisticsPrivate);
+  return p.m_droppedFrames.load(std::memory_order_relaxed);
+}
+
+quint64 OpenGLProfilerStatistics::stutterCount() const
+{
+  P(const OpenGLProfilerStatisticsPrivate);
+  std::lock_guard<std::mutex> lock(p.m_mutex);
+  return p.m_stutterCount;
+}
+
+std::vector<OpenGLProfilerStatistics::Stutter> OpenGLProfilerStatistics::stutters() const
+{
+  P(const OpenGLProfilerStatisticsPrivate);
+  std::lock_guard<std::mutex> lock(p.m_mutex);
+
+  // Oldest first
+  quint64 count = std::min<quint64>(p.m_stutterCount, MaxStutters);
+  std::vector<Stutter> stutters;
+  stutters.reserve(count);
+  for (quint64 i = p.m_stutterCount - count; i < p.m_stutterCount; ++i)
+  {
+    stutters.push_back(p.m_stutters[i % MaxStutters]);
+  }
+  return stutters;
+}
+
+bool OpenGLProfilerStatistics::save(QString const &fileName) const
+{
+  P(const OpenGLProfilerStatisticsPrivate);
+  QFile file(fileName);
+  if (!file.open(QFile::WriteOnly | QFile::Truncate | QFile::Text)) return false;
+  std::vector<Stutter> recentStutters = stutters();
+
+  std::lock_guard<std::mutex> lock(p.m_mutex);
+  QTextStream out(&file);
+  out << "{\"frameBudgetMs\":" << (p.m_frameBudget / 1e6f) << ",\"frames\":" << p.m_frames << ",\"droppedFrames\":" << p.m_droppedFrames.load(std::memory_order_relaxed);
+  out << ",\"windows\":[";
+  for (size_t i = 0; i < p.m_windows.size(); ++i)
+  {
+    out << (i ? "," : "") << p.m_windows[i];
+  }
+  out << "],\n\"frame\":";
+  writeSummaries(out, p.m_frameStatistics, p.m_windows);
+  out << ",\n\"interval\":";
+  writeSummaries(out, p.m_intervalStatistics, p.m_windows);
+
+  out << ",\n\"stutters\":{\"count\":" << p.m_stutterCount << ",\"recent\":[";
+  for (size_t i = 0; i < recentStutters.size(); ++i)
+  {
+    Stutter const &stutter = recentStutters[i];
+    out << (i ? "," : "") << "{\"frame\":" << stutter.frame << ",\"frameMs\":" << stutter.frameMs << ",\"intervalMs\":" << stutter.intervalMs << '}';
+  }
+  out << "]},\n\"markers\":[";
+  for (size_t i = 0; i < p.m_activeKeys.size(); ++i)
+  {
+    size_t key = p.m_activeKeys[i];
+    out << (i ? ",\n" : "\n") << "{\"name\":";
+    writeName(out, OpenGLMarkerRegistry::name(static_cast<OpenGLMarkerId>(key / 2)));
+    out << ",\"track\":" << ((key % 2 == OpenGLMarkerResult::GpuTrack) ? "\"GPU\"" : "\"CPU\"") << ",\"windows\":";
+    writeSummaries(out, *p.m_markers[key], p.m_windows);
+    out << '}';
+  }
+  out << "\n]}\n";
+  out.flush();
+
+  return (file.error() == QFile::NoError);
+}
+
+/*******************************************************************************
+ * Public Slots
+ ******************************************************************************/
+void OpenGLProfilerStatistics::frameResultsAvailable(OpenGLFrameResults const &results)
+{
+  P(OpenGLProfilerStatisticsPrivate);
+
+  // If the worker falls behind, frames are counted rather than waited on.
+  size_t head = p.m_queueHead.load(std::memory_order_relaxed);
+  size_t next = (head + 1) % QueueFrames;
+  if (next == p.m_queueTail.load(std::memory_order_acquire))
+  {
+    p.m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  QueuedFrame &frame = p.m_queue[head];
+  QueuedSample *samples = &p.m_queueSamples[head * QueueSamplesPerFrame];
+  frame.startTime = results.startTime();
+  frame.endTime = results.endTime();
+  frame.count = 0;
+  for (OpenGLMarkerResults const *markers : { &results.gpuResults(), &results.cpuResults() })
+  {
+    for (OpenGLMarkerResult const &result : *markers)
+    {
+      if (frame.count == QueueSamplesPerFrame) break;
+      QueuedSample &sample = samples[frame.count++];
+      sample.id = result.id();
+      sample.track = result.track();
+      sample.ns = result.endTime() - result.startTime();
+    }
+  }
+  p.m_queueHead.store(next, std::memory_order_release);
+
+  // Taking the lock keeps the worker from missing the wake up.
+  {
+    std::lock_guard<std::mutex> lock(p.m_wakeMutex);
+  }
+  p.m_wake.notify_one();
+}
@@ -0,0 +1,79 @@
+#ifndef OPENGLPROFILERSTATISTICS_H
+#define OPENGLPROFILERSTATISTICS_H OpenGLProfilerStatistics
+
+#include <vector>
+#include <QObject>
+#include <OpenGLMarkerRegistry>
+#include <OpenGLMarkerResult>
+class OpenGLFrameResults;
+
+// Rolling statistics of OpenGLProfiler results per marker, over one or more
+// windows of the last N samples. A marker gives one sample per frame (the
+// time of all its occurrences), the frame itself gives its GPU time and
+// the interval to the previous frame.
+//
+// The render thread only copies results into a preallocated queue, a worker
+// thread updates the statistics. Percentiles come from a fixed log-scale
+// histogram (about 9% bucket width), min/max/mean are exact.
+class OpenGLProfilerStatisticsPrivate;
+class OpenGLProfilerStatistics : public QObject
+{
+  Q_OBJECT
+public:
+  enum
+  {
+    MaxWindows = 4,
+    MaxStutters = 64
+  };
+
+  // All times in milliseconds.
+  struct Summary
+  {
+    unsigned samples;
+    float mean;
+    float min;
+    float max;
+    float p50;
+    float p95;
+    float p99;
+  };
+
+  // A frame which took longer than the frame budget.
+  struct Stutter
+  {
+    quint64 frame;
+    float frameMs;
+    float intervalMs;
+  };
+
+  // Constructors / Destructors
+  explicit OpenGLProfilerStatistics(QObject *parent = 0);
+  ~OpenGLProfilerStatistics();
+
+  // Statistics Settings (changing the windows resets the statistics)
+  void setWindows(std::vector<unsigned> const &samples);
+  std::vector<unsigned> windows() const;
+  void setFrameBudget(float ms);
+  float frameBudget() const;
+  void clear();
+
+  // Query Information, false if there are no samples yet.
+  bool markerSummary(OpenGLMarkerId id, OpenGLMarkerResult::Track track, size_t window, Summary &summary) const;
+  bool frameSummary(size_t window, Summary &summary) const;
+  bool intervalSummary(size_t window, Summary &summary) const;
+  quint64 frames() const;
+  quint64 droppedFrames() const;
+  quint64 stutterCount() const;
+  std::vector<Stutter> stutters() const;
+
+  // Returns false if the file could not be written.
+  bool save(QString const &fileName) const;
+
+public slots:
+  void frameResultsAvailable(OpenGLFrameResults const &results);
+
+private:
+  OpenGLProfilerStatisticsPrivate *m_private;
+};
+
+#endif // OPENGLPROFILERSTATISTICS_H
@@ -1,6 +1,7 @@
 #include "openglprofilervisualizer.h"
 #include "openglframeresults.h"
 
+#include <algorithm>
 #include <cstdint>
 
 #include <QColor>
@@ -27,6 +28,8 @@ class OpenGLProfilerVisualizerPrivate
 {
 public:
   OpenGLProfilerVisualizerPrivate();
+  QRectF barRect(float start, float end, size_t row, float rowHeight) const;
+  void drawBar(QRectF const &rect, QString const &name, QString const &info, QColor const &color, QPointF const &mousePos);
 
   bool m_dirty;
   QPoint m_windowPosition;
@@ -45,6 +48,42 @@ OpenGLProfilerVisualizerPrivate::OpenGLProfilerVisualizerPrivate() :
   // Intentionally Empty
 }
 
+QRectF OpenGLProfilerVisualizerPrivate::barRect(float start, float end, size_t row, float rowHeight) const
+{
+  QRectF rect;
+  rect.setLeft(m_topLeft.x() + m_surfaceArea.width() * start);
+  rect.setRight(m_topLeft.x() + m_surfaceArea.width() * end);
+  rect.setTop(m_topLeft.y() + rowHeight * row);
+  rect.setBottom(m_topLeft.y() + rowHeight * (row + 1));
+  return rect;
+}
+
+void OpenGLProfilerVisualizerPrivate::drawBar(QRectF const &rect, QString const &name, QString const &info, QColor const &color, QPointF const &mousePos)
+{
+  QColor barColor = color;
+
+  // Display debug information if selected
+  if (rect.contains(mousePos))
+  {
+    barColor = Qt::yellow;
+    if (m_currToolTip != name)
+    {
+      m_currToolTip = name;
+      QString str = name + " " + info +
+        "\nState calls: " + QString::number(m_lastResultSet.issuedStateCalls()) + " issued, " +
+        QString::number(m_lastResultSet.filteredStateCalls()) + " filtered";
+      QToolTip::showText(QCursor::pos(), str);
+    }
+  }
+  else if (m_currToolTip == name)
+  {
+    m_currToolTip.clear();
+    QToolTip::hideText();
+  }
+
+  OpenGLDebugDraw::Screen::drawRect(rect, barColor);
+}
+
 /*******************************************************************************
  * OpenGLProfilerVisualizer
  ******************************************************************************/
@@ -92,11 +131,26 @@ void OpenGLProfilerVisualizer::paintGL()
   // Draw Background
   OpenGLDebugDraw::Screen::drawRect(p.m_surfaceRect, Qt::white);
 
-  // Find our step
-  float markerYStep = p.m_surfaceArea.height() / p.m_lastResultSet.maxDepth();
-  uint64_t frameBegin = p.m_lastResultSet.startTime();
-  uint64_t frameEnd = p.m_lastResultSet.endTime();
+  // Rows: GPU markers, then one lane of CPU markers per thread, then calls.
+  OpenGLFrameResults const &results = p.m_lastResultSet;
+  const OpenGLMarkerResults &gpuResults = results.gpuResults();
+  const OpenGLMarkerResults &cpuResults = results.cpuResults();
+  const OpenGLCallResults &callResults = results.callResults();
+  size_t cpuRow = results.maxDepth();
+  size_t callRow = cpuRow + results.cpuThreads() * results.maxCpuDepth();
+  size_t rows = callRow + (callResults.empty() ? 0 : 1);
+  float markerYStep = p.m_surfaceArea.height() / rows;
+
+  // CPU work usually starts before the GPU picks it up, show both.
+  uint64_t frameBegin = results.startTime();
+  uint64_t frameEnd = results.endTime();
+  for (OpenGLMarkerResult const &result : cpuResults)
+  {
+    frameBegin = std::min<uint64_t>(frameBegin, result.startTime());
+    frameEnd = std::max<uint64_t>(frameEnd, result.endTime());
+  }
   float frameTime = float(frameEnd - frameBegin);
+  float gpuFrameTime = float(results.endTime() - results.startTime());
 
   // Find mouse pos
   QPoint absoluteMousePos = KInputManager::mousePosition();
@@ -106,45 +160,35 @@ void OpenGLProfilerVisualizer::paintGL()
     float(relativeMousePos.y()) / p.m_windowSize.height()
   );
 
-  // Draw each marker
-  QColor markerColor;
-  QRectF normalizedMarkerRect;
-  float normalizedMarkerStart, normalizedMarkerEnd;
-  const OpenGLMarkerResults &gpuResults = p.m_lastResultSet.gpuResults();
+  // Draw each GPU marker
   for (size_t i = 0; i < gpuResults.size(); ++i)
   {
     const OpenGLMarkerResult &result = gpuResults[i];
+    QRectF rect = p.barRect((result.startTime() - frameBegin) / frameTime, (result.endTime() - frameBegin) / frameTime, result.depth(), markerYStep);
+    QString info = QString::number(result.elapsedMilliseconds()) + " ms (GPU)";
+    p.drawBar(rect, result.name(), info, Karma::colorShift(Qt::red, float(i) / gpuResults.size()), normalizedRelativeMousePos);
+  }
 
-    // Calculate normalized marker area
-    normalizedMarkerStart = (result.startTime() - frameBegin) / frameTime;
-    normalizedMarkerEnd = (result.endTime() - frameBegin) / frameTime;
-    normalizedMarkerRect.setLeft(p.m_topLeft.x() + p.m_surfaceArea.width() * normalizedMarkerStart);
-    normalizedMarkerRect.setRight(p.m_topLeft.x() + p.m_surfaceArea.width() * normalizedMarkerEnd);
-    normalizedMarkerRect.setTop(p.m_topLeft.y() + markerYStep * result.depth());
-    normalizedMarkerRect.setBottom(p.m_topLeft.y() + markerYStep * (result.depth() + 1));
-
-    // Display debug information if selected
-    if (normalizedMarkerRect.contains(normalizedRelativeMousePos))
-    {
-      markerColor = Qt::yellow;
-      if (p.m_currToolTip != result.name())
-      {
-        p.m_currToolTip = result.name();
-        QString str = result.name() + " " + QString::number(result.elapsedMilliseconds());
-        QToolTip::showText(QCursor::pos(), str);
-      }
-    }
-    else
-    {
-      markerColor = Karma::colorShift(Qt::red, float(i) / gpuResults.size());
-      if (p.m_currToolTip == result.name())
-      {
-        p.m_currToolTip.clear();
-        QToolTip::hideText();
-      }
-    }
+  // Draw each CPU marker in the lane of its thread
+  for (size_t i = 0; i < cpuResults.size(); ++i)
+  {
+    const OpenGLMarkerResult &result = cpuResults[i];
+    size_t row = cpuRow + result.thread() * results.maxCpuDepth() + result.depth();
+    QRectF rect = p.barRect((result.startTime() - frameBegin) / frameTime, (result.endTime() - frameBegin) / frameTime, row, markerYStep);
+    QString info = QString::number(result.elapsedMilliseconds()) + " ms (CPU, thread " + QString::number(result.thread()) + ")";
+    p.drawBar(rect, result.name(), info, Karma::colorShift(Qt::green, float(i) / cpuResults.size()), normalizedRelativeMousePos);
+  }
 
-    OpenGLDebugDraw::Screen::drawRect(normalizedMarkerRect, markerColor);
+  // Draw the CPU time of each profiled call back to back, scaled to the GPU frame
+  float normalizedCallEnd = 0.0f;
+  for (size_t i = 0; i < callResults.size(); ++i)
+  {
+    const OpenGLCallResult &result = callResults[i];
+    float normalizedCallStart = normalizedCallEnd;
+    normalizedCallEnd = std::min(1.0f, normalizedCallStart + result.ns / gpuFrameTime);
+    QRectF rect = p.barRect(normalizedCallStart, normalizedCallEnd, callRow, markerYStep);
+    QString info = QString::number(result.calls) + " calls, " + QString::number(result.ns / 1e6f) + " ms (CPU)";
+    p.drawBar(rect, OpenGLCallProfiler::name(result.id), info, Karma::colorShift(Qt::blue, float(i) / callResults.size()), normalizedRelativeMousePos);
   }
 }
 
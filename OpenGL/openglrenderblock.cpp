@@ -6,6 +6,7 @@
 #include <KSize>
 #include <KVector2D>
 #include <OpenGLRenderBlockData>
+#include <OpenGLRingBuffer>
 
 class OpenGLRenderBlockPrivate
 {
@@ -13,13 +14,17 @@ public:
   OpenGLRenderBlockPrivate();
   bool m_dirty;
   OpenGLRenderBlockData m_blockData;
+  OpenGLRingBuffer::Allocation m_block;
   void updateCombinationMatrices();
 };
 
 OpenGLRenderBlockPrivate::OpenGLRenderBlockPrivate() :
   m_dirty(false)
 {
-  // Intentionally Empty
+  m_block.data = Q_NULLPTR;
+  m_block.buffer = 0;
+  m_block.offset = 0;
+  m_block.size = 0;
 }
 
 void OpenGLRenderBlockPrivate::updateCombinationMatrices()
@@ -167,22 +172,46 @@ void OpenGLRenderBlock::update()
 {
   P(OpenGLRenderBlockPrivate);
 
-  if (!p.m_dirty) return;
-
-  OpenGLBuffer::RangeAccessFlags flags =
-      OpenGLBuffer::RangeInvalidate
-    | OpenGLBuffer::RangeUnsynchronized
-    | OpenGLBuffer::RangeWrite;
-  OpenGLRenderBlockData *data = (OpenGLRenderBlockData*)mapRange(0, sizeof(OpenGLRenderBlockData), flags);
-  std::memcpy(data, &p.m_blockData, sizeof(OpenGLRenderBlockData));
-  unmap();
+  OpenGLRingBuffer *ring = OpenGLRingBuffer::ringBuffer();
+  if (ring && ring->isCreated())
+  {
+    p.m_block = ring->allocate(sizeof(OpenGLRenderBlockData), OpenGLUniformBufferObject::alignmentOffset());
+    if (p.m_block.data)
+    {
+      std::memcpy(p.m_block.data, &p.m_blockData, sizeof(OpenGLRenderBlockData));
+      ring->flush(p.m_block);
+      p.m_dirty = false;
+      return;
+    }
+  }
+
+  // Without a ring buffer (or space in it) the block uses its own storage.
+  if (!isCreated())
+  {
+    setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    if (!create()) qFatal("Failed to create the render block buffer!");
+  }
+  bind();
+  if (size() < static_cast<int>(sizeof(OpenGLRenderBlockData)))
+  {
+    allocate(static_cast<int>(sizeof(OpenGLRenderBlockData)));
+  }
+  write(0, &p.m_blockData, static_cast<int>(sizeof(OpenGLRenderBlockData)));
+  release();
+  p.m_block.data = Q_NULLPTR;
+  p.m_block.buffer = bufferId();
+  p.m_block.offset = 0;
+  p.m_block.size = sizeof(OpenGLRenderBlockData);
 
   p.m_dirty = false;
 }
 
-void OpenGLRenderBlock::allocate()
+void OpenGLRenderBlock::bindBlock(unsigned index)
 {
-  OpenGLUniformBufferObject::allocate(sizeof(OpenGLRenderBlockData));
+  P(OpenGLRenderBlockPrivate);
+  if (!p.m_block.buffer) return;
+  OpenGLUniformBufferObject::bindBufferId(index, p.m_block.buffer);
+  GL::glBindBufferRange(GL_UNIFORM_BUFFER, index, p.m_block.buffer, static_cast<GLintptr>(p.m_block.offset), sizeof(OpenGLRenderBlockData));
 }
 
 bool OpenGLRenderBlock::dirty() const
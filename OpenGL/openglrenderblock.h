@@ -42,8 +42,10 @@ public:
   int height() const;
 
   // Public Methods
+  // Note: update() streams the block through the OpenGLRingBuffer, so it has
+  //       to run every frame before bindBlock() (allocations expire).
   void update();
-  void allocate();
+  void bindBlock(unsigned index);
   bool dirty() const;
 
 private:
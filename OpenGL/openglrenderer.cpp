@@ -4,6 +4,7 @@
 #include <KMacros>
 #include <KSize>
 #include <KString>
+#include <OpenGLMarkerRegistry>
 #include <OpenGLMarkerScoped>
 #include <OpenGLRenderPass>
 #include <OpenGLScene>
@@ -18,12 +19,15 @@ class OpenGLRendererPrivate
 {
 public:
   typedef std::vector<OpenGLRenderView> OpenGLRenderViewList;
+  typedef std::vector<OpenGLMarkerId> OpenGLMarkerIdList;
   OpenGLRendererPrivate();
+  OpenGLMarkerId viewportMarker(unsigned viewport);
 
   bool m_paused;
   KSize m_screenDimensions;
   OpenGLRenderViewList m_renderViews;
   OpenGLRenderPassQueue m_masterQueue;
+  OpenGLMarkerIdList m_viewportMarkers;
 };
 
 OpenGLRendererPrivate::OpenGLRendererPrivate() :
@@ -32,6 +36,17 @@ OpenGLRendererPrivate::OpenGLRendererPrivate() :
   // Intentionally Empty
 }
 
+OpenGLMarkerId OpenGLRendererPrivate::viewportMarker(unsigned viewport)
+{
+  // Names are only built for viewports not seen before, frames pass the id.
+  while (m_viewportMarkers.size() < viewport)
+  {
+    KString name = KString("Viewport %1").arg(static_cast<unsigned>(m_viewportMarkers.size() + 1));
+    m_viewportMarkers.push_back(OpenGLMarkerRegistry::intern(qPrintable(name)));
+  }
+  return m_viewportMarkers[viewport - 1];
+}
+
 OpenGLRenderer::OpenGLRenderer() :
   m_private(0)
 {
@@ -65,10 +80,10 @@ void OpenGLRenderer::render(OpenGLScene &scene)
 {
   P(OpenGLRendererPrivate);
   unsigned int currViewport = 1;
-  OpenGLMarkerScoped _("Total Render Time");
+  OpenGLMarkerScoped _(OPENGL_MARKER_ID("Total Render Time"));
   for (OpenGLRenderView &renderView: p.m_renderViews)
   {
-    OpenGLMarkerScoped _(KString("Viewport %1").arg(currViewport));
+    OpenGLMarkerScoped _(p.viewportMarker(currViewport));
     renderView.bind();
     renderView.commit(scene);
     renderView.render(scene);
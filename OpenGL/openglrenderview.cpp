@@ -57,7 +57,7 @@ void OpenGLRenderView::resize(int width, int height)
 void OpenGLRenderView::commit(OpenGLScene &scene)
 {
   P(OpenGLRenderViewPrivate);
-  OpenGLMarkerScoped _("Prepare Scene");
+  OpenGLMarkerScoped _(OPENGL_MARKER_ID("Prepare Scene"));
   p.m_view.commit();
   p.m_passQueue.commit(p.m_view);
   scene.commit(p.m_view);
@@ -66,7 +66,7 @@ void OpenGLRenderView::commit(OpenGLScene &scene)
 void OpenGLRenderView::render(OpenGLScene &scene)
 {
   P(OpenGLRenderViewPrivate);
-  OpenGLMarkerScoped _("Render Scene");
+  OpenGLMarkerScoped _(OPENGL_MARKER_ID("Render Scene"));
   p.m_passQueue.render(scene);
 }
 
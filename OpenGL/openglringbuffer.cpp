@@ -0,0 +1,294 @@
+#include "openglringbuffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <KDebug>
+#include <KElapsedTimer>
+#include <KMacros>
+#include <OpenGLFunctions>
+#include <QOpenGLContext>
+
+// Not every GL header has these (GL 4.4 / ARB_buffer_storage).
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+typedef void (QOPENGLF_APIENTRYP OpenGLBufferStorage)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+
+// Waits on a fence in slices, so a lost context cannot hang the frame forever.
+static const GLuint64 FenceTimeoutNs = 100000000ull;
+
+static OpenGLRingBuffer *sg_ringBuffer = Q_NULLPTR;
+
+static size_t alignOffset(size_t offset, size_t alignment)
+{
+  return ((offset + alignment - 1) / alignment) * alignment;
+}
+
+/*******************************************************************************
+ * OpenGLRingBufferPrivate
+ ******************************************************************************/
+class OpenGLRingBufferPrivate
+{
+public:
+  OpenGLRingBufferPrivate();
+  bool allocateStorage(size_t frameSize);
+  void deleteFences();
+  void acquire();
+
+  OpenGLBufferStorage m_bufferStorage;
+  GLuint m_buffer;
+  unsigned char *m_mapping;
+  size_t m_frameSize;
+  size_t m_head;
+  unsigned m_frame;
+  bool m_acquired;
+  GLsync m_fences[OpenGLRingBuffer::FrameCount];
+  std::vector<GLuint> m_retired;
+  OpenGLRingBuffer::Statistics m_statistics;
+};
+
+OpenGLRingBufferPrivate::OpenGLRingBufferPrivate() :
+  m_bufferStorage(Q_NULLPTR), m_buffer(0), m_mapping(Q_NULLPTR), m_frameSize(0), m_head(0), m_frame(0), m_acquired(false)
+{
+  std::fill(m_fences, m_fences + OpenGLRingBuffer::FrameCount, GLsync(0));
+  std::memset(&m_statistics, 0, sizeof(m_statistics));
+}
+
+bool OpenGLRingBufferPrivate::allocateStorage(size_t frameSize)
+{
+  GLsizeiptr size = static_cast<GLsizeiptr>(frameSize * OpenGLRingBuffer::FrameCount);
+  unsigned char *mapping = Q_NULLPTR;
+  GLuint buffer = 0;
+  GL::glGenBuffers(1, &buffer);
+  GL::glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+  if (m_bufferStorage)
+  {
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    m_bufferStorage(GL_COPY_WRITE_BUFFER, size, Q_NULLPTR, flags);
+    mapping = static_cast<unsigned char*>(GL::glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags));
+  }
+  else
+  {
+    GL::glBufferData(GL_COPY_WRITE_BUFFER, size, Q_NULLPTR, GL_STREAM_DRAW);
+  }
+  GL::glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+  if (m_bufferStorage && !mapping)
+  {
+    GL::glDeleteBuffers(1, &buffer);
+    return false;
+  }
+
+  // The old storage may still be bound by this frame, it goes at the next one.
+  if (m_buffer) m_retired.push_back(m_buffer);
+  deleteFences();
+  m_buffer = buffer;
+  m_mapping = mapping;
+  m_frameSize = frameSize;
+  m_head = m_frame * m_frameSize;
+  return true;
+}
+
+void OpenGLRingBufferPrivate::deleteFences()
+{
+  for (GLsync &fence : m_fences)
+  {
+    if (fence) GL::glDeleteSync(fence);
+    fence = 0;
+  }
+}
+
+void OpenGLRingBufferPrivate::acquire()
+{
+  // Only stalls if the GPU is more than FrameCount - 1 frames behind.
+  GLsync &fence = m_fences[m_frame];
+  if (fence)
+  {
+    GLenum result = GL::glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+      KElapsedTimer timer;
+      timer.start();
+      do
+      {
+        result = GL::glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FenceTimeoutNs);
+      } while (result == GL_TIMEOUT_EXPIRED);
+      ++m_statistics.stalls;
+      m_statistics.stallNs += timer.nsecsElapsed();
+    }
+    GL::glDeleteSync(fence);
+    fence = 0;
+  }
+
+  if (!m_retired.empty())
+  {
+    GL::glDeleteBuffers(static_cast<GLsizei>(m_retired.size()), m_retired.data());
+    m_retired.clear();
+  }
+
+  m_head = m_frame * m_frameSize;
+  m_acquired = true;
+}
+
+/*******************************************************************************
+ * OpenGLRingBuffer
+ ******************************************************************************/
+OpenGLRingBuffer::OpenGLRingBuffer() :
+  m_private(new OpenGLRingBufferPrivate)
+{
+  // Intentionally Empty
+}
+
+OpenGLRingBuffer::~OpenGLRingBuffer()
+{
+  destroy();
+  delete m_private;
+}
+
+bool OpenGLRingBuffer::create(size_t frameSize)
+{
+  P(OpenGLRingBufferPrivate);
+  destroy();
+
+  QOpenGLContext *ctx = QOpenGLContext::currentContext();
+  if (ctx->hasExtension("GL_ARB_buffer_storage"))
+  {
+    p.m_bufferStorage = reinterpret_cast<OpenGLBufferStorage>(ctx->getProcAddress("glBufferStorage"));
+  }
+  else if (ctx->hasExtension("GL_EXT_buffer_storage"))
+  {
+    p.m_bufferStorage = reinterpret_cast<OpenGLBufferStorage>(ctx->getProcAddress("glBufferStorageEXT"));
+  }
+
+  // Fall back to mapping ranges if persistent storage cannot be mapped.
+  if (p.allocateStorage(frameSize)) return true;
+  p.m_bufferStorage = Q_NULLPTR;
+  return p.allocateStorage(frameSize);
+}
+
+void OpenGLRingBuffer::destroy()
+{
+  P(OpenGLRingBufferPrivate);
+  if (!p.m_buffer) return;
+  p.deleteFences();
+  p.m_retired.push_back(p.m_buffer);
+  GL::glDeleteBuffers(static_cast<GLsizei>(p.m_retired.size()), p.m_retired.data());
+  p.m_retired.clear();
+  p.m_buffer = 0;
+  p.m_mapping = Q_NULLPTR;
+  p.m_acquired = false;
+}
+
+bool OpenGLRingBuffer::isCreated() const
+{
+  P(const OpenGLRingBufferPrivate);
+  return (p.m_buffer != 0);
+}
+
+bool OpenGLRingBuffer::isPersistent() const
+{
+  P(const OpenGLRingBufferPrivate);
+  return (p.m_mapping != Q_NULLPTR);
+}
+
+size_t OpenGLRingBuffer::frameSize() const
+{
+  P(const OpenGLRingBufferPrivate);
+  return p.m_frameSize;
+}
+
+OpenGLRingBuffer::Allocation OpenGLRingBuffer::allocate(size_t size, size_t alignment)
+{
+  P(OpenGLRingBufferPrivate);
+  Allocation allocation = { Q_NULLPTR, 0, 0, size };
+  if (!p.m_buffer || size == 0) return allocation;
+  if (!p.m_acquired) p.acquire();
+  if (alignment == 0) alignment = 1;
+
+  size_t begin = p.m_frame * p.m_frameSize;
+  size_t offset = alignOffset(p.m_head, alignment);
+  if (offset + size > begin + p.m_frameSize)
+  {
+    // Sized for everything this frame needed so far, it will need it again.
+    size_t required = (p.m_head - begin) + size + alignment;
+    size_t frameSize = 2 * p.m_frameSize;
+    while (frameSize < required) frameSize *= 2;
+    if (!p.allocateStorage(frameSize)) return allocation;
+    ++p.m_statistics.grows;
+    offset = alignOffset(p.m_head, alignment);
+  }
+  p.m_head = offset + size;
+
+  allocation.buffer = p.m_buffer;
+  allocation.offset = offset;
+  if (p.m_mapping)
+  {
+    allocation.data = p.m_mapping + offset;
+  }
+  else
+  {
+    // Nothing in flight uses this partition anymore, so no implicit sync either.
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+    GL::glBindBuffer(GL_COPY_WRITE_BUFFER, p.m_buffer);
+    allocation.data = GL::glMapBufferRange(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), flags);
+    GL::glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  }
+
+  ++p.m_statistics.allocations;
+  p.m_statistics.bytes += size;
+  return allocation;
+}
+
+void OpenGLRingBuffer::flush(Allocation const &allocation)
+{
+  P(OpenGLRingBufferPrivate);
+  if (p.m_mapping || !allocation.data) return;
+  GL::glBindBuffer(GL_COPY_WRITE_BUFFER, allocation.buffer);
+  GL::glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+  GL::glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void OpenGLRingBuffer::endFrame()
+{
+  P(OpenGLRingBufferPrivate);
+  if (!p.m_acquired) return;
+
+  size_t used = p.m_head - p.m_frame * p.m_frameSize;
+  p.m_statistics.peakFrameSize = std::max(p.m_statistics.peakFrameSize, used);
+  ++p.m_statistics.frames;
+
+  p.m_fences[p.m_frame] = GL::glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  p.m_frame = (p.m_frame + 1) % FrameCount;
+  p.m_acquired = false;
+}
+
+OpenGLRingBuffer::Statistics const &OpenGLRingBuffer::statistics() const
+{
+  P(const OpenGLRingBufferPrivate);
+  return p.m_statistics;
+}
+
+void OpenGLRingBuffer::report() const
+{
+  P(const OpenGLRingBufferPrivate);
+  Statistics const &s = p.m_statistics;
+  if (s.frames == 0) return;
+  kDebug() << "Ring Buffer | Persistent | Frame (KiB) | Peak (KiB) | Allocations / Frame | Stalls | Stall (ms) | Grows";
+  kDebug() << "Ring Buffer |" << isPersistent() << "|" << p.m_frameSize / 1024 << "|" << s.peakFrameSize / 1024
+           << "|" << float(s.allocations) / s.frames << "|" << s.stalls << "|" << float(s.stallNs) / 1e6f << "|" << s.grows;
+}
+
+OpenGLRingBuffer *OpenGLRingBuffer::ringBuffer()
+{
+  return sg_ringBuffer;
+}
+
+void OpenGLRingBuffer::setRingBuffer(OpenGLRingBuffer *ringBuffer)
+{
+  sg_ringBuffer = ringBuffer;
+}
@@ -0,0 +1,76 @@
+#ifndef OPENGLRINGBUFFER_H
+#define OPENGLRINGBUFFER_H OpenGLRingBuffer
+
+#include <cstddef>
+#include <QtOpenGL/QGL>
+
+// Streams per-frame data (view blocks, light data, debug vertices) through a
+// single buffer split into FrameCount partitions. A partition is only written
+// again once the fence placed at the end of its frame has signaled, so uploads
+// never race with the GPU still reading them.
+//
+// With GL_ARB_buffer_storage (GL 4.4) or GL_EXT_buffer_storage the buffer is
+// mapped once, persistently and coherently, and allocate() is a pointer bump.
+// Otherwise (GL 3.3 / ES 3.0) every allocation maps its own range, which may
+// be unsynchronized for the same reason, and flush() unmaps it; only one
+// allocation may be open at a time on that path.
+//
+// Allocations are valid until the end of the frame. When a frame outgrows its
+// partition the storage is replaced by one twice as large; the old buffer is
+// deleted once the next frame starts, so everything is re-bound every frame.
+class OpenGLRingBufferPrivate;
+class OpenGLRingBuffer
+{
+public:
+  enum
+  {
+    FrameCount = 3,
+    DefaultFrameSize = 256 * 1024
+  };
+
+  struct Allocation
+  {
+    void *data;
+    GLuint buffer;
+    size_t offset;
+    size_t size;
+  };
+
+  struct Statistics
+  {
+    quint64 allocations;
+    quint64 bytes;
+    unsigned frames;
+    unsigned stalls;
+    unsigned grows;
+    size_t peakFrameSize;
+    quint64 stallNs;
+  };
+
+  OpenGLRingBuffer();
+  ~OpenGLRingBuffer();
+
+  // Ring Buffer Actions
+  bool create(size_t frameSize = DefaultFrameSize);
+  void destroy();
+  bool isCreated() const;
+  bool isPersistent() const;
+  size_t frameSize() const;
+
+  // Alignment may be any value (e.g. a vertex stride), not just powers of two.
+  Allocation allocate(size_t size, size_t alignment);
+  void flush(Allocation const &allocation);
+  void endFrame();
+
+  Statistics const &statistics() const;
+  void report() const;
+
+  // Global Settings
+  static OpenGLRingBuffer *ringBuffer();
+  static void setRingBuffer(OpenGLRingBuffer *ringBuffer);
+
+private:
+  OpenGLRingBufferPrivate *m_private;
+};
+
+#endif // OPENGLRINGBUFFER_H
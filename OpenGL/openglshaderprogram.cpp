@@ -1,5 +1,6 @@
 #include "openglshaderprogram.h"
 #include <QDir>
+#include <QDirIterator>
 #include <QFile>
 #include <QOpenGLContext>
 #include <QSurfaceFormat>
@@ -7,8 +8,18 @@
 #include <OpenGLUniformBufferObject>
 #include <OpenGLSLParser>
 #include <OpenGLUniformManager>
+#include <KDebug>
+#include <KElapsedTimer>
+#include <KHash>
+#include <KMappedFile>
+#include <KParallel>
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 #include "kabstractlexer.h"
 #include "kbufferedfilereader.h"
@@ -42,17 +53,641 @@ OpenGLShaderProgramUniformUpdate::OpenGLShaderProgramUniformUpdate(unsigned loca
   // Intentionally Empty
 }
 
+/*******************************************************************************
+ * OpenGLShaderSourceCache
+ ******************************************************************************/
+// Preprocessed sources keyed on the hash of everything that changes the
+// output: version comment, defines, include paths and the file itself. The
+// full key is kept to rule out collisions.
+struct OpenGLShaderSource
+{
+  std::string m_key;
+  std::string m_source;
+  uint64_t m_sourceHash;
+  std::vector<std::string> m_autobinder;
+  std::vector<std::string> m_autosampler;
+};
+
+typedef std::shared_ptr<OpenGLShaderSource const> OpenGLShaderSourcePtr;
+static std::unordered_map<uint64_t, OpenGLShaderSourcePtr> sg_sourceCache;
+static std::mutex sg_sourceMutex;
+
+static void appendUnique(std::vector<std::string> &dst, std::vector<std::string> const &src)
+{
+  for (std::string const &identifier : src)
+  {
+    if (std::find(dst.begin(), dst.end(), identifier) == dst.end())
+    {
+      dst.push_back(identifier);
+    }
+  }
+}
+
+/*******************************************************************************
+ * OpenGLProgramBinary
+ ******************************************************************************/
+// Linked programs are written next to the other caches, named by the program
+// key (stage sources + GL vendor/renderer/version). The header repeats the
+// key and hashes the binary, so stale or damaged files are simply rebuilt.
+// Files of another context (driver update) are deleted on first use.
+struct OpenGLProgramBinaryHeader
+{
+  char magic[4];
+  uint32_t version;
+  uint64_t context;
+  uint64_t key;
+  uint64_t binaryHash;
+  uint64_t buildNs;
+  uint32_t binaryFormat;
+  uint32_t binarySize;
+};
+
+static const char OpenGLProgramBinaryMagic[4] = { 'K', 'P', 'R', 'G' };
+static const uint32_t OpenGLProgramBinaryVersion = 2;
+static const char OpenGLProgramBinarySuffix[] = ".kprog";
+
+static bool sg_binaryCacheEnabled = true;
+static OpenGLShaderProgram::BinaryCacheStatistics sg_binaryStatistics = { 0, 0, 0, 0, 0 };
+
+static bool binaryCacheSupported()
+{
+  return sg_binaryCacheEnabled && GL::capabilities().programBinaryFormats > 0;
+}
+
+// Drivers only accept binaries they produced, so the context identifies them.
+static uint64_t contextHash()
+{
+  static uint64_t hash = 0;
+  if (hash == 0)
+  {
+    GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION };
+    hash = Karma::hash(&OpenGLProgramBinaryVersion, sizeof(OpenGLProgramBinaryVersion));
+    for (GLenum name : names)
+    {
+      char const *value = reinterpret_cast<char const*>(GL::glGetString(name));
+      if (value) hash = Karma::hash(value, std::strlen(value), hash);
+    }
+  }
+  return hash;
+}
+
+static QString binaryFileName(uint64_t key)
+{
+  return Karma::cacheFileName(QString::number(key, 16) + OpenGLProgramBinarySuffix);
+}
+
+// Every other context writes its own keys, so the files it left behind would
+// never be read again. Unreadable headers are old versions, also deleted.
+static void pruneBinaryCache()
+{
+  static bool pruned = false;
+  if (pruned) return;
+  pruned = true;
+
+  int removed = 0;
+  QDirIterator it(Karma::cacheDirectory(), QStringList() << (QString("*") + OpenGLProgramBinarySuffix), QDir::Files);
+  while (it.hasNext())
+  {
+    QFile file(it.next());
+    OpenGLProgramBinaryHeader header;
+    bool current =
+      file.open(QFile::ReadOnly) &&
+      file.read(reinterpret_cast<char*>(&header), sizeof(header)) == static_cast<qint64>(sizeof(header)) &&
+      std::memcmp(header.magic, OpenGLProgramBinaryMagic, sizeof(header.magic)) == 0 &&
+      header.version == OpenGLProgramBinaryVersion &&
+      header.context == contextHash();
+    file.close();
+    if (!current && file.remove()) ++removed;
+  }
+  if (removed > 0) kDebug() << "Program Binary Cache | Pruned |" << removed;
+}
+
+/*******************************************************************************
+ * OpenGLShaderBatch
+ ******************************************************************************/
+// Not every GL header has these (KHR_parallel_shader_compile shares the
+// enum with the ARB variant).
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+#ifndef GL_GEOMETRY_SHADER
+#define GL_GEOMETRY_SHADER 0x8DD9
+#endif
+#ifndef GL_TESS_CONTROL_SHADER
+#define GL_TESS_CONTROL_SHADER 0x8E88
+#endif
+#ifndef GL_TESS_EVALUATION_SHADER
+#define GL_TESS_EVALUATION_SHADER 0x8E87
+#endif
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+
+typedef void (QOPENGLF_APIENTRYP OpenGLMaxShaderCompilerThreads)(GLuint count);
+
+// Stages preprocessed per task, every file is parsed independently.
+static const size_t StageGrain = 1;
+
+static unsigned sg_batchDepth = 0;
+static std::vector<OpenGLShaderProgram*> sg_batch;
+static OpenGLShaderProgram::CompileStatistics sg_compileStatistics = { 0, 0, 0, 0, 0 };
+
+static GLenum shaderStage(QOpenGLShader::ShaderType type)
+{
+  switch (type)
+  {
+  case QOpenGLShader::Vertex:
+    return GL_VERTEX_SHADER;
+  case QOpenGLShader::Fragment:
+    return GL_FRAGMENT_SHADER;
+  case QOpenGLShader::Geometry:
+    return GL_GEOMETRY_SHADER;
+  case QOpenGLShader::TessellationControl:
+    return GL_TESS_CONTROL_SHADER;
+  case QOpenGLShader::TessellationEvaluation:
+    return GL_TESS_EVALUATION_SHADER;
+  case QOpenGLShader::Compute:
+    return GL_COMPUTE_SHADER;
+  }
+  return GL_VERTEX_SHADER;
+}
+
+// Everything needed to preprocess a stage away from the GL thread. The raw
+// shader object only lives between submission and the link status check.
+struct OpenGLShaderStage
+{
+  QOpenGLShader::ShaderType m_type;
+  QString m_fileName;
+  std::string m_header;
+  std::string m_key;
+  uint64_t m_keyHash;
+  std::vector<char const*> m_includePaths;
+  OpenGLShaderSourcePtr m_source;
+  GLuint m_shader;
+};
+
+// Safe to call from the worker threads, both caches lock internally.
+static bool preprocessStage(OpenGLShaderStage &stage)
+{
+  {
+    std::lock_guard<std::mutex> lock(sg_sourceMutex);
+    auto it = sg_sourceCache.find(stage.m_keyHash);
+    if (it != sg_sourceCache.end() && it->second->m_key == stage.m_key)
+    {
+      stage.m_source = it->second;
+      return true;
+    }
+  }
+
+  // Preprocess the shader file
+  KBufferedFileReader reader(stage.m_fileName, 1024);
+
+  if (!reader.valid())
+  {
+    qFatal("Failed to open file: `%s`", qPrintable(stage.m_fileName));
+  }
+
+  std::shared_ptr<OpenGLShaderSource> preprocessed = std::make_shared<OpenGLShaderSource>();
+  preprocessed->m_key = stage.m_key;
+  preprocessed->m_source = stage.m_header;
+  KStringWriter writer(preprocessed->m_source);
+  OpenGLSLParser parser(&reader, &writer);
+  QByteArray filePath = stage.m_fileName.toUtf8();
+  parser.setFilePath(filePath.constData());
+  for (char const *path : stage.m_includePaths)
+  {
+    parser.addIncludePath(path);
+  }
+  parser.setAutoresolver(&preprocessed->m_autobinder);
+  parser.setAutosampler(&preprocessed->m_autosampler);
+  parser.initialize();
+  if (!parser.parse())
+  {
+    return false;
+  }
+  preprocessed->m_sourceHash = Karma::hash(preprocessed->m_source.data(), preprocessed->m_source.size());
+
+  std::lock_guard<std::mutex> lock(sg_sourceMutex);
+  stage.m_source = sg_sourceCache[stage.m_keyHash] = preprocessed;
+  return true;
+}
+
+/*******************************************************************************
+ * Reflection
+ ******************************************************************************/
+// Stages which may declare subroutines, in subroutineStage() order.
+static const GLenum sg_subroutineStages[] =
+{
+#if !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
+  GL_VERTEX_SHADER, GL_TESS_CONTROL_SHADER, GL_TESS_EVALUATION_SHADER,
+  GL_GEOMETRY_SHADER, GL_FRAGMENT_SHADER, GL_COMPUTE_SHADER
+#else
+  GL_VERTEX_SHADER, GL_FRAGMENT_SHADER
+#endif
+};
+static const size_t SubroutineStageCount = sizeof(sg_subroutineStages) / sizeof(sg_subroutineStages[0]);
+
+static int subroutineStage(GLenum stage)
+{
+  for (size_t i = 0; i < SubroutineStageCount; ++i)
+  {
+    if (sg_subroutineStages[i] == stage) return static_cast<int>(i);
+  }
+  return -1;
+}
+
+typedef std::unordered_map<std::string, GLint> OpenGLReflectionMap;
+
+/*******************************************************************************
+ * OpenGLShaderProgramPrivate
+ ******************************************************************************/
+enum OpenGLShaderProgramState
+{
+  Idle,           // Nothing pending, isLinked() is final.
+  Queued,         // Waiting in the open batch.
+  Compiling,      // Stages and link submitted, status not checked yet.
+  LoadingBinary   // Cached binary submitted, status not checked yet.
+};
+
 class OpenGLShaderProgramPrivate
 {
 public:
+  OpenGLShaderProgramPrivate();
+  uint64_t binaryKey() const;
+  bool compileStages(OpenGLShaderProgram &program);
+  bool loadBinary(OpenGLShaderProgram &program, uint64_t key, quint64 &buildNs);
+  void saveBinary(OpenGLShaderProgram &program, uint64_t key, quint64 buildNs);
+  void submitStages(OpenGLShaderProgram &program);
+  void reportErrors(OpenGLShaderProgram &program);
+  void releaseStages(OpenGLShaderProgram &program);
+  void registerCallbacks(OpenGLShaderProgram &program);
+  void addSubroutineStage(GLenum stage);
+  void reflect(OpenGLShaderProgram &program);
+  bool submit(OpenGLShaderProgram &program);
+  bool finish(OpenGLShaderProgram &program);
+  OpenGLShaderProgramState m_state;
+  unsigned m_subroutineStageMask;
+  uint64_t m_key;
+  quint64 m_cachedNs;
+  quint64 m_cpuNs;
+  std::vector<OpenGLShaderStage> m_stages;
   std::vector<char const*> m_includePaths;
   std::vector<std::string> m_autobinder;
   std::vector<std::string> m_autosampler;
   std::vector<OpenGLShaderProgramUniformUpdate> m_uniformUpdate;
   std::vector<OpenGLShaderProgramUniformBufferUpdate> m_bufferUpdate;
   std::string m_defines;
+  OpenGLReflectionMap m_uniforms;
+  OpenGLReflectionMap m_uniformBlocks;
+  OpenGLReflectionMap m_subroutines[SubroutineStageCount];
+  OpenGLReflectionMap m_subroutineUniforms[SubroutineStageCount];
 };
 
+OpenGLShaderProgramPrivate::OpenGLShaderProgramPrivate() :
+  m_state(Idle), m_subroutineStageMask(0), m_key(0), m_cachedNs(0), m_cpuNs(0)
+{
+  // Intentionally Empty
+}
+
+uint64_t OpenGLShaderProgramPrivate::binaryKey() const
+{
+  // The source hashes already cover the version comment and defines.
+  uint64_t key = contextHash();
+  for (OpenGLShaderStage const &stage : m_stages)
+  {
+    uint64_t stageKey[2] = { uint64_t(stage.m_type), stage.m_source->m_sourceHash };
+    key = Karma::hash(stageKey, sizeof(stageKey), key);
+  }
+  return key;
+}
+
+bool OpenGLShaderProgramPrivate::compileStages(OpenGLShaderProgram &program)
+{
+  for (OpenGLShaderStage const &stage : m_stages)
+  {
+    if (!program.OpenGLShaderProgramChecked::addShaderFromSourceCode(stage.m_type, stage.m_source->m_source.c_str()))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool OpenGLShaderProgramPrivate::loadBinary(OpenGLShaderProgram &program, uint64_t key, quint64 &buildNs)
+{
+  QFile file(binaryFileName(key));
+  if (!file.open(QFile::ReadOnly)) return false;
+  QByteArray contents = file.readAll();
+  file.close();
+
+  OpenGLProgramBinaryHeader header;
+  if (contents.size() < static_cast<int>(sizeof(header))) return false;
+  std::memcpy(&header, contents.constData(), sizeof(header));
+  char const *binary = contents.constData() + sizeof(header);
+  bool valid =
+    std::memcmp(header.magic, OpenGLProgramBinaryMagic, sizeof(header.magic)) == 0 &&
+    header.version == OpenGLProgramBinaryVersion &&
+    header.context == contextHash() &&
+    header.key == key &&
+    sizeof(header) + header.binarySize == static_cast<size_t>(contents.size()) &&
+    header.binaryHash == Karma::hash(binary, header.binarySize);
+  if (!valid)
+  {
+    ++sg_binaryStatistics.rejected;
+    return false;
+  }
+
+  // The driver may still refuse it (e.g. after an update with the same
+  // strings), which is only known once the link status is checked.
+  GL::glProgramBinary(program.programId(), header.binaryFormat, binary, static_cast<GLsizei>(header.binarySize));
+  buildNs = header.buildNs;
+  return true;
+}
+
+void OpenGLShaderProgramPrivate::saveBinary(OpenGLShaderProgram &program, uint64_t key, quint64 buildNs)
+{
+  GLint length = 0;
+  GL::glGetProgramiv(program.programId(), GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) return;
+
+  QByteArray contents(static_cast<int>(sizeof(OpenGLProgramBinaryHeader)) + length, '\0');
+  char *binary = contents.data() + sizeof(OpenGLProgramBinaryHeader);
+  GLenum format = 0;
+  GL::glGetProgramBinary(program.programId(), length, &length, &format, binary);
+  if (length <= 0) return;
+  contents.resize(static_cast<int>(sizeof(OpenGLProgramBinaryHeader)) + length);
+
+  OpenGLProgramBinaryHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, OpenGLProgramBinaryMagic, sizeof(header.magic));
+  header.version = OpenGLProgramBinaryVersion;
+  header.context = contextHash();
+  header.key = key;
+  header.binaryHash = Karma::hash(binary, static_cast<size_t>(length));
+  header.buildNs = buildNs;
+  header.binaryFormat = format;
+  header.binarySize = static_cast<uint32_t>(length);
+  std::memcpy(contents.data(), &header, sizeof(header));
+
+  // Never leave a partial file behind, it would only fail validation later.
+  QString fileName = binaryFileName(key);
+  QFile file(fileName);
+  bool success = file.open(QFile::WriteOnly | QFile::Truncate) && file.write(contents) == contents.size();
+  file.close();
+  if (!success) QFile::remove(fileName);
+}
+
+void OpenGLShaderProgramPrivate::submitStages(OpenGLShaderProgram &program)
+{
+  // No status queries here, those would wait for the driver.
+  GLuint id = program.programId();
+  if (m_key != 0) GL::glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  for (OpenGLShaderStage &stage : m_stages)
+  {
+    char const *source = stage.m_source->m_source.c_str();
+    stage.m_shader = GL::glCreateShader(shaderStage(stage.m_type));
+    GL::glShaderSource(stage.m_shader, 1, &source, Q_NULLPTR);
+    GL::glCompileShader(stage.m_shader);
+    GL::glAttachShader(id, stage.m_shader);
+  }
+  GL::glLinkProgram(id);
+  m_state = Compiling;
+}
+
+void OpenGLShaderProgramPrivate::reportErrors(OpenGLShaderProgram &program)
+{
+  GLint length = 0;
+  std::string log;
+  for (OpenGLShaderStage const &stage : m_stages)
+  {
+    GLint status = GL_FALSE;
+    GL::glGetShaderiv(stage.m_shader, GL_COMPILE_STATUS, &status);
+    if (status == GL_TRUE) continue;
+    GL::glGetShaderiv(stage.m_shader, GL_INFO_LOG_LENGTH, &length);
+    log.assign(std::max(length, 1), '\0');
+    GL::glGetShaderInfoLog(stage.m_shader, length, Q_NULLPTR, &log[0]);
+    qWarning("Failed to compile `%s`:\n%s", qPrintable(stage.m_fileName), log.c_str());
+  }
+  GL::glGetProgramiv(program.programId(), GL_INFO_LOG_LENGTH, &length);
+  log.assign(std::max(length, 1), '\0');
+  GL::glGetProgramInfoLog(program.programId(), length, Q_NULLPTR, &log[0]);
+  qWarning("Failed to link program:\n%s", log.c_str());
+}
+
+void OpenGLShaderProgramPrivate::releaseStages(OpenGLShaderProgram &program)
+{
+  for (OpenGLShaderStage const &stage : m_stages)
+  {
+    if (stage.m_shader == 0) continue;
+    GL::glDetachShader(program.programId(), stage.m_shader);
+    GL::glDeleteShader(stage.m_shader);
+  }
+  m_stages.clear();
+}
+
+void OpenGLShaderProgramPrivate::registerCallbacks(OpenGLShaderProgram &program)
+{
+  for (std::string const &resolver : m_autobinder)
+  {
+    OpenGLUniformManager::registerUniformBufferCallbacks(resolver, program);
+  }
+  for (std::string const &resolver : m_autosampler)
+  {
+    OpenGLUniformManager::registerTextureSamplerCallbacks(resolver, program);
+  }
+}
+
+void OpenGLShaderProgramPrivate::addSubroutineStage(GLenum stage)
+{
+  // Binary programs have nothing attached, so the stages are kept here.
+  int s = subroutineStage(stage);
+  if (s >= 0) m_subroutineStageMask |= (1u << s);
+}
+
+void OpenGLShaderProgramPrivate::reflect(OpenGLShaderProgram &program)
+{
+  m_uniforms.clear();
+  m_uniformBlocks.clear();
+  for (size_t i = 0; i < SubroutineStageCount; ++i)
+  {
+    m_subroutines[i].clear();
+    m_subroutineUniforms[i].clear();
+  }
+  if (!program.isLinked()) return;
+
+  GLuint id = program.programId();
+  GLint count = 0, maxLength = 0;
+  GLsizei length = 0;
+  std::vector<GLchar> name;
+
+  // Arrays are reported as "name[0]", both spellings resolve.
+  GL::glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &count);
+  GL::glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+  name.resize(std::max(maxLength, 1));
+  for (GLint i = 0; i < count; ++i)
+  {
+    GLint size;
+    GLenum type;
+    GL::glGetActiveUniform(id, GLuint(i), GLsizei(name.size()), &length, &size, &type, name.data());
+    GLint location = GL::glGetUniformLocation(id, name.data());
+    if (location == -1) continue; // Uniform block member
+    std::string uniform(name.data(), length);
+    m_uniforms[uniform] = location;
+    if (uniform.size() > 3 && uniform.compare(uniform.size() - 3, 3, "[0]") == 0)
+    {
+      m_uniforms[uniform.substr(0, uniform.size() - 3)] = location;
+    }
+  }
+
+  GL::glGetProgramiv(id, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+  GL::glGetProgramiv(id, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+  name.resize(std::max(maxLength, 1));
+  for (GLint i = 0; i < count; ++i)
+  {
+    GL::glGetActiveUniformBlockName(id, GLuint(i), GLsizei(name.size()), &length, name.data());
+    m_uniformBlocks[std::string(name.data(), length)] = i;
+  }
+
+#if !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)
+  // Only the stages the program was built from, the entry points are null
+  // below GL 4.0 without ARB_shader_subroutine.
+  if (!GL::capabilities().shaderSubroutine) return;
+  for (size_t s = 0; s < SubroutineStageCount; ++s)
+  {
+    GLenum stage = sg_subroutineStages[s];
+    if (!(m_subroutineStageMask & (1u << s))) continue;
+    if (stage == GL_COMPUTE_SHADER && !GL::capabilities().computeShader) continue;
+    GL::glGetProgramStageiv(id, stage, GL_ACTIVE_SUBROUTINES, &count);
+    GL::glGetProgramStageiv(id, stage, GL_ACTIVE_SUBROUTINE_MAX_LENGTH, &maxLength);
+    name.resize(std::max(maxLength, 1));
+    for (GLint i = 0; i < count; ++i)
+    {
+      GL::glGetActiveSubroutineName(id, stage, GLuint(i), GLsizei(name.size()), &length, name.data());
+      m_subroutines[s][std::string(name.data(), length)] = i;
+    }
+
+    GL::glGetProgramStageiv(id, stage, GL_ACTIVE_SUBROUTINE_UNIFORMS, &count);
+    GL::glGetProgramStageiv(id, stage, GL_ACTIVE_SUBROUTINE_UNIFORM_MAX_LENGTH, &maxLength);
+    name.resize(std::max(maxLength, 1));
+    for (GLint i = 0; i < count; ++i)
+    {
+      GL::glGetActiveSubroutineUniformName(id, stage, GLuint(i), GLsizei(name.size()), &length, name.data());
+      m_subroutineUniforms[s][std::string(name.data(), length)] = GL::glGetSubroutineUniformLocation(id, stage, name.data());
+    }
+  }
+#endif
+}
+
+bool OpenGLShaderProgramPrivate::submit(OpenGLShaderProgram &program)
+{
+  KElapsedTimer timer;
+  timer.start();
+
+  // Stages that failed to preprocess were reported by the parser.
+  m_stages.erase(std::remove_if(m_stages.begin(), m_stages.end(), [](OpenGLShaderStage const &stage) { return !stage.m_source; }), m_stages.end());
+  m_subroutineStageMask = 0;
+  for (OpenGLShaderStage const &stage : m_stages)
+  {
+    appendUnique(m_autobinder, stage.m_source->m_autobinder);
+    appendUnique(m_autosampler, stage.m_source->m_autosampler);
+    addSubroutineStage(shaderStage(stage.m_type));
+  }
+  for (QOpenGLShader const *shader : program.shaders())
+  {
+    addSubroutineStage(shaderStage(shader->shaderType()));
+  }
+
+  // Shaders attached directly are not part of the key and go through Qt, so
+  // those programs are still linked synchronously.
+  program.create();
+  if (m_stages.empty() || !program.shaders().isEmpty())
+  {
+    bool linked = compileStages(program) && program.OpenGLShaderProgramChecked::link();
+    m_stages.clear();
+    m_state = Idle;
+    reflect(program);
+    registerCallbacks(program);
+    return linked;
+  }
+
+  m_key = 0;
+  if (binaryCacheSupported())
+  {
+    pruneBinaryCache();
+    m_key = binaryKey();
+  }
+  if (m_key != 0 && loadBinary(program, m_key, m_cachedNs))
+  {
+    m_state = LoadingBinary;
+  }
+  else
+  {
+    submitStages(program);
+  }
+  m_cpuNs = timer.nsecsElapsed();
+  ++sg_compileStatistics.programs;
+  sg_compileStatistics.submitNs += m_cpuNs;
+  return true;
+}
+
+bool OpenGLShaderProgramPrivate::finish(OpenGLShaderProgram &program)
+{
+  if (!program.isReady()) ++sg_compileStatistics.stalled;
+  KElapsedTimer timer;
+  timer.start();
+
+  GLint status = GL_FALSE;
+  if (m_state == LoadingBinary)
+  {
+    GL::glGetProgramiv(program.programId(), GL_LINK_STATUS, &status);
+    if (status == GL_TRUE)
+    {
+      // Nothing attached, so Qt only picks up the status.
+      program.OpenGLShaderProgramChecked::link();
+      quint64 loadNs = m_cpuNs + timer.nsecsElapsed();
+      ++sg_binaryStatistics.hits;
+      sg_binaryStatistics.linkNs += loadNs;
+      sg_binaryStatistics.savedNs += (m_cachedNs > loadNs) ? m_cachedNs - loadNs : 0;
+    }
+    else
+    {
+      // Build from source, the program object is reused.
+      ++sg_binaryStatistics.rejected;
+      submitStages(program);
+    }
+  }
+
+  if (m_state == Compiling)
+  {
+    GL::glGetProgramiv(program.programId(), GL_LINK_STATUS, &status);
+    if (status == GL_TRUE)
+    {
+      program.OpenGLShaderProgramChecked::link();
+    }
+    else
+    {
+      reportErrors(program);
+    }
+
+    // GL thread time only, the driver may have compiled in the background.
+    quint64 buildNs = m_cpuNs + timer.nsecsElapsed();
+    if (m_key != 0)
+    {
+      ++sg_binaryStatistics.misses;
+      sg_binaryStatistics.linkNs += buildNs;
+      if (status == GL_TRUE) saveBinary(program, m_key, buildNs);
+    }
+  }
+  releaseStages(program);
+  sg_compileStatistics.waitNs += timer.nsecsElapsed();
+
+  // Resolving the callbacks queries locations, which must not recurse.
+  m_state = Idle;
+  reflect(program);
+  registerCallbacks(program);
+  return (status == GL_TRUE);
+}
+
 /*******************************************************************************
  * OpenGLShaderProgramWrapped
  ******************************************************************************/
@@ -64,6 +699,15 @@ OpenGLShaderProgram::OpenGLShaderProgram(QObject *parent) :
 
 OpenGLShaderProgram::~OpenGLShaderProgram()
 {
+  P(OpenGLShaderProgramPrivate);
+  if (p.m_state == Queued)
+  {
+    sg_batch.erase(std::remove(sg_batch.begin(), sg_batch.end(), this), sg_batch.end());
+  }
+  else if (p.m_state != Idle)
+  {
+    p.releaseStages(*this);
+  }
   delete m_private;
 }
 
@@ -74,37 +718,89 @@ void OpenGLShaderProgram::addIncludePath(const char *path)
 
 void OpenGLShaderProgram::addSharedIncludePath(const char *path)
 {
+  // Any preprocessed source may resolve its includes differently now.
   OpenGLSLParser::addSharedIncludePath(path);
+  clearSourceCache();
 }
 
 bool OpenGLShaderProgram::addShaderFromSourceFile(QOpenGLShader::ShaderType type, const QString &fileName)
 {
   P(OpenGLShaderProgramPrivate);
-  std::string ppSource = getVersionComment().toUtf8().constData() + p.m_defines;
-
-  // Preprocess the shader file
-  KBufferedFileReader reader(fileName, 1024);
-
-  if (!reader.valid())
+  OpenGLShaderStage stage;
+  stage.m_type = type;
+  stage.m_fileName = fileName;
+  stage.m_header = getVersionComment().toUtf8().constData() + p.m_defines;
+  stage.m_key = stage.m_header;
+  for (char const *path : p.m_includePaths)
   {
-    qFatal("Failed to open file: `%s`", qPrintable(fileName));
+    stage.m_key.append(path).push_back('\0');
   }
+  stage.m_key.append(fileName.toUtf8().constData());
+  stage.m_keyHash = Karma::hash(stage.m_key.data(), stage.m_key.size());
+  stage.m_includePaths = p.m_includePaths;
+  stage.m_shader = 0;
 
-  KStringWriter writer(ppSource);
-  OpenGLSLParser parser(&reader, &writer);
-  parser.setFilePath(fileName.toUtf8().constData());
-  for (char const *path : m_private->m_includePaths)
+  // Inside a batch, the source is preprocessed by flushBatch().
+  if (sg_batchDepth == 0 && !preprocessStage(stage))
   {
-    parser.addIncludePath(path);
+    return false;
   }
-  parser.setAutoresolver(&p.m_autobinder);
-  parser.setAutosampler(&p.m_autosampler);
-  parser.initialize();
-  if (parser.parse())
+
+  // Compiled by link(), unless the linked program comes from the binary cache.
+  p.m_stages.push_back(stage);
+  return true;
+}
+
+void OpenGLShaderProgram::setBinaryCacheEnabled(bool enabled)
+{
+  sg_binaryCacheEnabled = enabled;
+}
+
+OpenGLShaderProgram::BinaryCacheStatistics const &OpenGLShaderProgram::binaryCacheStatistics()
+{
+  return sg_binaryStatistics;
+}
+
+void OpenGLShaderProgram::reportBinaryCache()
+{
+  BinaryCacheStatistics const &s = sg_binaryStatistics;
+  unsigned total = s.hits + s.misses;
+  if (total == 0) return;
+  kDebug() << "Program Binary Cache | Hits | Misses | Rejected | Hit Rate (%) | Link (ms) | Saved (ms)";
+  kDebug() << "Program Binary Cache |" << s.hits << "|" << s.misses << "|" << s.rejected
+           << "|" << 100.0f * s.hits / total << "|" << float(s.linkNs) / 1e6f << "|" << float(s.savedNs) / 1e6f;
+}
+
+void OpenGLShaderProgram::clearSourceCache()
+{
   {
-    return OpenGLShaderProgramChecked::addShaderFromSourceCode(type, ppSource.c_str());
+    std::lock_guard<std::mutex> lock(sg_sourceMutex);
+    sg_sourceCache.clear();
   }
-  return false;
+  OpenGLSLParser::clearIncludeCache();
+}
+
+int OpenGLShaderProgram::uniformLocation(const char *name)
+{
+  P(OpenGLShaderProgramPrivate);
+  if (p.m_state != Idle) finishLink();
+  OpenGLReflectionMap::const_iterator it = p.m_uniforms.find(name);
+  if (it != p.m_uniforms.end()) return it->second;
+
+  // Not enumerated (e.g. a single array element), only asked for once.
+  int location = OpenGLShaderProgramProfiled::uniformLocation(name);
+  p.m_uniforms.emplace(name, location);
+  return location;
+}
+
+int OpenGLShaderProgram::uniformLocation(const QByteArray &name)
+{
+  return uniformLocation(name.constData());
+}
+
+int OpenGLShaderProgram::uniformLocation(const QString &name)
+{
+  return uniformLocation(name.toUtf8().constData());
 }
 
 void OpenGLShaderProgram::uniformBlockBinding(const char *location, unsigned index)
@@ -119,7 +815,30 @@ void OpenGLShaderProgram::uniformBlockBinding(unsigned location, unsigned index)
 
 unsigned OpenGLShaderProgram::uniformBlockLocation(const char *location)
 {
-  return GL::glGetUniformBlockIndex(this->programId(), location);
+  P(OpenGLShaderProgramPrivate);
+  if (p.m_state != Idle) finishLink();
+  OpenGLReflectionMap::const_iterator it = p.m_uniformBlocks.find(location);
+  return (it != p.m_uniformBlocks.end()) ? unsigned(it->second) : GL_INVALID_INDEX;
+}
+
+unsigned OpenGLShaderProgram::subroutineIndex(GLenum stage, const char *name)
+{
+  P(OpenGLShaderProgramPrivate);
+  if (p.m_state != Idle) finishLink();
+  int s = subroutineStage(stage);
+  if (s == -1) return GL_INVALID_INDEX;
+  OpenGLReflectionMap::const_iterator it = p.m_subroutines[s].find(name);
+  return (it != p.m_subroutines[s].end()) ? unsigned(it->second) : GL_INVALID_INDEX;
+}
+
+int OpenGLShaderProgram::subroutineUniformLocation(GLenum stage, const char *name)
+{
+  P(OpenGLShaderProgramPrivate);
+  if (p.m_state != Idle) finishLink();
+  int s = subroutineStage(stage);
+  if (s == -1) return -1;
+  OpenGLReflectionMap::const_iterator it = p.m_subroutineUniforms[s].find(name);
+  return (it != p.m_subroutineUniforms[s].end()) ? it->second : -1;
 }
 
 void OpenGLShaderProgram::scheduleUniformBlockUpdate(unsigned location, unsigned index)
@@ -200,24 +919,70 @@ void OpenGLShaderProgram::addShaderDefines(const char *defs)
 }
 
 bool OpenGLShaderProgram::link()
+{
+  // Inside a batch this only queues the program.
+  if (!linkAsync()) return false;
+  return (sg_batchDepth > 0) || finishLink();
+}
+
+bool OpenGLShaderProgram::linkAsync()
+{
+  P(OpenGLShaderProgramPrivate);
+  if (sg_batchDepth == 0)
+  {
+    return p.submit(*this);
+  }
+  if (p.m_state != Queued)
+  {
+    p.m_state = Queued;
+    sg_batch.push_back(this);
+  }
+  return true;
+}
+
+bool OpenGLShaderProgram::isReady()
+{
+  P(OpenGLShaderProgramPrivate);
+  switch (p.m_state)
+  {
+  case Idle:
+    return true;
+  case Queued:
+    return false;
+  case Compiling:
+  case LoadingBinary:
+    break;
+  }
+
+  // Without the extension any status query waits, so it never pays to poll.
+  if (!parallelCompileSupported()) return true;
+  GLint complete = GL_TRUE;
+  GL::glGetProgramiv(programId(), GL_COMPLETION_STATUS_KHR, &complete);
+  return (complete == GL_TRUE);
+}
+
+bool OpenGLShaderProgram::finishLink()
 {
   P(OpenGLShaderProgramPrivate);
-  bool ret = OpenGLShaderProgramChecked::link();
-  for (std::string const &resolver : p.m_autobinder)
+  if (p.m_state == Queued)
   {
-    OpenGLUniformManager::registerUniformBufferCallbacks(resolver, *this);
+    flushBatch();
   }
-  for (std::string const &resolver : p.m_autosampler)
+  if (p.m_state == Idle)
   {
-    OpenGLUniformManager::registerTextureSamplerCallbacks(resolver, *this);
+    return isLinked();
   }
-  return ret;
+  return p.finish(*this);
 }
 
 bool OpenGLShaderProgram::bind()
 {
   P(OpenGLShaderProgramPrivate);
-  bool ret = OpenGLShaderProgramChecked::bind();
+  if (p.m_state != Idle) finishLink();
+
+  // Through GL:: instead of QOpenGLShaderProgram, so redundant binds are dropped.
+  if (!isLinked()) return false;
+  GL::glUseProgram(programId());
   for (OpenGLShaderProgramUniformBufferUpdate &update : p.m_bufferUpdate)
   {
     uniformBlockBinding(update.m_bufferLocation, update.m_bufferIndex);
@@ -228,5 +993,113 @@ bool OpenGLShaderProgram::bind()
     setUniformValue(update.m_bufferLocation, update.m_bufferIndex);
   }
   p.m_uniformUpdate.clear();
-  return ret;
+  return true;
+}
+
+void OpenGLShaderProgram::release()
+{
+  GL::glUseProgram(0);
+}
+
+void OpenGLShaderProgram::beginBatch()
+{
+  ++sg_batchDepth;
+}
+
+void OpenGLShaderProgram::endBatch()
+{
+  if (sg_batchDepth > 0 && --sg_batchDepth == 0)
+  {
+    flushBatch();
+  }
+}
+
+void OpenGLShaderProgram::flushBatch()
+{
+  std::vector<OpenGLShaderProgram*> batch;
+  batch.swap(sg_batch);
+  if (batch.empty()) return;
+
+  // Programs share many stages (and identical keys), each is parsed once.
+  KElapsedTimer timer;
+  timer.start();
+  std::vector<OpenGLShaderStage*> unique;
+  std::vector<OpenGLShaderStage*> duplicates;
+  std::unordered_map<uint64_t, OpenGLShaderStage*> keys;
+  for (OpenGLShaderProgram *program : batch)
+  {
+    for (OpenGLShaderStage &stage : program->m_private->m_stages)
+    {
+      if (stage.m_source) continue;
+      auto it = keys.find(stage.m_keyHash);
+      if (it == keys.end())
+      {
+        keys[stage.m_keyHash] = &stage;
+        unique.push_back(&stage);
+      }
+      else if (it->second->m_key == stage.m_key)
+      {
+        duplicates.push_back(&stage);
+      }
+      else
+      {
+        unique.push_back(&stage);
+      }
+    }
+  }
+  Karma::parallelFor(0, unique.size(), StageGrain, [&unique](size_t b, size_t e)
+  {
+    for (size_t i = b; i < e; ++i)
+    {
+      preprocessStage(*unique[i]);
+    }
+  });
+  for (OpenGLShaderStage *stage : duplicates)
+  {
+    stage->m_source = keys[stage->m_keyHash]->m_source;
+  }
+  sg_compileStatistics.preprocessNs += timer.nsecsElapsed();
+
+  // Submission has to stay on the GL thread, but never waits on the driver.
+  parallelCompileSupported();
+  for (OpenGLShaderProgram *program : batch)
+  {
+    program->m_private->submit(*program);
+  }
+}
+
+bool OpenGLShaderProgram::parallelCompileSupported()
+{
+  // Resolved once, the driver picks the thread count (0xFFFFFFFF).
+  static int supported = -1;
+  if (supported < 0)
+  {
+    QOpenGLContext *ctx = QOpenGLContext::currentContext();
+    OpenGLMaxShaderCompilerThreads maxThreads = Q_NULLPTR;
+    if (ctx->hasExtension("GL_KHR_parallel_shader_compile"))
+    {
+      maxThreads = reinterpret_cast<OpenGLMaxShaderCompilerThreads>(ctx->getProcAddress("glMaxShaderCompilerThreadsKHR"));
+    }
+    else if (ctx->hasExtension("GL_ARB_parallel_shader_compile"))
+    {
+      maxThreads = reinterpret_cast<OpenGLMaxShaderCompilerThreads>(ctx->getProcAddress("glMaxShaderCompilerThreadsARB"));
+    }
+    if (maxThreads) maxThreads(0xFFFFFFFF);
+    supported = (maxThreads != Q_NULLPTR) ? 1 : 0;
+  }
+  return (supported == 1);
+}
+
+OpenGLShaderProgram::CompileStatistics const &OpenGLShaderProgram::compileStatistics()
+{
+  return sg_compileStatistics;
+}
+
+void OpenGLShaderProgram::reportCompile()
+{
+  CompileStatistics const &s = sg_compileStatistics;
+  if (s.programs == 0) return;
+  kDebug() << "Program Compile | Programs | Stalled | Parallel | Preprocess (ms) | Submit (ms) | Wait (ms)";
+  kDebug() << "Program Compile |" << s.programs << "|" << s.stalled << "|" << (parallelCompileSupported() ? "Yes" : "No")
+           << "|" << float(s.preprocessNs) / 1e6f << "|" << float(s.submitNs) / 1e6f << "|" << float(s.waitNs) / 1e6f;
 }
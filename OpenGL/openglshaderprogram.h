@@ -177,16 +177,66 @@ public:
   void addIncludePath(char const *path);
   static void addSharedIncludePath(char const *path);
   bool addShaderFromSourceFile(QOpenGLShader::ShaderType type, const QString & fileName);
+  static void clearSourceCache();
+
+  // Sources added from files are compiled by link(), which first tries the
+  // on-disk program binary cache (keyed on the preprocessed sources and the
+  // GL vendor/renderer/version). Statistics cover the whole process.
+  struct BinaryCacheStatistics
+  {
+    unsigned hits;
+    unsigned misses;
+    unsigned rejected;
+    quint64 linkNs;
+    quint64 savedNs;
+  };
+  static void setBinaryCacheEnabled(bool enabled);
+  static BinaryCacheStatistics const &binaryCacheStatistics();
+  static void reportBinaryCache();
+
+  // Asynchronous compilation: Between beginBatch() and endBatch() sources are
+  // only recorded and link() queues the program. endBatch() preprocesses all
+  // queued sources on the worker threads and submits every program without
+  // waiting on the driver (which compiles them in parallel when it supports
+  // KHR_parallel_shader_compile). The link status is checked on first use:
+  // bind(), uniformLocation() or finishLink(). Batches may be nested.
+  struct CompileStatistics
+  {
+    unsigned programs;
+    unsigned stalled;
+    quint64 preprocessNs;
+    quint64 submitNs;
+    quint64 waitNs;
+  };
+  static void beginBatch();
+  static void endBatch();
+  static bool parallelCompileSupported();
+  static CompileStatistics const &compileStatistics();
+  static void reportCompile();
+  bool linkAsync();
+  bool isReady();
+  bool finishLink();
+
+  // Reflection: Active uniforms, uniform blocks and subroutines are enumerated
+  // once after linking, so the lookups below do not query GL. Still, resolve
+  // them at setup and keep the result rather than looking up per frame.
+  int uniformLocation(char const *name);
+  int uniformLocation(QByteArray const &name);
+  int uniformLocation(QString const &name);
   void uniformBlockBinding(char const* location, unsigned index);
   void uniformBlockBinding(unsigned location, unsigned index);
   unsigned uniformBlockLocation(char const* location);
+  unsigned subroutineIndex(GLenum stage, char const *name);
+  int subroutineUniformLocation(GLenum stage, char const *name);
   void scheduleUniformBlockUpdate(unsigned location, unsigned index);
   void scheduleUniformUpdate(unsigned location, unsigned index);
   QString getVersionComment();
   void addShaderDefines(char const *defs);
   bool link();
   bool bind();
+  void release();
 private:
+  static void flushBatch();
   OpenGLShaderProgramPrivate *m_private;
 };
 
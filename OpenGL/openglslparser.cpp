@@ -1,10 +1,16 @@
 #include "openglslparser.h"
 #include <QDir>
 
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
 #include <KAbstractReader>
 #include <KAbstractWriter>
 #include <KBufferedFileReader>
 #include <KCommon>
+#include "kstringwriter.h"
 
 // GLSL 3.30r6
 // (https://www.opengl.org/registry/doc/GLSLangSpec.3.30.6.clean.pdf)
@@ -44,6 +50,35 @@ static KParseMap<OpenGLSLToken> const sg_reserved =
 
 typedef KParseToken<OpenGLSLToken> ParseToken;
 
+/*******************************************************************************
+ * OpenGLSL Include Cache
+ ******************************************************************************/
+// An include expands the same way no matter who includes it (nested includes
+// resolve relative to the included file or the shared paths), so the expanded
+// text and the identifiers it registers are kept per absolute path.
+struct OpenGLSLInclude
+{
+  std::string m_source;
+  OpenGLSLParser::Autoresolver m_autobinder;
+  OpenGLSLParser::Autosampler m_autosampler;
+};
+
+typedef std::shared_ptr<OpenGLSLInclude const> OpenGLSLIncludePtr;
+static std::unordered_map<std::string, OpenGLSLIncludePtr> sg_includeCache;
+static std::mutex sg_includeMutex;
+
+static void appendUnique(std::vector<std::string> *dst, std::vector<std::string> const &src)
+{
+  if (!dst) return;
+  for (std::string const &identifier : src)
+  {
+    if (std::find(dst->begin(), dst->end(), identifier) == dst->end())
+    {
+      dst->push_back(identifier);
+    }
+  }
+}
+
 /*******************************************************************************
  * OpenGLSL Parser Private
  ******************************************************************************/
@@ -89,6 +124,7 @@ public:
   void setAutosampler(Autosampler *a);
   void addIncludePath(char const *path);
   static void addSharedIncludePath(char const *path);
+  static void clearIncludeCache();
 
 private:
   OpenGLSLParser *m_parent;
@@ -103,7 +139,7 @@ private:
 };
 
 OpenGLSLParserPrivate::OpenGLSLParserPrivate(OpenGLSLParser *parent, KAbstractReader *reader, KAbstractWriter *writer) :
-  KAbstractLexer<ParseToken>(reader), m_parent(parent), m_writer(writer)
+  KAbstractLexer<ParseToken>(reader), m_parent(parent), m_writer(writer), m_autobinder(Q_NULLPTR), m_autosampler(Q_NULLPTR)
 {
   // Intentionally Empty
 }
@@ -401,14 +437,34 @@ bool OpenGLSLParserPrivate::parse()
 
 void OpenGLSLParserPrivate::parseInclude()
 {
-  char const *absolutePath = currToken().m_lexicon.c_str();
-  KBufferedFileReader reader(absolutePath, 2014);
-  OpenGLSLParserPrivate subParse(m_parent, &reader, m_writer);
-  subParse.setFilePath(absolutePath);
-  subParse.setAutoresolver(m_autobinder);
-  subParse.setAutosampler(m_autosampler);
-  subParse.initializeLexer();
-  subParse.parse();
+  std::string absolutePath = currToken().m_lexicon;
+  OpenGLSLIncludePtr include;
+  {
+    std::lock_guard<std::mutex> lock(sg_includeMutex);
+    auto it = sg_includeCache.find(absolutePath);
+    if (it != sg_includeCache.end()) include = it->second;
+  }
+
+  // Expand once, outside of the lock since nested includes recurse.
+  if (!include)
+  {
+    std::shared_ptr<OpenGLSLInclude> expanded = std::make_shared<OpenGLSLInclude>();
+    KBufferedFileReader reader(absolutePath.c_str(), 2014);
+    KStringWriter writer(expanded->m_source);
+    OpenGLSLParserPrivate subParse(m_parent, &reader, &writer);
+    subParse.setFilePath(absolutePath.c_str());
+    subParse.setAutoresolver(&expanded->m_autobinder);
+    subParse.setAutosampler(&expanded->m_autosampler);
+    subParse.initializeLexer();
+    subParse.parse();
+
+    std::lock_guard<std::mutex> lock(sg_includeMutex);
+    include = sg_includeCache.emplace(absolutePath, expanded).first->second;
+  }
+
+  m_writer->append(include->m_source.c_str());
+  appendUnique(m_autobinder, include->m_autobinder);
+  appendUnique(m_autosampler, include->m_autosampler);
 }
 
 void OpenGLSLParserPrivate::autobindIdentifier()
@@ -458,7 +514,15 @@ void OpenGLSLParserPrivate::addIncludePath(const char *path)
 
 void OpenGLSLParserPrivate::addSharedIncludePath(const char *path)
 {
+  // Resolution of already expanded includes may change.
   m_sharedIncludePaths.push_back(path);
+  clearIncludeCache();
+}
+
+void OpenGLSLParserPrivate::clearIncludeCache()
+{
+  std::lock_guard<std::mutex> lock(sg_includeMutex);
+  sg_includeCache.clear();
 }
 
 /////////////
@@ -509,6 +573,11 @@ void OpenGLSLParser::addSharedIncludePath(const char *path)
   OpenGLSLParserPrivate::addSharedIncludePath(path);
 }
 
+void OpenGLSLParser::clearIncludeCache()
+{
+  OpenGLSLParserPrivate::clearIncludeCache();
+}
+
 bool OpenGLSLParser::parse()
 {
   P(OpenGLSLParserPrivate);
@@ -23,6 +23,9 @@ public:
   static void addSharedIncludePath(char const *path);
   bool parse();
 
+  // Expanded includes are shared by all parsers of the process.
+  static void clearIncludeCache();
+
 private:
   OpenGLSLParserPrivate *m_private;
 };
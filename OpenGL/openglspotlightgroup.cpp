@@ -30,14 +30,14 @@ bool OpenGLSpotLightGroup::create()
   return LightGroup::create();
 }
 
-void OpenGLSpotLightGroup::initializeMesh(OpenGLMesh &mesh)
+void OpenGLSpotLightGroup::initializeMesh(OpenGLMesh &mesh, int base)
 {
-  mesh.vertexAttribPointerDivisor(1, 4,     OpenGLElementType::Float, false, sizeof(DataType), DataType::TranslationOffset() , 1);
-  mesh.vertexAttribPointerDivisor(2, 4,     OpenGLElementType::Float, false, sizeof(DataType), DataType::DirectionOffset()   , 1);
-  mesh.vertexAttribPointerDivisor(4, 4,     OpenGLElementType::Float, false, sizeof(DataType), DataType::AttenuationOffset() , 1);
-  mesh.vertexAttribPointerDivisor(5, 4,     OpenGLElementType::Float, false, sizeof(DataType), DataType::DiffuseOffset()     , 1);
-  mesh.vertexAttribPointerDivisor(6, 3,     OpenGLElementType::Float, false, sizeof(DataType), DataType::SpecularOffset()    , 1);
-  mesh.vertexAttribPointerDivisor(7, 4, 4,  OpenGLElementType::Float, false, sizeof(DataType), DataType::PerpectiveOffset()  , 1);
+  mesh.vertexAttribPointerDivisor(1, 4,     OpenGLElementType::Float, false, sizeof(DataType), base + DataType::TranslationOffset() , 1);
+  mesh.vertexAttribPointerDivisor(2, 4,     OpenGLElementType::Float, false, sizeof(DataType), base + DataType::DirectionOffset()   , 1);
+  mesh.vertexAttribPointerDivisor(4, 4,     OpenGLElementType::Float, false, sizeof(DataType), base + DataType::AttenuationOffset() , 1);
+  mesh.vertexAttribPointerDivisor(5, 4,     OpenGLElementType::Float, false, sizeof(DataType), base + DataType::DiffuseOffset()     , 1);
+  mesh.vertexAttribPointerDivisor(6, 3,     OpenGLElementType::Float, false, sizeof(DataType), base + DataType::SpecularOffset()    , 1);
+  mesh.vertexAttribPointerDivisor(7, 4, 4,  OpenGLElementType::Float, false, sizeof(DataType), base + DataType::PerpectiveOffset()  , 1);
 }
 
 void OpenGLSpotLightGroup::translateBuffer(const OpenGLRenderBlock &stats, DataPointer data, ConstLightIterator begin, ConstLightIterator end)
@@ -41,6 +41,7 @@ enum class OpenGLInternalFormat
   Rgba32F               = 0x8814,
   Rg11B10F              = 0x8C3A,
   Rgb9E5                = 0x8C3D,
+  RgbBptcUnsignedFloat  = 0x8E8F,
   R8I                   = 0x8231,
   R8UI                  = 0x8232,
   R16I                  = 0x8233,
@@ -195,6 +196,8 @@ inline OpenGLFormat GetFormat(OpenGLInternalFormat s)
     return OpenGLFormat::Rgb;
   case OpenGLInternalFormat::Rgb9E5:
     return OpenGLFormat::Rgb;
+  case OpenGLInternalFormat::RgbBptcUnsignedFloat:
+    return OpenGLFormat::Rgb;
   case OpenGLInternalFormat::R8I:
     return OpenGLFormat::RedInteger;
   case OpenGLInternalFormat::R8UI:
@@ -335,6 +338,8 @@ inline OpenGLType GetType(OpenGLInternalFormat s)
     return OpenGLType::Float;
   case OpenGLInternalFormat::Rgb9E5:
     return OpenGLType::Float;
+  case OpenGLInternalFormat::RgbBptcUnsignedFloat:
+    return OpenGLType::HalfFloat;
   case OpenGLInternalFormat::R8I:
     return OpenGLType::UnsignedByte;
   case OpenGLInternalFormat::R8UI:
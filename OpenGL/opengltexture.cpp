@@ -130,6 +130,66 @@ void OpenGLTexture::allocate(void *data, int level)
   }
 }
 
+void OpenGLTexture::allocate(void const *data, int level, int width, int height, OpenGLType type)
+{
+  P(OpenGLTexturePrivate);
+  switch (p.m_target)
+  {
+  case Texture2D:
+    GL::glTexImage2D(p.m_target, level, static_cast<GLint>(p.m_format), width, height, 0, static_cast<GLenum>(GetFormat(p.m_format)), static_cast<GLenum>(type), data);
+    break;
+  case Texture1D:
+  case TextureRectangle:
+  case TextureCubeMap:
+  case ProxyTexture1D:
+  case ProxyTexture2D:
+  case ProxyTextureRectangle:
+  case ProxyTextureCubeMap:
+    qFatal("Unsupported Texture Type");
+    break;
+  }
+}
+
+void OpenGLTexture::allocateCompressed(void const *data, size_t size, int level, int width, int height)
+{
+  P(OpenGLTexturePrivate);
+  switch (p.m_target)
+  {
+  case Texture2D:
+    GL::glCompressedTexImage2D(p.m_target, level, static_cast<GLenum>(p.m_format), width, height, 0, static_cast<GLsizei>(size), data);
+    break;
+  case Texture1D:
+  case TextureRectangle:
+  case TextureCubeMap:
+  case ProxyTexture1D:
+  case ProxyTexture2D:
+  case ProxyTextureRectangle:
+  case ProxyTextureCubeMap:
+    qFatal("Unsupported Texture Type");
+    break;
+  }
+}
+
+void OpenGLTexture::allocate(OpenGLTexture::CubeMapFace face, void const *data, int level, int width, int height, OpenGLType type)
+{
+  P(OpenGLTexturePrivate);
+  if (p.m_target != TextureCubeMap)
+  {
+    qFatal("Cube map faces require a cube map texture");
+  }
+  GL::glTexImage2D(face, level, static_cast<GLint>(p.m_format), width, height, 0, static_cast<GLenum>(GetFormat(p.m_format)), static_cast<GLenum>(type), data);
+}
+
+void OpenGLTexture::allocateCompressed(OpenGLTexture::CubeMapFace face, void const *data, size_t size, int level, int width, int height)
+{
+  P(OpenGLTexturePrivate);
+  if (p.m_target != TextureCubeMap)
+  {
+    qFatal("Cube map faces require a cube map texture");
+  }
+  GL::glCompressedTexImage2D(face, level, static_cast<GLenum>(p.m_format), width, height, 0, static_cast<GLsizei>(size), data);
+}
+
 int OpenGLTexture::textureId()
 {
   P(OpenGLTexturePrivate);
@@ -156,6 +216,12 @@ int OpenGLTexture::getMaxLevel() const
   return result;
 }
 
+void OpenGLTexture::setMaxLevel(int level)
+{
+  P(OpenGLTexturePrivate);
+  GL::glTexParameteri(p.m_target, GL_TEXTURE_MAX_LEVEL, level);
+}
+
 const KSize &OpenGLTexture::size() const
 {
   P(const OpenGLTexturePrivate);
@@ -164,7 +230,7 @@ const KSize &OpenGLTexture::size() const
 
 int OpenGLTexture::numTextureUnits()
 {
-  return GL::getInteger<GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS>();
+  return GL::capabilities().maxCombinedTextureImageUnits;
 }
 
 GLenum OpenGLTexture::beginTextureUnits()
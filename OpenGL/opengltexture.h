@@ -22,10 +22,21 @@ public:
     ProxyTextureCubeMap         = 0x851B
   };
 
+  enum CubeMapFace
+  {
+    PositiveX                   = 0x8515,
+    NegativeX                   = 0x8516,
+    PositiveY                   = 0x8517,
+    NegativeY                   = 0x8518,
+    PositiveZ                   = 0x8519,
+    NegativeZ                   = 0x851A
+  };
+
   enum Direction
   {
     DirectionS                  = 0x2802,
     DirectionT                  = 0x2803,
+    DirectionR                  = 0x8072
   };
 
   enum WrapMode
@@ -93,10 +104,15 @@ public:
   void setCompareFunction(CompareFunction func);
   void allocate();
   void allocate(void *data, int level = 0);
+  void allocate(void const *data, int level, int width, int height, OpenGLType type);
+  void allocateCompressed(void const *data, size_t size, int level, int width, int height);
+  void allocate(CubeMapFace face, void const *data, int level, int width, int height, OpenGLType type);
+  void allocateCompressed(CubeMapFace face, void const *data, size_t size, int level, int width, int height);
   int textureId();
   Target target() const;
   void generateMipMaps();
   int getMaxLevel() const;
+  void setMaxLevel(int level);
   KSize const &size() const;
 
   // Texture Properties
@@ -1,5 +1,85 @@
 #include "opengltonemappingfunction.h"
 
+#include <cmath>
+#include <limits>
+#include <KParallel>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OPENGLTONEMAPPING_SSE2
+#include <emmintrin.h>
+#endif
+
+// Rows tone mapped per task.
+static const size_t RowGrain = 16;
+
+#ifdef OPENGLTONEMAPPING_SSE2
+static inline __m128 selectPs(__m128 mask, __m128 a, __m128 b)
+{
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// log2(x) for normal, positive x (atanh series around a mantissa near 1).
+static inline __m128 log2Ps(__m128 x)
+{
+  __m128i bits = _mm_castps_si128(x);
+  __m128i exponent = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127));
+  __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000)));
+  __m128 large = _mm_cmpgt_ps(m, _mm_set1_ps(1.41421356f));
+  m = selectPs(large, _mm_mul_ps(m, _mm_set1_ps(0.5f)), m);
+  exponent = _mm_sub_epi32(exponent, _mm_castps_si128(large));
+  __m128 s = _mm_div_ps(_mm_sub_ps(m, _mm_set1_ps(1.0f)), _mm_add_ps(m, _mm_set1_ps(1.0f)));
+  __m128 s2 = _mm_mul_ps(s, s);
+  __m128 series = _mm_add_ps(_mm_set1_ps(1.0f / 5.0f), _mm_mul_ps(s2, _mm_set1_ps(1.0f / 7.0f)));
+  series = _mm_add_ps(_mm_set1_ps(1.0f / 3.0f), _mm_mul_ps(s2, series));
+  series = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(s2, series));
+  __m128 ln = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(2.0f), s), series);
+  return _mm_add_ps(_mm_cvtepi32_ps(exponent), _mm_mul_ps(ln, _mm_set1_ps(1.44269504f)));
+}
+
+// 2^y, clamped to the normal float range (Taylor series of the fraction).
+static inline __m128 exp2Ps(__m128 y)
+{
+  y = _mm_max_ps(_mm_min_ps(y, _mm_set1_ps(127.0f)), _mm_set1_ps(-126.0f));
+  __m128i i = _mm_cvtps_epi32(y);
+  __m128 t = _mm_mul_ps(_mm_sub_ps(y, _mm_cvtepi32_ps(i)), _mm_set1_ps(0.69314718f));
+  __m128 p = _mm_add_ps(_mm_set1_ps(1.0f / 120.0f), _mm_mul_ps(t, _mm_set1_ps(1.0f / 720.0f)));
+  p = _mm_add_ps(_mm_set1_ps(1.0f / 24.0f), _mm_mul_ps(t, p));
+  p = _mm_add_ps(_mm_set1_ps(1.0f / 6.0f), _mm_mul_ps(t, p));
+  p = _mm_add_ps(_mm_set1_ps(1.0f / 2.0f), _mm_mul_ps(t, p));
+  p = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(t, p));
+  p = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(t, p));
+  __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(i, _mm_set1_epi32(127)), 23));
+  return _mm_mul_ps(p, scale);
+}
+#endif // OPENGLTONEMAPPING_SSE2
+
+/*******************************************************************************
+ * OpenGLToneMappingFunction
+ ******************************************************************************/
+OpenGLToneMappingFunction::~OpenGLToneMappingFunction()
+{
+  // Intentionally Empty
+}
+
+void OpenGLToneMappingFunction::apply(RgbF *pixels, size_t count) const
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    pixels[i] = (*this)(pixels[i]);
+  }
+}
+
+void OpenGLToneMappingFunction::applyParallel(RgbF *pixels, int width, int height) const
+{
+  Karma::parallelFor(0, size_t(height), RowGrain, [this, pixels, width](size_t b, size_t e)
+  {
+    apply(pixels + b * width, (e - b) * width);
+  });
+}
+
+/*******************************************************************************
+ * OpenGLStandardToneMapping
+ ******************************************************************************/
 OpenGLStandardToneMapping::OpenGLStandardToneMapping(float exposure, float contrast) :
   m_exposure(exposure), m_contrast(contrast)
 {
@@ -12,9 +92,44 @@ RgbF OpenGLStandardToneMapping::operator()(RgbF input) const
   return std::pow(eC / (eC + 1.0f), m_contrast / 2.2);
 }
 
+void OpenGLStandardToneMapping::apply(RgbF *pixels, size_t count) const
+{
+  // The curve is the same for every channel, so treat pixels as a float span.
+  float *values = &pixels[0].r;
+  size_t valueCount = 3 * count;
+  float gamma = float(m_contrast / 2.2);
+  size_t i = 0;
+#ifdef OPENGLTONEMAPPING_SSE2
+  __m128 exposure = _mm_set1_ps(m_exposure);
+  __m128 vGamma = _mm_set1_ps(gamma);
+  __m128 one = _mm_set1_ps(1.0f);
+  __m128 smallest = _mm_set1_ps(std::numeric_limits<float>::min());
+  for (; i + 4 <= valueCount; i += 4)
+  {
+    __m128 eC = _mm_mul_ps(exposure, _mm_loadu_ps(values + i));
+    __m128 x = _mm_div_ps(eC, _mm_add_ps(eC, one));
 
+    // Too small (or negative) values are black for any positive contrast
+    __m128 mapped = exp2Ps(_mm_mul_ps(vGamma, log2Ps(x)));
+    _mm_storeu_ps(values + i, _mm_and_ps(_mm_cmpge_ps(x, smallest), mapped));
+  }
+#endif // OPENGLTONEMAPPING_SSE2
+  for (; i < valueCount; ++i)
+  {
+    float eC = m_exposure * values[i];
+    values[i] = std::pow(eC / (eC + 1.0f), gamma);
+  }
+}
 
+/*******************************************************************************
+ * OpenGLDefaultToneMapping
+ ******************************************************************************/
 RgbF OpenGLDefaultToneMapping::operator()(RgbF input) const
 {
   return input;
 }
+
+void OpenGLDefaultToneMapping::apply(RgbF *, size_t) const
+{
+  // Intentionally Empty
+}
@@ -2,6 +2,7 @@
 #define OPENGLTONEMAPPINGFUNCTION_H OpenGLToneMappingFunction
 
 #include <algorithm>
+#include <cstddef>
 
 struct RgbF
 {
@@ -58,7 +59,12 @@ namespace std
 class OpenGLToneMappingFunction : public std::unary_function<RgbF, RgbF>
 {
 public:
+  virtual ~OpenGLToneMappingFunction();
   virtual RgbF operator()(RgbF input) const = 0;
+
+  // Batch Mapping (In place; the default calls operator() per pixel)
+  virtual void apply(RgbF *pixels, size_t count) const;
+  void applyParallel(RgbF *pixels, int width, int height) const;
 };
 
 class OpenGLStandardToneMapping : public OpenGLToneMappingFunction
@@ -66,6 +72,7 @@ class OpenGLStandardToneMapping : public OpenGLToneMappingFunction
 public:
   OpenGLStandardToneMapping(float exposure, float contrast);
   virtual RgbF operator()(RgbF input) const;
+  virtual void apply(RgbF *pixels, size_t count) const;
 private:
   float m_exposure, m_contrast;
 };
@@ -74,6 +81,7 @@ class OpenGLDefaultToneMapping : public OpenGLToneMappingFunction
 {
 public:
   virtual RgbF operator()(RgbF input) const;
+  virtual void apply(RgbF *pixels, size_t count) const;
 };
 
 #endif // OPENGLTONEMAPPINGFUNCTION_H
@@ -44,9 +44,7 @@ void OpenGLUniformBufferObject::bindBufferId(unsigned index, GLuint buffer)
 
 int OpenGLUniformBufferObject::getAlignment()
 {
-  GLint offset;
-  GL::glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offset);
-  return int(offset);
+  return GL::capabilities().uniformBufferOffsetAlignment;
 }
 
 int OpenGLUniformBufferObject::alignmentOffset()
@@ -2,6 +2,7 @@
 #define OPENGLVERTEXARRAYOBJECT_H OpenGLVertexArrayObject
 
 #include <OpenGLCommon>
+#include <OpenGLFunctions>
 #include <QOpenGLVertexArrayObject>
 
 // Register to check OpenGLVertexArrayObject
@@ -30,6 +31,10 @@ class OpenGLVertexArrayObject : public OpenGLVertexArrayObjectProfiled
 {
 public:
   explicit OpenGLVertexArrayObject(QObject *parent = 0) : OpenGLVertexArrayObjectProfiled(parent) {}
+
+  // Through GL:: instead of Qt, so redundant binds are dropped.
+  void bind() { GL::glBindVertexArray(objectId()); }
+  void release() { GL::glBindVertexArray(0); }
 };
 
 #endif // OPENGLVERTEXARRAYOBJECT_H
@@ -22,6 +22,7 @@ public:
   void swapRenderBlocks();
   void fixRenderBlocks();
   void updateRenderBlocks();
+  void bindRenderBlocks();
   bool viewportDirty();
 
   float m_aspectRatio;
@@ -36,6 +37,8 @@ public:
   OpenGLRenderBlock m_renderBlocks[2];
   int m_renderBlockIndex[2];
   int m_renderBlockBindings[2];
+  int m_boundRenderBlocks[2];
+  bool m_bound;
 };
 
 OpenGLViewportPrivate::OpenGLViewportPrivate() :
@@ -45,6 +48,9 @@ OpenGLViewportPrivate::OpenGLViewportPrivate() :
   m_renderBlockIndex[1] = 1;    // Previous Index
   m_renderBlockBindings[0] = 0; // Current Binding
   m_renderBlockBindings[1] = 0; // Previous Binding
+  m_boundRenderBlocks[0] = 0;
+  m_boundRenderBlocks[1] = 0;
+  m_bound = false;
 }
 
 OpenGLViewportPrivate::~OpenGLViewportPrivate()
@@ -88,16 +94,23 @@ void OpenGLViewportPrivate::fixRenderBlocks()
 
 void OpenGLViewportPrivate::updateRenderBlocks()
 {
-  // Update previous/current render block data (if needed)
+  // Stream both render blocks, ring buffer allocations only last a few frames.
   for (int i = 0; i < 2; ++i)
   {
-    if (m_renderBlocks[i].dirty())
-    {
-      m_renderBlocks[i].bind();
-      m_renderBlocks[i].update();
-      m_renderBlocks[i].release();
-    }
+    m_renderBlocks[i].update();
   }
+
+  // Rebind the blocks picked in bind() at their new location.
+  if (m_bound)
+  {
+    bindRenderBlocks();
+  }
+}
+
+void OpenGLViewportPrivate::bindRenderBlocks()
+{
+  m_renderBlocks[m_boundRenderBlocks[0]].bindBlock(K_CURRENT_VIEW_BINDING);
+  m_renderBlocks[m_boundRenderBlocks[1]].bindBlock(K_PREVIOUS_VIEW_BINDING);
 }
 
 bool OpenGLViewportPrivate::viewportDirty()
@@ -121,26 +134,21 @@ OpenGLViewport::~OpenGLViewport()
 void OpenGLViewport::create()
 {
   m_private = new OpenGLViewportPrivate;
-  P(OpenGLViewportPrivate);
-  for (int i = 0; i < 2; ++i)
-  {
-    p.m_renderBlocks[i].create();
-    p.m_renderBlocks[i].setUsagePattern(OpenGLBuffer::DynamicDraw);
-    p.m_renderBlocks[i].bind();
-    p.m_renderBlocks[i].allocate();
-    p.m_renderBlocks[i].release();
-  }
 }
 
 void OpenGLViewport::bind()
 {
   P(OpenGLViewportPrivate);
-  p.currentRenderBlock().bindBase(K_CURRENT_VIEW_BINDING);
-  p.previousRenderBlock().bindBase(K_PREVIOUS_VIEW_BINDING);
+  p.m_boundRenderBlocks[0] = p.m_renderBlockBindings[0];
+  p.m_boundRenderBlocks[1] = p.m_renderBlockBindings[1];
+  p.m_bound = true;
+  p.bindRenderBlocks();
 }
 
 void OpenGLViewport::release()
 {
+  P(OpenGLViewportPrivate);
+  p.m_bound = false;
   OpenGLUniformBufferObject::bindBufferId(K_CURRENT_VIEW_BINDING, 0);
   OpenGLUniformBufferObject::bindBufferId(K_PREVIOUS_VIEW_BINDING, 0);
 }
@@ -2,6 +2,8 @@
 #include "openglframeresults.h"
 #include "openglframetimer.h"
 #include "openglprofiler.h"
+#include "openglprofilercapture.h"
+#include "openglprofilerstatistics.h"
 #include "openglprofilervisualizer.h"
 
 #include <QApplication>
@@ -13,6 +15,7 @@
 #include <QOpenGLDebugMessage>
 #include <OpenGLDebugDraw>
 #include <OpenGLFramebufferObject>
+#include <OpenGLRingBuffer>
 
 #include <KCommon>
 #include <KInputManager>
@@ -33,12 +36,17 @@ public:
   bool m_profilerVisible;
   OpenGLProfiler m_profiler;
   OpenGLProfilerVisualizer m_profilerVisualizer;
+  OpenGLProfilerCapture m_profilerCapture;
+  QString m_profilerCaptureFile;
+  OpenGLProfilerStatistics m_profilerStatistics;
+  QString m_profilerStatisticsFile;
   OpenGLFrameTimer m_frameTimer;
+  OpenGLRingBuffer m_ringBuffer;
   QOpenGLDebugLogger *m_debugLogger;
 };
 
 OpenGLWidgetPrivate::OpenGLWidgetPrivate(QObject *parent) :
-  m_profilerVisible(false), m_profiler(parent), m_profilerVisualizer(parent), m_frameTimer(parent), m_debugLogger(Q_NULLPTR)
+  m_profilerVisible(false), m_profiler(parent), m_profilerVisualizer(parent), m_profilerCapture(parent), m_profilerStatistics(parent), m_frameTimer(parent), m_debugLogger(Q_NULLPTR)
 {
   // Intentionally Empty
 }
@@ -63,6 +71,15 @@ OpenGLWidget::OpenGLWidget(QWidget *parent) :
 
 OpenGLWidget::~OpenGLWidget()
 {
+  P(OpenGLWidgetPrivate);
+  if (!p.m_profilerCaptureFile.isEmpty())
+  {
+    qDebug() << "Profiler Capture" << (saveProfilerCapture(p.m_profilerCaptureFile) ? "saved to" : "failed to save to") << p.m_profilerCaptureFile;
+  }
+  if (!p.m_profilerStatisticsFile.isEmpty())
+  {
+    qDebug() << "Profiler Statistics" << (saveProfilerStatistics(p.m_profilerStatisticsFile) ? "saved to" : "failed to save to") << p.m_profilerStatisticsFile;
+  }
   makeCurrent();
   delete m_private;
 }
@@ -106,6 +123,31 @@ bool OpenGLWidget::profilerVisible() const
   return p.m_profilerVisible;
 }
 
+void OpenGLWidget::setProfilerRecording(bool recording, bool clear)
+{
+  P(OpenGLWidgetPrivate);
+  if (clear) p.m_profilerCapture.clear();
+  p.m_profilerCapture.setRecording(recording);
+}
+
+bool OpenGLWidget::profilerRecording() const
+{
+  P(OpenGLWidgetPrivate);
+  return p.m_profilerCapture.isRecording();
+}
+
+bool OpenGLWidget::saveProfilerCapture(QString const &fileName) const
+{
+  P(OpenGLWidgetPrivate);
+  return p.m_profilerCapture.save(fileName);
+}
+
+bool OpenGLWidget::saveProfilerStatistics(QString const &fileName) const
+{
+  P(OpenGLWidgetPrivate);
+  return p.m_profilerStatistics.save(fileName);
+}
+
 /*******************************************************************************
  * OpenGL Protected Methods
  ******************************************************************************/
@@ -116,9 +158,37 @@ void OpenGLWidget::initializeGL()
   // Initialize
   initializeOpenGLFunctions();
   GL::setInstance(this);
+
+  // Every wrapper calls through the table, a null entry would crash later on.
+  std::vector<char const*> missing;
+  if (!GL::resolve(context(), &missing))
+  {
+    QByteArray names;
+    for (char const *name : missing)
+    {
+      names.append(' ').append(name);
+    }
+    qFatal("OpenGLWidget: The context is missing required entry points:%s", names.constData());
+  }
+  if (p.m_ringBuffer.create())
+  {
+    OpenGLRingBuffer::setRingBuffer(&p.m_ringBuffer);
+  }
   if (p.m_profiler.initialize())
   {
     connect(&p.m_profiler, SIGNAL(frameResultsAvailable(OpenGLFrameResults)), &p.m_profilerVisualizer, SLOT(frameResultsAvailable(OpenGLFrameResults)));
+    connect(&p.m_profiler, SIGNAL(frameResultsAvailable(OpenGLFrameResults)), &p.m_profilerCapture, SLOT(frameResultsAvailable(OpenGLFrameResults)));
+    connect(&p.m_profiler, SIGNAL(frameResultsAvailable(OpenGLFrameResults)), &p.m_profilerStatistics, SLOT(frameResultsAvailable(OpenGLFrameResults)));
+
+    // KARMA_PROFILER_CAPTURE=<file> records from the start, saved on exit.
+    p.m_profilerCaptureFile = qgetenv("KARMA_PROFILER_CAPTURE");
+    if (!p.m_profilerCaptureFile.isEmpty())
+    {
+      p.m_profilerCapture.setRecording(true);
+    }
+
+    // KARMA_PROFILER_STATISTICS=<file> saves the rolling statistics on exit.
+    p.m_profilerStatisticsFile = qgetenv("KARMA_PROFILER_STATISTICS");
   }
   connect(this, SIGNAL(frameSwapped()), this, SLOT(update()));
   connect(this, SIGNAL(frameSwapped()), &p.m_frameTimer, SLOT(frameSwapped()));
@@ -161,12 +231,16 @@ void OpenGLWidget::paintGL()
     p.m_profilerVisualizer.paintGL();
   }
   OpenGLDebugDraw::draw();
+  p.m_ringBuffer.endFrame();
   QOpenGLWidget::paintGL();
 }
 
 void OpenGLWidget::teardownGL()
 {
+  P(OpenGLWidgetPrivate);
   OpenGLDebugDraw::teardown();
+  p.m_ringBuffer.destroy();
+  OpenGLRingBuffer::setRingBuffer(Q_NULLPTR);
 }
 
 /*******************************************************************************
@@ -32,6 +32,10 @@ public:
   void printVersionInformation();
   void setProfilerVisible(bool visible);
   bool profilerVisible() const;
+  void setProfilerRecording(bool recording, bool clear = false);
+  bool profilerRecording() const;
+  bool saveProfilerCapture(QString const &fileName) const;
+  bool saveProfilerStatistics(QString const &fileName) const;
 
   // Static Widget functions
   static void sMakeCurrent();
@@ -10,9 +10,11 @@ system(echo Creating config.pri.user... && echo BINARY_ROOT = \"$${OUT_PWD}\" >
 
 # Execute perl script to generate headers if perl is installed
 system(where /q perl && cd $${PWD} && perl scripts/GenHeaders.pl)
+system(where /q perl && cd $${PWD} && perl scripts/GenDispatch.pl)
 
 SUBDIRS =     \
   qtbaseExt   \
   Karma       \
   OpenGL      \
-  KarmaView
+  KarmaView   \
+  KarmaBenchmark
@@ -18,6 +18,10 @@ android {
   DEFINES += "QT_OPENGL_ES_3"
 }
 
+# Uncomment to log timing/scaling benchmarks from the sample scene and to
+# run the benchmarks and tolerance checks of KarmaBenchmark.
+#DEFINES += "KARMA_BENCHMARK"
+
 win32:CONFIG(release, debug|release): OUT_SUBDIR = release/
 win32:CONFIG(debug, debug|release): OUT_SUBDIR = debug/
 
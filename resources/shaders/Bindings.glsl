@@ -18,6 +18,7 @@
 #define K_SURFACE_TEXTURE_BINDING       14
 #define K_LIGHT_BUFFER_TEXTURE_BINDING  15
 #define K_AMBIENT_OCCLUSION_BINDING     16
+#define K_BRDF_LOOKUP_BINDING           17
 
 // Uniform Blocks
 #define K_CURRENT_VIEW_BINDING  1
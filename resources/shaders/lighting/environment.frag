@@ -10,16 +10,31 @@
 #include <GlobalBuffer.ubo>
 #include <Bindings.glsl>
 #include <Physical.glsl>
-#include <Hammersley.ubo>
 #include <ToneMapping.glsl>
 
+// K_CUBE_ENVIRONMENT selects cube maps for the environment and the
+// prefiltered chain (see OpenGLEnvironment::setCubeMapEnabled()).
+#ifdef K_CUBE_ENVIRONMENT
+#define EnvironmentSampler samplerCube
+#else
+#define EnvironmentSampler sampler2D
+#endif
+
 layout(binding = K_TEXTURE_0)
-uniform sampler2D environment;
+uniform EnvironmentSampler environment;
 layout(binding = K_TEXTURE_1)
 uniform sampler2D irradiance;
-uniform uvec2 Dimensions = uvec2(1200,2400);
+layout(binding = K_TEXTURE_2)
+uniform EnvironmentSampler prefiltered;
 layout(binding = K_AMBIENT_OCCLUSION_BINDING)
 uniform sampler2D ambientOcclusion;
+layout(binding = K_BRDF_LOOKUP_BINDING)
+uniform sampler2D brdfLookup;
+
+// Baked by OpenGLEnvironment (see KEnvironmentBaker).
+uniform vec3 IrradianceSH[9];
+uniform float PrefilteredMaxLevel = 5.0;
+uniform bool HasIrradianceMap = false;
 
 // Light Output
 layout(location = 0) out highp vec4 fFragColor;
@@ -31,58 +46,43 @@ vec3 rEnv(vec3 N)
   return vec3(-N.x, N.z, -N.y);
 }
 
-// Computes the exact mip-map to reference for the specular contribution.
-// Accessing the proper mip-map allows us to approximate the integral for this
-// angle of incidence on the current object.
-float compute_lod(uint NumSamples, float NoH)
+vec4 textureEnvironmentLod(EnvironmentSampler tex, vec3 N, float lod)
 {
-  return 0.5 * (log2(float(Dimensions.x * Dimensions.y) / NumSamples) - log2(D(NoH)));
+#ifdef K_CUBE_ENVIRONMENT
+  return textureLod(tex, N, lod);
+#else
+  return textureSphereLod(tex, N, lod);
+#endif
+}
+
+// Evaluates the second-order spherical harmonics irradiance. The coefficients
+// are already convolved with the cosine lobe, so this is the irradiance itself.
+vec3 irradianceSH(vec3 N)
+{
+  return IrradianceSH[0] * 0.282095
+       + IrradianceSH[1] * (0.488603 * N.y)
+       + IrradianceSH[2] * (0.488603 * N.z)
+       + IrradianceSH[3] * (0.488603 * N.x)
+       + IrradianceSH[4] * (1.092548 * N.x * N.y)
+       + IrradianceSH[5] * (1.092548 * N.y * N.z)
+       + IrradianceSH[6] * (0.315392 * (3.0 * N.z * N.z - 1.0))
+       + IrradianceSH[7] * (1.092548 * N.x * N.z)
+       + IrradianceSH[8] * (0.546274 * (N.x * N.x - N.y * N.y));
 }
 
 // Calculates the specular influence for a surface at the current fragment
-// location. This is an approximation of the lighting integral itself.
+// location with the split-sum approximation: The radiance is prefiltered per
+// roughness level on the CPU, and the BRDF integral (for the selected factors)
+// is a scale and bias of F0 read from the lookup table.
 vec3 radiance(vec3 N, vec3 V)
 {
-  // Precalculate rotation for +Z Hemisphere to microfacet normal.
-  vec3 UpVector = abs(N.z) < 0.999 ? ZAxis : XAxis;
-  vec3 TangentX = normalize(cross( UpVector, N ));
-  vec3 TangentY = cross(N, TangentX);
-
   // Note: I ended up using abs() for situations where the normal is
   // facing a little away from the view to still accept the approximation.
-  // I believe this is due to a separate issue with normal storage, so
-  // you may only need to saturate() each dot value instead of abs().
   float NoV = abs(dot(N, V));
-
-  // Approximate the integral for lighting contribution.
-  vec3 fColor = vec3(0.0);
-  const uint NumSamples = 20;
-  for (uint i = 0; i < NumSamples; ++i)
-  {
-    vec2 Xi = Hammersley(i, NumSamples);
-    vec3 Li = S(Xi); // Defined elsewhere as subroutine
-    vec3 H  = normalize(Li.x * TangentX + Li.y * TangentY + Li.z * N);
-    vec3 L  = normalize(-reflect(V, H));
-
-    // Calculate dot products for BRDF
-    float NoL = abs(dot(N, L));
-    float NoH = abs(dot(N, H));
-    float VoH = abs(dot(V, H));
-    float lod = compute_lod(NumSamples, NoH);
-
-    float F_ = F(VoH); // Defined elsewhere as subroutine
-    float G_ = G(NoL, NoV, NoH, VoH); // Defined elsewhere as subroutine
-    vec3 LColor = textureSphereLod(environment, rEnv(L), lod).rgb;
-
-    // Since the sample is skewed towards the Distribution, we don't need
-    // to evaluate all of the factors for the lighting equation. Also note
-    // that this function is calculating the specular portion, so we absolutely
-    // do not add any more diffuse here.
-    fColor += F_ * G_ * LColor * VoH / (NoH * NoV);
-  }
-
-  // Average the results
-  return fColor / float(NumSamples);
+  vec3 R = normalize(-reflect(V, N));
+  vec3 LColor = textureEnvironmentLod(prefiltered, rEnv(R), roughness() * PrefilteredMaxLevel).rgb;
+  vec2 Kbrdf = texture(brdfLookup, vec2(NoV, roughness())).rg;
+  return LColor * (metallic() * Kbrdf.x + Kbrdf.y);
 }
 
 void main()
@@ -91,7 +91,7 @@ void main()
   vec3 color;
   if (depth() == 1.0)
   {
-    color = textureSphereLod(environment, rEnv(-V), 0.0).rgb;
+    color = textureEnvironmentLod(environment, rEnv(-V), 0.0).rgb;
   }
   else
   {
@@ -101,7 +101,7 @@ void main()
     float NoL = saturate(dot(N, L));
 
     // Calculate the color
-    vec3 irrMap = textureSphereLod(irradiance, rEnv(N), 0.0).rgb;
+    vec3 irrMap = HasIrradianceMap ? textureSphereLod(irradiance, rEnv(N), 0.0).rgb : irradianceSH(rEnv(N));
     vec3 Kdiff  = irrMap * baseColor() / pi;
     vec3 Kspec  = radiance(N, V);
 
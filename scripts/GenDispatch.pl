@@ -0,0 +1,117 @@
+#!/usr/bin/env perl
+
+# GenDispatch.pl
+# Generates OpenGL/opengldispatchentries.h, the entry points of OpenGLDispatch.
+# Every function called by the GL:: wrappers in OpenGL/openglfunctions.h gets
+# an entry, flagged with the profiles (OpenGL/openglfunctions_*.h) which have
+# it. Run from the source root whenever a wrapper is added.
+
+use warnings;
+use strict;
+use Cwd;
+
+my $cwd = getcwd;
+my $srcDir = $cwd . "/OpenGL/";
+my $outFile = $srcDir . "opengldispatchentries.h";
+
+my %profiles =
+(
+  "Core33" => "openglfunctions_3_3_core.h",
+  "Core43" => "openglfunctions_4_3_core.h",
+  "Es30"   => "openglfunctions_es3_0.h"
+);
+
+sub read_file
+{
+  my ($filename) = @_;
+  open my $file, "<", $filename or die $!;
+  local $/;
+  my $contents = <$file>;
+  close $file;
+  return $contents;
+}
+
+sub trim
+{
+  my ($str) = @_;
+  $str =~ s/\s+/ /g;
+  $str =~ s/^\s+|\s+$//g;
+  return $str;
+}
+
+# Loosely comparable parameter type (the wrappers use aliases like GLclampf)
+sub base_type
+{
+  my ($type) = @_;
+  $type =~ s/\bconst\b//g;
+  $type =~ s/GLclampf/GLfloat/g;
+  $type =~ s/GLvoid/void/g;
+  $type =~ s/GLsizei/GLint/g;
+  $type =~ s/\s+//g;
+  return $type;
+}
+
+# Functions (and their parameter types) of each profile
+my %available;
+foreach my $profile (keys %profiles)
+{
+  my $contents = read_file($srcDir . $profiles{$profile});
+  while ($contents =~ /GL_PROFILE\(\w+,\s*(gl\w+)\s*(?:,([^)]*))?\)/g)
+  {
+    my @types = grep { /\S/ } split(/,/, defined $2 ? $2 : "");
+    $available{$1}{$profile} = [ map { trim($_) } @types ];
+  }
+}
+
+# The table needs the real signature, the wrappers may convert (e.g. the
+# desktop glDepthRange takes doubles). Keeps the wrapper's parameter names.
+sub entry_params
+{
+  my ($name, $params, @flags) = @_;
+  my @params = grep { /\S/ } split(/,/, $params);
+  foreach my $profile (@flags)
+  {
+    my @types = @{ $available{$name}{$profile} };
+    next unless scalar(@types) == scalar(@params);
+    my @names = map { /(\w+)\s*$/ ? $1 : "" } @params;
+    my @wrapped = map { my $p = $_; $p =~ s/\w+\s*$//; base_type($p) } @params;
+    next if join(",", @wrapped) eq join(",", map { base_type($_) } @types);
+    return join(", ", map { "$types[$_] $names[$_]" } 0 .. $#types);
+  }
+  return $params;
+}
+
+# Entry points called by the wrappers, in order of appearance
+my @entries;
+my %seen;
+my $wrappers = read_file($srcDir . "openglfunctions.h");
+while ($wrappers =~ /static\s+(?:inline\s+)?([\w\s\*]+?)\s*\b(gl\w+)\s*\(([^)]*)\)\s*(;|\{[^}]*\})/g)
+{
+  my ($ret, $wrapper, $params, $body) = (trim($1), $2, trim($3), $4);
+  my @names = ($body =~ /GL_DISPATCH->\s*(gl\w+)/g);
+  @names = ($wrapper) unless @names;
+  foreach my $name (@names)
+  {
+    next if $seen{$name}++;
+    my @flags = grep { $available{$name}{$_} } sort keys %profiles;
+    die "No profile provides $name" unless @flags;
+    push @entries, [ join(" | ", @flags), $ret, $name, entry_params($name, $params, reverse @flags) ];
+  }
+}
+
+# ES 3.0 entries first, the rest only exists on desktop GL.
+open my $out, ">", $outFile or die $!;
+print $out "// Generated by scripts/GenDispatch.pl, do not edit.\n";
+print $out "// GL_ENTRY(Profiles, ReturnType, Name, (Parameters))\n\n";
+foreach my $entry (grep { $_->[0] =~ /Es30/ } @entries)
+{
+  print $out "GL_ENTRY($entry->[0], $entry->[1], $entry->[2], ($entry->[3]))\n";
+}
+print $out "\n#if !defined(QT_NO_OPENGL) && !defined(QT_OPENGL_ES_2)\n";
+foreach my $entry (grep { $_->[0] !~ /Es30/ } @entries)
+{
+  print $out "GL_ENTRY($entry->[0], $entry->[1], $entry->[2], ($entry->[3]))\n";
+}
+print $out "#endif\n";
+close $out;
+print "Generated $outFile (" . scalar(@entries) . " entries)\n";